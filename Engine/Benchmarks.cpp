@@ -0,0 +1,663 @@
+#include "Benchmarks.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+
+#include "Editor/EditorScene.h"
+
+#include "Utils/Time.h"
+#include "Utils/JobSystem.h"
+#include "Scene/ColliderBaking.h"
+#include "Scene/PhysicsQueries.h"
+
+using namespace Editor;
+
+namespace
+{
+	// Runs `function` the given number of times and logs the timings, returns the average in milliseconds
+	template<typename Function>
+	float Measure(const char* name, uint32_t iterations, Function&& function)
+	{
+		std::vector<float> samples;
+		samples.reserve(iterations);
+
+		Timer timer;
+		for (uint32_t i = 0; i < std::max(iterations, 1u); i++)
+		{
+			timer.Start();
+			function();
+			samples.push_back(timer.GetElapsedTime() * 1000.f);
+		}
+
+		std::sort(samples.begin(), samples.end());
+		float sum = 0.f;
+		for (float sample : samples)
+			sum += sample;
+
+		float average = sum / float(samples.size());
+		WC_CORE_INFO("{:<36} avg {:9.3f}ms  min {:9.3f}ms  max {:9.3f}ms", name, average, samples.front(), samples.back());
+		return average;
+	}
+
+	// 1, 2, 4, ... threads up to one per hardware thread
+	std::vector<uint32_t> GetThreadCounts()
+	{
+		const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+		std::vector<uint32_t> threadCounts;
+		for (uint32_t threads = 1; threads < hardwareThreads; threads *= 2)
+			threadCounts.push_back(threads);
+		threadCounts.push_back(hardwareThreads);
+		return threadCounts;
+	}
+
+	// Benchmarks resize the job system, it gets the workers it had before back at the end of the scope
+	struct ScopedWorkers
+	{
+		const uint32_t Previous = jobSystem.GetWorkerCount();
+
+		~ScopedWorkers() { jobSystem.Create(Previous); }
+
+		void SetThreads(uint32_t threads) { jobSystem.Create(threads - 1); }
+	};
+
+	flecs::entity AddBox(EditorScene& scene, glm::vec2 position, BodyType type, const BoxCollider2DComponent& collider)
+	{
+		auto entity = scene.AddEntity();
+		entity.set<TransformComponent>({ .Translation = { position, 0.f } });
+		entity.set<RigidBodyComponent>({ .Type = type });
+		entity.set<BoxCollider2DComponent>(collider);
+		return entity;
+	}
+
+	// A static ground with `count` dynamic unit boxes above it in rows of `columns`, centered on x = 0. `layer` gives
+	// the collision layer of each box
+	void MakeBoxPile(EditorScene& scene, uint32_t count, uint32_t columns, uint32_t material, uint32_t (*layer)(uint32_t index) = nullptr)
+	{
+		AddBox(scene, { 0.f, -1.f }, BodyType::Static, { .Size = { 1000.f, 1.f }, .MaterialID = material });
+		for (uint32_t i = 0; i < count; i++)
+			AddBox(scene, { float(i % columns) * 1.1f - columns * 0.55f, float(i / columns) * 1.1f }, BodyType::Dynamic, { .MaterialID = material, .Layer = layer ? layer(i) : 0 });
+	}
+
+	// Builds the world, lets it settle for `warmupSteps` and measures `steps` more, all with the scene's sub-steps
+	float MeasureSteps(const char* name, Scene& world, uint32_t warmupSteps, uint32_t steps)
+	{
+		auto Step = [&]() { world.PhysicsWorld.Step(world.SimulationTime, world.PhysicsWorldData.SubSteps); };
+
+		world.CreatePhysicsWorld();
+		for (uint32_t i = 0; i < warmupSteps; i++)
+			Step();
+
+		return Measure(name, steps, Step);
+	}
+
+	ScriptBinary CompileBenchmarkScript(const std::string& name, std::string_view source)
+	{
+		ScriptBinary binary;
+		binary.Name = name;
+		size_t bytecodeSize = 0;
+		char* bytecode = luau_compile(source.data(), source.size(), nullptr, &bytecodeSize);
+		binary.binary.assign((uint8_t*)bytecode, (uint8_t*)bytecode + bytecodeSize);
+		free(bytecode);
+		return binary;
+	}
+
+	// 10k sprites over 2k textures, compares the old reverse cache scan against the slot name table and times
+	// saving/loading a scene that references its assets through the AssetRegistry, as YAML and as a binary scene
+	void AssetsBenchmark(const BenchmarkOptions& options)
+	{
+		namespace fs = std::filesystem;
+
+		constexpr uint32_t ENTITY_COUNT = 10'000;
+		constexpr uint32_t TEXTURE_COUNT = 2'000;
+
+		fs::path project = fs::temp_directory_path() / "blaze_benchmark_assets";
+		fs::remove_all(project);
+		fs::create_directories(project / "Textures");
+		std::string projectPath = fs::absolute(project).lexically_normal().generic_string();
+		std::string scenePath = projectPath + "/benchmark.scene";
+
+		assetRegistry.Open(projectPath);
+
+		// Named slots without GPU resources, LoadTexture finds them in the cache so nothing gets uploaded
+		assetManager.PushTexture(Texture(), "None");
+		for (uint32_t i = 0; i < TEXTURE_COUNT; i++)
+			assetManager.PushTexture(Texture(), std::format("{}/Textures/texture_{}.png", projectPath, i));
+
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+
+		EditorScene scene;
+		scene.Path = scenePath;
+		scene.basePath = projectPath + '/';
+
+		std::vector<uint32_t> textures(ENTITY_COUNT);
+		for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+		{
+			textures[i] = 1 + (i * 7919) % TEXTURE_COUNT;
+
+			auto entity = scene.AddEntity(std::format("Entity {}", i));
+			entity.set<TransformComponent>({ .Translation = { float(i % 100), float(i / 100), 0.f } });
+			entity.set<SpriteRendererComponent>({ .Texture = textures[i] });
+			if (i % 10 == 0) entity.set<BoxCollider2DComponent>({ .MaterialID = material });
+		}
+
+		WC_CORE_INFO("Assets: {} entities, {} textures, {} iterations", ENTITY_COUNT, TEXTURE_COUNT, options.Iterations);
+
+		size_t sink = 0;
+		float scanTime = Measure("Texture lookup (cache scan)", options.Iterations, [&]() {
+			for (uint32_t texture : textures)
+				for (const auto& [name, id] : assetManager.TextureCache)
+					if (id == texture)
+					{
+						sink += name.size();
+						break;
+					}
+			});
+
+		float slotTime = Measure("Texture lookup (slot names)", options.Iterations, [&]() {
+			for (uint32_t texture : textures)
+				sink += assetManager.GetTextureName(texture).size();
+			});
+		WC_CORE_INFO("{:<36} {:.1f}x", "Lookup speedup", scanTime / std::max(slotTime, 1e-6f));
+
+		Measure("Save (first, imports assets)", 1, [&]() { scene.Save(); });
+		Measure("Save", options.Iterations, [&]() { scene.Save(); });
+		float yamlLoadTime = Measure("Load", options.Iterations, [&]() { scene.Load(scenePath, projectPath); });
+
+		std::string binaryScenePath = projectPath + "/benchmark.blzscene";
+		Measure("Save (binary)", options.Iterations, [&]() { scene.Save(binaryScenePath); });
+		float binaryLoadTime = Measure("Load (binary)", options.Iterations, [&]() { scene.Load(binaryScenePath, projectPath); });
+		WC_CORE_INFO("{:<36} {:.1f}x, {:.2f}MB -> {:.2f}MB", "Binary load speedup", yamlLoadTime / std::max(binaryLoadTime, 1e-6f),
+			fs::file_size(scenePath) / (1024.0 * 1024.0), fs::file_size(binaryScenePath) / (1024.0 * 1024.0));
+
+		Measure("Rename directory (round trip)", options.Iterations, [&]() {
+			assetRegistry.Rename(projectPath + "/Textures", projectPath + "/Art");
+			assetRegistry.Rename(projectPath + "/Art", projectPath + "/Textures");
+			});
+
+		Measure("Manifest reopen", options.Iterations, [&]() { assetRegistry.Open(projectPath); });
+
+		uint32_t resolved = 0;
+		scene.m_Scene.EntityWorld.each([&](const SpriteRendererComponent& sprite) { resolved += sprite.Texture != 0; });
+		WC_CORE_INFO("Resolved {} of {} sprites after reload, {} assets in the manifest ({})", resolved, ENTITY_COUNT, assetRegistry.GetAssets().size(), sink);
+
+		scene.Destroy();
+		assetRegistry.Close();
+		assetManager = {}; // The slots don't own any GPU resources, Free would try to destroy them
+		fs::remove_all(project);
+	}
+
+	// Entering and leaving play mode on 50k entities, a quarter of them children and a tenth with bodies
+	void PlayModeBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t ENTITY_COUNT = 50'000;
+		constexpr uint32_t TEXTURE_COUNT = 64;
+
+		assetManager.PushTexture(Texture(), "None");
+		for (uint32_t i = 0; i < TEXTURE_COUNT; i++)
+			assetManager.PushTexture(Texture(), std::format("texture_{}.png", i));
+
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+
+		EditorScene scene;
+		scene.Create();
+
+		flecs::entity parent;
+		for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+		{
+			auto entity = scene.AddEntity(std::format("Entity {}", i));
+			entity.set<TransformComponent>({ .Translation = { float(i % 250), float(i / 250), 0.f } });
+			entity.set<SpriteRendererComponent>({ .Texture = 1 + i % TEXTURE_COUNT });
+			if (i % 10 == 0)
+			{
+				entity.set<RigidBodyComponent>({ .Type = BodyType::Dynamic });
+				entity.set<BoxCollider2DComponent>({ .MaterialID = material });
+			}
+
+			if (i % 4 == 0) parent = entity;
+			else if (i % 4 == 1) scene.SetChild(parent, entity);
+		}
+
+		WC_CORE_INFO("Play mode: {} entities, {} iterations", ENTITY_COUNT, options.Iterations);
+
+		SceneSnapshot snapshot;
+		Measure("Take snapshot", options.Iterations, [&]() { snapshot = TakeSnapshot(scene.m_Scene); });
+		WC_CORE_INFO("{:<36} {:.2f}MB", "Snapshot size", snapshot.Data.size() / (1024.0 * 1024.0));
+
+		Measure("Restore snapshot", options.Iterations, [&]() {
+			scene.m_Scene.DeleteAllEntities();
+			RestoreSnapshot(scene.m_Scene, snapshot);
+			});
+
+		float enterTime = 0.f, exitTime = 0.f;
+		Timer timer;
+		for (uint32_t i = 0; i < options.Iterations; i++)
+		{
+			timer.Start();
+			scene.SetState(SceneState::Play);
+			enterTime += timer.GetElapsedTime() * 1000.f;
+
+			scene.m_Scene.UpdatePhysics();
+
+			timer.Start();
+			scene.SetState(SceneState::Edit);
+			exitTime += timer.GetElapsedTime() * 1000.f;
+		}
+		WC_CORE_INFO("{:<36} avg {:9.3f}ms", "Enter play", enterTime / options.Iterations);
+		WC_CORE_INFO("{:<36} avg {:9.3f}ms", "Exit play", exitTime / options.Iterations);
+
+		uint32_t entities = 0;
+		scene.m_Scene.EntityWorld.each([&](const EntityTag&) { entities++; });
+		WC_CORE_INFO("{} entities after the round trips", entities);
+
+		snapshot = {}; // Its handles have to go before the slots
+		scene.Destroy();
+		assetManager = {};
+	}
+
+	// Building, reordering, reparenting and deleting a 20k entity hierarchy through the ID lists. The reorder is compared
+	// against the name vectors the hierarchy used before, where every move searched the sibling names
+	void HierarchyBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t ENTITY_COUNT = 20'000;
+		constexpr uint32_t PARENT_COUNT = 100;
+
+		EditorScene scene;
+		auto& hierarchy = scene.m_Scene;
+
+		std::vector<flecs::entity> entities(ENTITY_COUNT);
+		std::vector<std::string> names(ENTITY_COUNT);
+		for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+			names[i] = std::format("Entity {}", i);
+
+		WC_CORE_INFO("Hierarchy: {} entities, {} parents, {} iterations", ENTITY_COUNT, PARENT_COUNT, options.Iterations);
+
+		Measure("Add", options.Iterations, [&]() {
+			hierarchy.DeleteAllEntities();
+			for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+				entities[i] = hierarchy.AddEntity(names[i]);
+			});
+
+		Measure("Reparent", options.Iterations, [&]() {
+			for (uint32_t i = PARENT_COUNT; i < ENTITY_COUNT; i++)
+				hierarchy.SetChild(entities[i % PARENT_COUNT], entities[i], false);
+			for (uint32_t i = PARENT_COUNT; i < ENTITY_COUNT; i++)
+				hierarchy.RemoveChild(entities[i], false);
+			});
+
+		float moveTime = Measure("Move", options.Iterations, [&]() {
+			for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+				hierarchy.MoveEntity(entities[i], entities[(i * 7919) % ENTITY_COUNT]);
+			});
+
+		std::vector<std::string> order = names;
+		float namesTime = Measure("Move (name vector)", options.Iterations, [&]() {
+			for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+			{
+				const auto& target = names[(i * 7919) % ENTITY_COUNT];
+				if (target == names[i]) continue;
+
+				order.erase(std::find(order.begin(), order.end(), names[i]));
+				order.insert(std::find(order.begin(), order.end(), target) + 1, names[i]);
+			}
+			});
+		WC_CORE_INFO("{:<36} {:.1f}x", "Move speedup", namesTime / std::max(moveTime, 1e-6f));
+
+		Measure("Kill", options.Iterations, [&]() {
+			for (uint32_t i = 0; i < ENTITY_COUNT; i += 2)
+				hierarchy.KillEntity(entities[i]);
+			for (uint32_t i = 0; i < ENTITY_COUNT; i += 2)
+				entities[i] = hierarchy.AddEntity(names[i]);
+			});
+
+		// The list has to match the roots flecs knows about
+		uint32_t listed = 0, roots = 0;
+		hierarchy.EachChild(flecs::entity::null(), [&](flecs::entity) { listed++; });
+		hierarchy.EntityWorld.each([&](flecs::entity entity, const EntityTag&) { roots += entity.parent() == flecs::entity::null(); });
+		WC_CORE_INFO("{} of {} roots listed", listed, roots);
+
+		scene.Destroy();
+	}
+
+	// Stepping piles of 10k and 50k boxes with the job system at 1 thread (plain box2d) up to one per hardware thread
+	void PhysicsBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t WARMUP_STEPS = 60; // Lets the boxes land so the steps have contacts to solve
+
+		const uint32_t steps = std::max(options.Iterations * 5, 30u);
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+		ScopedWorkers workers;
+
+		for (uint32_t bodyCount : { 10'000u, 50'000u })
+		{
+			WC_CORE_INFO("Physics: {} bodies, {} steps", bodyCount, steps);
+
+			float singleThreadTime = 0.f;
+			for (uint32_t threads : GetThreadCounts())
+			{
+				workers.SetThreads(threads);
+
+				EditorScene scene;
+				MakeBoxPile(scene, bodyCount, 200, material);
+
+				float time = MeasureSteps(std::format("Step ({} threads)", threads).c_str(), scene.m_Scene, WARMUP_STEPS, steps);
+				if (threads == 1) singleThreadTime = time;
+				else WC_CORE_INFO("{:<36} {:.2f}x", "Speedup", singleThreadTime / std::max(time, 1e-6f));
+
+				scene.Destroy();
+			}
+		}
+	}
+
+	// 10k boxes dropped into one pile on four layers, once with every layer colliding and once with each layer only
+	// colliding with itself and the ground. Pairs are the contacts box2d keeps for overlapping shape bounds
+	void CollisionLayersBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t BODY_COUNT = 10'000;
+		constexpr uint32_t LAYER_COUNT = 4;
+		constexpr uint32_t WARMUP_STEPS = 120;
+
+		const uint32_t steps = std::max(options.Iterations * 5, 30u);
+		const CollisionLayerMatrix previousLayers = CollisionLayers;
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+
+		for (bool filtered : { false, true })
+		{
+			CollisionLayers = {};
+			for (uint32_t i = 1; i <= LAYER_COUNT; i++)
+			{
+				CollisionLayers.Names[i] = std::format("Layer {}", i);
+				if (filtered)
+					for (uint32_t j = 1; j <= LAYER_COUNT; j++)
+						CollisionLayers.SetCollides(i, j, i == j);
+			}
+
+			EditorScene scene;
+			MakeBoxPile(scene, BODY_COUNT, 100, material, [](uint32_t i) { return 1 + i % LAYER_COUNT; });
+
+			auto& world = scene.m_Scene;
+			MeasureSteps(filtered ? "Step (layers filtered)" : "Step (every layer collides)", world, WARMUP_STEPS, steps);
+
+			b2Counters counters = world.PhysicsWorld.GetCounters();
+			WC_CORE_INFO("{:<36} {} pairs, {} awake bodies", "", counters.contactCount, world.PhysicsWorld.GetAwakeBodyCount());
+
+			scene.Destroy();
+		}
+
+		CollisionLayers = previousLayers;
+	}
+
+	// A 400x60 tile terrain with caves and 2k boxes dropped on it, stepped with a body per tile and again after baking
+	// the tiles into chains
+	void TilesBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t WIDTH = 400;
+		constexpr uint32_t HEIGHT = 60;
+		constexpr uint32_t BOX_COUNT = 2'000;
+		constexpr uint32_t WARMUP_STEPS = 60;
+
+		const uint32_t steps = std::max(options.Iterations * 5, 30u);
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+
+		EditorScene scene;
+		for (uint32_t y = 0; y < HEIGHT; y++)
+			for (uint32_t x = 0; x < WIDTH; x++)
+			{
+				bool surface = int(y) < int(HEIGHT) - 10 + int(5.f * std::sin(x * 0.1f));
+				bool cave = (x / 8 + y / 6) % 5 == 0 && y > 4;
+				if (!surface || cave) continue;
+
+				AddBox(scene, { float(x), float(y) }, BodyType::Static, { .MaterialID = material });
+			}
+
+		for (uint32_t i = 0; i < BOX_COUNT; i++)
+			AddBox(scene, { float(i % WIDTH), float(HEIGHT + 2 + i / WIDTH * 2) }, BodyType::Dynamic, { .Size = { 0.8f, 0.8f }, .MaterialID = material });
+
+		auto& world = scene.m_Scene;
+		auto StepAll = [&](const char* name) {
+			MeasureSteps(name, world, WARMUP_STEPS, steps);
+			b2Counters counters = world.PhysicsWorld.GetCounters();
+			WC_CORE_INFO("{:<36} {} bodies, {} shapes", "", counters.bodyCount, counters.shapeCount);
+			};
+
+		StepAll("Step (body per tile)");
+
+		TileBakeResult result;
+		Measure("Bake tiles", 1, [&]() { result = BakeTileColliders(world); });
+		WC_CORE_INFO("{:<36} {} tiles into {} chains", "", result.Tiles, result.Chains);
+
+		StepAll("Step (baked chains)");
+
+		scene.Destroy();
+	}
+
+	// 10k rays and 10k circle overlaps a frame against 10k scattered boxes, cast one by one, batched on the job system
+	// at 1 thread up to one per hardware thread, and batched from a script through Physics.CastRays
+	void QueriesBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t BOX_COUNT = 10'000;
+		constexpr uint32_t QUERY_COUNT = 10'000;
+
+		const uint32_t frames = std::max(options.Iterations * 5, 30u);
+		uint32_t material = AddPhysicsMaterial("Benchmark");
+		ScopedWorkers workers;
+
+		EditorScene scene;
+		for (uint32_t i = 0; i < BOX_COUNT; i++)
+			AddBox(scene, { float((i * 7919) % 4000) * 0.1f - 200.f, float((i * 104729) % 1000) * 0.1f }, BodyType::Static, { .Size = { 0.5f, 0.5f }, .MaterialID = material });
+
+		auto& world = scene.m_Scene;
+		world.CreatePhysicsWorld();
+
+		// Fanned out from a row of origins, the same rays the script casts
+		std::vector<RayQuery> rays(QUERY_COUNT);
+		std::vector<CircleQuery> circles(QUERY_COUNT);
+		for (uint32_t i = 0; i < QUERY_COUNT; i++)
+		{
+			const float angle = float(i) * 2.399963f;
+			const glm::vec2 origin = { float(i % 100) * 4.f - 200.f, 40.f };
+			rays[i] = { .Origin = origin, .Translation = glm::vec2(std::cos(angle), std::sin(angle)) * 50.f };
+			circles[i] = { .Center = origin + glm::vec2(std::cos(angle), std::sin(angle)) * float(i % 40), .Radius = 3.f };
+		}
+
+		WC_CORE_INFO("Queries: {} boxes, {} rays and {} circles a frame, {} frames", BOX_COUNT, QUERY_COUNT, QUERY_COUNT, frames);
+
+		std::vector<RayHit> hits(QUERY_COUNT);
+		float serialTime = Measure("Rays (one by one)", frames, [&]() {
+			for (uint32_t i = 0; i < QUERY_COUNT; i++)
+			{
+				b2RayResult result = world.PhysicsWorld.CastRayClosest(rays[i].Origin, rays[i].Translation, CollisionLayerMatrix::GetQueryFilter());
+				hits[i].Entity = result.hit ? (double)(uintptr_t)b2Shape_GetUserData(result.shapeId) : 0.0;
+			}
+			});
+
+		OverlapResults overlaps;
+		for (uint32_t threads : GetThreadCounts())
+		{
+			workers.SetThreads(threads);
+
+			float time = Measure(std::format("Rays (batched, {} threads)", threads).c_str(), frames, [&]() { CastRays(world.PhysicsWorld, rays, hits); });
+			WC_CORE_INFO("{:<36} {:.2f}x", "Speedup", serialTime / std::max(time, 1e-6f));
+
+			Measure(std::format("Circles (batched, {} threads)", threads).c_str(), frames, [&]() { OverlapCircles(world.PhysicsWorld, circles, overlaps); });
+		}
+
+		uint32_t rayHits = 0;
+		for (const auto& hit : hits)
+			rayHits += hit.Entity != 0.0;
+		WC_CORE_INFO("{:<36} {} rays hit, {} circle overlaps", "", rayHits, overlaps.Entities.size());
+
+		// The script side, buffers filled once and reused every frame
+		constexpr std::string_view source = R"(
+			local RAYS = 10000
+			local rays = buffer.create(RAYS * 24)
+			local hits = buffer.create(RAYS * 32)
+			for i = 0, RAYS - 1 do
+				local angle = i * 2.399963
+				buffer.writef32(rays, i * 24, (i % 100) * 4 - 200)
+				buffer.writef32(rays, i * 24 + 4, 40)
+				buffer.writef32(rays, i * 24 + 8, math.cos(angle) * 50)
+				buffer.writef32(rays, i * 24 + 12, math.sin(angle) * 50)
+			end
+
+			hitCount = 0
+			function Update()
+				hits = Physics.CastRays(rays, RAYS, hits)
+				local count = 0
+				for i = 0, RAYS - 1 do
+					if buffer.readf64(hits, i * 32) ~= 0 then count += 1 end
+				end
+				hitCount = count
+			end
+		)";
+
+		ScriptBinary binary = CompileBenchmarkScript("queries_benchmark", source);
+
+		Script script;
+		if (script.Load(binary) == LUA_OK)
+		{
+			ScriptScene = &world;
+			Measure(std::format("Rays from a script ({} threads)", jobSystem.GetThreadCount()).c_str(), frames, [&]() { script.state.Execute("Update"); });
+			ScriptScene = nullptr;
+
+			script.state.GetGlobal("hitCount");
+			WC_CORE_INFO("{:<36} {} rays hit", "", script.state.To<double>());
+			script.state.Pop();
+			script.Unload();
+		}
+
+		scene.Destroy();
+	}
+
+	// Instantiating 1k, 10k and 50k copies of one script in the shared VM against a state per instance, which is how
+	// every script used to load. The per state runs stop at 10k, 50k states take gigabytes
+	void ScriptsBenchmark(const BenchmarkOptions& options)
+	{
+		constexpr uint32_t MAX_STATE_COUNT = 10'000;
+
+		constexpr std::string_view source = R"(
+			speed = 2
+			health = 100
+			local position = 0
+
+			function Update()
+				position = position + speed * 0.016
+				health = math.max(health - 0.01, 0)
+			end
+		)";
+
+		ScriptBinary binary = CompileBenchmarkScript("scripts_benchmark", source);
+
+		auto MB = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+
+		for (uint32_t count : { 1'000u, 10'000u, 50'000u })
+		{
+			WC_CORE_INFO("Scripts: {} instances", count);
+
+			scriptVM.Create();
+			const size_t sharedMemory = scriptVM.GetMemoryUsage();
+			{
+				std::vector<Script> scripts(count);
+				Measure("Instantiate (shared VM)", 1, [&]() {
+					for (auto& script : scripts)
+						script.Load(binary);
+					});
+
+				const size_t memory = scriptVM.GetMemoryUsage();
+				WC_CORE_INFO("{:<36} {:.2f}MB, {} bytes per instance, {:.2f}MB shared", "", MB(memory), (memory - sharedMemory) / count, MB(sharedMemory));
+
+				Measure("Update (shared VM)", options.Iterations, [&]() {
+					for (auto& script : scripts)
+						script.state.Execute("Update");
+					});
+			}
+			scriptVM.Destroy();
+
+			if (count > MAX_STATE_COUNT) continue;
+
+			std::vector<ScriptState> states(count);
+			Measure("Instantiate (state per instance)", 1, [&]() {
+				for (auto& state : states)
+				{
+					state.Load(binary);
+					RegisterScriptBindings(state.L);
+				}
+				});
+
+			size_t memory = 0;
+			for (auto& state : states)
+				memory += size_t(lua_gc(state.L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(state.L, LUA_GCCOUNTB, 0);
+			WC_CORE_INFO("{:<36} {:.2f}MB, {} bytes per instance", "", MB(memory), memory / count);
+
+			Measure("Update (state per instance)", options.Iterations, [&]() {
+				for (auto& state : states)
+					state.Execute("Update");
+				});
+
+			for (auto& state : states)
+				state.Close();
+		}
+	}
+
+	struct Benchmark
+	{
+		const char* Name;
+		void (*Run)(const BenchmarkOptions& options);
+	};
+
+	const Benchmark Benchmarks[] = {
+		{ "assets", AssetsBenchmark },
+		{ "play", PlayModeBenchmark },
+		{ "hierarchy", HierarchyBenchmark },
+		{ "physics", PhysicsBenchmark },
+		{ "layers", CollisionLayersBenchmark },
+		{ "tiles", TilesBenchmark },
+		{ "queries", QueriesBenchmark },
+		{ "scripts", ScriptsBenchmark },
+	};
+}
+
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options)
+{
+	bool benchmark = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--benchmark")
+		{
+			benchmark = true;
+			if (hasValue && argv[i + 1][0] != '-') options.Name = argv[++i];
+		}
+		else if (arg == "--iterations" && hasValue) options.Iterations = (uint32_t)std::max(std::atoi(argv[++i]), 1);
+	}
+
+	return benchmark;
+}
+
+int RunBenchmarks(const BenchmarkOptions& options)
+{
+	bool found = false;
+	for (const auto& benchmark : Benchmarks)
+	{
+		if (options.Name != "all" && options.Name != benchmark.Name) continue;
+
+		WC_CORE_INFO("--- {} ---", benchmark.Name);
+		benchmark.Run(options);
+		found = true;
+	}
+
+	if (!found)
+	{
+		std::string names;
+		for (const auto& benchmark : Benchmarks)
+			names += std::string(names.empty() ? "" : ", ") + benchmark.Name;
+
+		WC_CORE_ERROR("Unknown benchmark '{}', available: all, {}", options.Name, names);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+// CPU side micro benchmarks of engine systems, they run without a window or a GPU so numbers from different machines
+// and commits can be compared directly.
+//
+// Blaze-Editor --benchmark <name|all> [--iterations N] [--workers N]
+struct BenchmarkOptions
+{
+	std::string Name = "all";
+	uint32_t Iterations = 10;
+};
+
+// Returns false if --benchmark wasn't passed
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options);
+
+// Returns the process exit code
+int RunBenchmarks(const BenchmarkOptions& options);
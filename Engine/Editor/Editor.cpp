@@ -1,5 +1,7 @@
 #include "Editor.h"
 
+#include "../Scene/ColliderBaking.h"
+
 glm::vec4 decompress(uint32_t num)
 { // Remember! Convert from 0-255 to 0-1!
 	glm::vec4 Output;
@@ -80,6 +82,50 @@ void SaveStringToFile(const std::filesystem::path& filePath, const std::string&
 	file << content;
 }
 
+namespace
+{
+	const std::pair<const char*, Texture EditorInstance::*> EditorIcons[] = {
+		{ "close.png", &EditorInstance::t_Close },
+		{ "minimize.png", &EditorInstance::t_Minimize },
+		{ "maximize.png", &EditorInstance::t_Maximize },
+		{ "collapse.png", &EditorInstance::t_Collapse },
+
+		{ "folder_open.png", &EditorInstance::t_FolderOpen },
+		{ "folder_closed.png", &EditorInstance::t_FolderClosed },
+		{ "file.png", &EditorInstance::t_File },
+
+		{ "play.png", &EditorInstance::t_Play },
+		{ "simulate.png", &EditorInstance::t_Simulate },
+		{ "stop.png", &EditorInstance::t_Stop },
+
+		{ "eye.png", &EditorInstance::t_Eye },
+		{ "eye_slash.png", &EditorInstance::t_EyeClosed },
+
+		{ "debug.png", &EditorInstance::t_Debug },
+		{ "info.png", &EditorInstance::t_Info },
+		{ "warning.png", &EditorInstance::t_Warning },
+		{ "error.png", &EditorInstance::t_Error },
+		{ "critical.png", &EditorInstance::t_Critical },
+	};
+
+	const std::string IconPath = "assets/textures/menu/";
+
+	// Same spelling as the paths the file watchers report, used as the key of the assets panel caches
+	std::string NormalizePath(const std::filesystem::path& path)
+	{
+		std::string normalized = path.lexically_normal().generic_string();
+		if (normalized.size() > 1 && normalized.back() == '/') normalized.pop_back();
+		return normalized;
+	}
+}
+
+void EditorInstance::DecodeIcons()
+{
+	m_DecodedIcons.resize(std::size(EditorIcons));
+	for (size_t i = 0; i < std::size(EditorIcons); i++)
+		m_DecodedIcons[i].Load(IconPath + EditorIcons[i].first, 4);
+}
+
 void EditorInstance::Create()
 {
 	LoadSettings();
@@ -89,32 +135,22 @@ void EditorInstance::Create()
 	m_Renderer.Init();
 
 	// Load Textures
-	std::string assetPath = "assets/";
-	std::string texturePath = assetPath + "textures/menu/";
-	assetManager.LoadTexture(texturePath + "close.png", t_Close);
-	assetManager.LoadTexture(texturePath + "minimize.png", t_Minimize);
-	assetManager.LoadTexture(texturePath + "maximize.png", t_Maximize);
-	assetManager.LoadTexture(texturePath + "collapse.png", t_Collapse);
-
-	assetManager.LoadTexture(texturePath + "folder_open.png", t_FolderOpen);
-	assetManager.LoadTexture(texturePath + "folder_closed.png", t_FolderClosed);
-	assetManager.LoadTexture(texturePath + "file.png", t_File);
-
-	assetManager.LoadTexture(texturePath + "play.png", t_Play);
-	assetManager.LoadTexture(texturePath + "simulate.png", t_Simulate);
-	assetManager.LoadTexture(texturePath + "stop.png", t_Stop);
-
-	assetManager.LoadTexture(texturePath + "eye.png", t_Eye);
-	assetManager.LoadTexture(texturePath + "eye_slash.png", t_EyeClosed);
+	for (size_t i = 0; i < std::size(EditorIcons); i++)
+	{
+		std::string path = IconPath + EditorIcons[i].first;
+		Texture& icon = this->*EditorIcons[i].second;
 
-	assetManager.LoadTexture(texturePath + "debug.png", t_Debug);
-	assetManager.LoadTexture(texturePath + "info.png", t_Info);
-	assetManager.LoadTexture(texturePath + "warning.png", t_Warning);
-	assetManager.LoadTexture(texturePath + "error.png", t_Error);
-	assetManager.LoadTexture(texturePath + "critical.png", t_Critical);
+		if (i < m_DecodedIcons.size() && m_DecodedIcons[i].Data)
+		{
+			icon = assetManager.Textures[assetManager.LoadTextureFromMemory(m_DecodedIcons[i], path)];
+			m_DecodedIcons[i].Free();
+		}
+		else
+			assetManager.LoadTexture(path, icon);
+	}
+	m_DecodedIcons.clear();
 
-	PhysicsMaterials.emplace_back(PhysicsMaterial()); // @NOTE: Index 0 is the default material
-	PhysicsMaterialNames["Default"] = PhysicsMaterials.size() - 1;
+	AddPhysicsMaterial("Default"); // @NOTE: Index 0 is the default material
 
 	m_PhysicsDebugDraw = {
 		DrawPolygonFcn,
@@ -130,6 +166,9 @@ void EditorInstance::Create()
 	};
 
 	m_Renderer.CreateScreen(Globals.window.GetSize());
+
+	m_ShaderWatcher.Start("assets/shaders");
+	m_Thumbnails.Create();
 }
 
 void EditorInstance::Resize(glm::vec2 size)
@@ -143,7 +182,14 @@ void EditorInstance::Destroy()
 {
 	SaveSettings();
 
+	m_ProjectWatcher.Stop();
+	m_ShaderWatcher.Stop();
+
 	SavePhysicsMaterials(ProjectRootPath + "/physicsMaterials.yaml");
+	SaveCollisionLayers(ProjectRootPath + "/collisionLayers.yaml");
+	assetRegistry.Close();
+
+	m_Thumbnails.Destroy();
 
 	assetManager.Free();
 	m_Renderer.Deinit();
@@ -237,59 +283,16 @@ void EditorInstance::Input()
 	}
 }
 
-void EditorInstance::RenderEntity(flecs::entity entt, glm::mat4& transform)
-{
-	if (entt.get<EntityTag>()->showEntity)
-	{
-		auto& renderData = m_RenderData[CURRENT_FRAME];
-		if (entt.has<SpriteRendererComponent>())
-		{
-			auto& data = *entt.get<SpriteRendererComponent>();
-
-			renderData.DrawQuad(transform, data.Texture, data.Color, entt.id());
-		}
-		else if (entt.has<CircleRendererComponent>())
-		{
-			auto& data = *entt.get<CircleRendererComponent>();
-			renderData.DrawCircle(transform, data.Thickness, data.Fade, data.Color, entt.id());
-		}
-		else if (entt.has<TextRendererComponent>())
-		{
-			auto& data = *entt.get<TextRendererComponent>();
-
-			if (data.FontID != UINT32_MAX)
-				renderData.DrawString(data.Text, assetManager.Fonts[data.FontID], transform, data.Color, data.LineSpacing, data.Kerning, entt.id());
-		}
-		m_Scene.m_Scene.EntityWorld.query_builder<TransformComponent, EntityTag>()
-			.with(flecs::ChildOf, entt)
-			.each([&](flecs::entity child, TransformComponent childTransform, EntityTag)
-				{
-					transform = transform * childTransform.GetTransform();
-					RenderEntity(child, transform);
-				});
-	}
-}
-
 void EditorInstance::Render()
 {
+	WC_PROFILE_FUNCTION();
 	if (!ProjectExists()) return;
 	auto& renderData = m_RenderData[CURRENT_FRAME];
 
-	if (m_Renderer.TextureCapacity < assetManager.Textures.size())
-		m_Renderer.AllocateNewDescriptor(assetManager.Textures.capacity());
+	assetManager.Update();
+	m_Renderer.UpdateTextures(assetManager);
 
-	if (assetManager.TexturesUpdated)
-	{
-		assetManager.TexturesUpdated = false;
-		m_Renderer.UpdateTextures(assetManager);
-	}
-
-	m_Scene.m_Scene.EntityWorld.each([&](flecs::entity entt, TransformComponent& p) {
-		if (entt.parent() != 0) return;
-
-		glm::mat4 transform = p.GetTransform();
-		RenderEntity(entt, transform);
-		});
+	m_Scene.m_Scene.Render(renderData);
 
 	if (m_Scene.State != SceneState::Edit)
 	{
@@ -302,7 +305,12 @@ void EditorInstance::Render()
 	renderData.Reset();
 }
 
-void EditorInstance::Update() { m_Scene.Update(); }
+void EditorInstance::Update()
+{
+	ProcessFileChanges();
+	m_Thumbnails.Update();
+	m_Scene.Update();
+}
 
 void EditorInstance::UI_Editor()
 {
@@ -597,6 +605,17 @@ void EditorInstance::UI_SceneProperties()
 		{
 			auto& worldData = m_Scene.m_Scene.PhysicsWorldData;
 			ui::DragButton2("Gravity", worldData.Gravity);
+			ui::Drag("Sub-steps", worldData.SubSteps, 0.1f, 1, 16);
+			ui::Drag("Max steps per frame", worldData.MaxStepsPerFrame, 0.1f, 1, 32);
+
+			// Static box colliders on a grid become a few chain loops
+			gui::BeginDisabled(m_Scene.State != SceneState::Edit);
+			if (gui::Button("Bake tile colliders"))
+			{
+				auto result = BakeTileColliders(m_Scene.m_Scene);
+				WC_INFO("Baked {} tile bodies into {} chains", result.Tiles, result.Chains);
+			}
+			gui::EndDisabled();
 
 			ui::Drag3("Focal point", glm::value_ptr(m_Scene.camera.FocalPoint));
 			m_Scene.camera.UpdateView();
@@ -627,6 +646,68 @@ void EditorInstance::UI_SceneProperties()
 			//}
 		}
 
+		if (gui::CollapsingHeader("Collision layers"))
+		{
+			// Stored with the project
+			bool changed = false;
+			for (uint32_t i = 1; i < COLLISION_LAYER_COUNT; i++)
+				if (!CollisionLayers.Names[i].empty())
+				{
+					gui::PushID(i);
+					gui::InputText("##Name", &CollisionLayers.Names[i]);
+					// Scripts look layers up by name, so an empty or taken one falls back to the default
+					if (gui::IsItemDeactivatedAfterEdit() && (CollisionLayers.Names[i].empty() || CollisionLayers.Find(CollisionLayers.Names[i]) != i))
+						CollisionLayers.Names[i] = std::format("Layer {}", i);
+					gui::PopID();
+				}
+
+			uint32_t freeLayer = COLLISION_LAYER_COUNT;
+			for (uint32_t i = 0; i < COLLISION_LAYER_COUNT; i++)
+				if (CollisionLayers.Names[i].empty()) { freeLayer = i; break; }
+
+			gui::BeginDisabled(freeLayer == COLLISION_LAYER_COUNT);
+			if (gui::Button("Add layer"))
+				CollisionLayers.Names[freeLayer] = std::format("Layer {}", freeLayer);
+			gui::EndDisabled();
+
+			// Upper triangle of the matrix, each pair once
+			std::vector<uint32_t> layers;
+			for (uint32_t i = 0; i < COLLISION_LAYER_COUNT; i++)
+				if (!CollisionLayers.Names[i].empty()) layers.push_back(i);
+
+			if (gui::BeginTable("CollisionMatrix", int(layers.size()) + 1, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollX))
+			{
+				gui::TableSetupColumn("");
+				for (uint32_t layer : layers)
+					gui::TableSetupColumn(CollisionLayers.Names[layer].c_str());
+				gui::TableHeadersRow();
+
+				for (size_t row = 0; row < layers.size(); row++)
+				{
+					gui::TableNextRow();
+					gui::TableNextColumn(); ui::Text(CollisionLayers.Names[layers[row]]);
+					for (size_t column = 0; column < layers.size(); column++)
+					{
+						gui::TableNextColumn();
+						if (column < row) continue;
+
+						bool collides = CollisionLayers.Collides(layers[row], layers[column]);
+						gui::PushID(int(row * COLLISION_LAYER_COUNT + column));
+						if (gui::Checkbox("##Collides", &collides))
+						{
+							CollisionLayers.SetCollides(layers[row], layers[column], collides);
+							changed = true;
+						}
+						gui::PopID();
+					}
+				}
+
+				gui::EndTable();
+			}
+
+			if (changed) m_Scene.m_Scene.UpdateCollisionFilters();
+		}
+
 		if (gui::CollapsingHeader("Physics debug draw", nullptr, ImGuiTreeNodeFlags_DefaultOpen))
 		{
 			ui::Checkbox("Use drawing bounds", m_PhysicsDebugDraw.useDrawingBounds);
@@ -705,31 +786,7 @@ void EditorInstance::EntityReorderSeparator(const flecs::entity& entity)
 			IM_ASSERT(payload->DataSize == sizeof(flecs::entity));
 			flecs::entity droppedEntity = *static_cast<const flecs::entity*>(payload->Data);
 
-			if (droppedEntity.parent() == entity.parent())
-			{
-				std::vector<std::string>* entityOrder = nullptr;
-				if (entity.parent() == flecs::entity::null())
-					entityOrder = &m_Scene.m_Scene.EntityOrder;
-				else if (entity.parent().has<EntityOrderComponent>())
-					entityOrder = &entity.parent().get_ref<EntityOrderComponent>()->EntityOrder;
-
-				if (entityOrder)
-				{
-					auto targetIt = std::find(entityOrder->begin(), entityOrder->end(), std::string(entity.name()));
-					auto droppedIt = std::find(entityOrder->begin(), entityOrder->end(), std::string(droppedEntity.name()));
-
-					if (targetIt != entityOrder->end() && droppedIt != entityOrder->end() && targetIt != droppedIt)
-					{
-						std::string droppedName = *droppedIt;
-						entityOrder->erase(droppedIt);
-
-						int insertIndex = std::distance(entityOrder->begin(), std::find(entityOrder->begin(), entityOrder->end(), std::string(entity.name()))) + 1;
-						if (insertIndex > static_cast<int>(entityOrder->size()))
-							insertIndex = static_cast<int>(entityOrder->size());
-						entityOrder->insert(entityOrder->begin() + insertIndex, droppedName);
-					}
-				}
-			}
+			m_Scene.m_Scene.MoveEntity(droppedEntity, entity);
 		}
 		gui::EndDragDropTarget();
 	}
@@ -741,24 +798,7 @@ void EditorInstance::DisplayEntity(const flecs::entity& entity)
 	const bool is_selected = (m_Scene.SelectedEntity == entity);
 
 	std::vector<flecs::entity> children;
-	if (entity.has<EntityOrderComponent>())
-	{
-		auto& entityOrder = entity.get<EntityOrderComponent>()->EntityOrder;
-		for (const auto& childName : entityOrder)
-		{
-			std::string fullChildName = std::string(entity.name()) + "::" + childName;
-
-			flecs::entity childEntity = entity;
-			while (childEntity.parent() != flecs::entity::null())
-			{
-				childEntity = childEntity.parent();
-				fullChildName = std::string(childEntity.name()) + "::" + fullChildName;
-			}
-
-			if (auto childEntityResolved = m_Scene.m_Scene.EntityWorld.lookup(fullChildName.c_str()))
-				children.push_back(childEntityResolved);
-		}
-	}
+	m_Scene.m_Scene.EachChild(entity, [&](flecs::entity child) { children.push_back(child); });
 
 	ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_SpanAvailWidth;
 	if (is_selected)
@@ -866,7 +906,7 @@ void EditorInstance::DisplayEntity(const flecs::entity& entity)
 			gui::TreePush(entity.name().c_str());
 
 			for (const auto& child : children)
-				DisplayEntity(child);
+				if (child.is_alive()) DisplayEntity(child);
 			gui::TreePop();
 		}
 	}
@@ -929,13 +969,11 @@ void EditorInstance::UI_Entities()
 			if (gui::BeginChild("##ShowEntities", { 0, 0 }, ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar))
 			{
 				ui::DrawBgRows(10);
-				// This is not an iterator because 'DisplayEntity' function changes the size of the entity order vector
-				for (uint32_t i = 0; i < m_Scene.m_Scene.EntityOrder.size(); i++)
-				{
-					const auto& name = m_Scene.m_Scene.EntityOrder[i];
-					auto rootEntity = m_Scene.m_Scene.EntityWorld.lookup(name.c_str());
-					if (rootEntity) DisplayEntity(rootEntity);
-				}
+				// Collected first, 'DisplayEntity' can move, reparent and delete entities
+				std::vector<flecs::entity> roots;
+				m_Scene.m_Scene.EachChild(flecs::entity::null(), [&](flecs::entity root) { roots.push_back(root); });
+				for (const auto& rootEntity : roots)
+					if (rootEntity.is_alive()) DisplayEntity(rootEntity);
 
 				if (gui::IsWindowHovered() && gui::IsMouseClicked(ImGuiMouseButton_Right))
 				{
@@ -1053,7 +1091,13 @@ void EditorInstance::EditComponent(const std::string& name, UIFunc uiFunc)
 
 		auto& component = *m_Scene.SelectedEntity.get_mut<T>();
 		if (gui::CollapsingHeader((name + "##header").c_str(), m_Scene.State == SceneState::Edit ? &visible : NULL, ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			// Edits go through OnSet so observers (physics bodies) pick them up
+			gui::BeginGroup();
 			uiFunc(component);
+			gui::EndGroup();
+			if (gui::IsItemEdited()) m_Scene.SelectedEntity.modified<T>();
+		}
 
 		if (!visible) m_Scene.SelectedEntity.remove<T>(); // add modal popup
 	}
@@ -1081,22 +1125,7 @@ void EditorInstance::UI_Properties()
 					if (m_Scene.m_Scene.EntityWorld.lookup(nameBuffer.c_str()) != flecs::entity::null())
 						gui::OpenPopup("WarnNameExists");
 					else
-					{
-						if (m_Scene.SelectedEntity.parent() == flecs::entity::null())
-						{
-							auto& parentNames = m_Scene.m_Scene.EntityOrder;
-							for (auto& name : parentNames)
-								if (name == m_Scene.SelectedEntity.name().c_str()) name = nameBuffer;
-						}
-						else
-						{
-							auto& childrenNames = m_Scene.SelectedEntity.parent().get_ref<EntityOrderComponent>()->EntityOrder;
-							for (auto& name : childrenNames)
-								if (name == m_Scene.SelectedEntity.name().c_str()) name = nameBuffer;
-						}
-
-						m_Scene.SelectedEntity.set_name(nameBuffer.c_str());
-					}
+						m_Scene.m_Scene.SetEntityName(m_Scene.SelectedEntity, nameBuffer);
 				}
 			}
 			static enum { None, Transform, Render, Rigid, Script } menu = None;
@@ -1185,9 +1214,11 @@ void EditorInstance::UI_Properties()
 					case Rigid:
 					{
 						if (ItemAutoClose("Rigid Body Component", m_Scene.SelectedEntity.has<RigidBodyComponent>()))		m_Scene.SelectedEntity.add<RigidBodyComponent>();
-						bool hasCollider = m_Scene.SelectedEntity.has<BoxCollider2DComponent>() || m_Scene.SelectedEntity.has<CircleCollider2DComponent>();
-						if (ItemAutoClose("Box Collider Component", hasCollider))	m_Scene.SelectedEntity.add<BoxCollider2DComponent>();
-						if (ItemAutoClose("Circle Collider Component", hasCollider))	m_Scene.SelectedEntity.add<CircleCollider2DComponent>();
+						// Colliders are shapes on the entity's body, it can have one of each
+						if (ItemAutoClose("Box Collider Component", m_Scene.SelectedEntity.has<BoxCollider2DComponent>()))	m_Scene.SelectedEntity.add<BoxCollider2DComponent>();
+						if (ItemAutoClose("Circle Collider Component", m_Scene.SelectedEntity.has<CircleCollider2DComponent>()))	m_Scene.SelectedEntity.add<CircleCollider2DComponent>();
+						if (ItemAutoClose("Polygon Collider Component", m_Scene.SelectedEntity.has<PolygonCollider2DComponent>()))	m_Scene.SelectedEntity.add<PolygonCollider2DComponent>();
+						if (ItemAutoClose("Chain Collider Component", m_Scene.SelectedEntity.has<ChainCollider2DComponent>()))	m_Scene.SelectedEntity.add<ChainCollider2DComponent>();
 						break;
 					}
 					case Script:
@@ -1229,15 +1260,8 @@ void EditorInstance::UI_Properties()
 				EditComponent<SpriteRendererComponent>("Sprite Renderer", [&](auto& component)
 					{
 						gui::ColorEdit4("color", glm::value_ptr(component.Color));
-						std::string name = "None";
-						for (auto& [texturePath, id] : assetManager.TextureCache)
-						{
-							if (id == component.Texture)
-							{
-								name = std::filesystem::path(texturePath).stem().string();
-								break;
-							}
-						}
+						const auto& texturePath = assetManager.GetTextureName(component.Texture);
+						std::string name = texturePath.empty() ? "None" : std::filesystem::path(texturePath).stem().string();
 						gui::Text("Texture: "); gui::SameLine();
 						if (ui::MatchPayloadType("DND_PATH")) ui::PushButtonColor(gui::GetStyle().Colors[ImGuiCol_CheckMark], 0.8f, 0.9f, Globals.f_Display.Bold);
 						if (gui::Button(name.c_str()))
@@ -1299,15 +1323,8 @@ void EditorInstance::UI_Properties()
 					ui::Drag("Line spacing", component.LineSpacing, 0.01f);
 					ui::Drag("Kerning", component.Kerning, 0.01f);
 
-					std::string name = "None";
-					for (auto& [texturePath, id] : assetManager.FontCache)
-					{
-						if (id == component.FontID)
-						{
-							name = std::filesystem::path(texturePath).stem().string();
-							break;
-						}
-					}
+					const auto& fontPath = assetManager.GetFontName(component.FontID);
+					std::string name = fontPath.empty() ? "None" : std::filesystem::path(fontPath).stem().string();
 					gui::Text("Font: "); gui::SameLine();
 					if (ui::MatchPayloadType("DND_PATH")) ui::PushButtonColor(gui::GetStyle().Colors[ImGuiCol_CheckMark], 0.8f, 0.9f, Globals.f_Display.Bold);
 					if (gui::Button(name.c_str()))
@@ -1355,16 +1372,7 @@ void EditorInstance::UI_Properties()
 					{
 						ui::Separator("Material");
 
-						std::string currentMaterialName = "Unknown";
-
-						for (const auto& [name, matID] : PhysicsMaterialNames)
-						{
-							if (matID == currentMaterial)
-							{
-								currentMaterialName = name;
-								break;
-							}
-						}
+						std::string currentMaterialName = currentMaterial < PhysicsMaterialNamesByID.size() ? PhysicsMaterialNamesByID[currentMaterial] : "Unknown";
 
 						if (gui::BeginCombo("Materials", currentMaterialName.c_str()))
 						{
@@ -1383,9 +1391,7 @@ void EditorInstance::UI_Properties()
 
 								if (gui::Button("Create") || gui::IsKeyPressed(ImGuiKey_Enter))
 								{
-									PhysicsMaterials.push_back(PhysicsMaterial());
-									currentMaterial = PhysicsMaterials.size() - 1;
-									PhysicsMaterialNames[name] = currentMaterial;
+									currentMaterial = AddPhysicsMaterial(name);
 									name = "";
 									gui::CloseCurrentPopup();
 								}
@@ -1440,7 +1446,26 @@ void EditorInstance::UI_Properties()
 						if (currentMaterial == 0) gui::SetItemTooltip("Cannot edit Default material values");
 					};
 
-				EditComponent<RigidBodyComponent>("Rigid Body", [](auto& component) {
+				auto UI_CollisionLayer = [&](uint32_t& currentLayer)
+					{
+						if (gui::BeginCombo("Layer", CollisionLayers.Names[currentLayer].c_str()))
+						{
+							for (uint32_t i = 0; i < COLLISION_LAYER_COUNT; i++)
+							{
+								if (CollisionLayers.Names[i].empty()) continue;
+
+								bool isSelected = currentLayer == i;
+								if (gui::Selectable(CollisionLayers.Names[i].c_str(), isSelected))
+									currentLayer = i;
+
+								if (isSelected)
+									gui::SetItemDefaultFocus();
+							}
+							gui::EndCombo();
+						}
+					};
+
+				EditComponent<RigidBodyComponent>("Rigid Body", [&](auto& component) {
 
 					const char* bodyTypeStrings[] = { "Static", "Dynamic", "Kinematic" };
 					const char* currentBodyTypeString = bodyTypeStrings[(int)component.Type];
@@ -1454,6 +1479,7 @@ void EditorInstance::UI_Properties()
 							{
 								currentBodyTypeString = bodyTypeStrings[i];
 								component.Type = BodyType(i);
+								m_Scene.SelectedEntity.modified<RigidBodyComponent>(); // The combo is its own window, the group doesn't see it
 							}
 
 							if (isSelected)
@@ -1474,14 +1500,84 @@ void EditorInstance::UI_Properties()
 					ui::DragButton2("Offset", component.Offset);
 					ui::DragButton2("Size", component.Size);
 
+					uint32_t layer = component.Layer;
+					UI_CollisionLayer(component.Layer);
+
+					uint32_t material = component.MaterialID;
 					UI_PhysicsMaterial(component.MaterialID);
+					if (material != component.MaterialID || layer != component.Layer) m_Scene.SelectedEntity.modified<BoxCollider2DComponent>();
 					});
 
 				EditComponent<CircleCollider2DComponent>("Circle Collider", [&](auto& component) {
 					ui::DragButton2("Offset", component.Offset);
 					ui::Drag("Radius", component.Radius);
 
+					uint32_t layer = component.Layer;
+					UI_CollisionLayer(component.Layer);
+
+					uint32_t material = component.MaterialID;
+					UI_PhysicsMaterial(component.MaterialID);
+					if (material != component.MaterialID || layer != component.Layer) m_Scene.SelectedEntity.modified<CircleCollider2DComponent>();
+					});
+
+				// Returns true if a point was added or removed, edits to a point are picked up by EditComponent
+				auto UI_Points = [&](std::vector<glm::vec2>& points, size_t minCount, size_t maxCount)
+					{
+						bool changed = false;
+						if (gui::TreeNode(std::format("Points ({})", points.size()).c_str()))
+						{
+							gui::PushID("Points");
+							for (size_t i = 0; i < points.size(); i++)
+							{
+								gui::PushID(int(i));
+								ui::DragButton2(std::to_string(i).c_str(), points[i]);
+								gui::SameLine();
+								gui::BeginDisabled(points.size() <= minCount);
+								if (gui::Button("-"))
+								{
+									points.erase(points.begin() + i--);
+									changed = true;
+								}
+								gui::EndDisabled();
+								gui::PopID();
+							}
+							gui::PopID();
+
+							gui::BeginDisabled(points.size() >= maxCount);
+							if (gui::Button("Add point"))
+							{
+								points.push_back(points.empty() ? glm::vec2(0.f) : points.back() + glm::vec2(1.f, 0.f));
+								changed = true;
+							}
+							gui::EndDisabled();
+
+							gui::TreePop();
+						}
+						return changed;
+					};
+
+				EditComponent<PolygonCollider2DComponent>("Polygon Collider", [&](auto& component) {
+					bool changed = UI_Points(component.Points, 3, B2_MAX_POLYGON_VERTICES);
+					ui::Drag("Radius", component.Radius, 0.01f, 0.f, FLT_MAX);
+
+					uint32_t layer = component.Layer;
+					UI_CollisionLayer(component.Layer);
+
+					uint32_t material = component.MaterialID;
 					UI_PhysicsMaterial(component.MaterialID);
+					if (changed || material != component.MaterialID || layer != component.Layer) m_Scene.SelectedEntity.modified<PolygonCollider2DComponent>();
+					});
+
+				EditComponent<ChainCollider2DComponent>("Chain Collider", [&](auto& component) {
+					bool changed = UI_Points(component.Points, 0, SIZE_MAX);
+					ui::Checkbox("Loop", component.Loop);
+
+					uint32_t layer = component.Layer;
+					UI_CollisionLayer(component.Layer);
+
+					uint32_t material = component.MaterialID;
+					UI_PhysicsMaterial(component.MaterialID);
+					if (changed || material != component.MaterialID || layer != component.Layer) m_Scene.SelectedEntity.modified<ChainCollider2DComponent>();
 					});
 
 				EditComponent<ScriptComponent>("Script editor", [&](auto& component) {
@@ -1706,6 +1802,106 @@ void EditorInstance::UI_Console()
 	gui::PopStyleVar();
 }
 
+const std::vector<EditorInstance::DirectoryEntry>& EditorInstance::GetDirectoryEntries(const std::filesystem::path& directory)
+{
+	auto [it, inserted] = m_DirectoryCache.try_emplace(NormalizePath(directory));
+	if (inserted)
+	{
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+			it->second.push_back({ entry.path(), entry.is_directory(ec) });
+	}
+
+	return it->second;
+}
+
+const std::string& EditorInstance::GetFileContents(const std::string& filepath)
+{
+	auto [it, inserted] = m_FileContents.try_emplace(filepath);
+	if (inserted) it->second = OpenFile(filepath);
+	return it->second;
+}
+
+void EditorInstance::ProcessFileChanges()
+{
+	// Without a running watcher nothing reports outside changes, so the panel reads the disk every frame
+	if (m_DirectoryCacheDirty || !m_ProjectWatcher.IsRunning())
+	{
+		m_DirectoryCache.clear();
+		m_DirectoryCacheDirty = false;
+	}
+	if (!m_ProjectWatcher.IsRunning()) m_FileContents.clear();
+
+	auto shaderChanges = m_ShaderWatcher.Poll();
+	auto changes = m_ProjectWatcher.Poll();
+	if (shaderChanges.empty() && changes.empty()) return;
+
+	// Reloading replaces images and pipelines the frames in flight may still be using
+	bool idle = false;
+	auto WaitIdle = [&]() {
+		if (!idle) VulkanContext::GetLogicalDevice().WaitIdle();
+		idle = true;
+		};
+
+	for (const auto& change : shaderChanges)
+	{
+		if (change.Type == FileWatcher::Action::Removed) continue;
+
+		WaitIdle();
+		m_Renderer.ReloadShader(change.Path);
+	}
+
+	for (const auto& change : changes)
+	{
+		m_DirectoryCache.erase(NormalizePath(std::filesystem::path(change.Path).parent_path()));
+		m_DirectoryCache.erase(change.Path);
+		std::erase_if(m_FileContents, [&](const auto& entry) { return NormalizePath(entry.first) == change.Path; });
+		m_Thumbnails.Invalidate(change.Path);
+
+		if (change.Type == FileWatcher::Action::Removed || change.Path.find("/.blaze/") != std::string::npos) continue; // Editor caches
+
+		// Loaded assets are matched through their registry ID so it doesn't matter how their path was spelled when loading
+		AssetID id = assetRegistry.GetID(change.Path);
+		if (id != NULL_ASSET && !assetRegistry.UpdateHash(id)) continue; // Saved without changes
+
+		auto IsChanged = [&](const std::string& loadedPath) { return id != NULL_ASSET ? assetRegistry.GetID(loadedPath) == id : NormalizePath(loadedPath) == change.Path; };
+
+		std::vector<std::string> loaded;
+		switch (AssetRegistry::GetTypeFromExtension(change.Path))
+		{
+		case AssetType::Texture:
+			for (const auto& [name, textureID] : assetManager.TextureCache)
+				if (IsChanged(name)) loaded.push_back(name);
+
+			for (const auto& name : loaded)
+			{
+				WaitIdle();
+				if (assetManager.ReloadTexture(name)) WC_CORE_INFO("Reloaded {}", name);
+			}
+			break;
+
+		case AssetType::Font:
+			for (const auto& [name, fontID] : assetManager.FontCache)
+				if (IsChanged(name)) loaded.push_back(name);
+
+			for (const auto& name : loaded)
+				if (assetManager.ReloadFont(name)) WC_CORE_INFO("Reloaded {}", name);
+			break;
+
+		case AssetType::Script:
+			for (const auto& [name, binaryID] : ScriptBinaryCache)
+				if (IsChanged(name)) loaded.push_back(name);
+
+			for (const auto& name : loaded)
+				m_Scene.ReloadScript(name);
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
 void EditorInstance::UI_Assets()
 {
 	const std::set<std::string> textEditorExt = { ".txt", ".scene", ".yaml", ".blzproj", ".blzprojuser", ".blzent", ".lua", ".luau", ".luarc" };
@@ -1733,12 +1929,12 @@ void EditorInstance::UI_Assets()
 	// Expand all helper function
 	std::function<void(const std::filesystem::path&, bool)> setFolderStatesRecursively =
 		[&](const std::filesystem::path& path, bool state) {
-		for (const auto& entry : std::filesystem::directory_iterator(path))
+		for (const auto& entry : GetDirectoryEntries(path))
 		{
-			if (entry.is_directory())
+			if (entry.IsDirectory)
 			{
-				folderStates[entry.path().string()] = state;
-				setFolderStatesRecursively(entry.path(), state);
+				folderStates[entry.Path.string()] = state;
+				setFolderStatesRecursively(entry.Path, state);
 			}
 		}
 		};
@@ -1746,7 +1942,7 @@ void EditorInstance::UI_Assets()
 	// Lambda to handle file double click logic
 	auto openFileOnDoubleClick = [&](const std::filesystem::path& filePath)
 		{
-			if (filePath.extension() == ".scene")
+			if (AssetRegistry::GetTypeFromExtension(filePath.string()) == AssetType::Scene)
 			{
 				gui::OpenPopup(("Confirm##Scene" + filePath.string()).c_str());
 			}
@@ -1860,6 +2056,8 @@ void EditorInstance::UI_Assets()
 						if (ec) { WC_ERROR("Failed to delete file: {}", ec.message()); }
 						else
 						{
+							assetRegistry.Remove(filePath.string());
+							m_DirectoryCacheDirty = true;
 							if (std::filesystem::is_directory(filePath))
 							{
 								folderStates.erase(filePath.string());
@@ -1905,6 +2103,8 @@ void EditorInstance::UI_Assets()
 						if (ec) { WC_ERROR("Failed to rename file: {}", ec.message()); }
 						else
 						{
+							assetRegistry.Rename(filePath.string(), newFilePath.string());
+							m_DirectoryCacheDirty = true;
 							//WC_INFO("Renaming: {}, is DIR: {}", newFilePath.string(), is_directory(newFilePath));
 							if (is_directory(newFilePath))
 							{
@@ -1965,6 +2165,7 @@ void EditorInstance::UI_Assets()
 							}
 						}
 						newName = "New File";
+						m_DirectoryCacheDirty = true;
 						gui::CloseCurrentPopup();
 					}
 					gui::EndDisabled();
@@ -2000,6 +2201,7 @@ void EditorInstance::UI_Assets()
 				if (ec) { WC_ERROR("Failed to copy file: {}", ec.message()); }
 				else
 				{
+					m_DirectoryCacheDirty = true;
 					if (std::filesystem::is_directory(importDestPath))
 					{
 						folderStates[importDestPath.string()] = false;
@@ -2043,68 +2245,75 @@ void EditorInstance::UI_Assets()
 			{
 				if (path != assetsPath) gui::Indent(20);
 
-				for (const auto& entry : std::filesystem::directory_iterator(path))
+				for (const auto& entry : GetDirectoryEntries(path))
 				{
-					const auto& filenameStr = entry.path().filename().string();
-					const auto& fullPathStr = entry.path().string();
-					if (std::filesystem::exists(entry.path()))
+					const auto& filenameStr = entry.Path.filename().string();
+					const auto& fullPathStr = entry.Path.string();
+					if (entry.IsDirectory)
 					{
-						if (entry.is_directory())
-						{
-							auto [it, inserted] = folderStates.try_emplace(fullPathStr, false);
-							bool& isOpen = it->second;
+						auto [it, inserted] = folderStates.try_emplace(fullPathStr, false);
+						bool& isOpen = it->second;
 
-							gui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
-							gui::PushStyleColor(ImGuiCol_Button, gui::GetStyle().Colors[ImGuiCol_WindowBg]);
-							if (gui::ImageButton((filenameStr + "##b" + fullPathStr).c_str(), isOpen ? t_FolderOpen : t_FolderClosed, ImVec2(16, 16)))
-								isOpen = !isOpen;
+						gui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0, 0));
+						gui::PushStyleColor(ImGuiCol_Button, gui::GetStyle().Colors[ImGuiCol_WindowBg]);
+						if (gui::ImageButton((filenameStr + "##b" + fullPathStr).c_str(), isOpen ? t_FolderOpen : t_FolderClosed, ImVec2(16, 16)))
+							isOpen = !isOpen;
 
-							gui::PopStyleColor();
-							gui::PopStyleVar();
-							gui::SameLine();
-
-							if (gui::Selectable((filenameStr + "##" + fullPathStr).c_str(), selectedFolderPath == entry.path() && showIcons, ImGuiSelectableFlags_DontClosePopups))
-								selectedFolderPath = entry.path();
+						gui::PopStyleColor();
+						gui::PopStyleVar();
+						gui::SameLine();
 
-							if (gui::IsItemHovered())
-							{
-								if (gui::IsMouseDoubleClicked(0))
-									isOpen = !isOpen;
+						if (gui::Selectable((filenameStr + "##" + fullPathStr).c_str(), selectedFolderPath == entry.Path && showIcons, ImGuiSelectableFlags_DontClosePopups))
+							selectedFolderPath = entry.Path;
 
-								if (gui::IsMouseClicked(ImGuiMouseButton_Right))
-									gui::OpenPopup(("##RightClick" + entry.path().string()).c_str());
-							}
+						if (gui::IsItemHovered())
+						{
+							if (gui::IsMouseDoubleClicked(0))
+								isOpen = !isOpen;
 
-							if (isOpen)
-								displayDirectory(entry.path());
+							if (gui::IsMouseClicked(ImGuiMouseButton_Right))
+								gui::OpenPopup(("##RightClick" + entry.Path.string()).c_str());
 						}
-						else
+
+						if (isOpen)
+							displayDirectory(entry.Path);
+					}
+					else
+					{
+						ImGuiTreeNodeFlags leafFlags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+						gui::TreeNodeEx((filenameStr + "##" + fullPathStr).c_str(), leafFlags);
+						if (gui::IsItemHovered())
 						{
-							ImGuiTreeNodeFlags leafFlags = ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
-							gui::TreeNodeEx((filenameStr + "##" + fullPathStr).c_str(), leafFlags);
-							if (gui::IsItemHovered())
-							{
-								if (previewAsset)
-									gui::OpenPopup(("PreviewAsset##" + fullPathStr).c_str());
+							if (previewAsset)
+								gui::OpenPopup(("PreviewAsset##" + fullPathStr).c_str());
 
-								if (gui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
-									openFileOnDoubleClick(entry.path());
+							if (gui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+								openFileOnDoubleClick(entry.Path);
 
-								if (gui::IsMouseClicked(ImGuiMouseButton_Right))
-									gui::OpenPopup(("##RightClick" + entry.path().string()).c_str());
+							if (gui::IsMouseClicked(ImGuiMouseButton_Right))
+								gui::OpenPopup(("##RightClick" + entry.Path.string()).c_str());
 
-								//gui::SetNextWindowPos({ gui::GetCursorScreenPos().x + gui::GetItemRectSize().x, gui::GetCursorScreenPos().y });
-								if (gui::BeginPopup(("PreviewAsset##" + fullPathStr).c_str(), ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoMouseInputs | ImGuiWindowFlags_NoSavedSettings))
+							//gui::SetNextWindowPos({ gui::GetCursorScreenPos().x + gui::GetItemRectSize().x, gui::GetCursorScreenPos().y });
+							if (gui::BeginPopup(("PreviewAsset##" + fullPathStr).c_str(), ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoMouseInputs | ImGuiWindowFlags_NoSavedSettings))
+							{
+								gui::Text("Preview: %s", filenameStr.c_str());
+								if (AssetRegistry::GetTypeFromExtension(fullPathStr) == AssetType::Texture)
 								{
-									gui::Text("Preview: %s", filenameStr.c_str());
-									gui::EndPopup();
+									if (auto thumbnail = m_Thumbnails.Get(NormalizePath(entry.Path)))
+									{
+										gui::Image(thumbnail->Texture, { (float)ThumbnailService::CELL_SIZE, (float)ThumbnailService::CELL_SIZE }, thumbnail->UV0, thumbnail->UV1);
+										gui::TextDisabled("%u x %u", thumbnail->ImageWidth, thumbnail->ImageHeight);
+									}
+									else
+										gui::TextDisabled("Loading...");
 								}
+								gui::EndPopup();
 							}
-
-							openFilePopups(entry.path());
 						}
+
+						openFilePopups(entry.Path);
 					}
-					openRightClick(entry.path().string());
+					openRightClick(entry.Path.string());
 				}
 
 				if (path != assetsPath) gui::Unindent(20);
@@ -2135,6 +2344,8 @@ void EditorInstance::UI_Assets()
 							try
 							{
 								std::filesystem::rename(sourcePath, sourcePath.parent_path().parent_path() / sourcePath.filename());
+								assetRegistry.Rename(sourcePath.string(), (sourcePath.parent_path().parent_path() / sourcePath.filename()).string());
+								m_DirectoryCacheDirty = true;
 							}
 							catch (const std::exception& e)
 							{
@@ -2165,122 +2376,130 @@ void EditorInstance::UI_Assets()
 					if (std::filesystem::exists(selectedFolderPath))
 					{
 						int i = 0;
-						for (const auto& entry : std::filesystem::directory_iterator(selectedFolderPath))
+						for (const auto& entry : GetDirectoryEntries(selectedFolderPath))
 						{
 							if (i > 0 && i % itemsPerRow != 0)
 								gui::SameLine();
 
-							if (std::filesystem::exists(entry.path()))
+							if (entry.IsDirectory)
 							{
-								if (entry.is_directory())
+								gui::BeginGroup();
+								gui::PushStyleVar(ImGuiStyleVar_FramePadding, { 0, 0 });
+								gui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+								gui::ImageButton((entry.Path.string() + "/").c_str(), ui::MatchPayloadType("DND_PATH") ? t_FolderOpen : t_FolderClosed, { buttonSize, buttonSize });
+								if (gui::IsItemHovered())
 								{
-									gui::BeginGroup();
-									gui::PushStyleVar(ImGuiStyleVar_FramePadding, { 0, 0 });
-									gui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
-									gui::ImageButton((entry.path().string() + "/").c_str(), ui::MatchPayloadType("DND_PATH") ? t_FolderOpen : t_FolderClosed, { buttonSize, buttonSize });
-									if (gui::IsItemHovered())
-									{
-										if (gui::IsMouseDoubleClicked(0))
-											selectedFolderPath = entry.path();
+									if (gui::IsMouseDoubleClicked(0))
+										selectedFolderPath = entry.Path;
 
-										if (gui::IsMouseClicked(ImGuiMouseButton_Right))
-											gui::OpenPopup(("##RightClick" + entry.path().string()).c_str());
-									}
+									if (gui::IsMouseClicked(ImGuiMouseButton_Right))
+										gui::OpenPopup(("##RightClick" + entry.Path.string()).c_str());
+								}
 
-									if (gui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID))
-									{
-										std::string mPath = entry.path().string();
-										gui::SetDragDropPayload("DND_PATH", mPath.c_str(), mPath.size() + 1);
-										gui::Text("Moving %s", entry.path().filename().string().c_str());
-										gui::EndDragDropSource();
-									}
+								if (gui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID))
+								{
+									std::string mPath = entry.Path.string();
+									gui::SetDragDropPayload("DND_PATH", mPath.c_str(), mPath.size() + 1);
+									gui::Text("Moving %s", entry.Path.filename().string().c_str());
+									gui::EndDragDropSource();
+								}
 
-									if (gui::BeginDragDropTarget())
+								if (gui::BeginDragDropTarget())
+								{
+									if (const ImGuiPayload* payload = gui::AcceptDragDropPayload("DND_PATH"))
 									{
-										if (const ImGuiPayload* payload = gui::AcceptDragDropPayload("DND_PATH"))
-										{
-											const char* payloadPath = static_cast<const char*>(payload->Data);
-											std::filesystem::path sourcePath(payloadPath);
-											std::filesystem::path targetPath = entry.path() / sourcePath.filename();
-											std::filesystem::rename(sourcePath, targetPath);
-										}
-										gui::EndDragDropTarget();
+										const char* payloadPath = static_cast<const char*>(payload->Data);
+										std::filesystem::path sourcePath(payloadPath);
+										std::filesystem::path targetPath = entry.Path / sourcePath.filename();
+										std::filesystem::rename(sourcePath, targetPath);
+										assetRegistry.Rename(sourcePath.string(), targetPath.string());
+										m_DirectoryCacheDirty = true;
 									}
+									gui::EndDragDropTarget();
+								}
 
-									gui::PopStyleColor();
-									gui::PopStyleVar();
+								gui::PopStyleColor();
+								gui::PopStyleVar();
 
-									std::string filename = entry.path().filename().string();
-									float wrapWidth = buttonSize; // Width for wrapping the text
-									std::istringstream stream(filename);
-									std::vector<std::string> words{ std::istream_iterator<std::string>{stream}, std::istream_iterator<std::string>{} };
+								std::string filename = entry.Path.filename().string();
+								float wrapWidth = buttonSize; // Width for wrapping the text
+								std::istringstream stream(filename);
+								std::vector<std::string> words{ std::istream_iterator<std::string>{stream}, std::istream_iterator<std::string>{} };
 
-									std::string currentLine;
-									float currentLineWidth = 0.0f;
-									gui::PushStyleVar(ImGuiStyleVar_ItemSpacing, { 0, 0 });
-									for (const auto& word : words)
+								std::string currentLine;
+								float currentLineWidth = 0.0f;
+								gui::PushStyleVar(ImGuiStyleVar_ItemSpacing, { 0, 0 });
+								for (const auto& word : words)
+								{
+									ImVec2 wordSize = gui::CalcTextSize(word.c_str());
+									if (currentLineWidth + wordSize.x > wrapWidth)
 									{
-										ImVec2 wordSize = gui::CalcTextSize(word.c_str());
-										if (currentLineWidth + wordSize.x > wrapWidth)
-										{
-											gui::SetCursorPosX(gui::GetCursorPosX() + (wrapWidth - currentLineWidth) / 2.0f);
-											gui::TextUnformatted(currentLine.c_str());
-											currentLine.clear();
-											currentLineWidth = 0.0f;
-										}
-										if (!currentLine.empty())
-										{
-											currentLine += " ";
-											currentLineWidth += gui::CalcTextSize(" ").x;
-										}
-										currentLine += word;
-										currentLineWidth += wordSize.x;
+										gui::SetCursorPosX(gui::GetCursorPosX() + (wrapWidth - currentLineWidth) / 2.0f);
+										gui::TextUnformatted(currentLine.c_str());
+										currentLine.clear();
+										currentLineWidth = 0.0f;
 									}
 									if (!currentLine.empty())
 									{
-										gui::SetCursorPosX(gui::GetCursorPosX() + (wrapWidth - currentLineWidth) / 2.0f);
-										gui::TextUnformatted(currentLine.c_str());
+										currentLine += " ";
+										currentLineWidth += gui::CalcTextSize(" ").x;
 									}
-									gui::PopStyleVar();
-									gui::EndGroup();
+									currentLine += word;
+									currentLineWidth += wordSize.x;
+								}
+								if (!currentLine.empty())
+								{
+									gui::SetCursorPosX(gui::GetCursorPosX() + (wrapWidth - currentLineWidth) / 2.0f);
+									gui::TextUnformatted(currentLine.c_str());
 								}
+								gui::PopStyleVar();
+								gui::EndGroup();
+							}
+							else
+							{
+								gui::BeginGroup();
+								gui::PushStyleVar(ImGuiStyleVar_FramePadding, { 0, 0 });
+								gui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
+								// Only visible images and scenes are requested, scrolling through a large folder doesn't queue all of it
+								const ThumbnailService::Thumbnail* thumbnail = nullptr;
+								AssetType type = AssetRegistry::GetTypeFromExtension(entry.Path.string());
+								if ((type == AssetType::Texture || type == AssetType::Scene) && gui::IsRectVisible({ buttonSize, buttonSize }))
+									thumbnail = m_Thumbnails.Get(NormalizePath(entry.Path));
+
+								if (thumbnail)
+									gui::ImageButton((entry.Path.string() + "/").c_str(), thumbnail->Texture, { buttonSize, buttonSize }, thumbnail->UV0, thumbnail->UV1);
 								else
+									gui::ImageButton((entry.Path.string() + "/").c_str(), t_File, { buttonSize, buttonSize });
+								if (gui::IsItemHovered())
 								{
-									gui::BeginGroup();
-									gui::PushStyleVar(ImGuiStyleVar_FramePadding, { 0, 0 });
-									gui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
-									gui::ImageButton((entry.path().string() + "/").c_str(), t_File, { buttonSize, buttonSize });
-									if (gui::IsItemHovered())
-									{
-										if (gui::IsMouseDoubleClicked(0))
-											openFileOnDoubleClick(entry.path());
+									if (gui::IsMouseDoubleClicked(0))
+										openFileOnDoubleClick(entry.Path);
 
-										if (gui::IsMouseClicked(ImGuiMouseButton_Right))
-											gui::OpenPopup(("##RightClick" + entry.path().string()).c_str());
-									}
+									if (gui::IsMouseClicked(ImGuiMouseButton_Right))
+										gui::OpenPopup(("##RightClick" + entry.Path.string()).c_str());
+								}
 
-									if (gui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID))
-									{
-										std::string mPath = entry.path().string();
-										gui::SetDragDropPayload("DND_PATH", mPath.c_str(), mPath.size() + 1);
-										gui::Text("Moving %s", entry.path().filename().string().c_str());
-										gui::EndDragDropSource();
-									}
+								if (gui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID))
+								{
+									std::string mPath = entry.Path.string();
+									gui::SetDragDropPayload("DND_PATH", mPath.c_str(), mPath.size() + 1);
+									gui::Text("Moving %s", entry.Path.filename().string().c_str());
+									gui::EndDragDropSource();
+								}
 
-									gui::PopStyleVar();
-									gui::PopStyleColor();
+								gui::PopStyleVar();
+								gui::PopStyleColor();
 
-									gui::PushTextWrapPos(gui::GetCursorPos().x + buttonSize);
-									gui::TextWrapped(entry.path().filename().string().c_str());
-									gui::PopTextWrapPos();
-									gui::EndGroup();
+								gui::PushTextWrapPos(gui::GetCursorPos().x + buttonSize);
+								gui::TextWrapped(entry.Path.filename().string().c_str());
+								gui::PopTextWrapPos();
+								gui::EndGroup();
 
-									openFilePopups(entry.path());
-								}
+								openFilePopups(entry.Path);
 							}
 							i++;
 
-							openRightClick(entry.path().string());
+							openRightClick(entry.Path.string());
 						}
 						if (i == 0)
 						{
@@ -2344,7 +2563,7 @@ void EditorInstance::UI_Assets()
 		// For text-editable files, check if unsaved.
 		if (textEditorExt.contains(it->extension().string()))
 		{
-			const std::string fileContent = OpenFile(fileKey);
+			const std::string& fileContent = GetFileContents(fileKey);
 			if (fileBuffers.find(fileKey) == fileBuffers.end())
 				fileBuffers[fileKey] = fileContent;
 
@@ -2362,11 +2581,14 @@ void EditorInstance::UI_Assets()
 				if (gui::BeginMenuBar())
 				{
 					if (gui::Button(("Save##" + fileKey).c_str()))
+					{
 						SaveStringToFile(*it, fileBuffers[fileKey]);
+						m_FileContents[fileKey] = fileBuffers[fileKey];
+					}
 
 					gui::BeginDisabled((flags & ImGuiWindowFlags_UnsavedDocument) == 0);
 					if (gui::Button(("Revert All##" + fileKey).c_str()))
-						tempChange = OpenFile(fileKey);
+						tempChange = m_FileContents[fileKey] = OpenFile(fileKey);
 
 					gui::EndDisabled();
 					gui::EndMenuBar();
@@ -2383,6 +2605,7 @@ void EditorInstance::UI_Assets()
 		{
 			openedFileNames.erase(fileKey);
 			fileBuffers.erase(fileKey);
+			m_FileContents.erase(fileKey);
 			it = openedFiles.erase(it);
 		}
 		else
@@ -2435,6 +2658,233 @@ void EditorInstance::UI_DebugStats()
 
 			m_MaxFPS = m_MinFPS = fps;
 		}
+
+		{
+			gui::SeparatorText("Textures");
+			auto samplerStats = vk::samplerCache.GetStats();
+			ui::Text(std::format("Texture slots: {} / {} ({} free)", assetManager.Textures.size() - assetManager.FreeTextures.size(), m_Renderer.TextureCapacity, assetManager.FreeTextures.size()));
+			ui::Text(std::format("Samplers: {} shared by {} textures", samplerStats.Samplers, samplerStats.References));
+			ui::Text(std::format("Sampler cache: {} hits, {} misses", samplerStats.Hits, samplerStats.Misses));
+			ui::Text(std::format("Texture memory: {:.1f} MB", assetManager.TextureMemory / (1024.0 * 1024.0)));
+			auto deduplication = assetManager.GetDeduplicationStats();
+			ui::Text(std::format("Duplicate files sharing a texture: {} ({:.1f} MB saved)", deduplication.Textures, deduplication.Memory / (1024.0 * 1024.0)));
+
+			// Stored with the project, 0 keeps unused textures loaded until the scene changes
+			int budget = int(assetManager.TextureBudget / (1024 * 1024));
+			if (gui::DragInt("Texture budget (MB)", &budget, 1.f, 0, 16384))
+				assetManager.TextureBudget = size_t(budget) * 1024 * 1024;
+			if (gui::IsItemDeactivatedAfterEdit())
+				SaveProjectData();
+
+			// Stored with the project, applies to textures loaded from now on
+			gui::BeginDisabled(!VulkanContext::GetPhysicalDevice().GetFeatures().textureCompressionBC || ProjectRootPath.empty());
+			if (gui::Checkbox("Compress on import (BC1/BC4/BC7)", &assetManager.CompressTextures))
+				SaveProjectData();
+			gui::EndDisabled();
+		}
+
+		{
+			gui::SeparatorText("Physics");
+			const auto& stats = m_Scene.m_Scene.PhysicsStats;
+			ui::Text(std::format("Steps: {} x {} sub-steps ({} dropped)", stats.Steps, stats.SubSteps, stats.DroppedSteps));
+			ui::Text(std::format("Bodies: {} ({} awake)", stats.Bodies, stats.AwakeBodies));
+			ui::Text(std::format("Shapes: {}, contacts: {}, islands: {}", stats.Shapes, stats.Contacts, stats.Islands));
+
+			if (gui::BeginTable("PhysicsTimings", 2, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+			{
+				auto TimingRow = [](const char* name, float time)
+					{
+						gui::TableNextRow();
+						gui::TableNextColumn(); ui::Text(name);
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", time));
+					};
+
+				TimingRow("Step", stats.Step);
+				TimingRow("Broadphase", stats.Broadphase);
+				TimingRow("Narrowphase", stats.Narrowphase);
+				TimingRow("Solver", stats.Solver);
+				TimingRow("Split islands", stats.SplitIslands);
+				TimingRow("Sleep islands", stats.SleepIslands);
+
+				gui::EndTable();
+			}
+		}
+
+		if (gpuProfiler.IsSupported())
+		{
+			gui::SeparatorText("GPU");
+			gui::Checkbox("Enabled##GPUProfiler", &gpuProfiler.Enabled);
+			gui::SameLine();
+			if (gui::Button("Export JSON##GPUProfiler"))
+				gpuProfiler.ExportJSON("gpu_timings.json");
+
+			if (gui::BeginTable("GPUTimings", 6, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+			{
+				gui::TableSetupColumn("Zone");
+				gui::TableSetupColumn("Last");
+				gui::TableSetupColumn("Avg");
+				gui::TableSetupColumn("P50");
+				gui::TableSetupColumn("P95");
+				gui::TableSetupColumn("P99");
+				gui::TableHeadersRow();
+
+				auto ZoneRow = [](const GPUZoneStats& zone)
+					{
+						gui::TableNextRow();
+						gui::TableNextColumn(); ui::Text(zone.Name);
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", zone.Last));
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", zone.Average));
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", zone.P50));
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", zone.P95));
+						gui::TableNextColumn(); ui::Text(std::format("{:.3f}ms", zone.P99));
+					};
+
+				ZoneRow(gpuProfiler.GetFrameStats());
+				for (auto& zone : gpuProfiler.GetZones())
+					ZoneRow(zone);
+
+				gui::EndTable();
+			}
+		}
+	}
+	gui::End();
+}
+
+void EditorInstance::UI_Profiler()
+{
+	if (gui::Begin("Profiler", &showProfiler))
+	{
+#if WC_PROFILER
+		static bool paused = false;
+		static std::vector<Profiler::Frame> pausedFrames;
+		static uint32_t pausedHead = 0;
+		static int selected = -1; // Offset from the newest frame, -1 means the newest
+		static int captureFrameCount = 120;
+
+		if (gui::Checkbox("Pause", &paused) && paused)
+		{
+			pausedFrames = Profiler::GetFrames();
+			pausedHead = Profiler::GetFrameHead();
+		}
+		if (!paused) selected = -1;
+
+		gui::SameLine();
+		gui::SetNextItemWidth(100.f);
+		gui::InputInt("Frames##Capture", &captureFrameCount);
+		captureFrameCount = glm::clamp(captureFrameCount, 1, 10000);
+		gui::SameLine();
+		gui::BeginDisabled(Profiler::IsCapturing());
+		if (gui::Button("Capture Trace"))
+			Profiler::CaptureTrace(captureFrameCount, "trace.json");
+		gui::EndDisabled();
+		gui::SetItemTooltip("Writes the next frames to trace.json, open it in chrome://tracing or ui.perfetto.dev");
+
+		const auto& frames = paused ? pausedFrames : Profiler::GetFrames();
+		const uint32_t head = paused ? pausedHead : Profiler::GetFrameHead();
+		if (frames.empty())
+		{
+			gui::End();
+			return;
+		}
+
+		// Oldest -> newest
+		auto GetFrame = [&](int index) -> const Profiler::Frame& { return frames[(head + 1 + index) % Profiler::FRAME_HISTORY]; };
+
+		float durations[Profiler::FRAME_HISTORY];
+		for (int i = 0; i < Profiler::FRAME_HISTORY; i++)
+			durations[i] = GetFrame(i).GetDuration();
+
+		gui::PlotHistogram("##FrameTimes", durations, Profiler::FRAME_HISTORY, 0, "Frame time (ms)", 0.f, 33.f, { gui::GetContentRegionAvail().x, 60.f });
+		if (gui::IsItemClicked())
+		{
+			if (!paused)
+			{
+				paused = true;
+				pausedFrames = Profiler::GetFrames();
+				pausedHead = Profiler::GetFrameHead();
+			}
+			float t = (gui::GetMousePos().x - gui::GetItemRectMin().x) / gui::GetItemRectSize().x;
+			selected = Profiler::FRAME_HISTORY - 1 - glm::clamp(int(t * Profiler::FRAME_HISTORY), 0, int(Profiler::FRAME_HISTORY) - 1);
+		}
+
+		const auto& frame = GetFrame(Profiler::FRAME_HISTORY - 1 - glm::max(selected, 0));
+		ui::Text(std::format("Frame {} - {:.3f}ms", frame.Index, frame.GetDuration()));
+
+		// Flame chart
+		auto threadNames = Profiler::GetThreadNames();
+		std::vector<uint32_t> threadDepth(threadNames.size(), 0);
+		std::unordered_map<std::string_view, double> counters;
+		for (auto& event : frame.Events)
+		{
+			if (event.Data.Type == Profiler::EventType::Zone)
+				threadDepth[event.Thread] = glm::max(threadDepth[event.Thread], uint32_t(event.Data.Depth + 1));
+			else
+				counters[event.Data.Name] = event.Data.Value;
+		}
+
+		constexpr float rowHeight = 20.f;
+		if (gui::BeginChild("FlameChart", { 0.f, gui::GetContentRegionAvail().y - (counters.empty() ? 0.f : 120.f) }, true))
+		{
+			auto* drawList = gui::GetWindowDrawList();
+			const float width = gui::GetContentRegionAvail().x;
+			const double scale = frame.End > frame.Start ? width / double(frame.End - frame.Start) : 0.0;
+
+			for (uint32_t thread = 0; thread < threadNames.size(); thread++)
+			{
+				if (threadDepth[thread] == 0) continue;
+
+				ui::Text(threadNames[thread]);
+				ImVec2 origin = gui::GetCursorScreenPos();
+				gui::Dummy({ width, threadDepth[thread] * rowHeight });
+
+				for (auto& event : frame.Events)
+				{
+					if (event.Thread != thread || event.Data.Type != Profiler::EventType::Zone) continue;
+
+					uint64_t start = glm::max(event.Data.Start, frame.Start);
+					uint64_t end = glm::min(event.Data.End, frame.End);
+					if (end <= start) continue;
+
+					ImVec2 min = { origin.x + float((start - frame.Start) * scale), origin.y + event.Data.Depth * rowHeight };
+					ImVec2 max = { origin.x + float((end - frame.Start) * scale), min.y + rowHeight - 1.f };
+					if (max.x - min.x < 1.f) max.x = min.x + 1.f;
+
+					uint32_t hash = uint32_t(std::hash<std::string_view>{}(event.Data.Name));
+					ImU32 color = IM_COL32(80 + (hash & 0x7F), 80 + ((hash >> 8) & 0x7F), 80 + ((hash >> 16) & 0x7F), 255);
+					drawList->AddRectFilled(min, max, color, 2.f);
+
+					float duration = float(event.Data.End - event.Data.Start) / 1'000'000.f;
+					if (max.x - min.x > 30.f)
+					{
+						auto label = std::format("{} {:.2f}ms", event.Data.Name, duration);
+						drawList->PushClipRect(min, max, true);
+						drawList->AddText({ min.x + 3.f, min.y + 2.f }, IM_COL32_WHITE, label.c_str());
+						drawList->PopClipRect();
+					}
+
+					if (gui::IsMouseHoveringRect(min, max))
+						gui::SetTooltip("%s\n%.3fms", event.Data.Name, duration);
+				}
+			}
+		}
+		gui::EndChild();
+
+		if (!counters.empty() && gui::BeginTable("Counters", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY))
+		{
+			gui::TableSetupColumn("Counter");
+			gui::TableSetupColumn("Value");
+			gui::TableHeadersRow();
+			for (auto& [name, value] : counters)
+			{
+				gui::TableNextRow();
+				gui::TableNextColumn(); gui::TextUnformatted(name.data(), name.data() + name.size());
+				gui::TableNextColumn(); ui::Text(std::format("{}", value));
+			}
+			gui::EndTable();
+		}
+#else
+		gui::TextDisabled("The profiler is compiled out of Release builds, configure with -DWC_PROFILER=ON to keep it");
+#endif
 	}
 	gui::End();
 }
@@ -3118,6 +3568,7 @@ void EditorInstance::UI()
 					{
 						m_Scene.Save();
 						SavePhysicsMaterials(ProjectRootPath + "/physicsMaterials.yaml");
+						SaveCollisionLayers(ProjectRootPath + "/collisionLayers.yaml");
 					}
 
 					if (gui::MenuItem("Save As", "CTRL + A + S"))
@@ -3141,6 +3592,7 @@ void EditorInstance::UI()
 					gui::MenuItem("Console", nullptr, &showConsole);
 					gui::MenuItem("Assets", nullptr, &showAssets);
 					gui::MenuItem("Debug Statistics", nullptr, &showDebugStats);
+					gui::MenuItem("Profiler", nullptr, &showProfiler);
 					gui::MenuItem("Style Editor", nullptr, &showStyleEditor);
 
 					if (gui::BeginMenu("Theme"))
@@ -3187,6 +3639,7 @@ void EditorInstance::UI()
 				if (showConsole) UI_Console();
 				if (showAssets) UI_Assets();
 				if (showDebugStats) UI_DebugStats();
+				if (showProfiler) UI_Profiler();
 				if (showStyleEditor) UI_StyleEditor();
 			}
 		}
@@ -3232,6 +3685,15 @@ bool EditorInstance::ProjectExistInList(const std::string& pName)
 
 void EditorInstance::ResetProject()
 {
+	m_ProjectWatcher.Stop();
+	m_DirectoryCache.clear();
+	m_FileContents.clear();
+	m_Thumbnails.SetProject("", "");
+	assetRegistry.Close();
+	assetManager.CompressTextures = false;
+	assetManager.TextureCachePath.clear();
+	assetManager.TextureBudget = 0;
+	CollisionLayers = {};
 	ProjectName = "";
 	ProjectRootPath = "";
 	ProjectFirstScene = "";
@@ -3255,6 +3717,9 @@ void EditorInstance::SaveProjectData()
 	data["scriptsPath"] = std::filesystem::relative(scriptsPath, ProjectRootPath).string();
 	data["entitiesPath"] = std::filesystem::relative(entitiesPath, ProjectRootPath).string();
 
+	data["compressTextures"] = assetManager.CompressTextures;
+	data["textureBudgetMB"] = uint64_t(assetManager.TextureBudget / (1024 * 1024));
+
 	YAML::Node openedScenes;
 	for (const auto& scene : savedProjectScenes)
 		openedScenes.push_back(std::filesystem::relative(scene, scenesPath).string());
@@ -3290,6 +3755,7 @@ bool EditorInstance::LoadProject(const std::string& filepath)
 
 		ProjectName = std::filesystem::path(filepath).stem().string();
 		ProjectRootPath = filepath;
+		assetRegistry.Open(ProjectRootPath);
 
 		YAML::Node data = YAML::LoadFile(GetProjectSettingsPath());
 		if (data)
@@ -3301,10 +3767,17 @@ bool EditorInstance::LoadProject(const std::string& filepath)
 			if (data["scenesPath"]) scenesPath = ProjectRootPath + '/' + data["scenesPath"].as<std::string>();
 			if (data["scriptsPath"]) scriptsPath = ProjectRootPath + '/' + data["scriptsPath"].as<std::string>();
 			if (data["entitiesPath"]) entitiesPath = ProjectRootPath + '/' + data["entitiesPath"].as<std::string>();
+
+			if (data["compressTextures"]) assetManager.CompressTextures = data["compressTextures"].as<bool>();
+			if (data["textureBudgetMB"]) assetManager.TextureBudget = data["textureBudgetMB"].as<uint64_t>() * 1024 * 1024;
 		}
+		assetManager.TextureCachePath = ProjectRootPath + "/.blaze/cache/textures";
+		m_Thumbnails.SetProject(ProjectRootPath, ProjectRootPath + "/.blaze/cache/thumbnails");
+		m_ProjectWatcher.Start(ProjectRootPath);
 		AddProjectToList(ProjectRootPath);
 
 		LoadPhysicsMaterials(ProjectRootPath + "/physicsMaterials.yaml");
+		LoadCollisionLayers(ProjectRootPath + "/collisionLayers.yaml");
 
 		if (std::filesystem::exists(GetProjectUserSettingsPath()))
 		{
@@ -3348,6 +3821,9 @@ void EditorInstance::CreateProject(const std::string& filepath, const std::strin
 	AddProjectToList(ProjectRootPath);
 	//std::string assetDir = ProjectRootPath + "/Assets";
 	std::filesystem::create_directory(ProjectRootPath);
+	assetRegistry.Open(ProjectRootPath);
+	assetManager.TextureCachePath = ProjectRootPath + "/.blaze/cache/textures";
+	m_Thumbnails.SetProject(ProjectRootPath, ProjectRootPath + "/.blaze/cache/thumbnails");
 
 	std::filesystem::create_directory(texturePath);
 	std::filesystem::create_directory(fontPath);
@@ -3357,6 +3833,7 @@ void EditorInstance::CreateProject(const std::string& filepath, const std::strin
 	std::filesystem::create_directory(scriptsPath);
 	std::filesystem::create_directory(entitiesPath);
 
+	m_ProjectWatcher.Start(ProjectRootPath);
 	SaveProjectData();
 }
 
@@ -3366,6 +3843,7 @@ void EditorInstance::DeleteProject(const std::string& filepath) // @TODO: This f
 	{
 		if (IsProject(filepath))
 		{
+			m_ProjectWatcher.Stop(); // The watch keeps a handle to the directory on Windows
 			std::filesystem::remove_all(filepath);
 			RemoveProjectFromList(filepath);
 			ResetProject();
@@ -3394,7 +3872,12 @@ void EditorInstance::RenameProject(const std::string& newName)
 	RemoveProjectFromList(ProjectRootPath);
 	auto oldProjectPath = ProjectRootPath;
 	ProjectRootPath = ProjectRootPath.substr(0, ProjectRootPath.find_last_of('\\') + 1) + newName;
+	assetRegistry.Close(); // @NOTE: Manifest paths are project relative, only the root changes
+	m_ProjectWatcher.Stop();
 	std::filesystem::rename(oldProjectPath, ProjectRootPath);
+	assetRegistry.Open(ProjectRootPath);
+	m_ProjectWatcher.Start(ProjectRootPath);
+	m_Thumbnails.SetProject(ProjectRootPath, ProjectRootPath + "/.blaze/cache/thumbnails"); // Keyed by path, the old entries don't match anymore
 	AddProjectToList(ProjectRootPath);
 	ProjectName = newName;
 	SaveProjectData(); // @TODO: Obsolete?
@@ -6,10 +6,14 @@
 
 #include "../Utils/List.h"
 #include "../Utils/FileDialogs.h"
+#include "../Utils/FileWatcher.h"
+#include "../Utils/Profiler.h"
 
 #include "../Rendering/Renderer2D.h"
+#include "../Rendering/GPUProfiler.h"
 
 #include "EditorScene.h"
+#include "ThumbnailService.h"
 
 #include "../Globals.h"
 
@@ -46,6 +50,23 @@ struct EditorInstance
 
 	b2DebugDraw m_PhysicsDebugDraw;
 
+	// Image and scene previews for the assets panel, made in the background into an atlas of their own
+	ThumbnailService m_Thumbnails;
+
+	// Hot reload, ProcessFileChanges re-imports what changed in the project and rebuilds the pipelines of recompiled shaders
+	wc::FileWatcher m_ProjectWatcher;
+	wc::FileWatcher m_ShaderWatcher;
+
+	// Listings for the assets panel, only read again when the watcher reports a change inside the directory
+	struct DirectoryEntry
+	{
+		std::filesystem::path Path;
+		bool IsDirectory = false;
+	};
+	std::unordered_map<std::string, std::vector<DirectoryEntry>> m_DirectoryCache;
+	bool m_DirectoryCacheDirty = false; // Set when the panel itself moved files, the listings are dropped before the next frame
+	std::unordered_map<std::string, std::string> m_FileContents; // Saved contents of the text files open in the assets panel
+
     // Window Buttons
 	Texture t_Close;
 	Texture t_Minimize;
@@ -73,6 +94,8 @@ struct EditorInstance
     Texture t_Error;
     Texture t_Critical;
 
+	std::vector<Image> m_DecodedIcons; // Filled by DecodeIcons, uploaded and freed in Create
+
 	bool allowInput = true;
 
 	bool showEditor = true;
@@ -82,10 +105,14 @@ struct EditorInstance
 	bool showConsole = true;
 	bool showAssets = true;
 	bool showDebugStats = false;
+	bool showProfiler = false;
 	bool showStyleEditor = false;
 
 	EditorScene m_Scene;
 
+	// Only decodes the icon images, doesn't touch Vulkan so it can run on a worker thread before Create
+	void DecodeIcons();
+
 	void Create();
 
 	void Resize(glm::vec2 size);
@@ -94,8 +121,6 @@ struct EditorInstance
 
 	void Input();
 
-	void RenderEntity(flecs::entity entt, glm::mat4& transform);
-
 	void Render();
 
 	void Update();
@@ -119,10 +144,18 @@ struct EditorInstance
 
 	void UI_Console();
 
+	const std::vector<DirectoryEntry>& GetDirectoryEntries(const std::filesystem::path& directory);
+
+	const std::string& GetFileContents(const std::string& filepath);
+
+	void ProcessFileChanges();
+
 	void UI_Assets();
 
 	void UI_DebugStats();
 
+	void UI_Profiler();
+
 	void UI_StyleEditor(ImGuiStyle* ref = nullptr);
 
 	void WindowButtons();
@@ -1,8 +1,47 @@
 #include "EditorScene.h"
 #include <filesystem>
+#include <fstream>
+#include <map>
+#include <variant>
+
+#include "../Scene/SceneFormat.h"
+#include "../Utils/MappedFile.h"
+#include "../Utils/Profiler.h"
 
 using namespace Editor;
 
+// The project relative path (readable, used as a fallback) and the asset ID (survives renames), NULL_ASSET outside of the project
+static std::pair<std::string, AssetID> GetAssetReference(const std::string& path, AssetType type, const std::string& basePath)
+{
+	AssetID id = assetRegistry.Import(path, type);
+	if (auto asset = assetRegistry.Get(id)) return { asset->Path, id };
+	return { std::filesystem::relative(path, basePath).string(), NULL_ASSET };
+}
+
+static std::string ResolveAssetPath(AssetID id, const std::string& path, const std::string& basePath)
+{
+	if (id != NULL_ASSET)
+	{
+		std::string absolutePath = assetRegistry.GetAbsolutePath(id);
+		if (!absolutePath.empty()) return absolutePath;
+	}
+
+	return basePath + path;
+}
+
+static void SerializeAsset(YAML::Node& componentData, const std::string& key, const std::string& path, AssetType type, const std::string& basePath)
+{
+	auto [relativePath, id] = GetAssetReference(path, type, basePath);
+	componentData[key] = relativePath;
+	if (id != NULL_ASSET) componentData[key + "ID"] = id;
+}
+
+static std::string DeserializeAsset(const YAML::Node& componentData, const std::string& key, const std::string& basePath)
+{
+	AssetID id = componentData[key + "ID"] ? componentData[key + "ID"].as<AssetID>() : NULL_ASSET;
+	return ResolveAssetPath(id, componentData[key].as<std::string>(), basePath);
+}
+
 YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, const std::string& basePath)
 {
 	YAML::Node entityData;
@@ -24,14 +63,8 @@ YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, cons
 		auto component = entity.get_ref<TextRendererComponent>();
 		YAML::Node componentData;
 		componentData["Text"] = component->Text;
-		for (const auto& [name, fontID] : assetManager.FontCache) // ew, but there's no other way ig
-		{
-			if (fontID == component->FontID)
-			{
-				componentData["Font"] = std::filesystem::relative(name, basePath).string();
-				break;
-			}
-		}
+		const auto& fontPath = assetManager.GetFontName(component->FontID);
+		if (!fontPath.empty()) SerializeAsset(componentData, "Font", fontPath, AssetType::Font, basePath);
 
 		componentData["Color"] = component->Color;
 		componentData["Kerning"] = component->Kerning;
@@ -45,16 +78,9 @@ YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, cons
 		YAML::Node componentData;
 		componentData["Color"] = component->Color;
 
-		for (const auto& [name, texID] : assetManager.TextureCache) // ew, but there's no other way ig
-		{
-			if (texID == component->Texture)
-			{
-				auto fName = name;
-				if (name != "None") fName = std::filesystem::relative(name, basePath).string();;
-				componentData["Texture"] = fName;
-				break;
-			}
-		}
+		const auto& texturePath = assetManager.GetTextureName(component->Texture);
+		if (texturePath.empty() || texturePath == "None") componentData["Texture"] = "None";
+		else SerializeAsset(componentData, "Texture", texturePath, AssetType::Texture, basePath);
 
 		entityData["SpriteRendererComponent"] = componentData;
 	}
@@ -90,15 +116,10 @@ YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, cons
 		componentData["Offset"] = component->Offset;
 		componentData["Size"] = component->Size;
 
-		if (component->MaterialID != 0)
-			for (const auto& [name, matID] : PhysicsMaterialNames) // ew, but there's no other way ig
-			{
-				if (matID == component->MaterialID)
-				{
-					componentData["Material"] = name;
-					break;
-				}
-			}
+		if (component->MaterialID != 0 && component->MaterialID < PhysicsMaterialNamesByID.size())
+			componentData["Material"] = PhysicsMaterialNamesByID[component->MaterialID];
+
+		if (component->Layer != 0) componentData["Layer"] = component->Layer;
 
 		entityData["BoxCollider2DComponent"] = componentData;
 	}
@@ -110,24 +131,49 @@ YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, cons
 		componentData["Offset"] = component->Offset;
 		componentData["Radius"] = component->Radius;
 
-		if (component->MaterialID != 0)
-			for (const auto& [name, matID] : PhysicsMaterialNames) // ew, but there's no other way ig
-			{
-				if (matID == component->MaterialID)
-				{
-					componentData["Material"] = name;
-					break;
-				}
-			}
+		if (component->MaterialID != 0 && component->MaterialID < PhysicsMaterialNamesByID.size())
+			componentData["Material"] = PhysicsMaterialNamesByID[component->MaterialID];
+
+		if (component->Layer != 0) componentData["Layer"] = component->Layer;
 
 		entityData["CircleCollider2DComponent"] = componentData;
 	}
 
+	if (entity.has<PolygonCollider2DComponent>())
+	{
+		auto component = entity.get_ref<PolygonCollider2DComponent>();
+		YAML::Node componentData;
+		componentData["Points"] = component->Points;
+		componentData["Radius"] = component->Radius;
+
+		if (component->MaterialID != 0 && component->MaterialID < PhysicsMaterialNamesByID.size())
+			componentData["Material"] = PhysicsMaterialNamesByID[component->MaterialID];
+
+		if (component->Layer != 0) componentData["Layer"] = component->Layer;
+
+		entityData["PolygonCollider2DComponent"] = componentData;
+	}
+
+	if (entity.has<ChainCollider2DComponent>())
+	{
+		auto component = entity.get_ref<ChainCollider2DComponent>();
+		YAML::Node componentData;
+		componentData["Points"] = component->Points;
+		componentData["Loop"] = component->Loop;
+
+		if (component->MaterialID != 0 && component->MaterialID < PhysicsMaterialNamesByID.size())
+			componentData["Material"] = PhysicsMaterialNamesByID[component->MaterialID];
+
+		if (component->Layer != 0) componentData["Layer"] = component->Layer;
+
+		entityData["ChainCollider2DComponent"] = componentData;
+	}
+
 	if (entity.has<ScriptComponent>())
 	{
 		auto component = entity.get_ref<ScriptComponent>();
 		YAML::Node componentData;
-		componentData["Path"] = std::filesystem::relative(component->ScriptInstance.Name, basePath).string();
+		SerializeAsset(componentData, "Path", component->ScriptInstance.Name, AssetType::Script, basePath);
 
 		entityData["ScriptComponent"] = componentData;
 	}
@@ -135,27 +181,11 @@ YAML::Node SerializeEntity(const Scene& scene, const flecs::entity& entity, cons
 	if (entity.has<EntityOrderComponent>())
 	{
 		YAML::Node childrenData;
-		/*scene.EntityWorld.query_builder<EntityTag>()
-			.with(flecs::ChildOf, entity)
-			.each([&](flecs::entity child, EntityTag) {
-			YAML::Node childData = SerializeEntity(scene, child);
+		scene.EachChild(entity, [&](flecs::entity child) {
+			YAML::Node childData = SerializeEntity(scene, child, basePath);
 
 			childrenData.push_back(childData);
-				});*/
-
-		for (const auto& name : entity.get_ref<EntityOrderComponent>()->EntityOrder)
-		{
-			auto child = entity.lookup(name.c_str());
-
-			if (child)
-			{
-				YAML::Node childData = SerializeEntity(scene, child, basePath);
-
-				childrenData.push_back(childData);
-			}
-			else
-				WC_ERROR("Could not find entity with name '{}'", name.c_str());
-		}
+			});
 
 		if (childrenData.size() != 0)
 			entityData["Children"] = childrenData;
@@ -195,7 +225,7 @@ flecs::entity DeserializeEntity(Scene& scene, const YAML::Node& entityData, cons
 				component.Kerning = componentData["Kerning"].as<float>();
 				component.LineSpacing = componentData["LineSpacing"].as<float>();
 
-				if (componentData["Font"]) component.FontID = assetManager.LoadFont(basePath + componentData["Font"].as<std::string>());
+				if (componentData["Font"]) component.FontID = assetManager.LoadFont(DeserializeAsset(componentData, "Font", basePath));
 
 				entity.set<TextRendererComponent>(component);
 			}
@@ -208,7 +238,7 @@ flecs::entity DeserializeEntity(Scene& scene, const YAML::Node& entityData, cons
 				SpriteRendererComponent component;
 				component.Color = componentData["Color"].as<glm::vec4>();
 				auto name = componentData["Texture"].as<std::string>();
-				if (name != "None") name = basePath + name;
+				if (name != "None") name = DeserializeAsset(componentData, "Texture", basePath);
 
 				component.Texture = assetManager.LoadTexture(name);
 
@@ -249,6 +279,7 @@ flecs::entity DeserializeEntity(Scene& scene, const YAML::Node& entityData, cons
 				component.Offset = componentData["Offset"].as<glm::vec2>();
 				component.Size = componentData["Size"].as<glm::vec2>();
 				if (componentData["Material"]) component.MaterialID = PhysicsMaterialNames[componentData["Material"].as<std::string>()];
+				if (componentData["Layer"]) component.Layer = std::min(componentData["Layer"].as<uint32_t>(), COLLISION_LAYER_COUNT - 1);
 
 				entity.set<BoxCollider2DComponent>(component);
 			}
@@ -262,21 +293,50 @@ flecs::entity DeserializeEntity(Scene& scene, const YAML::Node& entityData, cons
 				component.Offset = componentData["Offset"].as<glm::vec2>();
 				component.Radius = componentData["Radius"].as<float>();
 				if (componentData["Material"]) component.MaterialID = PhysicsMaterialNames[componentData["Material"].as<std::string>()];
+				if (componentData["Layer"]) component.Layer = std::min(componentData["Layer"].as<uint32_t>(), COLLISION_LAYER_COUNT - 1);
 
 				entity.set<CircleCollider2DComponent>(component);
 			}
 		}
 
+		{
+			auto componentData = entityData["PolygonCollider2DComponent"];
+			if (componentData)
+			{
+				PolygonCollider2DComponent component;
+				component.Points = componentData["Points"].as<std::vector<glm::vec2>>();
+				if (componentData["Radius"]) component.Radius = componentData["Radius"].as<float>();
+				if (componentData["Material"]) component.MaterialID = PhysicsMaterialNames[componentData["Material"].as<std::string>()];
+				if (componentData["Layer"]) component.Layer = std::min(componentData["Layer"].as<uint32_t>(), COLLISION_LAYER_COUNT - 1);
+
+				entity.set<PolygonCollider2DComponent>(component);
+			}
+		}
+
+		{
+			auto componentData = entityData["ChainCollider2DComponent"];
+			if (componentData)
+			{
+				ChainCollider2DComponent component;
+				component.Points = componentData["Points"].as<std::vector<glm::vec2>>();
+				if (componentData["Loop"]) component.Loop = componentData["Loop"].as<bool>();
+				if (componentData["Material"]) component.MaterialID = PhysicsMaterialNames[componentData["Material"].as<std::string>()];
+				if (componentData["Layer"]) component.Layer = std::min(componentData["Layer"].as<uint32_t>(), COLLISION_LAYER_COUNT - 1);
+
+				entity.set<ChainCollider2DComponent>(component);
+			}
+		}
+
 		{
 			auto componentData = entityData["ScriptComponent"];
 			if (componentData)
 			{
 				ScriptComponent component;
-				auto path = basePath + componentData["Path"].as<std::string>();
+				auto path = DeserializeAsset(componentData, "Path", basePath);
 				component.ScriptInstance.Load(ScriptBinaries[LoadScriptBinary(path)]);
 				component.ScriptInstance.Name = path;
 
-				entity.set<ScriptComponent>(component);
+				entity.set<ScriptComponent>(std::move(component)); // A copy would load another instance
 			}
 		}
 
@@ -298,22 +358,16 @@ YAML::Node toYAML(const Scene& scene, const std::string& basePath)
 	YAML::Node metaData;
 	YAML::Node entitiesData;
 
-	for (const auto& name : scene.EntityOrder)
-	{
-		auto entity = scene.EntityWorld.lookup(name.c_str());
-
-		if (entity)
-		{
-			entitiesData.push_back(SerializeEntity(scene, entity, basePath));
-		}
-		else
-			WC_ERROR("Could not find entity with name '{}'", name.c_str());
-	}
+	scene.EachChild(flecs::entity::null(), [&](flecs::entity entity) {
+		entitiesData.push_back(SerializeEntity(scene, entity, basePath));
+		});
 
 	if (scene.PhysicsWorld.IsValid())
 	{
 		metaData["Gravity"] = scene.PhysicsWorld.GetGravity();
 	}
+	metaData["SubSteps"] = scene.PhysicsWorldData.SubSteps;
+	metaData["MaxStepsPerFrame"] = scene.PhysicsWorldData.MaxStepsPerFrame;
 
 	if (entitiesData)
 		metaData["Entities"] = entitiesData;
@@ -331,10 +385,377 @@ void fromYAML(Scene& scene, const YAML::Node& data, const std::string& basePath)
 	}
 }
 
-void CopyScene(const Scene& srcScene, Scene& dstScene, const std::string& basePath)
+// Scene to .blzscene, assets are looked up once per texture, font and script instead of once per entity
+struct BinarySceneWriter
+{
+	const Scene* Source = nullptr;
+	SceneFileWriter File;
+	std::string BasePath;
+	SceneSnapshot* Snapshot = nullptr; // Writes loaded IDs and names instead of asset references
+	std::unordered_map<uint32_t, uint32_t> Textures, Fonts;
+	std::unordered_map<std::string, uint32_t> Scripts;
+
+	uint32_t AddAsset(const std::string& path, AssetType type, uint32_t loadedID)
+	{
+		if (Snapshot) return File.AddAsset(loadedID, path, type);
+
+		auto [relativePath, id] = GetAssetReference(path, type, BasePath);
+		return File.AddAsset(id, relativePath, type);
+	}
+
+	uint32_t AddTexture(uint32_t texture)
+	{
+		auto [it, inserted] = Textures.try_emplace(texture, SCENE_NONE);
+		const auto& path = assetManager.GetTextureName(texture);
+		if (!inserted || path.empty() || path == "None") return it->second;
+
+		it->second = AddAsset(path, AssetType::Texture, texture);
+		if (Snapshot) Snapshot->Textures.emplace_back(texture);
+		return it->second;
+	}
+
+	uint32_t AddFont(uint32_t font)
+	{
+		auto [it, inserted] = Fonts.try_emplace(font, SCENE_NONE);
+		const auto& path = assetManager.GetFontName(font);
+		if (!inserted || path.empty()) return it->second;
+
+		it->second = AddAsset(path, AssetType::Font, font);
+		if (Snapshot) Snapshot->Fonts.emplace_back(font);
+		return it->second;
+	}
+
+	uint32_t AddScript(const std::string& path)
+	{
+		auto [it, inserted] = Scripts.try_emplace(path, SCENE_NONE);
+		if (inserted && !path.empty()) it->second = AddAsset(path, AssetType::Script, Snapshot ? LoadScriptBinary(path) : 0); // Already loaded, a cache lookup
+		return it->second;
+	}
+
+	uint32_t AddMaterial(uint32_t material)
+	{
+		if (material == 0 || material >= PhysicsMaterialNamesByID.size()) return SCENE_NONE;
+		return File.AddString(PhysicsMaterialNamesByID[material]);
+	}
+
+	void WriteEntity(const flecs::entity& entity, uint32_t parent)
+	{
+		const char* name = entity.name().c_str();
+		uint32_t index = File.AddEntity(name && *name ? File.AddString(name) : SCENE_NONE, parent);
+
+		if (auto component = entity.get<TransformComponent>())
+			File.AddComponent(SceneComponent::Transform, index, SceneTransformRecord{ component->Translation, component->Scale, component->Rotation });
+
+		if (auto component = entity.get<TextRendererComponent>())
+		{
+			File.AddComponent(SceneComponent::TextRenderer, index, SceneTextRecord{
+				.Color = component->Color,
+				.Text = File.AddString(component->Text),
+				.Font = AddFont(component->FontID),
+				.Kerning = component->Kerning,
+				.LineSpacing = component->LineSpacing,
+				});
+		}
+
+		if (auto component = entity.get<SpriteRendererComponent>())
+			File.AddComponent(SceneComponent::SpriteRenderer, index, SceneSpriteRecord{ .Color = component->Color, .Texture = AddTexture(component->Texture) });
+
+		if (auto component = entity.get<CircleRendererComponent>())
+			File.AddComponent(SceneComponent::CircleRenderer, index, SceneCircleRecord{ component->Color, component->Thickness, component->Fade });
+
+		if (auto component = entity.get<RigidBodyComponent>())
+		{
+			File.AddComponent(SceneComponent::RigidBody, index, SceneRigidBodyRecord{
+				.Type = (uint32_t)component->Type,
+				.FixedRotation = component->FixedRotation,
+				.Bullet = component->Bullet,
+				.FastRotation = component->FastRotation,
+				.GravityScale = component->GravityScale,
+				.LinearDamping = component->LinearDamping,
+				.AngularDamping = component->AngularDamping,
+				});
+		}
+
+		if (auto component = entity.get<BoxCollider2DComponent>())
+			File.AddComponent(SceneComponent::BoxCollider2D, index, SceneBoxColliderRecord{ component->Offset, component->Size, AddMaterial(component->MaterialID), component->Layer });
+
+		if (auto component = entity.get<CircleCollider2DComponent>())
+			File.AddComponent(SceneComponent::CircleCollider2D, index, SceneCircleColliderRecord{ component->Offset, component->Radius, AddMaterial(component->MaterialID), component->Layer });
+
+		if (auto component = entity.get<PolygonCollider2DComponent>())
+			File.AddComponent(SceneComponent::PolygonCollider2D, index, ScenePolygonColliderRecord{ File.AddPoints(component->Points), component->Radius, AddMaterial(component->MaterialID), component->Layer });
+
+		if (auto component = entity.get<ChainCollider2DComponent>())
+			File.AddComponent(SceneComponent::ChainCollider2D, index, SceneChainColliderRecord{ File.AddPoints(component->Points), component->Loop, AddMaterial(component->MaterialID), component->Layer });
+
+		if (auto component = entity.get<ScriptComponent>())
+			File.AddComponent(SceneComponent::Script, index, SceneScriptRecord{ AddScript(component->ScriptInstance.Name) });
+
+		if (entity.has<EntityOrderComponent>())
+			Source->EachChild(entity, [&](flecs::entity child) { WriteEntity(child, index); });
+	}
+};
+
+SceneFileWriter toBinary(const Scene& scene, const std::string& basePath, SceneSnapshot* snapshot = nullptr)
 {
-	dstScene.DeleteAllEntities();
-	fromYAML(dstScene, toYAML(srcScene, basePath), basePath);
+	BinarySceneWriter writer = { .Source = &scene, .BasePath = basePath, .Snapshot = snapshot };
+	scene.EachChild(flecs::entity::null(), [&](flecs::entity entity) { writer.WriteEntity(entity, SCENE_NONE); });
+
+	if (scene.PhysicsWorld.IsValid())
+	{
+		writer.File.Header.Flags |= SceneFile_Gravity;
+		writer.File.Header.Gravity = scene.PhysicsWorld.GetGravity();
+	}
+
+	writer.File.Header.Flags |= SceneFile_Stepping;
+	writer.File.Header.SubSteps = (uint16_t)std::min(scene.PhysicsWorldData.SubSteps, 0xFFFFu);
+	writer.File.Header.MaxStepsPerFrame = (uint16_t)std::min(scene.PhysicsWorldData.MaxStepsPerFrame, 0xFFFFu);
+
+	return std::move(writer.File);
+}
+
+// Creates the entities of a binary scene in bulk: entities with the same components and parent end up in the same flecs
+// table, so each group is one ecs_bulk_init that copies whole component arrays. Groups are created a hierarchy level at
+// a time so parents exist before their children. Expects no other entities with the same names at the root
+void fromBinary(Scene& scene, const SceneFileReader& file, const std::string& basePath, bool snapshot = false)
+{
+	constexpr uint32_t COMPONENT_COUNT = (uint32_t)SceneComponent::Count;
+	constexpr uint32_t HAS_CHILDREN = 1u << COMPONENT_COUNT;
+
+	auto& world = scene.EntityWorld;
+	auto entities = file.GetEntities();
+	auto assets = file.GetAssets();
+	const uint32_t entityCount = (uint32_t)entities.size();
+
+	// Every referenced asset is loaded once, snapshots already have the IDs
+	std::vector<uint32_t> assetIDs(assets.size(), 0);
+	std::vector<std::string> assetPaths(assets.size());
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		if (snapshot)
+		{
+			assetIDs[i] = (uint32_t)assets[i].ID;
+			assetPaths[i] = file.GetString(assets[i].Path);
+			continue;
+		}
+
+		assetPaths[i] = ResolveAssetPath(assets[i].ID, std::string(file.GetString(assets[i].Path)), basePath);
+		switch ((AssetType)assets[i].Type)
+		{
+		case AssetType::Texture: assetIDs[i] = assetManager.LoadTexture(assetPaths[i]); break;
+		case AssetType::Font: assetIDs[i] = assetManager.LoadFont(assetPaths[i]); break;
+		case AssetType::Script: assetIDs[i] = LoadScriptBinary(assetPaths[i]); break;
+		default: break;
+		}
+	}
+
+	auto GetAsset = [&](uint32_t index, AssetType type, uint32_t fallback) {
+		return index < assets.size() && assets[index].Type == (uint32_t)type ? assetIDs[index] : fallback;
+		};
+
+	auto GetMaterial = [&](uint32_t name) -> uint32_t {
+		if (name == SCENE_NONE) return 0;
+		auto it = PhysicsMaterialNames.find(std::string(file.GetString(name)));
+		return it != PhysicsMaterialNames.end() ? it->second : 0;
+		};
+
+	const auto transforms = file.GetColumn<SceneTransformRecord>(SceneComponent::Transform);
+	const auto texts = file.GetColumn<SceneTextRecord>(SceneComponent::TextRenderer);
+	const auto sprites = file.GetColumn<SceneSpriteRecord>(SceneComponent::SpriteRenderer);
+	const auto circles = file.GetColumn<SceneCircleRecord>(SceneComponent::CircleRenderer);
+	const auto rigidBodies = file.GetColumn<SceneRigidBodyRecord>(SceneComponent::RigidBody);
+	const auto boxColliders = file.GetColumn<SceneBoxColliderRecord>(SceneComponent::BoxCollider2D);
+	const auto circleColliders = file.GetColumn<SceneCircleColliderRecord>(SceneComponent::CircleCollider2D);
+	const auto polygonColliders = file.GetColumn<ScenePolygonColliderRecord>(SceneComponent::PolygonCollider2D);
+	const auto chainColliders = file.GetColumn<SceneChainColliderRecord>(SceneComponent::ChainCollider2D);
+	const auto scripts = file.GetColumn<SceneScriptRecord>(SceneComponent::Script);
+
+	// Which columns each entity is in and its row in them
+	std::vector<uint32_t> masks(entityCount, 0);
+	std::vector<uint32_t> rows[COMPONENT_COUNT];
+	auto MarkColumn = [&](SceneComponent component, std::span<const uint32_t> columnEntities) {
+		auto& componentRows = rows[(uint32_t)component];
+		componentRows.resize(entityCount);
+		for (uint32_t row = 0; row < (uint32_t)columnEntities.size(); row++)
+		{
+			masks[columnEntities[row]] |= 1u << (uint32_t)component;
+			componentRows[columnEntities[row]] = row;
+		}
+		};
+
+	MarkColumn(SceneComponent::Transform, transforms.Entities);
+	MarkColumn(SceneComponent::TextRenderer, texts.Entities);
+	MarkColumn(SceneComponent::SpriteRenderer, sprites.Entities);
+	MarkColumn(SceneComponent::CircleRenderer, circles.Entities);
+	MarkColumn(SceneComponent::RigidBody, rigidBodies.Entities);
+	MarkColumn(SceneComponent::BoxCollider2D, boxColliders.Entities);
+	MarkColumn(SceneComponent::CircleCollider2D, circleColliders.Entities);
+	MarkColumn(SceneComponent::PolygonCollider2D, polygonColliders.Entities);
+	MarkColumn(SceneComponent::ChainCollider2D, chainColliders.Entities);
+	MarkColumn(SceneComponent::Script, scripts.Entities);
+
+	std::vector<uint32_t> depths(entityCount, 0);
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		uint32_t parent = entities[i].Parent;
+		if (parent == SCENE_NONE) continue;
+
+		depths[i] = depths[parent] + 1;
+		masks[parent] |= HAS_CHILDREN;
+	}
+
+	// Level, parent, components -> entities
+	std::map<std::tuple<uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> groups;
+	for (uint32_t i = 0; i < entityCount; i++)
+		groups[{ depths[i], entities[i].Parent, masks[i] }].push_back(i);
+
+	std::vector<ecs_entity_t> ids(entityCount, 0);
+	for (const auto& [key, members] : groups)
+	{
+		const uint32_t parent = std::get<1>(key), mask = std::get<2>(key);
+
+		ecs_bulk_desc_t desc = {};
+		void* data[FLECS_ID_DESC_MAX] = {};
+		int32_t idCount = 0;
+
+		// Components without data are default constructed
+		auto AddID = [&](ecs_id_t id, void* values) {
+			desc.ids[idCount] = id;
+			data[idCount++] = values;
+			};
+
+		auto AddColumn = [&]<typename Record, typename Component>(SceneComponent component, const SceneColumn<Record>& column, std::vector<Component>& values, auto&& convert) {
+			if (!(mask & (1u << (uint32_t)component))) return;
+
+			values.reserve(members.size());
+			for (uint32_t entity : members)
+				values.push_back(convert(column[rows[(uint32_t)component][entity]]));
+			AddID(world.component<Component>().id(), values.data());
+			};
+
+		std::vector<TransformComponent> transformValues;
+		std::vector<TextRendererComponent> textValues;
+		std::vector<SpriteRendererComponent> spriteValues;
+		std::vector<CircleRendererComponent> circleValues;
+		std::vector<RigidBodyComponent> rigidBodyValues;
+		std::vector<BoxCollider2DComponent> boxColliderValues;
+		std::vector<CircleCollider2DComponent> circleColliderValues;
+		std::vector<PolygonCollider2DComponent> polygonColliderValues;
+		std::vector<ChainCollider2DComponent> chainColliderValues;
+
+		AddID(world.component<EntityTag>().id(), nullptr);
+		AddID(world.component<EntityLinkComponent>().id(), nullptr); // Linked once every ID is known
+
+		AddColumn(SceneComponent::Transform, transforms, transformValues, [](const SceneTransformRecord& record) {
+			return TransformComponent{ record.Translation, record.Scale, record.Rotation };
+			});
+
+		AddColumn(SceneComponent::TextRenderer, texts, textValues, [&](const SceneTextRecord& record) {
+			TextRendererComponent component;
+			component.Text = file.GetString(record.Text);
+			component.FontID = GetAsset(record.Font, AssetType::Font, FontHandle::Null);
+			component.Color = record.Color;
+			component.Kerning = record.Kerning;
+			component.LineSpacing = record.LineSpacing;
+			return component;
+			});
+
+		AddColumn(SceneComponent::SpriteRenderer, sprites, spriteValues, [&](const SceneSpriteRecord& record) {
+			return SpriteRendererComponent{ .Color = record.Color, .Texture = GetAsset(record.Texture, AssetType::Texture, 0) };
+			});
+
+		AddColumn(SceneComponent::CircleRenderer, circles, circleValues, [](const SceneCircleRecord& record) {
+			return CircleRendererComponent{ record.Color, record.Thickness, record.Fade };
+			});
+
+		AddColumn(SceneComponent::RigidBody, rigidBodies, rigidBodyValues, [](const SceneRigidBodyRecord& record) {
+			return RigidBodyComponent{
+				.Type = record.Type <= (uint32_t)BodyType::Kinematic ? (BodyType)record.Type : BodyType::Static,
+				.FixedRotation = record.FixedRotation != 0,
+				.Bullet = record.Bullet != 0,
+				.FastRotation = record.FastRotation != 0,
+				.GravityScale = record.GravityScale,
+				.LinearDamping = record.LinearDamping,
+				.AngularDamping = record.AngularDamping,
+			};
+			});
+
+		AddColumn(SceneComponent::BoxCollider2D, boxColliders, boxColliderValues, [&](const SceneBoxColliderRecord& record) {
+			return BoxCollider2DComponent{ .Offset = record.Offset, .Size = record.Size, .MaterialID = GetMaterial(record.Material), .Layer = std::min(record.Layer, COLLISION_LAYER_COUNT - 1) };
+			});
+
+		AddColumn(SceneComponent::CircleCollider2D, circleColliders, circleColliderValues, [&](const SceneCircleColliderRecord& record) {
+			return CircleCollider2DComponent{ .Offset = record.Offset, .Radius = record.Radius, .MaterialID = GetMaterial(record.Material), .Layer = std::min(record.Layer, COLLISION_LAYER_COUNT - 1) };
+			});
+
+		AddColumn(SceneComponent::PolygonCollider2D, polygonColliders, polygonColliderValues, [&](const ScenePolygonColliderRecord& record) {
+			return PolygonCollider2DComponent{ .Points = file.GetPoints(record.Points), .Radius = record.Radius, .MaterialID = GetMaterial(record.Material), .Layer = std::min(record.Layer, COLLISION_LAYER_COUNT - 1) };
+			});
+
+		AddColumn(SceneComponent::ChainCollider2D, chainColliders, chainColliderValues, [&](const SceneChainColliderRecord& record) {
+			return ChainCollider2DComponent{ .Points = file.GetPoints(record.Points), .Loop = record.Loop != 0, .MaterialID = GetMaterial(record.Material), .Layer = std::min(record.Layer, COLLISION_LAYER_COUNT - 1) };
+			});
+
+		// Scripts get their instance once the entities exist, copying one into the bulk insert would run its top level twice
+		if (mask & (1u << (uint32_t)SceneComponent::Script)) AddID(world.component<ScriptComponent>().id(), nullptr);
+
+		if (mask & HAS_CHILDREN) AddID(world.component<EntityOrderComponent>().id(), nullptr);
+
+		if (parent != SCENE_NONE) AddID(ecs_pair(EcsChildOf, ids[parent]), nullptr);
+
+		desc.count = (int32_t)members.size();
+		desc.data = data;
+		const ecs_entity_t* created = ecs_bulk_init(world, &desc);
+		for (size_t i = 0; i < members.size(); i++)
+			ids[members[i]] = created[i];
+	}
+
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		if (entities[i].Name == SCENE_NONE) continue;
+
+		std::string name(file.GetString(entities[i].Name));
+		ecs_set_name(world, ids[i], name.c_str());
+	}
+
+	// Siblings are stored in the order the editor showed them in, the roots go after the ones the scene already has.
+	// Every entity is in its table already, so this only writes to components
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		uint32_t parent = entities[i].Parent;
+		auto& order = parent == SCENE_NONE ? scene.Roots : *flecs::entity(world, ids[parent]).get_mut<EntityOrderComponent>();
+		auto& link = *flecs::entity(world, ids[i]).get_mut<EntityLinkComponent>();
+
+		link.Previous = order.Last;
+		if (order.Last) flecs::entity(world, order.Last).get_mut<EntityLinkComponent>()->Next = ids[i];
+		else order.First = ids[i];
+		order.Last = ids[i];
+	}
+
+	for (size_t i = 0; i < scripts.size(); i++)
+	{
+		uint32_t asset = scripts[i].Script;
+		if (asset >= assets.size() || assets[asset].Type != (uint32_t)AssetType::Script) continue;
+
+		auto& component = *flecs::entity(world, ids[scripts.Entities[i]]).get_mut<ScriptComponent>();
+		component.ScriptInstance.Load(ScriptBinaries[assetIDs[asset]]);
+		component.ScriptInstance.Name = assetPaths[asset];
+	}
+}
+
+SceneSnapshot Editor::TakeSnapshot(const Scene& scene)
+{
+	WC_PROFILE_FUNCTION();
+	SceneSnapshot snapshot;
+	snapshot.Data = toBinary(scene, {}, &snapshot).Finish();
+	return snapshot;
+}
+
+void Editor::RestoreSnapshot(Scene& scene, const SceneSnapshot& snapshot)
+{
+	WC_PROFILE_FUNCTION();
+	SceneFileReader file;
+	if (file.Open(snapshot.Data.data(), snapshot.Data.size())) fromBinary(scene, file, {}, true);
 }
 
 void EditorScene::CreatePhysicsWorld() { m_Scene.CreatePhysicsWorld(); }
@@ -384,36 +805,90 @@ void EditorScene::SetState(SceneState newState)
 
 	if (newState == SceneState::Play || newState == SceneState::Simulate)
 	{
-		CopyScene(m_Scene, m_TempScene, basePath);
-
-		CreatePhysicsWorld();
+		m_Snapshot = TakeSnapshot(m_Scene); // The bodies already exist, SyncPhysicsBodies kept them up to date while editing
 
+		ScriptScene = &m_Scene;
 		m_Scene.EntityWorld.each([](ScriptComponent& script)
 			{
 				if (script.ScriptInstance)
 					script.ScriptInstance.state.Execute("Create");
 			});
+		ScriptScene = nullptr;
 	}
 	else if (newState == SceneState::Edit)
 	{
+		ScriptScene = &m_Scene;
 		m_Scene.EntityWorld.each([](ScriptComponent& script)
 			{
 				if (script.ScriptInstance)
 					script.ScriptInstance.state.Execute("Destroy");
 			});
-		m_Scene.PhysicsWorld.Destroy();
-
-		CopyScene(m_TempScene, m_Scene, basePath);
+		ScriptScene = nullptr;
+		m_Scene.DeleteAllEntities(); // Takes the physics world along, the restored bodies are built by the next sync
+		RestoreSnapshot(m_Scene, m_Snapshot);
+		m_Snapshot = {}; // The restored components hold the assets now
 	}
 
 	if (SelectedEntity != flecs::entity::null()) SelectedEntity = m_Scene.EntityWorld.lookup(selectedEntityName.c_str());
 }
 
+void EditorScene::ReloadScript(const std::string& path)
+{
+	auto it = ScriptBinaryCache.find(path);
+	if (it == ScriptBinaryCache.end()) return;
+
+	struct Variable
+	{
+		std::string Name;
+		std::variant<double, bool, std::string> Value;
+	};
+
+	// Read with the old binary's variable names, the recompile replaces them
+	const auto variableNames = ScriptBinaries[it->second].VariableNames;
+	LoadScriptBinary(path, true);
+	const auto& binary = ScriptBinaries[it->second];
+
+	m_Scene.EntityWorld.each([&](ScriptComponent& component)
+		{
+			auto& script = component.ScriptInstance;
+			if (!script || script.Name != path) return;
+
+			std::vector<Variable> variables;
+			for (const auto& name : variableNames)
+			{
+				script.state.GetGlobal(name);
+				if (script.state.IsString() && !script.state.IsNumber()) variables.push_back({ name, script.state.To<std::string>() });
+				else if (script.state.IsNumber()) variables.push_back({ name, script.state.To<double>() });
+				else if (script.state.IsBool()) variables.push_back({ name, script.state.To<bool>() });
+				script.state.Pop();
+			}
+
+			script.Unload();
+			if (script.Load(binary) != LUA_OK) return;
+			script.Name = path;
+
+			for (const auto& variable : variables)
+				if (std::find(binary.VariableNames.begin(), binary.VariableNames.end(), variable.Name) != binary.VariableNames.end())
+					std::visit([&](const auto& value) { script.state.SetVariable(variable.Name, value); }, variable.Value);
+
+			if (State != SceneState::Edit)
+			{
+				ScriptScene = &m_Scene;
+				script.state.Execute("Create");
+				ScriptScene = nullptr;
+			}
+		});
+
+	WC_CORE_INFO("Reloaded {}", path);
+}
+
 void EditorScene::UpdatePhysics() { m_Scene.UpdatePhysics(); }
 void EditorScene::Update()
 {
 	if (State == SceneState::Play || State == SceneState::Simulate)
 		m_Scene.Update();
+	else
+		m_Scene.SyncPhysicsBodies();
 }
 
 YAML::Node EditorScene::ExportEntity(const flecs::entity& entity) { return SerializeEntity(m_Scene, entity, basePath); }
@@ -422,12 +897,30 @@ flecs::entity EditorScene::LoadEntity(const std::string& path) { return LoadEnti
 
 void EditorScene::Save()
 {
-	YAML::Node data = toYAML(m_Scene, basePath);
-	data["CameraFocalPoint"] = camera.FocalPoint; // @TODO: Camera loading doesn't work
-	data["CameraYaw"] = camera.Yaw;
-	data["CameraPitch"] = camera.Pitch;
-	data["CameraDistance"] = camera.m_Distance;
-	YAMLUtils::SaveFile(Path, data);
+	if (std::filesystem::path(Path).extension() == ".blzscene")
+	{
+		SceneFileWriter file = toBinary(m_Scene, basePath);
+		file.Header.Flags |= SceneFile_Camera;
+		file.Header.CameraFocalPoint = camera.FocalPoint;
+		file.Header.CameraYaw = camera.Yaw;
+		file.Header.CameraPitch = camera.Pitch;
+		file.Header.CameraDistance = camera.m_Distance;
+
+		auto data = file.Finish();
+		std::ofstream output(Path, std::ios::binary);
+		output.write((const char*)data.data(), std::streamsize(data.size()));
+		if (!output.good()) WC_CORE_ERROR("Failed to write {}", Path);
+	}
+	else
+	{
+		YAML::Node data = toYAML(m_Scene, basePath);
+		data["CameraFocalPoint"] = camera.FocalPoint; // @TODO: Camera loading doesn't work
+		data["CameraYaw"] = camera.Yaw;
+		data["CameraPitch"] = camera.Pitch;
+		data["CameraDistance"] = camera.m_Distance;
+		YAMLUtils::SaveFile(Path, data);
+	}
+	assetRegistry.Save();
 }
 
 void EditorScene::Save(const std::string& filepath)
@@ -442,20 +935,70 @@ bool EditorScene::Load(const std::string& filepath, const std::string& bPath, co
 	basePath = bPath + '/';
 
 	if (clear) m_Scene.DeleteAllEntities();
-	if (!std::filesystem::exists(Path))
+
+	// Either format can be behind either extension (packs keep the original name), the content decides
+	std::vector<uint8_t> packed;
+	MappedFile mapped;
+	std::span<const uint8_t> bytes;
+	if (auto entry = assetPack.Find(Path, AssetPackKind::Scene))
+	{
+		packed = assetPack.Read(*entry);
+		bytes = packed;
+	}
+	else if (mapped.Open(Path))
+		bytes = { mapped.GetData(), mapped.GetSize() };
+	else if (!std::filesystem::exists(Path))
 	{
 		WC_CORE_ERROR("{} does not exist.", Path);
 		return false;
 	}
 
-	YAML::Node data = YAML::LoadFile(Path);
+	if (SceneFileReader::IsSceneFile(bytes.data(), bytes.size()))
+	{
+		SceneFileReader file;
+		if (!file.Open(bytes.data(), bytes.size())) return false;
+
+		// Merging goes through the YAML path, which reuses entities that already have the name
+		if (clear) fromBinary(m_Scene, file, basePath);
+		else fromYAML(m_Scene, ConvertSceneToYAML(file), basePath);
+
+		const auto& header = file.GetHeader();
+		auto& worldData = m_Scene.PhysicsWorldData;
+		if (header.Flags & SceneFile_Gravity) worldData.Gravity = header.Gravity;
+		if (header.Flags & SceneFile_Stepping)
+		{
+			worldData.SubSteps = std::max<uint32_t>(header.SubSteps, 1);
+			worldData.MaxStepsPerFrame = std::max<uint32_t>(header.MaxStepsPerFrame, 1);
+		}
+
+		if (header.Flags & SceneFile_Camera)
+		{
+			camera.FocalPoint = header.CameraFocalPoint;
+			camera.Yaw = header.CameraYaw;
+			camera.Pitch = header.CameraPitch;
+			camera.m_Distance = header.CameraDistance;
+		}
+	}
+	else
+	{
+		YAML::Node data;
+		if (!bytes.empty()) data = YAML::Load(std::string((const char*)bytes.data(), bytes.size()));
+		fromYAML(m_Scene, data, basePath);
+
+		auto& worldData = m_Scene.PhysicsWorldData;
+		if (data["Gravity"]) worldData.Gravity = data["Gravity"].as<glm::vec2>();
+		if (data["SubSteps"]) worldData.SubSteps = std::max(data["SubSteps"].as<uint32_t>(), 1u);
+		if (data["MaxStepsPerFrame"]) worldData.MaxStepsPerFrame = std::max(data["MaxStepsPerFrame"].as<uint32_t>(), 1u);
+
+		if (data["CameraFocalPoint"]) camera.FocalPoint = data["CameraFocalPoint"].as<glm::vec3>();
+		if (data["CameraYaw"]) camera.Yaw = data["CameraYaw"].as<float>();
+		if (data["CameraPitch"]) camera.Pitch = data["CameraPitch"].as<float>();
+		if (data["CameraDistance"]) camera.m_Distance = data["CameraDistance"].as<float>();
+	}
 
-	fromYAML(m_Scene, data, basePath);
+	// Only now that the new scene holds its handles, so assets shared with the previous scene aren't reloaded
+	if (clear) assetManager.UnloadUnused();
 
-	if (data["CameraFocalPoint"]) camera.FocalPoint = data["CameraFocalPoint"].as<glm::vec3>();
-	if (data["CameraYaw"]) camera.Yaw = data["CameraYaw"].as<float>();
-	if (data["CameraPitch"]) camera.Pitch = data["CameraPitch"].as<float>();
-	if (data["CameraDistance"]) camera.m_Distance = data["CameraDistance"].as<float>();
 	camera.UpdateView();
 	return true;
 }
@@ -3,6 +3,7 @@
 #include "../UI/Widgets.h"
 
 #include "../Scene/Scene.h"
+#include "../Scene/AssetRegistry.h"
 #include "Commands.h"
 #include "../Math/Camera.h"
 
@@ -36,11 +37,27 @@ namespace Editor
 		return tc;
 	}
 
+	// The edit mode scene, kept while it plays. Same layout as a .blzscene but the asset records hold the IDs the assets
+	// are loaded under, so restoring doesn't resolve paths, ask the registry or load anything
+	struct SceneSnapshot
+	{
+		std::vector<uint8_t> Data;
+
+		// Keeps the assets loaded while the running scene doesn't use them
+		std::vector<TextureHandle> Textures;
+		std::vector<FontHandle> Fonts;
+	};
+
+	SceneSnapshot TakeSnapshot(const Scene& scene);
+
+	// Into an empty scene
+	void RestoreSnapshot(Scene& scene, const SceneSnapshot& snapshot);
+
 	struct EditorScene
 	{
 		// @NOTE: maybe we should move the entity ordering in this struct as this is a feature that is only being used by the editor
 		Scene m_Scene;
-		Scene m_TempScene;
+		SceneSnapshot m_Snapshot; // While playing or simulating
 
 		std::string Path;
 		std::string basePath;
@@ -74,6 +91,10 @@ namespace Editor
 
 		void SetState(SceneState newState);
 
+		// Recompiles the script and swaps the new chunk into every instance running it. Exported number, string and bool
+		// variables keep their values and instances in a running scene get their Create call again
+		void ReloadScript(const std::string& path);
+
 		void UpdatePhysics();
 		void Update();
 
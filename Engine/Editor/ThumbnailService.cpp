@@ -0,0 +1,687 @@
+#include "ThumbnailService.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+#include <stb_image/stb_image.h>
+
+#include "../Rendering/SoftwareRasterizer.h"
+#include "../Rendering/vk/SyncContext.h"
+#include "../Scene/Components.h"
+#include "../Scene/SceneFormat.h"
+#include "../Utils/Hash.h"
+#include "../Utils/LZ4.h"
+#include "../Utils/Log.h"
+#include "../Utils/Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WC_THUMBNAIL_SSE2 1
+#include <emmintrin.h>
+#else
+#define WC_THUMBNAIL_SSE2 0
+#endif
+
+namespace Editor
+{
+	namespace
+	{
+		constexpr uint32_t CACHE_MAGIC = 0x424D4854; // "THMB"
+		constexpr uint32_t CACHE_VERSION = 1; // Bumped whenever the filtering changes
+		constexpr size_t CELL_BYTES = size_t(ThumbnailService::CELL_SIZE) * ThumbnailService::CELL_SIZE * 4;
+
+		struct CacheHeader
+		{
+			uint32_t Magic = CACHE_MAGIC;
+			uint32_t Version = CACHE_VERSION;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t ImageWidth = 0;
+			uint32_t ImageHeight = 0;
+			int64_t WriteTime = 0; // file_time_type ticks
+			uint64_t FileSize = 0;
+			uint64_t ContentHash = 0;
+			uint64_t CompressedSize = 0; // LZ4, Width x Height RGBA8 once decompressed
+		};
+
+		struct DecodedThumbnail
+		{
+			uint32_t Width = 0, Height = 0;
+			uint32_t ImageWidth = 0, ImageHeight = 0;
+			std::vector<uint8_t> Pixels;
+		};
+
+		// 2x2 box filter, same rounding and edge handling as TextureCompression::BuildMipChain
+		void Halve(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst)
+		{
+			uint32_t dstWidth = std::max(srcWidth >> 1, 1u), dstHeight = std::max(srcHeight >> 1, 1u);
+			for (uint32_t y = 0; y < dstHeight; y++)
+			{
+				const uint8_t* row0 = src + size_t(std::min(y * 2, srcHeight - 1)) * srcWidth * 4;
+				const uint8_t* row1 = src + size_t(std::min(y * 2 + 1, srcHeight - 1)) * srcWidth * 4;
+				uint8_t* out = dst + size_t(y) * dstWidth * 4;
+
+				uint32_t x = 0;
+#if WC_THUMBNAIL_SSE2
+				if (srcWidth >= 2)
+				{
+					const __m128i zero = _mm_setzero_si128();
+					const __m128i rounding = _mm_set1_epi16(2);
+
+					// 4 output pixels from 8 source pixels of both rows, the pixels are split into even and odd columns as 32 bit lanes
+					for (; x + 4 <= dstWidth; x += 4)
+					{
+						__m128 a0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(row0 + x * 8)));
+						__m128 b0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16)));
+						__m128 a1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(row1 + x * 8)));
+						__m128 b1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16)));
+
+						__m128i even0 = _mm_castps_si128(_mm_shuffle_ps(a0, b0, _MM_SHUFFLE(2, 0, 2, 0)));
+						__m128i odd0 = _mm_castps_si128(_mm_shuffle_ps(a0, b0, _MM_SHUFFLE(3, 1, 3, 1)));
+						__m128i even1 = _mm_castps_si128(_mm_shuffle_ps(a1, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+						__m128i odd1 = _mm_castps_si128(_mm_shuffle_ps(a1, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+						__m128i low = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(even0, zero), _mm_unpacklo_epi8(odd0, zero)),
+							_mm_add_epi16(_mm_unpacklo_epi8(even1, zero), _mm_unpacklo_epi8(odd1, zero)));
+						__m128i high = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(even0, zero), _mm_unpackhi_epi8(odd0, zero)),
+							_mm_add_epi16(_mm_unpackhi_epi8(even1, zero), _mm_unpackhi_epi8(odd1, zero)));
+
+						low = _mm_srli_epi16(_mm_add_epi16(low, rounding), 2);
+						high = _mm_srli_epi16(_mm_add_epi16(high, rounding), 2);
+						_mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(low, high));
+					}
+				}
+#endif
+
+				for (; x < dstWidth; x++)
+				{
+					uint32_t x0 = std::min(x * 2, srcWidth - 1), x1 = std::min(x * 2 + 1, srcWidth - 1);
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+						out[x * 4 + c] = uint8_t((sum + 2) / 4);
+					}
+				}
+			}
+		}
+
+		// Box filter for the last step where the scale is below 2, every source texel is weighted by how much of it the
+		// destination texel covers
+		void Resample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight)
+		{
+			struct Tap
+			{
+				uint32_t Index;
+				float Weight;
+			};
+
+			auto BuildTaps = [](uint32_t srcSize, uint32_t dstSize, std::vector<uint32_t>& offsets, std::vector<Tap>& taps) {
+				float scale = float(srcSize) / dstSize;
+				offsets.assign(1, 0);
+				for (uint32_t i = 0; i < dstSize; i++)
+				{
+					float start = i * scale, end = (i + 1) * scale;
+					for (uint32_t s = uint32_t(start); s < srcSize && float(s) < end; s++)
+					{
+						float weight = (std::min(end, s + 1.f) - std::max(start, float(s))) / scale;
+						if (weight > 0.f) taps.push_back({ s, weight });
+					}
+					offsets.push_back((uint32_t)taps.size());
+				}
+				};
+
+			std::vector<uint32_t> offsetsX, offsetsY;
+			std::vector<Tap> tapsX, tapsY;
+			BuildTaps(srcWidth, dstWidth, offsetsX, tapsX);
+			BuildTaps(srcHeight, dstHeight, offsetsY, tapsY);
+
+			std::vector<float> rows(size_t(dstWidth) * srcHeight * 4);
+			for (uint32_t y = 0; y < srcHeight; y++)
+				for (uint32_t x = 0; x < dstWidth; x++)
+				{
+					float* out = &rows[(size_t(y) * dstWidth + x) * 4];
+					for (uint32_t t = offsetsX[x]; t < offsetsX[x + 1]; t++)
+					{
+						const uint8_t* texel = src + (size_t(y) * srcWidth + tapsX[t].Index) * 4;
+						for (uint32_t c = 0; c < 4; c++)
+							out[c] += texel[c] * tapsX[t].Weight;
+					}
+				}
+
+			for (uint32_t y = 0; y < dstHeight; y++)
+				for (uint32_t x = 0; x < dstWidth; x++)
+				{
+					float sum[4] = {};
+					for (uint32_t t = offsetsY[y]; t < offsetsY[y + 1]; t++)
+					{
+						const float* texel = &rows[(size_t(tapsY[t].Index) * dstWidth + x) * 4];
+						for (uint32_t c = 0; c < 4; c++)
+							sum[c] += texel[c] * tapsY[t].Weight;
+					}
+
+					for (uint32_t c = 0; c < 4; c++)
+						dst[(size_t(y) * dstWidth + x) * 4 + c] = uint8_t(std::min(sum[c] + 0.5f, 255.f));
+				}
+		}
+
+		// Fits the image into maxSize x maxSize. Halving does almost all of the work for large images, only the last
+		// step has an arbitrary scale
+		std::vector<uint8_t> Downsample(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t maxSize, uint32_t& outWidth, uint32_t& outHeight)
+		{
+			float scale = std::min(1.f, float(maxSize) / std::max(width, height));
+			outWidth = std::clamp(uint32_t(width * scale + 0.5f), 1u, maxSize);
+			outHeight = std::clamp(uint32_t(height * scale + 0.5f), 1u, maxSize);
+
+			std::vector<uint8_t> halved, scratch;
+			const uint8_t* source = rgba;
+			while (width >= outWidth * 2 && height >= outHeight * 2)
+			{
+				scratch.resize(size_t(width >> 1) * (height >> 1) * 4);
+				Halve(source, width, height, scratch.data());
+				halved.swap(scratch);
+				source = halved.data();
+				width >>= 1;
+				height >>= 1;
+			}
+
+			if (width == outWidth && height == outHeight)
+				return std::vector<uint8_t>(source, source + size_t(width) * height * 4);
+
+			std::vector<uint8_t> output(size_t(outWidth) * outHeight * 4);
+			Resample(source, width, height, output.data(), outWidth, outHeight);
+			return output;
+		}
+
+		std::vector<uint8_t> ReadFile(const std::string& filepath)
+		{
+			std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+			if (!file.is_open()) return {};
+
+			std::vector<uint8_t> data((size_t)file.tellg());
+			file.seekg(0);
+			file.read((char*)data.data(), data.size());
+			return data;
+		}
+
+		bool ReadCache(const std::string& cachePath, CacheHeader& header, std::vector<uint8_t>& compressed)
+		{
+			std::ifstream file(cachePath, std::ios::binary);
+			if (!file.is_open()) return false;
+
+			if (!file.read((char*)&header, sizeof(header)) || header.Magic != CACHE_MAGIC || header.Version != CACHE_VERSION) return false;
+			if (header.Width == 0 || header.Height == 0 || header.Width > ThumbnailService::THUMBNAIL_SIZE || header.Height > ThumbnailService::THUMBNAIL_SIZE) return false;
+
+			compressed.resize(header.CompressedSize);
+			return (bool)file.read((char*)compressed.data(), compressed.size());
+		}
+
+		void WriteCache(const std::string& cachePath, const CacheHeader& header, const std::vector<uint8_t>& compressed)
+		{
+			std::error_code ec;
+			std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+
+			// Written next to the cache entry first so a reader never sees half of it
+			std::string temporaryPath = cachePath + ".tmp";
+			{
+				std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					WC_CORE_WARN("Failed to write the thumbnail cache to {}", cachePath);
+					return;
+				}
+
+				file.write((const char*)&header, sizeof(header));
+				file.write((const char*)compressed.data(), compressed.size());
+			}
+
+			std::filesystem::rename(temporaryPath, cachePath, ec);
+			if (ec) std::filesystem::remove(temporaryPath, ec);
+		}
+
+		bool Unpack(const CacheHeader& header, const std::vector<uint8_t>& compressed, DecodedThumbnail& thumbnail)
+		{
+			thumbnail.Width = header.Width;
+			thumbnail.Height = header.Height;
+			thumbnail.ImageWidth = header.ImageWidth;
+			thumbnail.ImageHeight = header.ImageHeight;
+			thumbnail.Pixels.resize(size_t(header.Width) * header.Height * 4);
+			return wc::LZ4::Decompress(compressed.data(), compressed.size(), thumbnail.Pixels.data(), thumbnail.Pixels.size());
+		}
+
+		// Draws the sprites and circles of a scene file with the software rasterizer, the way Scene::Render would once it's
+		// loaded. Textures are decoded here and the asset manager is never touched. Text is left out, its font atlas would
+		// have to be generated first. Assets are found by their project relative path, the registry that knows their IDs
+		// belongs to the main thread
+		bool RenderScene(const std::string& filepath, const std::string& projectDirectory, DecodedThumbnail& thumbnail)
+		{
+			auto contents = ReadFile(filepath);
+			if (!blaze::SceneFileReader::IsSceneFile(contents.data(), contents.size()))
+			{
+				std::vector<uint8_t> converted;
+				try
+				{
+					YAML::Node data = YAML::Load(std::string((const char*)contents.data(), contents.size()));
+					if (!blaze::ConvertSceneToBinary(data, converted)) return false;
+				}
+				catch (const std::exception&)
+				{
+					return false;
+				}
+				contents.swap(converted);
+			}
+
+			blaze::SceneFileReader file;
+			if (!file.Open(contents.data(), contents.size())) return false;
+
+			blaze::SoftwareRasterizer rasterizer;
+			rasterizer.ThreadCount = 1; // Already on a worker
+
+			// Texture IDs are asset indices + 1, 0 samples as white like the asset manager's default texture
+			auto assets = file.GetAssets();
+			std::vector<blaze::Image> images(assets.size());
+			rasterizer.Textures.assign(assets.size() + 1, nullptr);
+			for (size_t i = 0; i < assets.size(); i++)
+			{
+				if (assets[i].Type != (uint32_t)blaze::AssetType::Texture) continue;
+
+				images[i].Load(projectDirectory + '/' + std::string(file.GetString(assets[i].Path)), 4);
+				if (images[i].Data) rasterizer.Textures[i + 1] = &images[i];
+			}
+
+			// Like in the scene, entities without a transform aren't drawn and neither are their children
+			auto entities = file.GetEntities();
+			auto transformRecords = file.GetColumn<blaze::SceneTransformRecord>(blaze::SceneComponent::Transform);
+			std::vector<glm::mat4> transforms(entities.size(), glm::mat4(1.f));
+			std::vector<uint8_t> visible(entities.size(), 0);
+			for (size_t row = 0; row < transformRecords.size(); row++)
+			{
+				auto record = transformRecords[row];
+				transforms[transformRecords.Entities[row]] = blaze::TransformComponent{ record.Translation, record.Scale, record.Rotation }.GetTransform();
+				visible[transformRecords.Entities[row]] = 1;
+			}
+
+			for (size_t i = 0; i < entities.size(); i++)
+			{
+				uint32_t parent = entities[i].Parent;
+				if (parent == blaze::SCENE_NONE) continue;
+
+				transforms[i] = transforms[parent] * transforms[i];
+				visible[i] &= visible[parent];
+			}
+
+			// An entity with a sprite doesn't draw its circle
+			blaze::RenderData renderData;
+			auto sprites = file.GetColumn<blaze::SceneSpriteRecord>(blaze::SceneComponent::SpriteRenderer);
+			for (size_t row = 0; row < sprites.size(); row++)
+			{
+				uint32_t entity = sprites.Entities[row];
+				if (!visible[entity]) continue;
+
+				auto record = sprites[row];
+				renderData.DrawQuad(transforms[entity], record.Texture < assets.size() ? record.Texture + 1 : 0, record.Color);
+				visible[entity] = 0;
+			}
+
+			auto circles = file.GetColumn<blaze::SceneCircleRecord>(blaze::SceneComponent::CircleRenderer);
+			for (size_t row = 0; row < circles.size(); row++)
+			{
+				uint32_t entity = circles.Entities[row];
+				if (!visible[entity]) continue;
+
+				auto record = circles[row];
+				renderData.DrawCircle(transforms[entity], record.Thickness, record.Fade, record.Color);
+			}
+
+			blaze::Image image;
+			rasterizer.RenderThumbnail(renderData, ThumbnailService::THUMBNAIL_SIZE, image);
+
+			thumbnail.Width = thumbnail.ImageWidth = image.Width;
+			thumbnail.Height = thumbnail.ImageHeight = image.Height;
+			thumbnail.Pixels.assign(image.Data, image.Data + image.AllocSize());
+
+			image.Free();
+			for (auto& loaded : images)
+				if (loaded.Data) loaded.Free();
+			rasterizer.Free();
+			return true;
+		}
+
+		bool Generate(const std::string& filepath, const std::string& projectDirectory, const std::string& cacheDirectory, DecodedThumbnail& thumbnail)
+		{
+			namespace fs = std::filesystem;
+
+			if (blaze::AssetRegistry::GetTypeFromExtension(filepath) == blaze::AssetType::Scene)
+				return RenderScene(filepath, projectDirectory, thumbnail);
+
+			std::error_code ec;
+			auto writeTime = fs::last_write_time(filepath, ec);
+			if (ec) return false;
+			uint64_t fileSize = fs::file_size(filepath, ec);
+			if (ec) return false;
+
+			std::string cachePath = cacheDirectory.empty() ? "" : (fs::path(cacheDirectory) / std::format("{:016x}.thumb", wc::Hash64(filepath))).string();
+
+			// Unchanged files are answered from the header alone, without reading the image
+			CacheHeader header;
+			std::vector<uint8_t> compressed;
+			bool cached = !cachePath.empty() && ReadCache(cachePath, header, compressed);
+			if (cached && header.WriteTime == (int64_t)writeTime.time_since_epoch().count() && header.FileSize == fileSize && Unpack(header, compressed, thumbnail))
+				return true;
+
+			auto contents = ReadFile(filepath);
+			if (contents.empty()) return false;
+
+			uint64_t contentHash = wc::Hash64(contents.data(), contents.size());
+			bool decoded = cached && header.ContentHash == contentHash && Unpack(header, compressed, thumbnail);
+			if (!decoded)
+			{
+				int width = 0, height = 0, channels = 0;
+				stbi_uc* pixels = stbi_load_from_memory(contents.data(), (int)contents.size(), &width, &height, &channels, 4);
+				if (!pixels) return false;
+
+				thumbnail.ImageWidth = width;
+				thumbnail.ImageHeight = height;
+				thumbnail.Pixels = Downsample(pixels, width, height, ThumbnailService::THUMBNAIL_SIZE, thumbnail.Width, thumbnail.Height);
+				stbi_image_free(pixels);
+
+				compressed.clear();
+				wc::LZ4::Compress(thumbnail.Pixels.data(), thumbnail.Pixels.size(), compressed);
+			}
+
+			if (!cachePath.empty())
+			{
+				header = {
+					.Width = thumbnail.Width,
+					.Height = thumbnail.Height,
+					.ImageWidth = thumbnail.ImageWidth,
+					.ImageHeight = thumbnail.ImageHeight,
+					.WriteTime = (int64_t)writeTime.time_since_epoch().count(),
+					.FileSize = fileSize,
+					.ContentHash = contentHash,
+					.CompressedSize = compressed.size(),
+				};
+				WriteCache(cachePath, header, compressed);
+			}
+
+			return true;
+		}
+	}
+
+	void ThumbnailService::Create(uint32_t workerCount)
+	{
+		blaze::TextureSpecification specification = blaze::Texture::GetSpecification(ATLAS_SIZE, ATLAS_SIZE);
+		specification.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		specification.addressModeU = vk::SamplerAddressMode::CLAMP_TO_EDGE;
+		specification.addressModeV = vk::SamplerAddressMode::CLAMP_TO_EDGE;
+		specification.addressModeW = vk::SamplerAddressMode::CLAMP_TO_EDGE;
+		m_Atlas.Allocate(specification);
+		m_Atlas.SetName("Thumbnail atlas");
+
+		// Cells are only drawn once something was copied into them, the rest of the atlas never has to be cleared
+		vk::SyncContext::ImmediateSubmit([&](VkCommandBuffer cmd) {
+			m_Atlas.image.SetLayout(cmd, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			});
+
+		m_StagingBuffer.Allocate(MAX_UPLOADS_PER_FRAME * CELL_BYTES);
+
+		const uint32_t cellCount = (ATLAS_SIZE / CELL_SIZE) * (ATLAS_SIZE / CELL_SIZE);
+		m_CellOwners.assign(cellCount, {});
+		m_FreeCells.clear();
+		for (uint32_t i = cellCount; i > 0; i--)
+			m_FreeCells.push_back(i - 1);
+
+		if (workerCount == 0) workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Stopping = false;
+		for (uint32_t i = 0; i < workerCount; i++)
+			m_Workers.emplace_back([this, i]() {
+				WC_PROFILE_THREAD(std::format("Thumbnail worker {}", i + 1));
+				Work();
+				});
+	}
+
+	void ThumbnailService::Destroy()
+	{
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_Stopping = true;
+			m_Requests.clear();
+		}
+		m_Condition.notify_all();
+
+		for (auto& worker : m_Workers)
+			worker.join();
+		m_Workers.clear();
+		m_Results.clear();
+
+		m_Entries.clear();
+		m_CellOwners.clear();
+		m_FreeCells.clear();
+
+		m_Atlas.Destroy();
+		m_Atlas = {};
+		m_StagingBuffer.Free();
+	}
+
+	void ThumbnailService::SetProject(const std::string& projectDirectory, const std::string& cacheDirectory)
+	{
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_ProjectDirectory = projectDirectory;
+			m_CacheDirectory = cacheDirectory;
+			m_Requests.clear();
+			m_Results.clear();
+		}
+
+		// Thumbnails still being decoded are dropped when they come back, their generation doesn't exist anymore
+		m_Entries.clear();
+		m_FreeCells.clear();
+		for (uint32_t i = (uint32_t)m_CellOwners.size(); i > 0; i--)
+		{
+			m_CellOwners[i - 1].clear();
+			m_FreeCells.push_back(i - 1);
+		}
+	}
+
+	const ThumbnailService::Thumbnail* ThumbnailService::Get(const std::string& filepath)
+	{
+		if (m_Workers.empty()) return nullptr;
+
+		auto [it, inserted] = m_Entries.try_emplace(filepath);
+		Entry& entry = it->second;
+		entry.LastUsedFrame = m_Frame;
+
+		if (inserted)
+		{
+			entry.Generation = ++m_NextGeneration;
+			{
+				std::scoped_lock lock(m_Mutex);
+				m_Requests.push_back({ filepath, entry.Generation });
+			}
+			m_Condition.notify_one();
+		}
+
+		return entry.Status == State::Ready ? &entry.Preview : nullptr;
+	}
+
+	void ThumbnailService::Invalidate(const std::string& filepath)
+	{
+		auto it = m_Entries.find(filepath);
+		if (it == m_Entries.end()) return;
+
+		if (it->second.Cell != UINT32_MAX)
+		{
+			m_CellOwners[it->second.Cell].clear();
+			m_FreeCells.push_back(it->second.Cell);
+		}
+		m_Entries.erase(it);
+	}
+
+	void ThumbnailService::Update()
+	{
+		WC_PROFILE_FUNCTION();
+
+		m_Frame++;
+
+		std::vector<Result> results;
+		{
+			std::scoped_lock lock(m_Mutex);
+
+			// Requests for thumbnails that scrolled out of view are dropped, Get asks again once they're back
+			std::erase_if(m_Requests, [&](const Request& request) {
+				auto it = m_Entries.find(request.Path);
+				if (it == m_Entries.end() || it->second.Generation != request.Generation) return true;
+				if (it->second.LastUsedFrame + 1 >= m_Frame) return false;
+
+				m_Entries.erase(it);
+				return true;
+				});
+
+			results.swap(m_Results);
+		}
+
+		if (results.empty()) return;
+
+		std::vector<VkBufferImageCopy> regions;
+		uint8_t* staging = nullptr;
+
+		std::vector<Result> waiting; // No cell could be freed or the upload budget is used up
+		for (auto& result : results)
+		{
+			auto it = m_Entries.find(result.Path);
+			if (it == m_Entries.end() || it->second.Generation != result.Generation) continue;
+
+			Entry& entry = it->second;
+			if (result.ImageWidth == 0)
+			{
+				entry.Status = State::Failed;
+				continue;
+			}
+
+			uint32_t cell;
+			if (regions.size() == MAX_UPLOADS_PER_FRAME || !AcquireCell(cell))
+			{
+				waiting.push_back(std::move(result));
+				continue;
+			}
+
+			if (!staging) staging = (uint8_t*)m_StagingBuffer.Map();
+			memcpy(staging + regions.size() * CELL_BYTES, result.Cell.data(), CELL_BYTES);
+
+			const uint32_t cellsPerRow = ATLAS_SIZE / CELL_SIZE;
+			const uint32_t x = (cell % cellsPerRow) * CELL_SIZE, y = (cell / cellsPerRow) * CELL_SIZE;
+			regions.push_back({
+				.bufferOffset = regions.size() * CELL_BYTES,
+				.imageSubresource = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.layerCount = 1,
+				},
+				.imageOffset = { (int32_t)x, (int32_t)y, 0 },
+				.imageExtent = { CELL_SIZE, CELL_SIZE, 1 },
+				});
+
+			entry.Cell = cell;
+			entry.Status = State::Ready;
+			entry.Preview = {
+				.Texture = (ImTextureID)m_Atlas,
+				.UV0 = ImVec2(float(x) / ATLAS_SIZE, float(y) / ATLAS_SIZE),
+				.UV1 = ImVec2(float(x + CELL_SIZE) / ATLAS_SIZE, float(y + CELL_SIZE) / ATLAS_SIZE),
+				.ImageWidth = result.ImageWidth,
+				.ImageHeight = result.ImageHeight,
+			};
+			m_CellOwners[cell] = result.Path;
+		}
+
+		if (!waiting.empty())
+		{
+			std::scoped_lock lock(m_Mutex);
+			m_Results.insert(m_Results.end(), std::make_move_iterator(waiting.begin()), std::make_move_iterator(waiting.end()));
+		}
+
+		if (regions.empty()) return;
+		m_StagingBuffer.Unmap();
+
+		vk::SyncContext::ImmediateSubmit([&](VkCommandBuffer cmd) {
+			// The frames in flight may still be drawing the other cells
+			m_Atlas.image.InsertMemoryBarrier(cmd, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+			vkCmdCopyBufferToImage(cmd, m_StagingBuffer, m_Atlas.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+
+			m_Atlas.image.InsertMemoryBarrier(cmd, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			});
+	}
+
+	bool ThumbnailService::AcquireCell(uint32_t& cell)
+	{
+		if (!m_FreeCells.empty())
+		{
+			cell = m_FreeCells.back();
+			m_FreeCells.pop_back();
+			return true;
+		}
+
+		// Least recently drawn, cells the frames in flight may still be sampling are left alone
+		auto oldest = m_Entries.end();
+		for (const auto& owner : m_CellOwners)
+		{
+			auto it = m_Entries.find(owner);
+			if (it == m_Entries.end() || it->second.LastUsedFrame + FRAME_OVERLAP >= m_Frame) continue;
+			if (oldest == m_Entries.end() || it->second.LastUsedFrame < oldest->second.LastUsedFrame) oldest = it;
+		}
+
+		if (oldest == m_Entries.end()) return false;
+
+		cell = oldest->second.Cell;
+		m_CellOwners[cell].clear();
+		m_Entries.erase(oldest);
+		return true;
+	}
+
+	void ThumbnailService::Work()
+	{
+		while (true)
+		{
+			Request request;
+			std::string projectDirectory, cacheDirectory;
+			{
+				std::unique_lock lock(m_Mutex);
+				m_Condition.wait(lock, [&]() { return m_Stopping || !m_Requests.empty(); });
+				if (m_Stopping) return;
+
+				request = std::move(m_Requests.back());
+				m_Requests.pop_back();
+				projectDirectory = m_ProjectDirectory;
+				cacheDirectory = m_CacheDirectory;
+			}
+
+			Result result = {
+				.Path = std::move(request.Path),
+				.Generation = request.Generation,
+			};
+
+			DecodedThumbnail thumbnail;
+			if (Generate(result.Path, projectDirectory, cacheDirectory, thumbnail))
+			{
+				result.ImageWidth = thumbnail.ImageWidth;
+				result.ImageHeight = thumbnail.ImageHeight;
+
+				// Centered, the cell around the image stays transparent
+				result.Cell.assign(CELL_BYTES, 0);
+				uint32_t offsetX = (CELL_SIZE - thumbnail.Width) / 2, offsetY = (CELL_SIZE - thumbnail.Height) / 2;
+				for (uint32_t y = 0; y < thumbnail.Height; y++)
+					memcpy(&result.Cell[(size_t(offsetY + y) * CELL_SIZE + offsetX) * 4], &thumbnail.Pixels[size_t(y) * thumbnail.Width * 4], thumbnail.Width * 4);
+			}
+
+			std::scoped_lock lock(m_Mutex);
+			m_Results.push_back(std::move(result));
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Rendering/Texture.h"
+#include "../Rendering/vk/Buffer.h"
+
+namespace Editor
+{
+	// Image previews for the assets panel. Files are decoded and box filtered down on worker threads, finished thumbnails
+	// are copied into cells of one atlas that belongs to the editor, so browsing never touches the AssetManager (and with it
+	// the scene's bindless textures or texture budget). Cells are recycled least recently drawn first.
+	// Every thumbnail is also written to the project's thumbnail cache, entries are keyed by the file's path and checked
+	// against its write time and size, a content hash decides when those changed without the image changing (checkouts, copies).
+	// Scenes are rendered on the workers too, straight from the file without creating entities or running scripts. They
+	// aren't written to the disk cache, they also depend on the textures they use
+	class ThumbnailService
+	{
+	public:
+		static constexpr uint32_t CELL_SIZE = 128;
+		static constexpr uint32_t THUMBNAIL_SIZE = CELL_SIZE - 2; // Centered in its cell, the transparent border keeps linear filtering from bleeding into the neighbours
+		static constexpr uint32_t ATLAS_SIZE = 2048; // 256 cells, 16MB
+		static constexpr uint32_t MAX_UPLOADS_PER_FRAME = 16;
+
+		struct Thumbnail
+		{
+			ImTextureID Texture = 0;
+			ImVec2 UV0, UV1; // The whole cell, the image keeps its aspect ratio inside it
+			uint32_t ImageWidth = 0, ImageHeight = 0; // Size of the source image
+		};
+
+		// 0 workers uses the hardware thread count, leaving one for the main thread
+		void Create(uint32_t workerCount = 0);
+
+		void Destroy();
+
+		// Drops every thumbnail. Scenes resolve their assets against the project directory, an empty cache directory
+		// disables the disk cache
+		void SetProject(const std::string& projectDirectory, const std::string& cacheDirectory);
+
+		// Returns nullptr until the thumbnail is ready or if the file can't be decoded. Only call it for visible items,
+		// thumbnails that weren't asked for in the last frames are the first to be recycled and their pending requests are dropped
+		const Thumbnail* Get(const std::string& filepath);
+
+		// The file changed or was removed, it's decoded again the next time it's asked for
+		void Invalidate(const std::string& filepath);
+
+		// Uploads finished thumbnails, called once per frame before the UI
+		void Update();
+
+	private:
+		enum class State : uint8_t { Pending, Ready, Failed };
+
+		struct Entry
+		{
+			Thumbnail Preview;
+			State Status = State::Pending;
+			uint32_t Generation = 0;
+			uint32_t Cell = UINT32_MAX;
+			uint64_t LastUsedFrame = 0;
+		};
+
+		struct Request
+		{
+			std::string Path;
+			uint32_t Generation = 0;
+		};
+
+		struct Result
+		{
+			std::string Path;
+			uint32_t Generation = 0;
+			uint32_t ImageWidth = 0, ImageHeight = 0; // 0 if decoding failed
+			std::vector<uint8_t> Cell; // CELL_SIZE x CELL_SIZE RGBA8
+		};
+
+		void Work();
+
+		bool AcquireCell(uint32_t& cell);
+
+		std::unordered_map<std::string, Entry> m_Entries; // Main thread only
+		std::vector<uint32_t> m_FreeCells;
+		std::vector<std::string> m_CellOwners; // Path of the entry using each cell
+		uint32_t m_NextGeneration = 0;
+		uint64_t m_Frame = 0;
+
+		blaze::Texture m_Atlas;
+		vk::StagingBuffer m_StagingBuffer; // MAX_UPLOADS_PER_FRAME cells
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+		std::string m_ProjectDirectory;
+		std::string m_CacheDirectory;
+		std::vector<Request> m_Requests; // Handled newest first, what was scrolled to last is what's on screen
+		std::vector<Result> m_Results;
+	};
+}
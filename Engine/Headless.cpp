@@ -0,0 +1,323 @@
+#include "Headless.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "Editor/EditorScene.h"
+
+#include "Rendering/Renderer2D.h"
+#include "Rendering/GPUProfiler.h"
+#include "Rendering/Descriptors.h"
+#include "Rendering/SoftwareRasterizer.h"
+
+#include "Utils/Profiler.h"
+#include "Utils/Time.h"
+
+#include "Globals.h"
+
+using namespace Editor;
+
+namespace
+{
+	struct StageTimings
+	{
+		const char* Name;
+		std::vector<float> Samples; // milliseconds
+
+		void Print() const
+		{
+			if (Samples.empty()) return;
+
+			std::vector<float> sorted = Samples;
+			std::sort(sorted.begin(), sorted.end());
+
+			float sum = 0.f;
+			for (float sample : sorted)
+				sum += sample;
+
+			WC_CORE_INFO("{:<24} avg {:8.3f}ms  p50 {:8.3f}ms  p95 {:8.3f}ms  max {:8.3f}ms", Name, sum / float(sorted.size()),
+				sorted[sorted.size() / 2], sorted[size_t(float(sorted.size() - 1) * 0.95f + 0.5f)], sorted.back());
+		}
+	};
+
+	void CompareWithReference(EditorScene& scene, Renderer2D& renderer, const HeadlessOptions& options)
+	{
+		RenderData renderData;
+		scene.m_Scene.Render(renderData);
+
+		SoftwareRasterizer rasterizer;
+		rasterizer.SyncTextures(assetManager);
+		rasterizer.Resize(options.Size);
+
+		Timer timer;
+		timer.Start();
+		rasterizer.Render(renderData, scene.camera.GetViewProjectionMatrix());
+		float rasterTime = timer.GetElapsedTime() * 1000.f;
+
+		Image reference, gpu;
+		rasterizer.ReadOutput(reference);
+		renderer.ReadOutput(gpu, false); // The rasterizer doesn't do post processing
+
+		constexpr int TOLERANCE = 8; // Per channel, filtering and interpolation precision differ slightly
+		uint64_t totalDifference = 0;
+		uint32_t mismatches = 0;
+		for (uint32_t i = 0; i < reference.Width * reference.Height; i++)
+		{
+			bool mismatch = false;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				int difference = std::abs(int(reference.Data[i * 4 + c]) - int(gpu.Data[i * 4 + c]));
+				totalDifference += difference;
+				mismatch |= difference > TOLERANCE;
+			}
+			mismatches += mismatch;
+		}
+
+		std::filesystem::path output = options.OutputPath;
+		std::string base = (output.parent_path() / output.stem()).string();
+		reference.Save(base + "_reference.png");
+		gpu.Save(base + "_main.png");
+
+		uint32_t pixelCount = reference.Width * reference.Height;
+		WC_CORE_INFO("Reference: rasterized in {:.3f}ms, mean difference {:.3f}, {} of {} pixels ({:.2f}%) differ by more than {}",
+			rasterTime, double(totalDifference) / double(pixelCount * 4), mismatches, pixelCount, 100.0 * mismatches / pixelCount, TOLERANCE);
+
+		reference.Free();
+		gpu.Free();
+		rasterizer.Free();
+		renderData.Free();
+	}
+
+	std::string ResolveScenePath(const HeadlessOptions& options)
+	{
+		namespace fs = std::filesystem;
+
+		if (!options.ScenePath.empty())
+		{
+			for (const fs::path& path : {
+				fs::path(options.ScenePath),
+				fs::path(options.ProjectPath) / options.ScenePath,
+				fs::path(options.ProjectPath) / "Scenes" / (options.ScenePath + ".scene"),
+				fs::path(options.ProjectPath) / "Scenes" / (options.ScenePath + ".blzscene") })
+				if (fs::exists(path) && fs::is_regular_file(path))
+					return fs::absolute(path).string();
+
+			return options.ScenePath;
+		}
+
+		// Sorted so the same project always picks the same scene
+		std::vector<std::string> scenes;
+		for (const auto& entry : fs::recursive_directory_iterator(options.ProjectPath))
+			if (entry.is_regular_file() && AssetRegistry::GetTypeFromExtension(entry.path().string()) == AssetType::Scene)
+				scenes.push_back(entry.path().string());
+
+		// Shipped projects may only have the pack
+		if (scenes.empty())
+			for (const auto& entry : assetPack.GetEntries())
+				if (entry.Kind == AssetPackKind::Scene)
+					scenes.push_back((fs::path(options.ProjectPath) / assetPack.GetPath(entry)).string());
+
+		if (scenes.empty()) return {};
+
+		std::sort(scenes.begin(), scenes.end());
+		return scenes.front();
+	}
+}
+
+bool ParseHeadlessArgs(int argc, char** argv, HeadlessOptions& options)
+{
+	bool headless = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless")
+		{
+			headless = true;
+			if (hasValue && argv[i + 1][0] != '-') options.ProjectPath = argv[++i];
+		}
+		else if (arg == "--scene" && hasValue) options.ScenePath = argv[++i];
+		else if (arg == "--out" && hasValue) options.OutputPath = argv[++i];
+		else if (arg == "--frames" && hasValue) options.Frames = (uint32_t)std::max(std::atoi(argv[++i]), 0);
+		else if (arg == "--size" && hasValue)
+		{
+			glm::uvec2 size;
+			if (sscanf(argv[++i], "%ux%u", &size.x, &size.y) == 2 && size.x > 0 && size.y > 0)
+				options.Size = size;
+			else
+				WC_CORE_WARN("Invalid size {}, expected WxH", argv[i]);
+		}
+		else if (arg == "--edit") options.Play = false;
+		else if (arg == "--reference") options.Reference = true;
+		else if (arg == "--mount" && hasValue) options.PackPath = argv[++i];
+	}
+
+	if (!headless) return false;
+
+	auto MakeAbsolute = [](std::string& path) { if (!path.empty()) path = std::filesystem::absolute(path).string(); };
+	MakeAbsolute(options.ProjectPath);
+	MakeAbsolute(options.OutputPath);
+	MakeAbsolute(options.PackPath);
+	if (!options.ScenePath.empty() && std::filesystem::exists(options.ScenePath))
+		MakeAbsolute(options.ScenePath);
+
+	return true;
+}
+
+int RunHeadless(const HeadlessOptions& options)
+{
+	if (options.ProjectPath.empty() || !std::filesystem::is_directory(options.ProjectPath))
+	{
+		WC_CORE_ERROR("Headless: {} is not a project directory", options.ProjectPath);
+		return 1;
+	}
+
+	if (!options.PackPath.empty() && !assetPack.Open(options.PackPath, options.ProjectPath))
+		WC_CORE_WARN("Headless: continuing with the project files");
+
+	std::string scenePath = ResolveScenePath(options);
+	if (scenePath.empty())
+	{
+		WC_CORE_ERROR("Headless: no scene found in {}", options.ProjectPath);
+		return 1;
+	}
+
+	WC_CORE_INFO("Headless: {} on {}, {} frames at {}x{}", scenePath, VulkanContext::GetPhysicalDevice().GetProperties().deviceName, options.Frames, options.Size.x, options.Size.y);
+
+	vk::SyncContext::Create();
+	gpuProfiler.Init();
+	vk::descriptorAllocator.Create();
+	Globals.SoundContext.InitializeContext(); // Scripts are allowed to play sounds
+
+	StageTimings loadTiming = { "Load" };
+	StageTimings updateTiming = { "Update" };
+	StageTimings renderTiming = { "Render (record/submit)" };
+	StageTimings gpuWaitTiming = { "GPU wait" };
+	StageTimings frameTiming = { "Frame" };
+	StageTimings readbackTiming = { "Readback + save" };
+
+	Timer timer;
+	timer.Start();
+
+	assetManager.Init();
+
+	AddPhysicsMaterial("Default"); // @NOTE: Index 0 is the default material
+	LoadPhysicsMaterials(options.ProjectPath + "/physicsMaterials.yaml");
+	LoadCollisionLayers(options.ProjectPath + "/collisionLayers.yaml");
+
+	Renderer2D renderer;
+	renderer.Init();
+	renderer.CreateScreen(options.Size);
+
+	RenderData renderData[FRAME_OVERLAP];
+
+	assetRegistry.Open(options.ProjectPath);
+
+	EditorScene scene;
+	int result = 0;
+	if (!scene.Load(scenePath, options.ProjectPath))
+		result = 1;
+	else
+	{
+		scene.camera.Update(renderer.GetAspectRatio());
+		if (options.Play) scene.SetState(SceneState::Play);
+		loadTiming.Samples.push_back(timer.GetElapsedTime() * 1000.f);
+
+		for (uint32_t frame = 0; frame < options.Frames; frame++)
+		{
+			Timer frameTimer;
+			frameTimer.Start();
+
+			gpuProfiler.BeginFrame(); // Every previous frame has been waited on
+
+			// Fixed time step so runs are deterministic regardless of how fast the device is
+			Globals.deltaTime = scene.m_Scene.SimulationTime;
+
+			timer.Start();
+			scene.Update();
+			updateTiming.Samples.push_back(timer.GetElapsedTime() * 1000.f);
+
+			timer.Start();
+			{
+				WC_PROFILE_SCOPE("Render");
+				auto& data = renderData[CURRENT_FRAME];
+
+				assetManager.Update();
+				renderer.UpdateTextures(assetManager);
+
+				scene.m_Scene.Render(data);
+				renderer.Flush(data, scene.camera.GetViewProjectionMatrix());
+				data.Reset();
+			}
+			renderTiming.Samples.push_back(timer.GetElapsedTime() * 1000.f);
+
+			timer.Start();
+			{
+				WC_PROFILE_SCOPE("Wait for GPU");
+				VulkanContext::GetLogicalDevice().WaitIdle();
+			}
+			gpuWaitTiming.Samples.push_back(timer.GetElapsedTime() * 1000.f);
+
+			vk::SyncContext::UpdateFrame();
+			frameTiming.Samples.push_back(frameTimer.GetElapsedTime() * 1000.f);
+			WC_PROFILE_FRAME();
+		}
+
+		// Collect the timestamps of the last frames in flight
+		for (uint32_t i = 0; i < FRAME_OVERLAP; i++)
+		{
+			gpuProfiler.BeginFrame();
+			vk::SyncContext::UpdateFrame();
+		}
+
+		if (options.Reference)
+			CompareWithReference(scene, renderer, options);
+
+		timer.Start();
+		Image image;
+		renderer.ReadOutput(image);
+		image.Save(options.OutputPath);
+		image.Free();
+		readbackTiming.Samples.push_back(timer.GetElapsedTime() * 1000.f);
+
+		WC_CORE_INFO("Headless: wrote {}", options.OutputPath);
+
+		WC_CORE_INFO("CPU timings over {} frames:", options.Frames);
+		for (const auto* stage : { &loadTiming, &updateTiming, &renderTiming, &gpuWaitTiming, &frameTiming, &readbackTiming })
+			stage->Print();
+
+		if (gpuProfiler.IsSupported())
+		{
+			WC_CORE_INFO("GPU timings:");
+			auto PrintZone = [](const GPUZoneStats& zone) {
+				WC_CORE_INFO("{:<24} avg {:8.3f}ms  p50 {:8.3f}ms  p95 {:8.3f}ms  max {:8.3f}ms", zone.Name, zone.Average, zone.P50, zone.P95, zone.Max);
+				};
+
+			PrintZone(gpuProfiler.GetFrameStats());
+			for (const auto& zone : gpuProfiler.GetZones())
+				PrintZone(zone);
+		}
+
+		if (options.Play) scene.SetState(SceneState::Edit);
+	}
+
+	VulkanContext::GetLogicalDevice().WaitIdle();
+	scene.Destroy();
+	assetRegistry.Close();
+	assetPack.Close();
+
+	Globals.SoundContext.UninitializeContext();
+	vk::descriptorAllocator.Destroy();
+	assetManager.Free();
+	renderer.Deinit();
+	vk::samplerCache.Destroy();
+
+	for (int i = 0; i < FRAME_OVERLAP; i++)
+		renderData[i].Free();
+
+	gpuProfiler.Deinit();
+	vk::SyncContext::Destroy();
+
+	return result;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include <glm/glm.hpp>
+
+// Renders a project scene without a window or a swapchain and writes the final image to disk.
+// Meant for benchmarking and golden image tests, it also runs on software implementations (lavapipe).
+//
+// Blaze-Editor --headless <project> [--scene <name|path>] [--frames N] [--size WxH] [--out <file.png>] [--edit] [--reference] [--mount <file.blzpak>]
+struct HeadlessOptions
+{
+	std::string ProjectPath;
+	std::string ScenePath; // Defaults to the first scene found in the project
+	std::string OutputPath = "headless.png";
+	std::string PackPath; // Assets found in the pack are loaded from it instead of the project files
+
+	uint32_t Frames = 60;
+	glm::uvec2 Size = { 1280, 720 };
+
+	bool Play = true; // Runs scripts and physics, otherwise the scene is rendered as it was saved
+	bool Reference = false; // Also renders the last frame with the SoftwareRasterizer and compares it to the GPU main pass
+};
+
+// Returns false if --headless wasn't passed. Paths are made absolute since main changes the working directory
+bool ParseHeadlessArgs(int argc, char** argv, HeadlessOptions& options);
+
+// Expects VulkanContext to be created in headless mode, returns the process exit code
+int RunHeadless(const HeadlessOptions& options);
@@ -0,0 +1,263 @@
+#include "Packer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Rendering/Font.h"
+#include "Rendering/TextureCompression.h"
+#include "Scene/AssetPack.h"
+#include "Scene/AssetRegistry.h"
+#include "Scene/SceneFormat.h"
+#include "Scripting/ScriptBase.h"
+
+#include "Utils/Time.h"
+
+using namespace blaze;
+
+namespace
+{
+	std::vector<uint8_t> ReadFile(const std::filesystem::path& path)
+	{
+		std::ifstream file(path, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) return {};
+
+		std::vector<uint8_t> data((size_t)file.tellg());
+		file.seekg(0);
+		file.read((char*)data.data(), data.size());
+		return data;
+	}
+
+	bool PackTexture(AssetPackWriter& writer, const std::string& name, const std::filesystem::path& path, const PackOptions& options)
+	{
+		if (options.CompressTextures)
+		{
+			TextureCompression::EncodedTexture encoded;
+			if (TextureCompression::Import(path.string(), options.TextureCachePath, true, encoded))
+			{
+				const uint32_t info[4] = { (uint32_t)encoded.Format, encoded.Width, encoded.Height, encoded.MipLevels };
+				writer.Add(name, AssetPackKind::Texture, encoded.Data.data(), encoded.Data.size(), info, options.Compress);
+				return true;
+			}
+		}
+
+		int width = 0, height = 0, channels = 0;
+		stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+		if (!pixels) return false;
+
+		uint32_t mipLevels;
+		auto chain = TextureCompression::BuildMipChain(pixels, width, height, mipLevels);
+		stbi_image_free(pixels);
+
+		const uint32_t info[4] = { VK_FORMAT_R8G8B8A8_UNORM, (uint32_t)width, (uint32_t)height, mipLevels };
+		writer.Add(name, AssetPackKind::Texture, chain.data(), chain.size(), info, options.Compress);
+		return true;
+	}
+
+	bool PackFont(AssetPackWriter& writer, const std::string& name, const std::vector<uint8_t>& file, bool compress)
+	{
+		Image atlas = Font::Bake(file.data(), file.size());
+		if (!atlas.Data) return false;
+
+		std::vector<uint8_t> payload(file.begin(), file.end());
+		payload.insert(payload.end(), atlas.Data, atlas.Data + atlas.AllocSize());
+		delete[] atlas.Data;
+
+		const uint32_t info[4] = { (uint32_t)file.size(), atlas.Width, atlas.Height, 0 };
+		writer.Add(name, AssetPackKind::Font, payload.data(), payload.size(), info, compress);
+		return true;
+	}
+
+	// Shipped scenes load through the bulk binary path, binary files are stored as they are
+	bool PackScene(AssetPackWriter& writer, const std::string& name, const std::vector<uint8_t>& file, bool compress)
+	{
+		std::vector<uint8_t> binary;
+		if (SceneFileReader::IsSceneFile(file.data(), file.size()))
+		{
+			SceneFileReader reader;
+			if (!reader.Open(file.data(), file.size())) return false;
+			binary = file;
+		}
+		else
+		{
+			try
+			{
+				if (!ConvertSceneToBinary(YAML::Load(std::string(file.begin(), file.end())), binary)) return false;
+			}
+			catch (const std::exception& e)
+			{
+				WC_CORE_ERROR("Pack: failed to parse {}: {}", name, e.what());
+				return false;
+			}
+		}
+
+		writer.Add(name, AssetPackKind::Scene, binary.data(), binary.size(), nullptr, compress);
+		return true;
+	}
+
+	bool PackScript(AssetPackWriter& writer, const std::string& name, const std::filesystem::path& path, bool compress)
+	{
+		ScriptBinary binary;
+		if (binary.CompileScript(path.string()) || binary.binary.empty()) return false; // Returns true on errors
+
+		auto payload = binary.Serialize();
+		writer.Add(name, AssetPackKind::Script, payload.data(), payload.size(), nullptr, compress);
+		return true;
+	}
+}
+
+bool ParsePackArgs(int argc, char** argv, PackOptions& options)
+{
+	bool pack = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--pack")
+		{
+			pack = true;
+			if (hasValue && argv[i + 1][0] != '-') options.ProjectPath = argv[++i];
+		}
+		else if (arg == "--out" && hasValue) options.OutputPath = argv[++i];
+		else if (arg == "--no-compression") options.Compress = false;
+		else if (arg == "--compress-textures") options.CompressTextures = true;
+	}
+
+	if (!pack) return false;
+
+	auto MakeAbsolute = [](std::string& path) { if (!path.empty()) path = std::filesystem::absolute(path).lexically_normal().string(); };
+	MakeAbsolute(options.ProjectPath);
+	MakeAbsolute(options.OutputPath);
+
+	if (options.CompressTextures && !options.ProjectPath.empty())
+		options.TextureCachePath = options.ProjectPath + "/.blaze/cache/textures";
+
+	return true;
+}
+
+int RunPacker(const PackOptions& options)
+{
+	namespace fs = std::filesystem;
+
+	if (options.ProjectPath.empty() || !fs::is_directory(options.ProjectPath))
+	{
+		WC_CORE_ERROR("Pack: {} is not a project directory", options.ProjectPath);
+		return 1;
+	}
+
+	fs::path project = options.ProjectPath;
+	std::string outputPath = options.OutputPath;
+	if (outputPath.empty()) outputPath = (project / (project.filename().string() + ".blzpak")).string();
+
+	Timer timer;
+	timer.Start();
+
+	// Written next to the pack first so a failed build never replaces a working one
+	std::string temporaryPath = outputPath + ".tmp";
+	AssetPackWriter writer;
+	if (!writer.Create(temporaryPath)) return 1;
+
+	// Sorted so packing the same project twice gives the same file
+	std::vector<fs::path> files;
+	for (auto it = fs::recursive_directory_iterator(project); it != fs::recursive_directory_iterator(); ++it)
+	{
+		if (it->is_directory() && it->path().filename() == ".blaze") // Editor caches
+		{
+			it.disable_recursion_pending();
+			continue;
+		}
+
+		if (it->is_regular_file() && it->path().extension() != ".blzpak" && it->path().extension() != ".tmp")
+			files.push_back(it->path());
+	}
+	std::sort(files.begin(), files.end());
+
+	uint32_t failures = 0;
+	for (const auto& path : files)
+	{
+		std::string name = path.lexically_relative(project).generic_string();
+		AssetType type = AssetRegistry::GetTypeFromExtension(name);
+
+		bool packed = false;
+		switch (type)
+		{
+		case AssetType::Texture:
+			packed = PackTexture(writer, name, path, options);
+			break;
+		case AssetType::Font:
+			packed = PackFont(writer, name, ReadFile(path), options.Compress);
+			break;
+		case AssetType::Script:
+			packed = PackScript(writer, name, path, options.Compress);
+			break;
+		case AssetType::Scene:
+			packed = PackScene(writer, name, ReadFile(path), options.Compress);
+			break;
+		default:
+		{
+			auto data = ReadFile(path);
+			writer.Add(name, AssetPackKind::Raw, data.data(), data.size(), nullptr, options.Compress);
+			packed = true;
+			break;
+		}
+		}
+
+		if (!packed)
+		{
+			WC_CORE_ERROR("Pack: failed to bake {}", name);
+			failures++;
+		}
+	}
+
+	if (!writer.Finish() || failures)
+	{
+		WC_CORE_ERROR("Pack: {} assets failed, {} was not updated", failures, outputPath);
+		fs::remove(temporaryPath);
+		return 1;
+	}
+
+	std::error_code ec;
+	fs::rename(temporaryPath, outputPath, ec);
+	if (ec)
+	{
+		WC_CORE_ERROR("Pack: failed to write {}: {}", outputPath, ec.message());
+		return 1;
+	}
+
+	WC_CORE_INFO("Packed {} assets into {} in {:.2f}s, {:.2f}MB -> {:.2f}MB", writer.GetEntryCount(), outputPath, timer.GetElapsedTime(),
+		writer.GetRawSize() / (1024.0 * 1024.0), writer.GetStoredSize() / (1024.0 * 1024.0));
+
+	AssetPack pack;
+	if (!pack.Open(outputPath, options.ProjectPath) || !pack.Verify()) return 1;
+	return 0;
+}
+
+bool ParseConvertSceneArgs(int argc, char** argv, ConvertSceneOptions& options)
+{
+	for (int i = 1; i + 2 < argc; i++)
+		if (std::string(argv[i]) == "--convert-scene")
+		{
+			options.InputPath = std::filesystem::absolute(argv[i + 1]).lexically_normal().string();
+			options.OutputPath = std::filesystem::absolute(argv[i + 2]).lexically_normal().string();
+			return true;
+		}
+
+	return false;
+}
+
+int RunSceneConverter(const ConvertSceneOptions& options)
+{
+	Timer timer;
+	timer.Start();
+
+	if (!ConvertSceneFile(options.InputPath, options.OutputPath))
+	{
+		WC_CORE_ERROR("Convert: failed to convert {}", options.InputPath);
+		return 1;
+	}
+
+	WC_CORE_INFO("Converted {} to {} in {:.2f}s", options.InputPath, options.OutputPath, timer.GetElapsedTime());
+	return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+// Bakes a project into a single .blzpak for shipping builds: textures are decoded with their mips, scripts are compiled,
+// font atlases are generated and everything compressible is LZ4 compressed. Runs on the CPU only.
+// --compress-textures stores large textures block compressed (see TextureCompression), which needs BC support on the target GPU.
+//
+// Blaze-Editor --pack <project> [--out <file.blzpak>] [--no-compression] [--compress-textures]
+struct PackOptions
+{
+	std::string ProjectPath;
+	std::string OutputPath; // Defaults to <project>/<project name>.blzpak
+
+	bool Compress = true;
+	bool CompressTextures = false;
+	std::string TextureCachePath; // Shared with the editor's import cache
+};
+
+// Returns false if --pack wasn't passed. Paths are made absolute since main changes the working directory
+bool ParsePackArgs(int argc, char** argv, PackOptions& options);
+
+// Returns the process exit code
+int RunPacker(const PackOptions& options);
+
+// Converts a scene between the YAML authoring format (.scene) and the binary one (.blzscene), the output's extension picks the format.
+//
+// Blaze-Editor --convert-scene <input> <output>
+struct ConvertSceneOptions
+{
+	std::string InputPath;
+	std::string OutputPath;
+};
+
+// Returns false if --convert-scene wasn't passed
+bool ParseConvertSceneArgs(int argc, char** argv, ConvertSceneOptions& options);
+
+// Returns the process exit code
+int RunSceneConverter(const ConvertSceneOptions& options);
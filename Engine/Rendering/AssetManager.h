@@ -1,11 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Texture.h"
+#include "TextureCompression.h"
+#include "../Utils/Hash.h"
 #include "../Utils/Image.h"
 #include "Font.h"
+#include "vk/SyncContext.h"
+#include "../Scene/AssetPack.h"
 
 namespace blaze
 {
@@ -17,7 +23,41 @@ namespace blaze
         std::vector<Texture> Textures;
         std::vector<Font> Fonts;
 
-        bool TexturesUpdated = false; // This is set to true when a new texture is loaded. It's used to signal when we need to resize the descriptor set
+        // Reverse of the caches (slot -> name) so serialization doesn't have to search them, empty for unnamed slots
+        std::vector<std::string> TextureNames;
+        std::vector<std::string> FontNames;
+
+        // Slots of the bindless texture table that changed since the renderer last wrote it, only these get rewritten
+        std::vector<uint32_t> DirtyTextures;
+
+        // Slots of unloaded textures that are safe to reuse, none of the frames in flight can reference them anymore
+        std::vector<uint32_t> FreeTextures;
+
+        struct TextureSlot
+        {
+            uint32_t References = 0; // Live TextureHandles
+            uint64_t LastUsed = 0;   // Frame the last handle was released on, orders the budget eviction
+            size_t Size = 0;         // VRAM including mips, 0 when the image is shared
+            bool Evictable = false;  // Loaded by name from a file so it can be loaded again, see LoadTexture
+            uint64_t ContentKey = 0; // Set for files loaded by name, the image belongs to m_SharedTextures[ContentKey]
+        };
+
+        // Parallel to Textures
+        std::vector<TextureSlot> TextureSlots;
+
+        // Parallel to Fonts, live FontHandles
+        std::vector<uint32_t> FontReferences;
+        std::vector<uint32_t> FreeFonts;
+
+        // Unreferenced textures stay cached until the loaded textures go over this many bytes, then the least recently used
+        // ones are unloaded. 0 keeps them until UnloadUnused
+        size_t TextureBudget = 0;
+        size_t TextureMemory = 0;
+
+        // Large textures loaded from disk get block compressed on import (see TextureCompression), the encoded mip chains
+        // are cached in TextureCachePath so only the first load pays for the encoder
+        bool CompressTextures = false;
+        std::string TextureCachePath;
 
         void Init()
         {
@@ -29,11 +69,165 @@ namespace blaze
 
         void Free()
         {
-			for (auto& texture : Textures)
-                texture.Destroy();
+            for (uint32_t id = 0; id < Textures.size(); id++)
+                if (!TextureSlots[id].ContentKey) Textures[id].Destroy();
+
+            for (auto& [key, shared] : m_SharedTextures)
+                shared.Resource.Destroy();
 
             Textures.clear();
+            m_SharedTextures.clear();
             TextureCache.clear();
+            TextureNames.clear();
+            TextureSlots.clear();
+            DirtyTextures.clear();
+            FreeTextures.clear();
+            m_PendingTextures.clear();
+            TextureMemory = 0;
+        }
+
+        // Should be called once per frame after the frame's fence was waited on
+        void Update()
+        {
+            m_Frame++;
+
+            // Textures unloaded FRAME_OVERLAP frames ago are no longer referenced by any submitted command buffer
+            std::erase_if(m_PendingTextures, [&](const PendingTexture& pending) {
+                if (m_Frame - pending.Frame < FRAME_OVERLAP) return false;
+
+                DestroyImage(pending.ID);
+                Textures[pending.ID] = Texture();
+                TextureNames[pending.ID].clear();
+                TextureSlots[pending.ID] = {};
+                FreeTextures.push_back(pending.ID);
+                DirtyTextures.push_back(pending.ID); // Points the slot back to the white texture until it's reused
+                return true;
+                });
+
+            if (TextureBudget && TextureMemory > TextureBudget)
+                EvictTextures(TextureBudget);
+        }
+
+        // Only for slots no TextureHandle references. The image and slot are freed FRAME_OVERLAP frames after this call,
+        // which covers the frames already in flight but nothing drawn later, so nobody may draw with the ID anymore
+        void UnloadTexture(uint32_t id)
+        {
+            if (id == 0 || id >= Textures.size() || !Textures[id].view) return;
+            WC_ASSERT(TextureSlots[id].References == 0);
+
+            for (const auto& pending : m_PendingTextures)
+                if (pending.ID == id) return;
+
+            std::erase_if(TextureCache, [id](const auto& entry) { return entry.second == id; });
+            m_PendingTextures.push_back({ id, m_Frame });
+            ReleaseMemory(id);
+        }
+
+        // The atlas texture goes through UnloadTexture, the slot can be reused right away since fonts are only read on the CPU
+        void UnloadFont(uint32_t id)
+        {
+            if (id >= Fonts.size() || FontNames[id].empty()) return;
+
+            if (Fonts[id].TextureID) UnloadTexture(Fonts[id].TextureID);
+            delete[] Fonts[id].Atlas.Data;
+            Fonts[id] = Font();
+
+            std::erase_if(FontCache, [id](const auto& entry) { return entry.second == id; });
+            FontNames[id].clear();
+            FontReferences[id] = 0;
+            FreeFonts.push_back(id);
+        }
+
+        // Unloads every asset loaded by name that no handle references anymore. Called after a scene was replaced so the
+        // assets both scenes use are kept
+        void UnloadUnused()
+        {
+            for (uint32_t id = 1; id < TextureSlots.size(); id++)
+                if (TextureSlots[id].Evictable && TextureSlots[id].References == 0)
+                    UnloadTexture(id);
+
+            for (uint32_t id = 0; id < Fonts.size(); id++)
+                if (FontReferences[id] == 0 && !FontNames[id].empty())
+                    UnloadFont(id);
+        }
+
+        void AcquireTexture(uint32_t id) { if (id < TextureSlots.size()) TextureSlots[id].References++; }
+
+        void ReleaseTexture(uint32_t id)
+        {
+            if (id >= TextureSlots.size() || TextureSlots[id].References == 0) return;
+            if (--TextureSlots[id].References == 0) TextureSlots[id].LastUsed = m_Frame;
+        }
+
+        void AcquireFont(uint32_t id) { if (id < FontReferences.size()) FontReferences[id]++; }
+        void ReleaseFont(uint32_t id) { if (id < FontReferences.size() && FontReferences[id] > 0) FontReferences[id]--; }
+
+        // Hot reload of a texture loaded by name, the new image takes over the slot so every sprite using the ID picks it up.
+        // Textures the caller keeps a copy of (see LoadTexture) are skipped since the copy would dangle. Other files that
+        // shared the old image keep it, the old image is destroyed right away if nothing else uses it so the device has to be idle
+        bool ReloadTexture(const std::string& file)
+        {
+            auto it = TextureCache.find(file);
+            if (it == TextureCache.end() || it->second == 0 || !TextureSlots[it->second].Evictable) return false;
+
+            uint32_t id = it->second;
+            bool mipMapping = Textures[id].image.mipLevels > 1;
+            uint64_t key = GetContentKey(file, mipMapping);
+            if (!key || key == TextureSlots[id].ContentKey) return false; // Saved without changes
+
+            // The new content may match another loaded file
+            Texture texture;
+            bool shared = m_SharedTextures.contains(key);
+            if (!shared && (!ReadTexture(file, texture, mipMapping) || !texture.view)) return false;
+
+            ReleaseMemory(id);
+            DestroyImage(id);
+
+            if (!shared) m_SharedTextures[key] = { .Resource = texture, .Name = file, .Size = texture.GetMemorySize() };
+            AttachImage(id, key);
+
+            MarkTextureDirty(id);
+            return true;
+        }
+
+        // Hot reload of a font, it keeps its ID and gets a new atlas texture
+        bool ReloadFont(const std::string& file)
+        {
+            auto it = FontCache.find(file);
+            if (it == FontCache.end() || FontNames[it->second] != file || !std::filesystem::exists(file)) return false;
+
+            // The atlas is pushed under the font's name, the old one has to leave the texture cache first
+            uint32_t id = it->second;
+            if (Fonts[id].TextureID) UnloadTexture(Fonts[id].TextureID);
+            delete[] Fonts[id].Atlas.Data;
+            Fonts[id] = Font();
+
+            Fonts[id].Load(file, *this);
+            return Fonts[id].TextureID != 0;
+        }
+
+        const std::string& GetTextureName(uint32_t id) const { static const std::string none; return id < TextureNames.size() ? TextureNames[id] : none; }
+        const std::string& GetFontName(uint32_t id) const { static const std::string none; return id < FontNames.size() ? FontNames[id] : none; }
+
+        // Used when the contents of a texture are replaced in place so the renderer rewrites its descriptor
+        void MarkTextureDirty(uint32_t id) { DirtyTextures.push_back(id); }
+
+        struct DeduplicationStats
+        {
+            uint32_t Textures = 0; // Loaded files that got the image of an identical file instead of their own
+            size_t Memory = 0;     // VRAM that saved
+        };
+
+        DeduplicationStats GetDeduplicationStats() const
+        {
+            DeduplicationStats stats;
+            for (const auto& [key, shared] : m_SharedTextures)
+                if (shared.LiveUsers > 1)
+                {
+                    stats.Textures += shared.LiveUsers - 1;
+                    stats.Memory += (shared.LiveUsers - 1) * shared.Size;
+                }
+            return stats;
         }
 
 		uint32_t LoadFont(const std::string& file)
@@ -41,15 +235,25 @@ namespace blaze
 			if (FontCache.find(file) != FontCache.end())
 				return FontCache[file];
 
+            if (auto entry = assetPack.Find(file, AssetPackKind::Font))
+            {
+                auto data = assetPack.Read(*entry);
+                if (data.size() == entry->Info[0] + size_t(entry->Info[1]) * entry->Info[2] * 4)
+                {
+                    Image atlas(data.data() + entry->Info[0], entry->Info[1], entry->Info[2], 4); // Points into `data`
+                    uint32_t id = AllocateFont(file);
+                    if (Fonts[id].Load(data.data(), entry->Info[0], file, *this, &atlas))
+                        return id;
+
+                    UnloadFont(id);
+                }
+            }
+
 			if (std::filesystem::exists(file))
 			{
-                auto& font = Fonts.emplace_back();
-				
-				font.Load(file, *this);
-                TexturesUpdated = true;
-                FontCache[file] = uint32_t(Fonts.size() - 1);
-
-				return uint32_t(Fonts.size() - 1);
+                uint32_t id = AllocateFont(file);
+                Fonts[id].Load(file, *this);
+				return id;
 			}
 
             FontCache[file] = 0;
@@ -57,13 +261,7 @@ namespace blaze
 			return 0;
 		}
 
-		uint32_t PushTexture(const Texture& texture)
-		{
-			Textures.emplace_back(texture);
-            TexturesUpdated = true;
-
-			return uint32_t(Textures.size() - 1);
-		}
+		uint32_t PushTexture(const Texture& texture) { return PushSlot(texture, texture.GetMemorySize()); }
 
         uint32_t PushTexture(const Texture& texture, const std::string& name)
         {
@@ -73,31 +271,27 @@ namespace blaze
             auto texID = PushTexture(texture);
 
             TextureCache[name] = texID;
+            TextureNames[texID] = name;
             return texID;
         }
 
+        // The caller keeps a copy of the texture so it's never evicted
         uint32_t LoadTexture(const std::string& file, Texture& texture, bool mipMapping = false)
         {
-            if (TextureCache.find(file) != TextureCache.end())
-                return TextureCache[file];
-
-            if (std::filesystem::exists(file))
-            {
-                texture.Load(file, mipMapping);
-
-                return PushTexture(texture, file);
-            }
-
-            texture = Textures[0];
-            TextureCache[file] = 0;
-            WC_CORE_ERROR("Cannot find file at location: {}", file);
-            return 0;
+            bool created;
+            uint32_t id = LoadTextureByName(file, texture, mipMapping, created);
+            TextureSlots[id].Evictable = false;
+            return id;
         }
 
+        // Textures loaded by ID only are reloaded by name when needed again, so UnloadUnused and the budget may evict them
         uint32_t LoadTexture(const std::string& file, bool mipMapping = false)
         {
+            bool created;
             Texture texture;
-            return LoadTexture(file, texture, mipMapping);
+            uint32_t id = LoadTextureByName(file, texture, mipMapping, created);
+            if (created) TextureSlots[id].Evictable = true;
+            return id;
         }
 
         uint32_t LoadTextureFromMemory(const Image& image, const std::string& name)
@@ -118,5 +312,277 @@ namespace blaze
 
 			return PushTexture(texture);
 		}
+
+    private:
+        uint32_t PushSlot(const Texture& texture, size_t size)
+        {
+            uint32_t id;
+            if (!FreeTextures.empty())
+            {
+                id = FreeTextures.back();
+                FreeTextures.pop_back();
+                Textures[id] = texture;
+            }
+            else
+            {
+                id = uint32_t(Textures.size());
+                Textures.emplace_back(texture);
+                TextureNames.emplace_back();
+                TextureSlots.emplace_back();
+            }
+
+            TextureSlots[id] = { .LastUsed = m_Frame, .Size = size };
+            TextureMemory += size;
+
+            DirtyTextures.push_back(id);
+			return id;
+		}
+
+        // Copies of the same image under different names (common in art folders) are decoded and uploaded once, every
+        // name still gets its own slot so scenes keep referencing the file they were made with
+        uint32_t LoadTextureByName(const std::string& file, Texture& texture, bool mipMapping, bool& created)
+        {
+            created = false;
+            if (TextureCache.find(file) != TextureCache.end())
+            {
+                texture = Textures[TextureCache[file]];
+                return TextureCache[file];
+            }
+
+            uint64_t key = GetContentKey(file, mipMapping);
+            if (auto it = m_SharedTextures.find(key); key && it != m_SharedTextures.end())
+                WC_CORE_DEBUG("{} has the same content as {}, sharing its texture ({:.1f} KB saved)", file, it->second.Name, it->second.Size / 1024.0);
+            else if (key && ReadTexture(file, texture, mipMapping))
+                m_SharedTextures[key] = { .Resource = texture, .Name = file, .Size = texture.GetMemorySize() };
+            else
+            {
+                texture = Textures[0];
+                TextureCache[file] = 0;
+                WC_CORE_ERROR("Cannot find file at location: {}", file);
+                return 0;
+            }
+
+            uint32_t id = PushSlot(m_SharedTextures[key].Resource, 0);
+            AttachImage(id, key);
+            TextureCache[file] = id;
+            TextureNames[id] = file;
+
+            texture = Textures[id];
+            created = true;
+            return id;
+        }
+
+        // Identifies the image ReadTexture would create. Packed textures already store a hash of their payload, files on
+        // disk are hashed in full (XXH64 runs at several GB/s, well below decoding). 0 if the file can't be read
+        uint64_t GetContentKey(const std::string& file, bool mipMapping) const
+        {
+            if (auto entry = FindPackedTexture(file))
+                return wc::HashCombine(entry->ContentHash, 2); // Packed mip chains don't depend on mipMapping
+
+            uint64_t hash = wc::HashFile(file);
+            return hash ? wc::HashCombine(hash, mipMapping) : 0;
+        }
+
+        // Points the slot at the shared image, which counts towards TextureMemory once however many slots use it
+        void AttachImage(uint32_t id, uint64_t key)
+        {
+            auto& shared = m_SharedTextures[key];
+            if (shared.LiveUsers++ == 0) TextureMemory += shared.Size;
+            shared.Users++;
+
+            Textures[id] = shared.Resource;
+            TextureSlots[id].Size = 0;
+            TextureSlots[id].ContentKey = key;
+        }
+
+        // Called when the slot is unloaded, a shared image stays resident while other slots use it
+        void ReleaseMemory(uint32_t id)
+        {
+            TextureMemory -= TextureSlots[id].Size;
+            if (uint64_t key = TextureSlots[id].ContentKey)
+            {
+                auto& shared = m_SharedTextures[key];
+                if (--shared.LiveUsers == 0) TextureMemory -= shared.Size;
+            }
+        }
+
+        // Called once no frame in flight can use the slot anymore, shared images are destroyed with their last slot
+        void DestroyImage(uint32_t id)
+        {
+            uint64_t key = TextureSlots[id].ContentKey;
+            if (!key)
+            {
+                Textures[id].Destroy();
+                return;
+            }
+
+            auto it = m_SharedTextures.find(key);
+            if (--it->second.Users == 0)
+            {
+                it->second.Resource.Destroy();
+                m_SharedTextures.erase(it);
+            }
+            TextureSlots[id].ContentKey = 0;
+        }
+
+        // Packed textures the device can't sample are skipped, BC entries without textureCompressionBC load from the source file
+        const AssetPackEntry* FindPackedTexture(const std::string& file) const
+        {
+            auto entry = assetPack.Find(file, AssetPackKind::Texture);
+            if (entry && IsBlockCompressed((VkFormat)entry->Info[0]) && !VulkanContext::GetPhysicalDevice().GetFeatures().textureCompressionBC)
+                return nullptr;
+            return entry;
+        }
+
+        // Creates the texture without giving it a slot
+        bool ReadTexture(const std::string& file, Texture& texture, bool mipMapping)
+        {
+            // Packed textures come with their mips and get decompressed straight into the staging buffer
+            if (auto entry = FindPackedTexture(file))
+            {
+                if (texture.Load((VkFormat)entry->Info[0], entry->Info[1], entry->Info[2], entry->Info[3], entry->RawSize, [&](void* staging) { return assetPack.Read(*entry, staging); }))
+                {
+                    texture.SetName(file);
+                    return true;
+                }
+            }
+
+            if (CompressTextures && VulkanContext::GetPhysicalDevice().GetFeatures().textureCompressionBC && std::filesystem::exists(file))
+            {
+                TextureCompression::EncodedTexture encoded;
+                if (TextureCompression::Import(file, TextureCachePath, mipMapping, encoded) &&
+                    texture.Load(encoded.Format, encoded.Width, encoded.Height, encoded.MipLevels, encoded.Data.size(), [&](void* staging) { memcpy(staging, encoded.Data.data(), encoded.Data.size()); return true; }))
+                {
+                    texture.SetName(file);
+                    return true;
+                }
+            }
+
+            if (std::filesystem::exists(file))
+            {
+                texture.Load(file, mipMapping);
+                return true;
+            }
+
+            return false;
+        }
+
+        uint32_t AllocateFont(const std::string& name)
+        {
+            uint32_t id;
+            if (!FreeFonts.empty())
+            {
+                id = FreeFonts.back();
+                FreeFonts.pop_back();
+            }
+            else
+            {
+                id = uint32_t(Fonts.size());
+                Fonts.emplace_back();
+                FontNames.emplace_back();
+                FontReferences.emplace_back();
+            }
+
+            FontCache[name] = id;
+            FontNames[id] = name;
+            return id;
+        }
+
+        // Unloads unreferenced textures, least recently used first, until `budget` bytes are left
+        void EvictTextures(size_t budget)
+        {
+            std::vector<uint32_t> candidates;
+            for (uint32_t id = 1; id < TextureSlots.size(); id++)
+                if (TextureSlots[id].Evictable && TextureSlots[id].References == 0 && Textures[id].view)
+                    candidates.push_back(id);
+
+            std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) { return TextureSlots[a].LastUsed < TextureSlots[b].LastUsed; });
+            for (uint32_t id : candidates)
+            {
+                if (TextureMemory <= budget) break;
+                UnloadTexture(id);
+            }
+        }
+
+        struct PendingTexture
+        {
+            uint32_t ID;
+            uint64_t Frame; // Frame the texture was unloaded on
+        };
+
+        std::vector<PendingTexture> m_PendingTextures;
+        uint64_t m_Frame = 0;
+
+        struct SharedTexture
+        {
+            Texture Resource;
+            std::string Name;       // First file loaded with this content
+            size_t Size = 0;        // VRAM including mips
+            uint32_t Users = 0;     // Slots pointing at the image, including unloaded ones the frames in flight may still use
+            uint32_t LiveUsers = 0; // Slots that weren't unloaded, the image counts towards TextureMemory while there are any
+        };
+
+        // Images of the files loaded by name, keyed by their content (see GetContentKey)
+        std::unordered_map<uint64_t, SharedTexture> m_SharedTextures;
+    };
+
+    inline AssetManager assetManager;
+
+    // Reference counted ID of an asset in `assetManager`. Components hold these so UnloadUnused and the texture budget know
+    // which assets a scene still uses, flecs runs the copy/move/destructor hooks. Converts to and from the plain ID
+    template<typename T>
+    struct AssetHandle
+    {
+        static constexpr uint32_t Null = std::is_same_v<T, Font> ? UINT32_MAX : 0;
+
+        AssetHandle(uint32_t id = Null) : m_ID(id) { Acquire(); }
+        AssetHandle(const AssetHandle& other) : m_ID(other.m_ID) { Acquire(); }
+        AssetHandle(AssetHandle&& other) noexcept : m_ID(std::exchange(other.m_ID, Null)) {}
+        ~AssetHandle() { Release(); }
+
+        AssetHandle& operator=(const AssetHandle& other)
+        {
+            if (m_ID != other.m_ID)
+            {
+                Release();
+                m_ID = other.m_ID;
+                Acquire();
+            }
+            return *this;
+        }
+
+        AssetHandle& operator=(AssetHandle&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Release();
+                m_ID = std::exchange(other.m_ID, Null);
+            }
+            return *this;
+        }
+
+        AssetHandle& operator=(uint32_t id) { return *this = AssetHandle(id); }
+
+        operator uint32_t() const { return m_ID; }
+
+    private:
+        void Acquire()
+        {
+            if (m_ID == Null) return;
+            if constexpr (std::is_same_v<T, Font>) assetManager.AcquireFont(m_ID);
+            else assetManager.AcquireTexture(m_ID);
+        }
+
+        void Release()
+        {
+            if (m_ID == Null) return;
+            if constexpr (std::is_same_v<T, Font>) assetManager.ReleaseFont(m_ID);
+            else assetManager.ReleaseTexture(m_ID);
+        }
+
+        uint32_t m_ID = Null;
     };
+
+    using TextureHandle = AssetHandle<Texture>;
+    using FontHandle = AssetHandle<Font>;
 }
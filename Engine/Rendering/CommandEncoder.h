@@ -25,6 +25,7 @@ namespace wc
 		Dispatch,
 		PushConstants,
 		BindPipeline,
+		WriteTimestamp,
 	};
 
 	struct ICommand
@@ -102,6 +103,13 @@ namespace wc
 		VkDescriptorSetLayout descriptorLayout;
 	};
 
+	struct alignas(8) CMD_WriteTimestamp : public Command<CommandType::WriteTimestamp>
+	{
+		VkQueryPool queryPool;
+		uint32_t query;
+		VkPipelineStageFlagBits stage;
+	};
+
 	struct CommandEncoder
 	{
 		void BindShader(Shader shader)
@@ -192,6 +200,14 @@ namespace wc
 			PushConstants(sizeof(data), &data, 0);
 		}
 
+		void WriteTimestamp(VkQueryPool queryPool, uint32_t query, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT)
+		{
+			auto* cmd = encode<CMD_WriteTimestamp>();
+			cmd->queryPool = queryPool;
+			cmd->query = query;
+			cmd->stage = stage;
+		}
+
 		void ExecuteCompute(VkCommandBuffer cmd)
 		{
 			vkResetCommandBuffer(cmd, 0);
@@ -243,6 +259,12 @@ namespace wc
 					free(pCmd->data);
 				}
 				break;
+				case CommandType::WriteTimestamp:
+				{
+					auto* pCmd = static_cast<CMD_WriteTimestamp*>(command);
+					vkCmdWriteTimestamp(cmd, pCmd->stage, pCmd->queryPool, pCmd->query);
+				}
+				break;
 				}
 			}
 			
@@ -145,6 +145,23 @@ namespace vk
 
 	DescriptorWriter& DescriptorWriter::BindImage(uint32_t binding, VkSampler sampler, VkImageView image, VkImageLayout layout, VkDescriptorType type) { return BindImage(binding, { sampler, image, layout }, type); }
 
+	DescriptorWriter& DescriptorWriter::BindImage(uint32_t binding, uint32_t arrayElement, const VkDescriptorImageInfo& imageInfo, VkDescriptorType type)
+	{
+		VkWriteDescriptorSet write = {
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+
+			.dstSet = dstSet,
+			.dstBinding = binding,
+			.dstArrayElement = arrayElement,
+			.descriptorCount = 1,
+			.descriptorType = type,
+			.pImageInfo = &m_ImageInfos.emplace_back(imageInfo),
+		};
+
+		writes.push_back(write);
+		return *this;
+	}
+
 	DescriptorWriter& DescriptorWriter::BindImages(uint32_t binding, const std::vector<VkDescriptorImageInfo>& imageInfo, VkDescriptorType type)
 	{
 		VkWriteDescriptorSet write = {
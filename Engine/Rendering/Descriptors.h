@@ -49,6 +49,9 @@ namespace vk
 
 		DescriptorWriter& BindImage(uint32_t binding, VkSampler sampler, VkImageView image, VkImageLayout layout, VkDescriptorType type);
 
+		// Writes a single element of an array binding
+		DescriptorWriter& BindImage(uint32_t binding, uint32_t arrayElement, const VkDescriptorImageInfo& imageInfo, VkDescriptorType type);
+
 		DescriptorWriter& BindImages(uint32_t binding, const std::vector<VkDescriptorImageInfo>& imageInfo, VkDescriptorType type);
 
 		void Clear();
@@ -1,4 +1,7 @@
 #include "Font.h"
+
+#include <fstream>
+
 #include "RenderData.h"
 
 #include "AssetManager.h"
@@ -7,14 +10,75 @@
 namespace blaze
 {
 	void Font::Load(const std::string filepath, AssetManager& assetManager)
+    {
+        std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+        if (!file.is_open())
+        {
+            WC_CORE_ERROR("Cannot open font {}", filepath);
+            return;
+        }
+
+        std::vector<uint8_t> data((size_t)file.tellg());
+        file.seekg(0);
+        file.read((char*)data.data(), data.size());
+
+        Load(data.data(), data.size(), filepath, assetManager);
+    }
+
+    bool Font::Load(const uint8_t* data, size_t size, const std::string& name, AssetManager& assetManager, const Image* bakedAtlas)
     {
         msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype();
 
-        if (!ft) return; // @TODO: Handle errors
+        if (!ft) return false; // @TODO: Handle errors
+
+        msdfgen::FontHandle* font = msdfgen::loadFontData(ft, (const msdfgen::byte*)data, (int)size);
+        if (!font)
+        {
+            deinitializeFreetype(ft);
+            return false;
+        }
+
+        int width, height;
+        LoadGeometry(font, width, height);
+
+        // The packer is deterministic so a baked atlas of the same size matches the glyph layout
+        if (bakedAtlas && bakedAtlas->Width == (uint32_t)width && bakedAtlas->Height == (uint32_t)height)
+        {
+            Atlas = Image(bakedAtlas->Width, bakedAtlas->Height, 4);
+            memcpy(Atlas.Data, bakedAtlas->Data, Atlas.AllocSize());
+        }
+        else
+            Atlas = GenerateAtlas(width, height);
 
-        msdfgen::FontHandle* font = loadFont(ft, filepath.c_str());
-        if (!font) return;
+        Tex.Load(Atlas.Data, Atlas.Width, Atlas.Height);
+        TextureID = assetManager.PushTexture(Tex, name);
 
+        destroyFont(font);
+        deinitializeFreetype(ft);
+        return true;
+    }
+
+    Image Font::Bake(const uint8_t* data, size_t size)
+    {
+        Image atlas;
+        msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype();
+        if (!ft) return atlas;
+
+        if (msdfgen::FontHandle* font = msdfgen::loadFontData(ft, (const msdfgen::byte*)data, (int)size))
+        {
+            Font bakedFont;
+            int width, height;
+            bakedFont.LoadGeometry(font, width, height);
+            atlas = bakedFont.GenerateAtlas(width, height);
+            destroyFont(font);
+        }
+
+        deinitializeFreetype(ft);
+        return atlas;
+    }
+
+    void Font::LoadGeometry(msdfgen::FontHandle* font, int& width, int& height)
+    {
         struct CharsetRange
         {
             uint32_t Begin, End;
@@ -33,6 +97,7 @@ namespace blaze
                 charset.add(c);
         }
 
+        Glyphs.clear();
         Geometry = msdf_atlas::FontGeometry(&Glyphs);
         Geometry.loadCharset(font, 1.0, charset);
 
@@ -47,11 +112,11 @@ namespace blaze
         atlasPacker.setScale(emSize);
         atlasPacker.pack(Glyphs.data(), (int)Glyphs.size());
 
-
-        int width, height;
         atlasPacker.getDimensions(width, height);
-        emSize = atlasPacker.getScale();
+    }
 
+    Image Font::GenerateAtlas(int width, int height)
+    {
 #define DEFAULT_ANGLE_THRESHOLD 3.0
 #define LCG_MULTIPLIER 6364136223846793005ull
 #define LCG_INCREMENT 1442695040888963407ull
@@ -102,12 +167,7 @@ namespace blaze
                 newBitmap.Set(x, y, glm::vec4(col, 255.f));
             }
 
-        Tex.Load(newBitmap.Data, newBitmap.Width, newBitmap.Height);
-        TextureID = assetManager.PushTexture(Tex, filepath);
-        newBitmap.Free();
-
-        destroyFont(font);
-        deinitializeFreetype(ft);
+        return newBitmap;
     }
 
     glm::vec2 Font::CalculateTextSize(const std::string& string, float lineSpacing, float kerning)
@@ -10,6 +10,7 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include "Texture.h"
+#include "../Utils/Image.h"
 
 namespace blaze
 {
@@ -18,12 +19,24 @@ namespace blaze
     struct Font
     {
         void Load(const std::string filepath, AssetManager& assetManager);
+
+        // Loads a font file from memory, `bakedAtlas` skips the MSDF generation if it was baked from the same file (asset packs)
+        bool Load(const uint8_t* data, size_t size, const std::string& name, AssetManager& assetManager, const Image* bakedAtlas = nullptr);
+
+        // Generates the atlas on the CPU only, used by the asset packer
+        static Image Bake(const uint8_t* data, size_t size);
+
         glm::vec2 CalculateTextSize(const std::string& string, float lineSpacing = 0.f, float kerning = 0.f);
 
         uint32_t TextureID = 0;
         Texture Tex;
+        Image Atlas; // CPU copy of the atlas, used by the software rasterizer
         msdf_atlas::FontGeometry Geometry;
         
         std::vector<msdf_atlas::GlyphGeometry> Glyphs;
+
+    private:
+        void LoadGeometry(msdfgen::FontHandle* font, int& width, int& height);
+        Image GenerateAtlas(int width, int height);
     };
 }
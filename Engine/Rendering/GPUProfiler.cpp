@@ -0,0 +1,212 @@
+#include "GPUProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <format>
+
+#include "../Utils/Log.h"
+
+namespace blaze
+{
+	void GPUZoneStats::Push(float ms)
+	{
+		Last = ms;
+		History[HistoryIndex] = ms;
+		HistoryIndex = (HistoryIndex + 1) % GPU_PROFILER_HISTORY;
+		SampleCount = glm::min(SampleCount + 1, GPU_PROFILER_HISTORY);
+	}
+
+	void GPUZoneStats::Compute()
+	{
+		if (SampleCount == 0) return;
+
+		float sorted[GPU_PROFILER_HISTORY];
+		memcpy(sorted, History, SampleCount * sizeof(float));
+		std::sort(sorted, sorted + SampleCount);
+
+		float sum = 0.f;
+		for (uint32_t i = 0; i < SampleCount; i++)
+			sum += sorted[i];
+
+		auto Percentile = [&](float p) { return sorted[uint32_t(p * float(SampleCount - 1) + 0.5f)]; };
+
+		Average = sum / float(SampleCount);
+		P50 = Percentile(0.5f);
+		P95 = Percentile(0.95f);
+		P99 = Percentile(0.99f);
+		Max = sorted[SampleCount - 1];
+	}
+
+	void GPUProfiler::Init()
+	{
+		auto& physicalDevice = VulkanContext::GetPhysicalDevice();
+		auto limits = physicalDevice.GetLimits();
+		auto families = physicalDevice.GetQueueFamilyProperties();
+
+		uint32_t graphicsBits = families[vk::SyncContext::GetGraphicsQueue().queueFamily].timestampValidBits;
+		uint32_t computeBits = families[vk::SyncContext::GetComputeQueue().queueFamily].timestampValidBits;
+
+		m_Supported = limits.timestampPeriod > 0.f && graphicsBits > 0;
+		m_ComputeSupported = m_Supported && computeBits > 0;
+		if (!m_Supported)
+		{
+			WC_CORE_WARN("Timestamp queries are not supported, GPU profiling is disabled");
+			return;
+		}
+		if (!m_ComputeSupported)
+			WC_CORE_WARN("Timestamp queries are not supported on the compute queue, compute zones will not be profiled");
+
+		m_TimestampPeriod = limits.timestampPeriod;
+		uint32_t validBits = m_ComputeSupported ? glm::min(graphicsBits, computeBits) : graphicsBits;
+		m_TimestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = GPU_PROFILER_MAX_ZONES * 2,
+		};
+
+		for (uint32_t i = 0; i < FRAME_OVERLAP; i++)
+		{
+			vkCreateQueryPool(VulkanContext::GetLogicalDevice(), &createInfo, VulkanContext::GetAllocator(), &m_QueryPools[i]);
+			VulkanContext::SetObjectName(m_QueryPools[i], std::format("GPUProfiler::QueryPool[{}]", i));
+			vkResetQueryPool(VulkanContext::GetLogicalDevice(), m_QueryPools[i], 0, createInfo.queryCount);
+			m_FrameZones[i].reserve(GPU_PROFILER_MAX_ZONES);
+		}
+	}
+
+	void GPUProfiler::Deinit()
+	{
+		for (uint32_t i = 0; i < FRAME_OVERLAP; i++)
+		{
+			if (m_QueryPools[i]) vkDestroyQueryPool(VulkanContext::GetLogicalDevice(), m_QueryPools[i], VulkanContext::GetAllocator());
+			m_QueryPools[i] = VK_NULL_HANDLE;
+			m_FrameZones[i].clear();
+		}
+
+		m_Zones.clear();
+		m_ZoneLookup.clear();
+	}
+
+	void GPUProfiler::BeginFrame()
+	{
+		if (!m_Supported) return;
+
+		auto& zones = m_FrameZones[CURRENT_FRAME];
+		VkQueryPool pool = m_QueryPools[CURRENT_FRAME];
+
+		if (!zones.empty())
+		{
+			// Result + availability for each query
+			uint64_t results[GPU_PROFILER_MAX_ZONES * 2][2];
+			uint32_t queryCount = (uint32_t)zones.size() * 2;
+			vkGetQueryPoolResults(VulkanContext::GetLogicalDevice(), pool, 0, queryCount, queryCount * sizeof(results[0]), results, sizeof(results[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+			uint64_t frameBegin = UINT64_MAX;
+			uint64_t frameEnd = 0;
+			for (uint32_t i = 0; i < zones.size(); i++)
+			{
+				auto& begin = results[i * 2];
+				auto& end = results[i * 2 + 1];
+				if (!begin[1] || !end[1]) continue; // Not available
+
+				uint64_t ticks = ((end[0] & m_TimestampMask) - (begin[0] & m_TimestampMask)) & m_TimestampMask;
+				m_Zones[zones[i]].Push(float(double(ticks) * m_TimestampPeriod / 1'000'000.0));
+
+				frameBegin = glm::min(frameBegin, begin[0] & m_TimestampMask);
+				frameEnd = glm::max(frameEnd, end[0] & m_TimestampMask);
+			}
+
+			if (frameEnd > frameBegin)
+				m_FrameStats.Push(float(double(frameEnd - frameBegin) * m_TimestampPeriod / 1'000'000.0));
+
+			for (auto& zone : m_Zones)
+				zone.Compute();
+			m_FrameStats.Compute();
+
+			vkResetQueryPool(VulkanContext::GetLogicalDevice(), pool, 0, queryCount);
+			zones.clear();
+		}
+	}
+
+	uint32_t GPUProfiler::AllocateZone(const char* name)
+	{
+		auto& zones = m_FrameZones[CURRENT_FRAME];
+		if (!Enabled || !m_Supported || zones.size() >= GPU_PROFILER_MAX_ZONES) return UINT32_MAX;
+
+		auto [it, inserted] = m_ZoneLookup.try_emplace(name, (uint32_t)m_Zones.size());
+		if (inserted)
+			m_Zones.emplace_back().Name = name;
+
+		zones.push_back(it->second);
+		return (uint32_t)zones.size() - 1;
+	}
+
+	uint32_t GPUProfiler::BeginZone(VkCommandBuffer cmd, const char* name)
+	{
+		uint32_t zone = AllocateZone(name);
+		if (zone != UINT32_MAX)
+			vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPools[CURRENT_FRAME], zone * 2);
+		return zone;
+	}
+
+	void GPUProfiler::EndZone(VkCommandBuffer cmd, uint32_t zone)
+	{
+		if (zone == UINT32_MAX) return;
+		vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPools[CURRENT_FRAME], zone * 2 + 1);
+	}
+
+	uint32_t GPUProfiler::BeginZone(wc::CommandEncoder& cmd, const char* name)
+	{
+		if (!m_ComputeSupported) return UINT32_MAX;
+
+		uint32_t zone = AllocateZone(name);
+		if (zone != UINT32_MAX)
+			cmd.WriteTimestamp(m_QueryPools[CURRENT_FRAME], zone * 2, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+		return zone;
+	}
+
+	void GPUProfiler::EndZone(wc::CommandEncoder& cmd, uint32_t zone)
+	{
+		if (zone == UINT32_MAX) return;
+		cmd.WriteTimestamp(m_QueryPools[CURRENT_FRAME], zone * 2 + 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	}
+
+	bool GPUProfiler::ExportJSON(const std::string& filepath) const
+	{
+		std::ofstream file(filepath);
+		if (!file.is_open())
+		{
+			WC_CORE_ERROR("Failed to open {}", filepath);
+			return false;
+		}
+
+		auto WriteZone = [&](const GPUZoneStats& zone)
+			{
+				file << std::format("\t\t{{ \"name\": \"{}\", \"samples\": {}, \"last\": {:.4f}, \"average\": {:.4f}, \"p50\": {:.4f}, \"p95\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}, \"history\": [",
+					zone.Name, zone.SampleCount, zone.Last, zone.Average, zone.P50, zone.P95, zone.P99, zone.Max);
+
+				// Oldest sample first
+				uint32_t start = zone.SampleCount < GPU_PROFILER_HISTORY ? 0 : zone.HistoryIndex;
+				for (uint32_t i = 0; i < zone.SampleCount; i++)
+					file << std::format("{}{:.4f}", i ? ", " : "", zone.History[(start + i) % GPU_PROFILER_HISTORY]);
+				file << "] }";
+			};
+
+		file << "{\n";
+		file << std::format("\t\"device\": \"{}\",\n", VulkanContext::GetPhysicalDevice().GetProperties().deviceName);
+		file << std::format("\t\"timestampPeriod\": {},\n", m_TimestampPeriod);
+		file << "\t\"unit\": \"ms\",\n";
+		file << "\t\"zones\": [\n";
+		WriteZone(m_FrameStats);
+		for (auto& zone : m_Zones)
+		{
+			file << ",\n";
+			WriteZone(zone);
+		}
+		file << "\n\t]\n}\n";
+
+		WC_CORE_INFO("Exported GPU timings to {}", filepath);
+		return true;
+	}
+}
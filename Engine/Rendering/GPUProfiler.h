@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "vk/SyncContext.h"
+#include "CommandEncoder.h"
+
+namespace blaze
+{
+	constexpr uint32_t GPU_PROFILER_MAX_ZONES = 64;
+	constexpr uint32_t GPU_PROFILER_HISTORY = 256; // Amount of frames kept for the statistics
+
+	struct GPUZoneStats
+	{
+		std::string Name;
+
+		float History[GPU_PROFILER_HISTORY] = {};
+		uint32_t HistoryIndex = 0;
+		uint32_t SampleCount = 0;
+
+		// Everything is in milliseconds
+		float Last = 0.f;
+		float Average = 0.f;
+		float P50 = 0.f;
+		float P95 = 0.f;
+		float P99 = 0.f;
+		float Max = 0.f;
+
+		void Push(float ms);
+
+		void Compute();
+	};
+
+	// Measures GPU time with timestamp queries. Every frame in flight owns its own query pool, the results
+	// are read back (without waiting) once the render fence for that frame has been signaled.
+	struct GPUProfiler
+	{
+		bool Enabled = true;
+
+		void Init();
+
+		void Deinit();
+
+		// Has to be called after the render fence of CURRENT_FRAME has been waited on
+		void BeginFrame();
+
+		uint32_t BeginZone(VkCommandBuffer cmd, const char* name);
+		void EndZone(VkCommandBuffer cmd, uint32_t zone);
+
+		uint32_t BeginZone(wc::CommandEncoder& cmd, const char* name);
+		void EndZone(wc::CommandEncoder& cmd, uint32_t zone);
+
+		const auto& GetZones() const { return m_Zones; }
+		const auto& GetFrameStats() const { return m_FrameStats; }
+		bool IsSupported() const { return m_Supported; }
+
+		bool ExportJSON(const std::string& filepath) const;
+
+	private:
+		uint32_t AllocateZone(const char* name);
+
+		VkQueryPool m_QueryPools[FRAME_OVERLAP] = {};
+		std::vector<uint32_t> m_FrameZones[FRAME_OVERLAP]; // Zone slot -> index into m_Zones
+
+		std::vector<GPUZoneStats> m_Zones;
+		std::unordered_map<std::string, uint32_t> m_ZoneLookup;
+		GPUZoneStats m_FrameStats = { .Name = "Frame" };
+
+		float m_TimestampPeriod = 1.f; // nanoseconds per tick
+		uint64_t m_TimestampMask = UINT64_MAX;
+		bool m_Supported = false;
+		bool m_ComputeSupported = false;
+	};
+
+	inline GPUProfiler gpuProfiler;
+
+	template<typename T>
+	struct GPUZone
+	{
+		T& cmd;
+		uint32_t zone;
+
+		GPUZone(T& cmd, const char* name) : cmd(cmd) { zone = gpuProfiler.BeginZone(cmd, name); }
+		~GPUZone() { gpuProfiler.EndZone(cmd, zone); }
+	};
+}
@@ -53,6 +53,11 @@ namespace blaze
 
 		auto GetLineVertexCount() const { return LineVertexBuffer.GetSize(); }
 
+		// CPU side copies, used by the software rasterizer
+		const auto& GetVertices() const { return VertexBuffer.GetData(); }
+		const auto& GetIndices() const { return IndexBuffer.GetData(); }
+		const auto& GetLineVertices() const { return LineVertexBuffer.GetData(); }
+
 		void UploadVertexData();
 
 		void UploadLineVertexData();
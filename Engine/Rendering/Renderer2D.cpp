@@ -1,13 +1,23 @@
 #include "Renderer2D.h"
 
+#include <algorithm>
+
 #include "AssetManager.h"
 
 #include "Descriptors.h"
+#include "GPUProfiler.h"
+#include "../Utils/Profiler.h"
+#include "../Utils/Image.h"
 
 #include "../imgui_backend/imgui_impl_vulkan.h"
 
 namespace blaze
 {
+	namespace
+	{
+		VkDynamicState s_DynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	}
+
 	auto BloomPass::GetOutput() { return m_Buffers[2].imageViews[0]; }
 
 	void BloomPass::Init()
@@ -161,11 +171,14 @@ namespace blaze
 		} settings;
 
 		settings.Params = glm::vec4(Threshold, Threshold - Knee, Knee * 2.f, 0.25f / Knee);
+		uint32_t zone = gpuProfiler.BeginZone(cmd, "Bloom Prefilter");
 		cmd.PushConstants(settings);
 		cmd.BindDescriptorSet(m_DescriptorSets[counter++]);
 		cmd.Dispatch(glm::ceil(glm::vec2(m_Buffers[0].image.GetSize()) / glm::vec2(m_ComputeWorkGroupSize)));
+		gpuProfiler.EndZone(cmd, zone);
 
 		settings.Mode = Downsample;
+		zone = gpuProfiler.BeginZone(cmd, "Bloom Downsample");
 		for (uint32_t currentMip = 1; currentMip < m_MipLevels; currentMip++)
 		{
 			glm::vec2 dispatchSize = glm::ceil((glm::vec2)m_Buffers[0].image.GetMipSize(currentMip) / glm::vec2(m_ComputeWorkGroupSize));
@@ -185,7 +198,10 @@ namespace blaze
 			cmd.Dispatch(dispatchSize);
 		}
 
+		gpuProfiler.EndZone(cmd, zone);
+
 		// First Upsample
+		zone = gpuProfiler.BeginZone(cmd, "Bloom Upsample");
 		settings.LOD = float(m_MipLevels - 2);
 		settings.Mode = UpsampleFirst;
 		cmd.PushConstants(settings);
@@ -202,6 +218,7 @@ namespace blaze
 			cmd.BindDescriptorSet(m_DescriptorSets[counter++]);
 			cmd.Dispatch(glm::ceil((glm::vec2)m_Buffers[2].image.GetMipSize(currentMip) / glm::vec2(m_ComputeWorkGroupSize)));
 		}
+		gpuProfiler.EndZone(cmd, zone);
 	}
 
 	void BloomPass::DestroyImages()
@@ -411,77 +428,133 @@ namespace blaze
 			vkCreateRenderPass(VulkanContext::GetLogicalDevice(), &renderPassInfo, VulkanContext::GetAllocator(), &m_RenderPass);
 		}
 
-		VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		m_Shader.Create(GetShaderCreateInfo());
 
 		{
-			VkDescriptorBindingFlags flags[1];
-			memset(flags, 0, sizeof(VkDescriptorBindingFlags) * (std::size(flags) - 1));
-			flags[std::size(flags) - 1] = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
-
-			wc::ShaderCreateInfo createInfo = {
-				.renderPass = m_RenderPass,
-				.bindingFlags = flags,
-				.bindingFlagCount = (uint32_t)std::size(flags),
-
-				.depthTest = true,
-				.dynamicDescriptorCount = true,
+			TextureCapacity = glm::min(m_Shader.DynamicDescriptorCount, MAX_TEXTURES);
+
+			VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, TextureCapacity };
+			VkDescriptorPoolCreateInfo poolInfo = {
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+				.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+				.maxSets = 1,
+				.poolSizeCount = 1,
+				.pPoolSizes = &poolSize,
+			};
+			vkCreateDescriptorPool(VulkanContext::GetLogicalDevice(), &poolInfo, VulkanContext::GetAllocator(), &m_TexturePool);
 
-				.dynamicState = dynamicStates,
-				.dynamicStateCount = std::size(dynamicStates),
+			VkDescriptorSetVariableDescriptorCountAllocateInfo setCounts = {
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
+				.descriptorSetCount = 1,
+				.pDescriptorCounts = &TextureCapacity,
 			};
-			createInfo.blendAttachments.push_back(wc::CreateBlendAttachment());
-			createInfo.blendAttachments.push_back(wc::CreateBlendAttachment(false));
-			wc::ReadBinary("assets/shaders/Renderer2D.vert", createInfo.binaries[0]);
-			wc::ReadBinary("assets/shaders/Renderer2D.frag", createInfo.binaries[1]);
 
-			m_Shader.Create(createInfo);
+			VkDescriptorSetAllocateInfo allocInfo = {
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+				.pNext = &setCounts,
+				.descriptorPool = m_TexturePool,
+				.descriptorSetCount = 1,
+				.pSetLayouts = &m_Shader.DescriptorLayout,
+			};
+			vkAllocateDescriptorSets(VulkanContext::GetLogicalDevice(), &allocInfo, &m_DescriptorSet);
 		}
 
-		{
-			wc::ShaderCreateInfo createInfo = {
-				.renderPass = m_RenderPass,
+		m_LineShader.Create(GetLineShaderCreateInfo());
+	}
 
-				.depthTest = true,
+	wc::ShaderCreateInfo Renderer2D::GetShaderCreateInfo()
+	{
+		// Update after bind lets new textures be written while previous frames that use the set are still in flight
+		static VkDescriptorBindingFlags flags[] = { VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT };
 
-				.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+		wc::ShaderCreateInfo createInfo = {
+			.renderPass = m_RenderPass,
+			.bindingFlags = flags,
+			.bindingFlagCount = (uint32_t)std::size(flags),
 
-				.dynamicState = dynamicStates,
-				.dynamicStateCount = std::size(dynamicStates),
-			};
-			createInfo.blendAttachments.push_back(wc::CreateBlendAttachment());
-			createInfo.blendAttachments.push_back(wc::CreateBlendAttachment(false));
-			wc::ReadBinary("assets/shaders/Line.vert", createInfo.binaries[0]);
-			wc::ReadBinary("assets/shaders/Line.frag", createInfo.binaries[1]);
+			.depthTest = true,
+			.dynamicDescriptorCount = true,
+			.updateAfterBind = true,
 
-			m_LineShader.Create(createInfo);
-		}
+			.dynamicState = s_DynamicStates,
+			.dynamicStateCount = std::size(s_DynamicStates),
+		};
+		createInfo.blendAttachments.push_back(wc::CreateBlendAttachment());
+		createInfo.blendAttachments.push_back(wc::CreateBlendAttachment(false));
+		wc::ReadBinary("assets/shaders/Renderer2D.vert", createInfo.binaries[0]);
+		wc::ReadBinary("assets/shaders/Renderer2D.frag", createInfo.binaries[1]);
+		return createInfo;
 	}
 
-	void Renderer2D::AllocateNewDescriptor(uint32_t count)
+	wc::ShaderCreateInfo Renderer2D::GetLineShaderCreateInfo()
 	{
-		TextureCapacity = count;
+		wc::ShaderCreateInfo createInfo = {
+			.renderPass = m_RenderPass,
 
-		if (m_DescriptorSet)
-			vk::descriptorAllocator.Free(m_DescriptorSet);
+			.depthTest = true,
 
-		VkDescriptorSetVariableDescriptorCountAllocateInfo set_counts = {
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO,
-			.descriptorSetCount = 1,
-			.pDescriptorCounts = &count,
+			.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+
+			.dynamicState = s_DynamicStates,
+			.dynamicStateCount = std::size(s_DynamicStates),
 		};
-		vk::descriptorAllocator.Allocate(m_DescriptorSet, m_Shader.DescriptorLayout, &set_counts, set_counts.descriptorSetCount);
+		createInfo.blendAttachments.push_back(wc::CreateBlendAttachment());
+		createInfo.blendAttachments.push_back(wc::CreateBlendAttachment(false));
+		wc::ReadBinary("assets/shaders/Line.vert", createInfo.binaries[0]);
+		wc::ReadBinary("assets/shaders/Line.frag", createInfo.binaries[1]);
+		return createInfo;
 	}
 
-	void Renderer2D::UpdateTextures(const AssetManager& assetManager)
+	bool Renderer2D::ReloadShader(const std::string& filepath)
 	{
-		vk::DescriptorWriter writer(m_DescriptorSet);
+		wc::InvalidateBinary(filepath);
+
+		std::filesystem::path path = filepath;
+		std::string name = path.stem().string();
+		std::string extension = path.extension().string();
+
+		bool reloaded = false;
+		if (name == "Renderer2D") reloaded = m_Shader.Reload(GetShaderCreateInfo());
+		else if (name == "Line") reloaded = m_LineShader.Reload(GetLineShaderCreateInfo());
+		else if (extension == ".comp")
+		{
+			wc::Shader* shader = nullptr;
+			if (name == "bloom") shader = &bloom.m_Shader;
+			else if (name == "composite") shader = &composite.m_Shader;
+			else if (name == "crt") shader = &crt.m_Shader;
 
-		std::vector<VkDescriptorImageInfo> infos;
-		for (auto& image : assetManager.Textures)
-			infos.emplace_back(image.sampler, image.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			if (shader) reloaded = shader->Reload(wc::ComputeShaderCreateInfo(filepath));
+		}
+
+		if (reloaded) WC_CORE_INFO("Reloaded {}", filepath);
+		return reloaded;
+	}
 
-		writer.BindImages(0, infos, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	void Renderer2D::UpdateTextures(AssetManager& assetManager)
+	{
+		auto& dirty = assetManager.DirtyTextures;
+		if (dirty.empty()) return;
+
+		std::sort(dirty.begin(), dirty.end());
+		dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+		vk::DescriptorWriter writer(m_DescriptorSet);
+		for (uint32_t id : dirty)
+		{
+			if (id >= TextureCapacity)
+			{
+				WC_CORE_ERROR("Texture {} doesn't fit in the texture table ({} slots)", id, TextureCapacity);
+				continue;
+			}
+
+			// Freed slots point to the white texture so stale IDs never reference a destroyed image
+			const auto& texture = assetManager.Textures[id].view ? assetManager.Textures[id] : assetManager.Textures[0];
+			writer.BindImage(0, id, { texture.sampler, texture.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+		}
 		writer.Update();
+
+		dirty.clear();
 	}
 
 	void Renderer2D::CreateScreen(glm::vec2 size)
@@ -631,6 +704,10 @@ namespace blaze
 		m_Shader.Destroy();
 		m_LineShader.Destroy();
 
+		vkDestroyDescriptorPool(VulkanContext::GetLogicalDevice(), m_TexturePool, VulkanContext::GetAllocator());
+		m_TexturePool = VK_NULL_HANDLE;
+		m_DescriptorSet = VK_NULL_HANDLE;
+
 		DestroyScreen();
 
 		vkDestroyRenderPass(VulkanContext::GetLogicalDevice(), m_RenderPass, VulkanContext::GetAllocator());
@@ -639,6 +716,9 @@ namespace blaze
 
 	void Renderer2D::Flush(RenderData& renderData, const glm::mat4& viewProj)
 	{
+		WC_PROFILE_FUNCTION();
+		WC_PROFILE_COUNTER("Indices", renderData.GetIndexCount());
+		WC_PROFILE_COUNTER("Line vertices", renderData.GetLineVertexCount());
 		//if (!m_IndexCount && !m_LineVertexCount) return;
 
 		{
@@ -651,6 +731,8 @@ namespace blaze
 			};
 
 			vkBeginCommandBuffer(cmd, &begInfo);
+			uint32_t zone = gpuProfiler.BeginZone(cmd, "Renderer2D");
+
 			VkRenderPassBeginInfo rpInfo = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
 
 			rpInfo.renderPass = m_RenderPass;
@@ -720,6 +802,7 @@ namespace blaze
 
 
 			vkCmdEndRenderPass(cmd);
+			gpuProfiler.EndZone(cmd, zone);
 			vkEndCommandBuffer(cmd);
 
 			vk::SyncContext::Submit(cmd, vk::SyncContext::GetGraphicsQueue());
@@ -727,11 +810,62 @@ namespace blaze
 
 		{
 			wc::CommandEncoder cmd;
-			bloom.Execute(cmd);
-			composite.Execute(cmd, m_RenderSize);
-			crt.Execute(cmd, m_RenderSize, 0.f);
+			{
+				GPUZone zone(cmd, "Bloom");
+				bloom.Execute(cmd);
+			}
+			{
+				GPUZone zone(cmd, "Composite");
+				composite.Execute(cmd, m_RenderSize);
+			}
+			{
+				GPUZone zone(cmd, "CRT");
+				crt.Execute(cmd, m_RenderSize, 0.f);
+			}
 
 			cmd.ExecuteCompute(m_ComputeCmd[CURRENT_FRAME]);
 		}
 	}
-}
\ No newline at end of file
+
+	void Renderer2D::ReadOutput(Image& image, bool postProcessed)
+	{
+		vk::Image& source = postProcessed ? m_FinalImage[0] : m_OutputImage; // Both are left in GENERAL
+		uint32_t width = source.width;
+		uint32_t height = source.height;
+
+		vk::StagingBuffer stagingBuffer;
+		stagingBuffer.Allocate(width * height * sizeof(glm::vec4), VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+
+		VulkanContext::GetLogicalDevice().WaitIdle(); // The compute queue could still be writing to it
+
+		vk::SyncContext::ImmediateSubmit([&](VkCommandBuffer cmd) {
+			source.SetLayout(cmd, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+			VkBufferImageCopy copyRegion = {
+				.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.imageSubresource.layerCount = 1,
+				.imageExtent = {
+					.width = width,
+					.height = height,
+					.depth = 1
+				},
+			};
+			vkCmdCopyImageToBuffer(cmd, source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &copyRegion);
+
+			source.SetLayout(cmd, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+			});
+
+		image.Init(malloc(width * height * 4), width, height, 4); // @NOTE: malloc because Image::Free uses free
+		const glm::vec4* pixels = (const glm::vec4*)stagingBuffer.Map();
+		for (uint32_t i = 0; i < width * height; i++)
+		{
+			glm::vec4 color = glm::clamp(pixels[i], 0.f, 1.f) * 255.f + 0.5f;
+			image.Data[i * 4 + 0] = (uint8_t)color.r;
+			image.Data[i * 4 + 1] = (uint8_t)color.g;
+			image.Data[i * 4 + 2] = (uint8_t)color.b;
+			image.Data[i * 4 + 3] = (uint8_t)color.a;
+		}
+		stagingBuffer.Unmap();
+		stagingBuffer.Free();
+	}
+}
@@ -10,6 +10,8 @@
 
 namespace blaze
 {
+	struct Image;
+
 	inline uint32_t m_ComputeWorkGroupSize = 4; // @TODO: REMOVE!!!?
 
 	struct BloomPass
@@ -90,7 +92,9 @@ namespace blaze
 
 		wc::Shader m_Shader;
 		VkDescriptorSet m_DescriptorSet;
+		VkDescriptorPool m_TexturePool = VK_NULL_HANDLE; // Update after bind pool, owns only m_DescriptorSet
 		uint32_t TextureCapacity = 0;
+		static constexpr uint32_t MAX_TEXTURES = 1 << 16; // The device limit is often in the millions, this keeps the pool small
 
 		wc::Shader m_LineShader;
 
@@ -118,9 +122,12 @@ namespace blaze
 
 		void Init();
 
-		void AllocateNewDescriptor(uint32_t count);
+		// Rebuilds the pipelines that use the shader binary at `filepath` (assets/shaders/...), returns false if none does.
+		// The device has to be idle
+		bool ReloadShader(const std::string& filepath);
 
-		void UpdateTextures(const AssetManager& assetManager);
+		// Writes the dirty slots of the bindless texture table, the set is allocated once in Init and never resized
+		void UpdateTextures(AssetManager& assetManager);
 
 		void CreateScreen(glm::vec2 size);
 
@@ -131,5 +138,13 @@ namespace blaze
 		void Deinit();
 
 		void Flush(RenderData& renderData, const glm::mat4& viewProj);
+
+		// Copies the final (post processed) image, or the main pass output, to the CPU as RGBA8. Waits for the device to be idle
+		void ReadOutput(Image& image, bool postProcessed = true);
+
+	private:
+		// Shared by Init and ReloadShader, reads the binaries
+		wc::ShaderCreateInfo GetShaderCreateInfo();
+		wc::ShaderCreateInfo GetLineShaderCreateInfo();
 	};
 }
@@ -2,10 +2,71 @@
 #include <spirv_cross/spirv_cross.hpp>
 #include "../Utils/Log.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace wc
 {
+	namespace
+	{
+		std::mutex s_BinaryCacheMutex;
+		std::unordered_map<std::string, std::vector<uint32_t>> s_BinaryCache;
+
+		bool IsSpirV(const std::vector<uint32_t>& binary) { return binary.size() > 5 && binary[0] == spv::MagicNumber; }
+
+		// Execution model of the first entry point, maps to the stage bit the same way as in the reflection
+		VkShaderStageFlagBits GetStage(const std::vector<uint32_t>& binary)
+		{
+			for (size_t i = 5; i < binary.size();)
+			{
+				uint32_t wordCount = binary[i] >> 16;
+				if ((binary[i] & 0xFFFF) == spv::OpEntryPoint && i + 1 < binary.size()) return VkShaderStageFlagBits(1 << binary[i + 1]);
+				if (wordCount == 0) break;
+				i += wordCount;
+			}
+
+			return VK_SHADER_STAGE_VERTEX_BIT;
+		}
+	}
+
+	void PrefetchBinaries(const std::string& directory)
+	{
+		if (!std::filesystem::is_directory(directory)) return;
+
+		for (const auto& entry : std::filesystem::directory_iterator(directory))
+		{
+			if (!entry.is_regular_file()) continue;
+
+			std::ifstream file(entry.path(), std::ios::ate | std::ios::binary);
+			if (!file.is_open()) continue;
+
+			std::vector<uint32_t> buffer((size_t)file.tellg() / sizeof(uint32_t));
+			file.seekg(0);
+			file.read((char*)buffer.data(), buffer.size() * sizeof(uint32_t));
+
+			std::scoped_lock lock(s_BinaryCacheMutex);
+			s_BinaryCache[entry.path().generic_string()] = std::move(buffer);
+		}
+	}
+
+	void InvalidateBinary(const std::string& filename)
+	{
+		std::scoped_lock lock(s_BinaryCacheMutex);
+		s_BinaryCache.erase(filename);
+	}
+
 	void ReadBinary(const std::string& filename, std::vector<uint32_t>& buffer)
 	{
+		{
+			std::scoped_lock lock(s_BinaryCacheMutex);
+			auto it = s_BinaryCache.find(filename);
+			if (it != s_BinaryCache.end())
+			{
+				buffer = it->second;
+				return;
+			}
+		}
+
 		std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
 		if (!file.is_open())
@@ -61,28 +122,31 @@ namespace wc
 		DescriptorLayout = VK_NULL_HANDLE;
 	}
 
-	void Shader::Create(const ShaderCreateInfo& createInfo)
+	bool Shader::Reload(const ShaderCreateInfo& createInfo)
 	{
-		std::array<VkShaderModule, 2> shaderModules = {};
-		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {};
+		if (!IsSpirV(createInfo.binaries[0]) || !IsSpirV(createInfo.binaries[1])) return false;
 
-		for (int i = 0; i < 2; i++)
-		{
-			auto& binary = createInfo.binaries[i];
-			VkShaderModuleCreateInfo moduleCreateInfo = {
-				.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-				.codeSize = binary.size() * sizeof(uint32_t),
-				.pCode = binary.data(),
-			};
+		vkDestroyPipeline(VulkanContext::GetLogicalDevice(), Pipeline, VulkanContext::GetAllocator());
+		CreatePipeline(createInfo);
+		return true;
+	}
 
-			vkCreateShaderModule(VulkanContext::GetLogicalDevice(), &moduleCreateInfo, VulkanContext::GetAllocator(), &shaderModules[i]);
-		}
+	bool Shader::Reload(const ComputeShaderCreateInfo& createInfo)
+	{
+		if (!IsSpirV(createInfo.binary)) return false;
+
+		vkDestroyPipeline(VulkanContext::GetLogicalDevice(), Pipeline, VulkanContext::GetAllocator());
+		CreatePipeline(createInfo);
+		return true;
+	}
 
+	void Shader::Create(const ShaderCreateInfo& createInfo)
+	{
 		{ // Reflection
 			std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
 			std::vector<VkPushConstantRange> ranges;
 
-			for (uint32_t i = 0; i < shaderModules.size(); i++)
+			for (uint32_t i = 0; i < std::size(createInfo.binaries); i++)
 			{
 				spirv_cross::Compiler compiler(createInfo.binaries[i]);
 				spirv_cross::ShaderResources resources = compiler.get_shader_resources();
@@ -199,25 +263,33 @@ namespace wc
 					}
 				}
 
-				VkPipelineShaderStageCreateInfo stage = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
-
-				stage.stage = (VkShaderStageFlagBits)shaderStage;
-				stage.module = shaderModules[i];
-				stage.pName = "main";
-				shaderStages[i] = stage;
 			}
 
 			if (createInfo.dynamicDescriptorCount)
 			{
 				auto& binding = layoutBindings[layoutBindings.size() - 1];
 				auto limits = VulkanContext::GetPhysicalDevice().GetLimits();
-				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) binding.descriptorCount = glm::min(limits.maxDescriptorSetSampledImages, limits.maxPerStageDescriptorSamplers);
-				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) binding.descriptorCount = limits.maxPerStageDescriptorSamplers;
+				if (createInfo.updateAfterBind)
+				{
+					// Update after bind sets have their own (usually much higher) limits
+					VkPhysicalDeviceVulkan12Properties properties12 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+					VulkanContext::GetPhysicalDevice().QueryProperties2(&properties12);
+
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) binding.descriptorCount = glm::min(properties12.maxDescriptorSetUpdateAfterBindSampledImages, properties12.maxPerStageDescriptorUpdateAfterBindSamplers);
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) binding.descriptorCount = properties12.maxPerStageDescriptorUpdateAfterBindSamplers;
+				}
+				else
+				{
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) binding.descriptorCount = glm::min(limits.maxDescriptorSetSampledImages, limits.maxPerStageDescriptorSamplers);
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) binding.descriptorCount = limits.maxPerStageDescriptorSamplers;
+				}
 				//@TODO: add more stuff here
+				DynamicDescriptorCount = binding.descriptorCount;
 			}
 
 			VkDescriptorSetLayoutCreateInfo layoutInfo = {
 				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+				.flags = createInfo.updateAfterBind ? (VkDescriptorSetLayoutCreateFlags)VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0u,
 				.bindingCount = static_cast<uint32_t>(layoutBindings.size()),
 				.pBindings = layoutBindings.data(),
 			};
@@ -245,6 +317,33 @@ namespace wc
 			vkCreatePipelineLayout(VulkanContext::GetLogicalDevice(), &info, VulkanContext::GetAllocator(), &PipelineLayout);
 		}
 
+		CreatePipeline(createInfo);
+	}
+
+	void Shader::CreatePipeline(const ShaderCreateInfo& createInfo)
+	{
+		std::array<VkShaderModule, 2> shaderModules = {};
+		std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages = {};
+
+		for (int i = 0; i < 2; i++)
+		{
+			auto& binary = createInfo.binaries[i];
+			VkShaderModuleCreateInfo moduleCreateInfo = {
+				.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+				.codeSize = binary.size() * sizeof(uint32_t),
+				.pCode = binary.data(),
+			};
+
+			vkCreateShaderModule(VulkanContext::GetLogicalDevice(), &moduleCreateInfo, VulkanContext::GetAllocator(), &shaderModules[i]);
+
+			shaderStages[i] = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = GetStage(binary),
+				.module = shaderModules[i],
+				.pName = "main",
+			};
+		}
+
 		VkViewport viewport = {
 			.x = 0.f,
 			.y = 0.f,
@@ -442,6 +541,7 @@ namespace wc
 				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) binding.descriptorCount = glm::min(limits.maxDescriptorSetSampledImages, limits.maxPerStageDescriptorSamplers);
 				if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) binding.descriptorCount = limits.maxPerStageDescriptorSamplers;
 				//@TODO: add more stuff here
+				DynamicDescriptorCount = binding.descriptorCount;
 			}
 
 			VkDescriptorSetLayoutCreateInfo layoutInfo = {
@@ -486,6 +586,11 @@ namespace wc
 			vkCreatePipelineLayout(VulkanContext::GetLogicalDevice(), &info, VulkanContext::GetAllocator(), &PipelineLayout);
 		}
 
+		CreatePipeline(createInfo);
+	}
+
+	void Shader::CreatePipeline(const ComputeShaderCreateInfo& createInfo)
+	{
 		VkShaderModuleCreateInfo moduleCreateInfo = {
 			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
 
@@ -13,6 +13,12 @@
 
 namespace wc
 {
+	// Reads every file in `directory` into memory so later ReadBinary calls with the same path don't touch the disk, safe to call from any thread
+	void PrefetchBinaries(const std::string& directory);
+
+	// Drops the prefetched copy so the next ReadBinary goes to the disk, used when a shader was recompiled
+	void InvalidateBinary(const std::string& filename);
+
 	void ReadBinary(const std::string& filename, std::vector<uint32_t>& buffer);
 	VkPipelineColorBlendAttachmentState CreateBlendAttachment(bool enable = true);
 
@@ -32,6 +38,7 @@ namespace wc
 		VkDescriptorBindingFlags* bindingFlags = nullptr;
 		uint32_t bindingFlagCount = 0;
 		bool dynamicDescriptorCount = false;
+		bool updateAfterBind = false; // The descriptor set has to be allocated from a pool created with VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT
 
 		VkDynamicState* dynamicState = nullptr;
 		uint32_t dynamicStateCount = 0;
@@ -55,6 +62,7 @@ namespace wc
 		VkPipeline Pipeline = VK_NULL_HANDLE;
 		VkPipelineLayout PipelineLayout = VK_NULL_HANDLE;
 		VkDescriptorSetLayout DescriptorLayout = VK_NULL_HANDLE;
+		uint32_t DynamicDescriptorCount = 0; // Upper bound of the variable sized binding when dynamicDescriptorCount is set
 
 		VkDescriptorSet AllocateDescriptorSet();
 
@@ -63,5 +71,16 @@ namespace wc
 		void Create(const ShaderCreateInfo& createInfo);
 
 		void Create(const ComputeShaderCreateInfo& createInfo);
+
+		// Hot reload, only the pipeline is rebuilt. The layouts are kept so descriptor sets allocated from them stay valid,
+		// which means the new binaries have to declare the same resources. Returns false if a binary isn't SPIR-V
+		bool Reload(const ShaderCreateInfo& createInfo);
+
+		bool Reload(const ComputeShaderCreateInfo& createInfo);
+
+	private:
+		void CreatePipeline(const ShaderCreateInfo& createInfo);
+
+		void CreatePipeline(const ComputeShaderCreateInfo& createInfo);
 	};
 }
\ No newline at end of file
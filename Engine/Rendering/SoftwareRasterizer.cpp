@@ -0,0 +1,472 @@
+#include "SoftwareRasterizer.h"
+
+#include <atomic>
+#include <cfloat>
+#include <filesystem>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "AssetManager.h"
+#include "../Utils/Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WC_RASTERIZER_SSE2 1
+#include <emmintrin.h>
+#else
+#define WC_RASTERIZER_SSE2 0
+#endif
+
+namespace blaze
+{
+	namespace
+	{
+		constexpr float PX_RANGE = 2.f; // Has to match pxRange in Renderer2D.frag
+
+		float Median(float r, float g, float b) { return glm::max(glm::min(r, g), glm::min(glm::max(r, g), b)); }
+
+		glm::vec4 Fetch(const Image& image, int32_t x, int32_t y)
+		{
+			// REPEAT address mode, same as the default TextureSpecification
+			int32_t width = (int32_t)image.Width, height = (int32_t)image.Height;
+			x = ((x % width) + width) % width;
+			y = ((y % height) + height) % height;
+
+			const uint8_t* texel = image.Data + y * image.bytes_per_scanline + x * image.Channels;
+			return glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.f;
+		}
+
+		void Blend(glm::vec4& dst, const glm::vec4& src)
+		{
+			// SRC_ALPHA, ONE_MINUS_SRC_ALPHA for both color and alpha, see wc::CreateBlendAttachment
+			dst = src * src.a + dst * (1.f - src.a);
+		}
+	}
+
+	void SoftwareRasterizer::Resize(glm::uvec2 size)
+	{
+		m_Size = size;
+		m_TileCount = (size + TILE_SIZE - 1u) / TILE_SIZE;
+
+		m_Color.resize(size.x * size.y);
+		m_Depth.resize(size.x * size.y);
+		m_TriangleBins.resize(m_TileCount.x * m_TileCount.y);
+		m_LineBins.resize(m_TileCount.x * m_TileCount.y);
+	}
+
+	void SoftwareRasterizer::SyncTextures(const AssetManager& assetManager)
+	{
+		if (m_SyncedTextures < assetManager.Textures.size())
+		{
+			Textures.resize(assetManager.Textures.size(), nullptr);
+
+			std::vector<const std::string*> names(assetManager.Textures.size(), nullptr);
+			for (size_t id = 0; id < names.size(); id++)
+				if (!assetManager.GetTextureName(id).empty()) names[id] = &assetManager.GetTextureName(id);
+
+			for (uint32_t i = m_SyncedTextures; i < names.size(); i++)
+			{
+				if (!names[i] || assetManager.FontCache.contains(*names[i]) || !std::filesystem::exists(*names[i])) continue;
+
+				Image image;
+				image.Load(*names[i], 4);
+				if (!image.Data) continue;
+
+				Textures[i] = &m_LoadedImages.emplace_back(image);
+			}
+
+			m_SyncedTextures = (uint32_t)assetManager.Textures.size();
+		}
+
+		// The font vector may have been reallocated since the last sync
+		for (auto& font : assetManager.Fonts)
+			if (font.Atlas.Data && font.TextureID < Textures.size())
+				Textures[font.TextureID] = &font.Atlas;
+	}
+
+	glm::vec4 SoftwareRasterizer::SampleTexture(uint32_t textureID, glm::vec2 uv, glm::vec2& size) const
+	{
+		const Image* image = textureID < Textures.size() ? Textures[textureID] : nullptr;
+		if (!image)
+		{
+			size = { 1.f, 1.f };
+			return glm::vec4(1.f);
+		}
+
+		size = { image->Width, image->Height };
+		glm::vec2 texel = uv * size;
+
+		// Texture::Allocate picks NEAREST for small textures and LINEAR for everything else
+		if (image->Width <= 128 || image->Height <= 128)
+			return Fetch(*image, (int32_t)glm::floor(texel.x), (int32_t)glm::floor(texel.y));
+
+		texel -= 0.5f;
+		glm::vec2 base = glm::floor(texel);
+		glm::vec2 f = texel - base;
+		int32_t x = (int32_t)base.x, y = (int32_t)base.y;
+
+		return glm::mix(
+			glm::mix(Fetch(*image, x, y), Fetch(*image, x + 1, y), f.x),
+			glm::mix(Fetch(*image, x, y + 1), Fetch(*image, x + 1, y + 1), f.x),
+			f.y);
+	}
+
+	void SoftwareRasterizer::SetupPrimitives(const RenderData& renderData, const glm::mat4& viewProj)
+	{
+		const auto& vertices = renderData.GetVertices();
+		const auto& indices = renderData.GetIndices();
+		const auto& lineVertices = renderData.GetLineVertices();
+
+		m_Triangles.clear();
+		m_Lines.clear();
+		for (auto& bin : m_TriangleBins) bin.clear();
+		for (auto& bin : m_LineBins) bin.clear();
+
+		const glm::vec2 size = m_Size;
+
+		// Returns false for vertices behind the camera, those primitives are dropped instead of clipped
+		auto Project = [&](const glm::vec3& position, glm::vec2& screen, float& depth, float& invW)
+			{
+				glm::vec4 clip = viewProj * glm::vec4(position, 1.f);
+				if (clip.w <= 1e-6f) return false;
+
+				invW = 1.f / clip.w;
+				glm::vec3 ndc = glm::vec3(clip) * invW;
+				screen = (glm::vec2(ndc) * 0.5f + 0.5f) * size; // Same viewport as Renderer2D::Flush
+				depth = ndc.z;
+				return true;
+			};
+
+		auto BinBounds = [&](glm::vec2 min, glm::vec2 max, auto& bins, uint32_t index)
+			{
+				if (max.x < 0.f || max.y < 0.f || min.x >= size.x || min.y >= size.y) return;
+
+				glm::uvec2 tileMin = glm::uvec2(glm::clamp(glm::floor(min), glm::vec2(0.f), size - 1.f)) / TILE_SIZE;
+				glm::uvec2 tileMax = glm::uvec2(glm::clamp(glm::ceil(max), glm::vec2(0.f), size - 1.f)) / TILE_SIZE;
+
+				for (uint32_t ty = tileMin.y; ty <= tileMax.y; ty++)
+					for (uint32_t tx = tileMin.x; tx <= tileMax.x; tx++)
+						bins[ty * m_TileCount.x + tx].push_back(index);
+			};
+
+		m_Triangles.reserve(indices.size() / 3);
+		for (uint32_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			Triangle triangle;
+			bool visible = true;
+			for (uint32_t v = 0; v < 3; v++)
+			{
+				triangle.Vertex[v] = indices[i + v];
+				if (triangle.Vertex[v] >= vertices.size()) { visible = false; break; }
+				visible &= Project(vertices[triangle.Vertex[v]].Position, triangle.Position[v], triangle.Depth[v], triangle.InvW[v]);
+			}
+			if (!visible) continue;
+
+			const glm::vec2* p = triangle.Position;
+			float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+			if (area == 0.f) continue;
+
+			// No culling (VK_CULL_MODE_NONE), flip the edges of back facing triangles so the inside is always positive
+			float sign = area > 0.f ? 1.f : -1.f;
+			triangle.InvArea = 1.f / (area * sign);
+
+			// Edge e is opposite of vertex e
+			for (uint32_t e = 0; e < 3; e++)
+			{
+				glm::vec2 a = p[(e + 1) % 3];
+				glm::vec2 b = p[(e + 2) % 3];
+				glm::vec2 d = (b - a) * sign;
+
+				triangle.A[e] = -d.y;
+				triangle.B[e] = d.x;
+				triangle.C[e] = d.y * a.x - d.x * a.y;
+				triangle.TopLeft[e] = (d.y == 0.f && d.x > 0.f) || d.y < 0.f;
+			}
+
+			glm::vec2 min = glm::min(p[0], glm::min(p[1], p[2]));
+			glm::vec2 max = glm::max(p[0], glm::max(p[1], p[2]));
+
+			m_Triangles.push_back(triangle);
+			BinBounds(min, max, m_TriangleBins, uint32_t(m_Triangles.size() - 1));
+		}
+
+		for (uint32_t i = 0; i + 1 < lineVertices.size(); i += 2)
+		{
+			Line line;
+			float invW;
+			bool visible = true;
+			for (uint32_t v = 0; v < 2; v++)
+			{
+				line.Vertex[v] = i + v;
+				visible &= Project(lineVertices[i + v].Position, line.Position[v], line.Depth[v], invW);
+			}
+			if (!visible) continue;
+
+			m_Lines.push_back(line);
+			BinBounds(glm::min(line.Position[0], line.Position[1]), glm::max(line.Position[0], line.Position[1]), m_LineBins, uint32_t(m_Lines.size() - 1));
+		}
+	}
+
+	void SoftwareRasterizer::ShadePixel(const RenderData& renderData, const Triangle& triangle, uint32_t x, uint32_t y)
+	{
+		const auto& vertices = renderData.GetVertices();
+		const Vertex& v0 = vertices[triangle.Vertex[0]];
+		const Vertex& v1 = vertices[triangle.Vertex[1]];
+		const Vertex& v2 = vertices[triangle.Vertex[2]];
+
+		// Screen space barycentrics for depth, perspective correct ones for the attributes
+		auto Barycentrics = [&](float px, float py, glm::vec3& linear)
+			{
+				linear = (triangle.A * px + triangle.B * py + triangle.C) * triangle.InvArea;
+				glm::vec3 perspective = linear * glm::vec3(triangle.InvW[0], triangle.InvW[1], triangle.InvW[2]);
+				return perspective / (perspective.x + perspective.y + perspective.z);
+			};
+
+		float px = float(x) + 0.5f, py = float(y) + 0.5f;
+		glm::vec3 linear;
+		glm::vec3 l = Barycentrics(px, py, linear);
+
+		float depth = linear.x * triangle.Depth[0] + linear.y * triangle.Depth[1] + linear.z * triangle.Depth[2];
+		uint32_t index = y * m_Size.x + x;
+		if (depth < 0.f || depth > 1.f || depth > m_Depth[index]) return; // LESS_OR_EQUAL
+
+		auto Interpolate = [&](const glm::vec3& w, auto member) { return v0.*member * w.x + v1.*member * w.y + v2.*member * w.z; };
+
+		glm::vec2 texCoords = Interpolate(l, &Vertex::TexCoords);
+		glm::vec4 vertexColor = Interpolate(l, &Vertex::Color);
+		float fade = Interpolate(l, &Vertex::Fade);
+		float thickness = Interpolate(l, &Vertex::Thickness);
+
+		glm::vec2 textureSize;
+		glm::vec4 textureColor = SampleTexture(v0.TextureID, texCoords, textureSize); // TextureID is flat, first vertex provokes
+		glm::vec4 color = textureColor * vertexColor;
+
+		if (thickness > 0.f)
+		{
+			float dist = 1.f - glm::length(texCoords);
+			float alpha = glm::smoothstep(0.f, fade, dist) * glm::smoothstep(thickness + fade, thickness, dist);
+
+			color = vertexColor;
+			color.a = alpha * vertexColor.a;
+		}
+		else if (thickness < 0.f)
+		{
+			// fwidth() from the neighbouring pixels
+			glm::vec3 unused;
+			glm::vec2 dx = Interpolate(Barycentrics(px + 1.f, py, unused), &Vertex::TexCoords) - texCoords;
+			glm::vec2 dy = Interpolate(Barycentrics(px, py + 1.f, unused), &Vertex::TexCoords) - texCoords;
+			glm::vec2 fwidth = glm::abs(dx) + glm::abs(dy);
+
+			glm::vec2 unitRange = glm::vec2(PX_RANGE) / textureSize;
+			glm::vec2 screenTexSize = 1.f / glm::max(fwidth, glm::vec2(1e-8f));
+			float screenPxRange = glm::max(0.5f * glm::dot(unitRange, screenTexSize), 1.f);
+
+			float sd = Median(textureColor.r, textureColor.g, textureColor.b);
+			float opacity = glm::clamp(screenPxRange * (sd - 0.5f) + 0.5f, 0.f, 1.f);
+			if (opacity == 0.f) return;
+
+			color = glm::mix(glm::vec4(0.f), vertexColor, opacity);
+		}
+
+		if (color.a <= 0.f) return;
+
+		Blend(m_Color[index], color);
+		m_Depth[index] = depth;
+	}
+
+	void SoftwareRasterizer::ShadeLinePixel(const RenderData& renderData, const Line& line, float t, uint32_t x, uint32_t y)
+	{
+		const auto& vertices = renderData.GetLineVertices();
+
+		float depth = glm::mix(line.Depth[0], line.Depth[1], t);
+		uint32_t index = y * m_Size.x + x;
+		if (depth < 0.f || depth > 1.f || depth > m_Depth[index]) return;
+
+		Blend(m_Color[index], glm::mix(vertices[line.Vertex[0]].Color, vertices[line.Vertex[1]].Color, t));
+		m_Depth[index] = depth;
+	}
+
+	void SoftwareRasterizer::RasterizeTile(const RenderData& renderData, uint32_t tileIndex)
+	{
+		glm::uvec2 tileMin = glm::uvec2(tileIndex % m_TileCount.x, tileIndex / m_TileCount.x) * TILE_SIZE;
+		glm::uvec2 tileMax = glm::min(tileMin + TILE_SIZE, m_Size); // exclusive
+
+		for (uint32_t y = tileMin.y; y < tileMax.y; y++)
+			for (uint32_t x = tileMin.x; x < tileMax.x; x++)
+			{
+				m_Color[y * m_Size.x + x] = ClearColor;
+				m_Depth[y * m_Size.x + x] = 1.f;
+			}
+
+		for (uint32_t triangleIndex : m_TriangleBins[tileIndex])
+		{
+			const Triangle& triangle = m_Triangles[triangleIndex];
+
+			glm::vec2 min = glm::min(triangle.Position[0], glm::min(triangle.Position[1], triangle.Position[2]));
+			glm::vec2 max = glm::max(triangle.Position[0], glm::max(triangle.Position[1], triangle.Position[2]));
+
+			glm::uvec2 start = glm::max(glm::ivec2(glm::floor(min)), glm::ivec2(tileMin));
+			glm::uvec2 end = glm::min(glm::ivec2(glm::ceil(max)), glm::ivec2(tileMax)); // exclusive
+
+			for (uint32_t y = start.y; y < end.y; y++)
+			{
+				float py = float(y) + 0.5f;
+#if WC_RASTERIZER_SSE2
+				// Coverage for 4 pixels at a time, shading stays scalar
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+				__m128 rowValue[3], stepX[3];
+				for (uint32_t e = 0; e < 3; e++)
+				{
+					rowValue[e] = _mm_set1_ps(triangle.B[e] * py + triangle.C[e]);
+					stepX[e] = _mm_set1_ps(triangle.A[e]);
+				}
+
+				for (uint32_t x = start.x; x < end.x; x += 4)
+				{
+					__m128 px = _mm_add_ps(_mm_set1_ps(float(x)), laneOffsets);
+
+					int mask = 0xF;
+					for (uint32_t e = 0; e < 3; e++)
+					{
+						__m128 w = _mm_add_ps(_mm_mul_ps(stepX[e], px), rowValue[e]);
+						__m128 inside = _mm_cmpgt_ps(w, zero);
+						if (triangle.TopLeft[e]) inside = _mm_or_ps(inside, _mm_cmpeq_ps(w, zero));
+						mask &= _mm_movemask_ps(inside);
+					}
+
+					for (uint32_t lane = 0; lane < 4; lane++)
+						if ((mask & (1 << lane)) && x + lane < end.x)
+							ShadePixel(renderData, triangle, x + lane, y);
+				}
+#else
+				for (uint32_t x = start.x; x < end.x; x++)
+				{
+					float px = float(x) + 0.5f;
+
+					bool inside = true;
+					for (uint32_t e = 0; e < 3; e++)
+					{
+						float w = triangle.A[e] * px + triangle.B[e] * py + triangle.C[e];
+						inside &= w > 0.f || (w == 0.f && triangle.TopLeft[e]);
+					}
+
+					if (inside) ShadePixel(renderData, triangle, x, y);
+				}
+#endif
+			}
+		}
+
+		// Lines are drawn after the triangles, same as in Renderer2D::Flush
+		for (uint32_t lineIndex : m_LineBins[tileIndex])
+		{
+			const Line& line = m_Lines[lineIndex];
+			glm::vec2 delta = line.Position[1] - line.Position[0];
+			uint32_t steps = (uint32_t)glm::ceil(glm::max(glm::abs(delta.x), glm::abs(delta.y)));
+
+			for (uint32_t i = 0; i <= steps; i++)
+			{
+				float t = steps ? float(i) / float(steps) : 0.f;
+				glm::vec2 p = glm::floor(line.Position[0] + delta * t);
+				if (p.x < tileMin.x || p.y < tileMin.y || p.x >= tileMax.x || p.y >= tileMax.y) continue;
+
+				ShadeLinePixel(renderData, line, t, (uint32_t)p.x, (uint32_t)p.y);
+			}
+		}
+	}
+
+	void SoftwareRasterizer::Render(const RenderData& renderData, const glm::mat4& viewProj)
+	{
+		WC_PROFILE_FUNCTION();
+		if (m_Size.x == 0 || m_Size.y == 0) return;
+
+		SetupPrimitives(renderData, viewProj);
+
+		uint32_t tileCount = m_TileCount.x * m_TileCount.y;
+		uint32_t threadCount = ThreadCount ? ThreadCount : glm::max(std::thread::hardware_concurrency(), 1u);
+		threadCount = glm::min(threadCount, tileCount);
+
+		std::atomic<uint32_t> nextTile = 0;
+		auto Worker = [&]()
+			{
+				for (uint32_t tile = nextTile++; tile < tileCount; tile = nextTile++)
+					RasterizeTile(renderData, tile);
+			};
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount - 1);
+		for (uint32_t i = 1; i < threadCount; i++)
+			threads.emplace_back(Worker);
+
+		Worker();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void SoftwareRasterizer::RenderThumbnail(const RenderData& renderData, uint32_t size, Image& image)
+	{
+		glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+		for (const auto& vertex : renderData.GetVertices())
+		{
+			min = glm::min(min, vertex.Position);
+			max = glm::max(max, vertex.Position);
+		}
+		for (const auto& vertex : renderData.GetLineVertices())
+		{
+			min = glm::min(min, vertex.Position);
+			max = glm::max(max, vertex.Position);
+		}
+
+		glm::mat4 viewProj(1.f);
+		if (min.x <= max.x)
+		{
+			glm::vec2 center = (glm::vec2(min) + glm::vec2(max)) * 0.5f;
+			float halfSize = glm::max(max.x - min.x, max.y - min.y) * 0.55f + 1e-3f; // Small margin
+
+			viewProj = glm::ortho(center.x - halfSize, center.x + halfSize, center.y - halfSize, center.y + halfSize);
+			viewProj[1][1] *= -1.f; // Same flip as EditorCamera
+
+			// Map [min.z, max.z] to [1, 0] so entities closer to the camera win, like with the editor camera
+			float depthRange = glm::max(max.z - min.z, 1e-3f);
+			viewProj[2][2] = -1.f / depthRange;
+			viewProj[3][2] = max.z / depthRange;
+		}
+
+		Resize({ size, size });
+		Render(renderData, viewProj);
+		ReadOutput(image);
+	}
+
+	void SoftwareRasterizer::ReadOutput(Image& image) const
+	{
+		image.Init(malloc(m_Size.x * m_Size.y * 4), m_Size.x, m_Size.y, 4); // @NOTE: malloc because Image::Free uses free
+		for (uint32_t i = 0; i < m_Size.x * m_Size.y; i++)
+		{
+			glm::vec4 color = glm::clamp(m_Color[i], 0.f, 1.f) * 255.f + 0.5f;
+			image.Data[i * 4 + 0] = (uint8_t)color.r;
+			image.Data[i * 4 + 1] = (uint8_t)color.g;
+			image.Data[i * 4 + 2] = (uint8_t)color.b;
+			image.Data[i * 4 + 3] = (uint8_t)color.a;
+		}
+	}
+
+	void SoftwareRasterizer::Free()
+	{
+		for (auto& image : m_LoadedImages)
+			stbi_image_free(image.Data);
+
+		m_LoadedImages.clear();
+		Textures.clear();
+		m_SyncedTextures = 0;
+
+		m_Color.clear();
+		m_Depth.clear();
+		m_Triangles.clear();
+		m_Lines.clear();
+		m_TriangleBins.clear();
+		m_LineBins.clear();
+		m_Size = m_TileCount = { 0, 0 };
+	}
+}
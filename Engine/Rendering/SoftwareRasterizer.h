@@ -0,0 +1,94 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "RenderData.h"
+#include "../Utils/Image.h"
+
+namespace blaze
+{
+	struct AssetManager;
+
+	// CPU reference implementation of the Renderer2D main pass (Renderer2D.vert/frag + Line.vert/frag), used to
+	// validate the Vulkan output and to render thumbnails on machines without a GPU. The output matches
+	// Renderer2D::m_OutputImage, post processing (bloom, composite, CRT) is not emulated.
+	//
+	// Triangles are binned into TILE_SIZE x TILE_SIZE tiles which are rasterized in parallel, every tile processes
+	// its triangles in submission order so depth testing and blending behave like on the GPU.
+	struct SoftwareRasterizer
+	{
+		static constexpr uint32_t TILE_SIZE = 64;
+
+		uint32_t ThreadCount = 0; // 0 uses every hardware thread
+		glm::vec4 ClearColor = { 0.f, 0.f, 0.f, 1.f };
+
+		// RGBA8 images indexed by texture ID, missing entries sample as white
+		std::vector<const Image*> Textures;
+
+		void Resize(glm::uvec2 size);
+
+		// Loads the CPU copies of every texture the asset manager knows about that isn't loaded yet.
+		// Font atlases are referenced directly, so this should be called again after loading fonts
+		void SyncTextures(const AssetManager& assetManager);
+
+		void Render(const RenderData& renderData, const glm::mat4& viewProj);
+
+		// Frames everything in `renderData` with an orthographic projection and renders it at size x size
+		void RenderThumbnail(const RenderData& renderData, uint32_t size, Image& image);
+
+		// Converts the output to RGBA8, same as Renderer2D::ReadOutput
+		void ReadOutput(Image& image) const;
+
+		glm::uvec2 GetSize() const { return m_Size; }
+
+		void Free();
+
+	private:
+		struct Triangle
+		{
+			glm::vec2 Position[3]; // pixels
+			float Depth[3];
+			float InvW[3];
+			uint32_t Vertex[3];
+
+			// Edge functions, E(x, y) = A * x + B * y + C
+			glm::vec3 A, B, C;
+			bool TopLeft[3];
+			float InvArea;
+		};
+
+		struct Line
+		{
+			glm::vec2 Position[2];
+			float Depth[2];
+			uint32_t Vertex[2];
+		};
+
+		void SetupPrimitives(const RenderData& renderData, const glm::mat4& viewProj);
+
+		void RasterizeTile(const RenderData& renderData, uint32_t tileIndex);
+
+		void ShadePixel(const RenderData& renderData, const Triangle& triangle, uint32_t x, uint32_t y);
+
+		void ShadeLinePixel(const RenderData& renderData, const Line& line, float t, uint32_t x, uint32_t y);
+
+		glm::vec4 SampleTexture(uint32_t textureID, glm::vec2 uv, glm::vec2& size) const;
+
+		glm::uvec2 m_Size = { 0, 0 };
+		glm::uvec2 m_TileCount = { 0, 0 };
+
+		std::vector<glm::vec4> m_Color;
+		std::vector<float> m_Depth;
+
+		std::vector<Triangle> m_Triangles;
+		std::vector<Line> m_Lines;
+		std::vector<std::vector<uint32_t>> m_TriangleBins;
+		std::vector<std::vector<uint32_t>> m_LineBins;
+
+		std::deque<Image> m_LoadedImages; // Owned by the rasterizer, Textures points into these or into font atlases
+		uint32_t m_SyncedTextures = 0;
+	};
+}
@@ -1,9 +1,31 @@
 #include "Texture.h"
+#include <algorithm>
+
 #include <stb_image/stb_image.h>
 #include "vk/SyncContext.h"
 
 namespace blaze
 {
+	size_t GetImageSize(VkFormat format, uint32_t width, uint32_t height)
+	{
+		size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+		switch (format)
+		{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return blocks * 8;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return blocks * 16;
+		case VK_FORMAT_R8_UNORM:
+			return size_t(width) * height;
+		default:
+			return size_t(width) * height * 4;
+		}
+	}
+
+	bool IsBlockCompressed(VkFormat format) { return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK; }
+
 	void Texture::Allocate(const TextureSpecification& specification)
 	{
 		vk::ImageSpecification imageSpecification =
@@ -13,7 +35,7 @@ namespace blaze
 			.width = specification.width,
 			.height = specification.height,
 
-			.mipLevels = specification.mipMapping ? vk::GetMipLevelCount(glm::vec2(specification.width, specification.height)) : 1,
+			.mipLevels = specification.mipLevels ? specification.mipLevels : specification.mipMapping ? vk::GetMipLevelCount(glm::vec2(specification.width, specification.height)) : 1,
 			.usage = specification.usage,
 		};
 
@@ -31,17 +53,22 @@ namespace blaze
 			.mipmapMode = specification.mipmapMode,
 		};
 
-		if (specification.mipMapping && VulkanContext::GetPhysicalDevice().GetFeatures().samplerAnisotropy)
+		if (image.mipLevels > 1 && VulkanContext::GetPhysicalDevice().GetFeatures().samplerAnisotropy)
 		{
 			samplerSpec.anisotropyEnable = true;
 			samplerSpec.maxAnisotropy = VulkanContext::GetPhysicalDevice().GetLimits().maxSamplerAnisotropy;
 		}
 
-		sampler.Create(samplerSpec);
+		sampler = vk::samplerCache.Acquire(samplerSpec);
 		imageID = MakeImGuiDescriptor(imageID, { .sampler = sampler, .imageView = view, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
 	}
 
 	void Texture::Allocate(uint32_t width, uint32_t height, bool mipMapping)
+	{
+		Allocate(GetSpecification(width, height, mipMapping));
+	}
+
+	TextureSpecification Texture::GetSpecification(uint32_t width, uint32_t height, bool mipMapping)
 	{
 		TextureSpecification texSpec = {
 			.width = width,
@@ -61,7 +88,15 @@ namespace blaze
 			texSpec.minFilter = vk::Filter::LINEAR;
 			texSpec.mipmapMode = vk::SamplerMipmapMode::LINEAR;
 		}
-		Allocate(texSpec);
+		return texSpec;
+	}
+
+	size_t Texture::GetMemorySize() const
+	{
+		size_t size = 0;
+		for (uint32_t i = 0; i < image.mipLevels; i++)
+			size += GetImageSize(image.format, std::max(image.width >> i, 1u), std::max(image.height >> i, 1u));
+		return size;
 	}
 
 	void Texture::Load(const void* data, uint32_t width, uint32_t height, bool mipMapping)
@@ -86,6 +121,58 @@ namespace blaze
 		stbi_image_free(data);
 	}
 
+	bool Texture::Load(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, size_t size, const std::function<bool(void* staging)>& write)
+	{
+		vk::StagingBuffer stagingBuffer;
+		stagingBuffer.Allocate(size);
+		bool written = write(stagingBuffer.Map());
+		stagingBuffer.Unmap();
+
+		if (!written)
+		{
+			stagingBuffer.Free();
+			return false;
+		}
+
+		TextureSpecification specification = GetSpecification(width, height, mipLevels > 1);
+		specification.format = format;
+		specification.mipLevels = mipLevels;
+		specification.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		Allocate(specification);
+
+		std::vector<VkBufferImageCopy> regions(mipLevels);
+		VkDeviceSize offset = 0;
+		for (uint32_t i = 0; i < mipLevels; i++)
+		{
+			uint32_t mipWidth = std::max(width >> i, 1u), mipHeight = std::max(height >> i, 1u);
+			regions[i] = {
+				.bufferOffset = offset,
+				.imageSubresource = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = i,
+					.layerCount = 1,
+				},
+				.imageExtent = { mipWidth, mipHeight, 1 },
+			};
+			offset += GetImageSize(format, mipWidth, mipHeight);
+		}
+
+		VkImageSubresourceRange subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.levelCount = mipLevels,
+			.layerCount = 1,
+		};
+
+		vk::SyncContext::ImmediateSubmit([&](VkCommandBuffer cmd) {
+			image.SetLayout(cmd, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+			vkCmdCopyBufferToImage(cmd, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+			image.SetLayout(cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+			});
+
+		stagingBuffer.Free();
+		return true;
+	}
+
 	void Texture::SetData(const void* data, uint32_t width, uint32_t height, uint32_t offsetX, uint32_t offsetY, bool mipMapping)
 	{
 		VkDeviceSize imageSize = width * height * 4;
@@ -231,13 +318,13 @@ namespace blaze
 	{
 		image.Destroy();
 		view.Destroy();
-		sampler.Destroy();
+		vk::samplerCache.Release(sampler);
+		sampler = VK_NULL_HANDLE;
 	}
 
 	void Texture::SetName(const std::string& name)
 	{
 		view.SetName(name + "_view");
-		sampler.SetName(name + "_sampler");
 		image.SetName(name + "_image");
 	}
 }
\ No newline at end of file
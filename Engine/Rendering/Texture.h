@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include "../imgui_backend/imgui_impl_vulkan.h"
 #include "vk/Image.h"
 
@@ -13,6 +14,7 @@ namespace blaze
 		uint32_t                 width = 1;
 		uint32_t                 height = 1;
         bool                     mipMapping = false;
+        uint32_t                 mipLevels = 0; // Overrides mipMapping when set
 		VkImageUsageFlags        usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
 
         // Sampler
@@ -24,6 +26,12 @@ namespace blaze
 		vk::SamplerAddressMode    addressModeW = vk::SamplerAddressMode::REPEAT;
     };
 
+    // Size of one tightly packed mip level, block compressed formats round up to whole 4x4 blocks
+    size_t GetImageSize(VkFormat format, uint32_t width, uint32_t height);
+
+    // BC formats, which need the textureCompressionBC device feature
+    bool IsBlockCompressed(VkFormat format);
+
     struct Texture 
     {
         vk::Image image;
@@ -35,10 +43,17 @@ namespace blaze
 
         void Allocate(uint32_t width, uint32_t height, bool mipMapping = false);
 
+        // Filtering depends on the size, small textures are assumed to be pixel art
+        static TextureSpecification GetSpecification(uint32_t width, uint32_t height, bool mipMapping = false);
+
         void Load(const void* data, uint32_t width, uint32_t height, bool mipMapping = false);
 
         void Load(const std::string& filepath, bool mipMapping = false);
 
+        // Uploads a pre-built mip chain, largest level first and tightly packed. `write` fills the mapped staging memory
+        // (`size` bytes) so packed assets are decompressed straight into it
+        bool Load(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, size_t size, const std::function<bool(void* staging)>& write);
+
         void SetData(const void* data, uint32_t width, uint32_t height, uint32_t offsetX = 0, uint32_t offsetY = 0, bool mipMapping = false);
 
         void MakeRenderable();
@@ -47,6 +62,9 @@ namespace blaze
 
         glm::ivec2 GetSize() { return { image.width, image.height }; }
 
+        // VRAM used by the image including its mips
+        size_t GetMemorySize() const;
+
         void SetName(const std::string& name);
 
         operator ImTextureID () const { return (ImTextureID)imageID; }
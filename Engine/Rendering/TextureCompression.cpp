@@ -0,0 +1,690 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WC_TEXTURE_COMPRESSION_SSE2 1
+#else
+#define WC_TEXTURE_COMPRESSION_SSE2 0
+#endif
+
+#include <stb_image/stb_image.h>
+
+#include "Texture.h"
+#include "../Utils/Hash.h"
+#include "../Utils/Log.h"
+#include "../Utils/Time.h"
+
+namespace blaze::TextureCompression
+{
+	namespace
+	{
+		constexpr uint32_t CACHE_MAGIC = 0x58544342; // "BCTX"
+
+		struct CacheHeader
+		{
+			uint32_t Magic = CACHE_MAGIC;
+			uint32_t Version = VERSION;
+			uint32_t Format = 0;
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t MipLevels = 0;
+			uint64_t Size = 0;
+		};
+
+		// BC7 4 bit index weights, out of 64
+		constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		// 4x4 RGBA8 pixels, row major
+		struct Block
+		{
+			alignas(16) uint8_t Pixels[64];
+
+			const uint8_t* operator[](int i) const { return Pixels + i * 4; }
+		};
+
+		Block LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY)
+		{
+			// Blocks hanging over the edge repeat the last row and column, those texels are never sampled
+			Block block;
+			for (uint32_t y = 0; y < 4; y++)
+				for (uint32_t x = 0; x < 4; x++)
+				{
+					uint32_t sx = std::min(blockX * 4 + x, width - 1), sy = std::min(blockY * 4 + y, height - 1);
+					memcpy(block.Pixels + (y * 4 + x) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+				}
+			return block;
+		}
+
+		// dot(pixel, direction) for all 16 pixels, the direction has to fit in 16 bits per component
+		void Project(const Block& block, const int direction[4], int dots[16])
+		{
+#if WC_TEXTURE_COMPRESSION_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i dir = _mm_setr_epi16((short)direction[0], (short)direction[1], (short)direction[2], (short)direction[3],
+				(short)direction[0], (short)direction[1], (short)direction[2], (short)direction[3]);
+
+			for (int i = 0; i < 16; i += 4)
+			{
+				__m128i pixels = _mm_load_si128((const __m128i*)block[i]);
+
+				// madd leaves r*dr + g*dg and b*db + a*da per pixel, adding the neighbouring lane finishes the dot product
+				__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), dir);
+				__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), dir);
+				lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+				hi = _mm_add_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+
+				__m128i result = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+				_mm_storeu_si128((__m128i*)(dots + i), result);
+			}
+#else
+			for (int i = 0; i < 16; i++)
+				dots[i] = block[i][0] * direction[0] + block[i][1] * direction[1] + block[i][2] * direction[2] + block[i][3] * direction[3];
+#endif
+		}
+
+		// Mean and principal axis of the first `channels` components, the axis is found with power iteration on the covariance
+		void PrincipalAxis(const Block& block, int channels, float mean[4], float axis[4])
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				mean[c] = 0.f;
+				axis[c] = 0.f;
+			}
+
+			for (int i = 0; i < 16; i++)
+				for (int c = 0; c < channels; c++)
+					mean[c] += block[i][c];
+
+			for (int c = 0; c < channels; c++)
+				mean[c] /= 16.f;
+
+			float covariance[4][4] = {};
+			for (int i = 0; i < 16; i++)
+				for (int a = 0; a < channels; a++)
+					for (int b = a; b < channels; b++)
+						covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+
+			for (int a = 0; a < channels; a++)
+				for (int b = 0; b < a; b++)
+					covariance[a][b] = covariance[b][a];
+
+			// Starting from the row of the channel with the most variance converges in a few steps and is never zero unless the block is flat
+			int largest = 0;
+			for (int c = 1; c < channels; c++)
+				if (covariance[c][c] > covariance[largest][largest]) largest = c;
+
+			if (covariance[largest][largest] <= 0.f) return;
+
+			for (int c = 0; c < channels; c++)
+				axis[c] = covariance[largest][c];
+
+			for (int iteration = 0; iteration < 8; iteration++)
+			{
+				float next[4] = {};
+				for (int a = 0; a < channels; a++)
+					for (int b = 0; b < channels; b++)
+						next[a] += covariance[a][b] * axis[b];
+
+				float length = 0.f;
+				for (int c = 0; c < channels; c++)
+					length += next[c] * next[c];
+
+				if (length <= 0.f) break;
+
+				length = 1.f / std::sqrt(length);
+				for (int c = 0; c < channels; c++)
+					axis[c] = next[c] * length;
+			}
+		}
+
+		// End points along the principal axis that cover the whole block
+		void AxisEndpoints(const Block& block, int channels, float start[4], float end[4])
+		{
+			float mean[4], axis[4];
+			PrincipalAxis(block, channels, mean, axis);
+
+			float minT = 0.f, maxT = 0.f;
+			for (int i = 0; i < 16; i++)
+			{
+				float t = 0.f;
+				for (int c = 0; c < channels; c++)
+					t += (block[i][c] - mean[c]) * axis[c];
+
+				minT = std::min(minT, t);
+				maxT = std::max(maxT, t);
+			}
+
+			for (int c = 0; c < 4; c++)
+			{
+				start[c] = mean[c] + axis[c] * minT;
+				end[c] = mean[c] + axis[c] * maxT;
+			}
+		}
+
+		// Least squares end points for the given interpolation weights (0 = start, 1 = end). Returns false if every pixel
+		// uses the same weight, the end points are underdetermined then
+		bool RefineEndpoints(const Block& block, const float weights[16], int channels, float start[4], float end[4])
+		{
+			float aa = 0.f, ab = 0.f, bb = 0.f;
+			float ax[4] = {}, bx[4] = {};
+			for (int i = 0; i < 16; i++)
+			{
+				float b = weights[i], a = 1.f - b;
+				aa += a * a;
+				ab += a * b;
+				bb += b * b;
+				for (int c = 0; c < channels; c++)
+				{
+					ax[c] += a * block[i][c];
+					bx[c] += b * block[i][c];
+				}
+			}
+
+			float determinant = aa * bb - ab * ab;
+			if (std::abs(determinant) < 1e-6f) return false;
+
+			determinant = 1.f / determinant;
+			for (int c = 0; c < channels; c++)
+			{
+				start[c] = std::clamp((ax[c] * bb - bx[c] * ab) * determinant, 0.f, 255.f);
+				end[c] = std::clamp((bx[c] * aa - ax[c] * ab) * determinant, 0.f, 255.f);
+			}
+			return true;
+		}
+
+		int Dot(const int a[4], const int b[4]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]; }
+
+		//-------------------------------------------------------------------------------------------------------------
+		// BC1: two RGB565 end points and 2 bit indices. Only the 4 color mode is used, the block is opaque
+
+		uint16_t To565(const float color[4])
+		{
+			uint32_t r = (uint32_t)std::clamp(std::lround(color[0] * 31.f / 255.f), 0l, 31l);
+			uint32_t g = (uint32_t)std::clamp(std::lround(color[1] * 63.f / 255.f), 0l, 63l);
+			uint32_t b = (uint32_t)std::clamp(std::lround(color[2] * 31.f / 255.f), 0l, 31l);
+			return uint16_t((r << 11) | (g << 5) | b);
+		}
+
+		void From565(uint16_t color, int rgb[4])
+		{
+			int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+			rgb[0] = (r << 3) | (r >> 2);
+			rgb[1] = (g << 2) | (g >> 4);
+			rgb[2] = (b << 3) | (b >> 2);
+			rgb[3] = 0;
+		}
+
+		struct BC1Fit
+		{
+			uint64_t Bits = 0;
+			uint32_t Error = UINT32_MAX;
+			float Weights[16] = {};
+		};
+
+		BC1Fit FitBC1(const Block& block, const float start[4], const float end[4])
+		{
+			uint16_t color0 = To565(end), color1 = To565(start);
+			bool swapped = color0 < color1;
+			if (swapped) std::swap(color0, color1); // color0 > color1 selects the 4 color mode
+
+			int endpoints[2][4];
+			From565(color0, endpoints[0]);
+			From565(color1, endpoints[1]);
+
+			int palette[4][3];
+			for (int c = 0; c < 3; c++)
+			{
+				palette[0][c] = endpoints[0][c];
+				palette[1][c] = endpoints[1][c];
+				palette[2][c] = (2 * endpoints[0][c] + endpoints[1][c]) / 3;
+				palette[3][c] = (endpoints[0][c] + 2 * endpoints[1][c]) / 3;
+			}
+
+			BC1Fit fit;
+			fit.Bits = uint64_t(color0) | (uint64_t(color1) << 16);
+
+			int direction[4] = { endpoints[1][0] - endpoints[0][0], endpoints[1][1] - endpoints[0][1], endpoints[1][2] - endpoints[0][2], 0 };
+			int range = Dot(endpoints[1], direction) - Dot(endpoints[0], direction);
+
+			int dots[16] = {};
+			if (range > 0) Project(block, direction, dots);
+
+			// Steps along color0 -> color1 map to the palette order 0, 2, 3, 1
+			constexpr uint32_t STEP_TO_INDEX[4] = { 0, 2, 3, 1 };
+			int origin = Dot(endpoints[0], direction);
+
+			fit.Error = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int step = range > 0 ? std::clamp(((dots[i] - origin) * 6 + range) / (2 * range), 0, 3) : 0;
+				uint32_t index = STEP_TO_INDEX[step];
+				fit.Bits |= uint64_t(index) << (32 + i * 2);
+				fit.Weights[i] = step / 3.f;
+
+				for (int c = 0; c < 3; c++)
+				{
+					int difference = palette[index][c] - block[i][c];
+					fit.Error += difference * difference;
+				}
+			}
+
+			// The weights go from color0 to color1, RefineEndpoints expects them from `start` to `end`
+			if (!swapped)
+				for (float& weight : fit.Weights)
+					weight = 1.f - weight;
+
+			return fit;
+		}
+
+		uint64_t EncodeBC1(const Block& block)
+		{
+			float start[4], end[4];
+			AxisEndpoints(block, 3, start, end);
+
+			BC1Fit best = FitBC1(block, start, end);
+			if (best.Error > 0 && RefineEndpoints(block, best.Weights, 3, start, end))
+			{
+				BC1Fit refined = FitBC1(block, start, end);
+				if (refined.Error < best.Error) best = refined;
+			}
+
+			return best.Bits;
+		}
+
+		//-------------------------------------------------------------------------------------------------------------
+		// BC4: two 8 bit end points and 3 bit indices, always in the 8 value mode (red0 > red1)
+
+		uint64_t EncodeBC4(const Block& block)
+		{
+			int high = 0, low = 255;
+			for (int i = 0; i < 16; i++)
+			{
+				high = std::max<int>(high, block[i][0]);
+				low = std::min<int>(low, block[i][0]);
+			}
+
+			uint64_t bits = uint64_t(high) | (uint64_t(low) << 8);
+			int range = high - low;
+			if (range == 0) return bits;
+
+			for (int i = 0; i < 16; i++)
+			{
+				// Step 0 is red0 and step 7 is red1, the ones in between are stored as 2..7
+				int step = ((high - block[i][0]) * 14 + range) / (2 * range);
+				uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+				bits |= index << (16 + i * 3);
+			}
+
+			return bits;
+		}
+
+		//-------------------------------------------------------------------------------------------------------------
+		// BC7: only mode 6 (one subset, RGBA 7.7.7.7 end points with a p-bit each and 4 bit indices). It covers color and
+		// alpha together, which is what sprites need, without the partition search the other modes would cost
+
+		struct BC7Fit
+		{
+			int Endpoints[2][4] = {}; // 7 bit
+			int PBits[2] = {};
+			int Indices[16] = {};
+			uint32_t Error = UINT32_MAX;
+			float Weights[16] = {};
+		};
+
+		// Picks the p-bit that gets the 8 bit end point closest to `color`
+		void QuantizeEndpoint(const float color[4], int endpoint[4], int& pBit)
+		{
+			float bestError = FLT_MAX;
+			for (int p = 0; p < 2; p++)
+			{
+				int quantized[4];
+				float error = 0.f;
+				for (int c = 0; c < 4; c++)
+				{
+					quantized[c] = (int)std::clamp(std::lround((color[c] - p) * 0.5f), 0l, 127l);
+					float difference = float((quantized[c] << 1) | p) - color[c];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					pBit = p;
+					memcpy(endpoint, quantized, sizeof(quantized));
+				}
+			}
+		}
+
+		BC7Fit FitBC7(const Block& block, const float start[4], const float end[4])
+		{
+			BC7Fit fit;
+			QuantizeEndpoint(start, fit.Endpoints[0], fit.PBits[0]);
+			QuantizeEndpoint(end, fit.Endpoints[1], fit.PBits[1]);
+
+			int endpoints[2][4];
+			for (int e = 0; e < 2; e++)
+				for (int c = 0; c < 4; c++)
+					endpoints[e][c] = (fit.Endpoints[e][c] << 1) | fit.PBits[e];
+
+			int direction[4];
+			for (int c = 0; c < 4; c++)
+				direction[c] = endpoints[1][c] - endpoints[0][c];
+
+			int origin = Dot(endpoints[0], direction);
+			int range = Dot(endpoints[1], direction) - origin;
+
+			int dots[16] = {};
+			if (range > 0) Project(block, direction, dots);
+
+			fit.Error = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				int index = 0;
+				if (range > 0)
+				{
+					// The weights are close to i * 64 / 15, so the rounded guess is off by one at most
+					int target = std::clamp(((dots[i] - origin) * 128 + range) / (2 * range), 0, 64);
+					index = std::clamp((target * 15 + 32) / 64, 0, 15);
+					if (index > 0 && std::abs(BC7_WEIGHTS[index - 1] - target) < std::abs(BC7_WEIGHTS[index] - target)) index--;
+					else if (index < 15 && std::abs(BC7_WEIGHTS[index + 1] - target) < std::abs(BC7_WEIGHTS[index] - target)) index++;
+				}
+
+				fit.Indices[i] = index;
+				fit.Weights[i] = BC7_WEIGHTS[index] / 64.f;
+
+				int weight = BC7_WEIGHTS[index];
+				for (int c = 0; c < 4; c++)
+				{
+					int value = ((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6;
+					int difference = value - block[i][c];
+					fit.Error += difference * difference;
+				}
+			}
+
+			return fit;
+		}
+
+		struct BitWriter
+		{
+			uint64_t Bits[2] = {};
+			uint32_t Offset = 0;
+
+			void Write(uint64_t value, uint32_t count)
+			{
+				for (uint32_t i = 0; i < count; i++, Offset++)
+					Bits[Offset / 64] |= ((value >> i) & 1) << (Offset % 64);
+			}
+		};
+
+		void EncodeBC7(const Block& block, uint8_t* output)
+		{
+			float start[4], end[4];
+			AxisEndpoints(block, 4, start, end);
+
+			BC7Fit best = FitBC7(block, start, end);
+			if (best.Error > 0 && RefineEndpoints(block, best.Weights, 4, start, end))
+			{
+				BC7Fit refined = FitBC7(block, start, end);
+				if (refined.Error < best.Error) best = refined;
+			}
+
+			// The first index is stored with 3 bits so its top bit has to be 0, swapping the end points inverts every index
+			if (best.Indices[0] >= 8)
+			{
+				std::swap(best.Endpoints[0], best.Endpoints[1]);
+				std::swap(best.PBits[0], best.PBits[1]);
+				for (int& index : best.Indices)
+					index = 15 - index;
+			}
+
+			BitWriter writer;
+			writer.Write(1 << 6, 7); // Mode 6
+			for (int c = 0; c < 4; c++)
+			{
+				writer.Write(best.Endpoints[0][c], 7);
+				writer.Write(best.Endpoints[1][c], 7);
+			}
+			writer.Write(best.PBits[0], 1);
+			writer.Write(best.PBits[1], 1);
+
+			writer.Write(best.Indices[0], 3);
+			for (int i = 1; i < 16; i++)
+				writer.Write(best.Indices[i], 4);
+
+			memcpy(output, writer.Bits, 16);
+		}
+
+		//-------------------------------------------------------------------------------------------------------------
+
+		bool Restore(const std::string& cachePath, EncodedTexture& texture)
+		{
+			std::ifstream file(cachePath, std::ios::binary);
+			if (!file.is_open()) return false;
+
+			CacheHeader header;
+			if (!file.read((char*)&header, sizeof(header)) || header.Magic != CACHE_MAGIC || header.Version != VERSION) return false;
+
+			size_t expectedSize = 0;
+			for (uint32_t i = 0; i < header.MipLevels; i++)
+				expectedSize += GetImageSize((VkFormat)header.Format, std::max(header.Width >> i, 1u), std::max(header.Height >> i, 1u));
+
+			if (header.MipLevels == 0 || header.Size != expectedSize) return false;
+
+			texture.Format = (VkFormat)header.Format;
+			texture.Width = header.Width;
+			texture.Height = header.Height;
+			texture.MipLevels = header.MipLevels;
+			texture.Data.resize(header.Size);
+			return (bool)file.read((char*)texture.Data.data(), texture.Data.size());
+		}
+
+		void Save(const std::string& cachePath, const EncodedTexture& texture)
+		{
+			std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path());
+
+			// Written next to the cache entry first so a reader never sees half of it
+			std::string temporaryPath = cachePath + ".tmp";
+			{
+				std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+				if (!file.is_open())
+				{
+					WC_CORE_WARN("Failed to write the texture cache to {}", cachePath);
+					return;
+				}
+
+				CacheHeader header = {
+					.Format = (uint32_t)texture.Format,
+					.Width = texture.Width,
+					.Height = texture.Height,
+					.MipLevels = texture.MipLevels,
+					.Size = texture.Data.size(),
+				};
+				file.write((const char*)&header, sizeof(header));
+				file.write((const char*)texture.Data.data(), texture.Data.size());
+			}
+
+			std::error_code ec;
+			std::filesystem::rename(temporaryPath, cachePath, ec);
+			if (ec) std::filesystem::remove(temporaryPath, ec);
+		}
+	}
+
+	VkFormat ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height)
+	{
+		bool opaque = true, grayscale = true;
+		for (size_t i = 0, count = size_t(width) * height; i < count && (opaque || grayscale); i++)
+		{
+			const uint8_t* pixel = rgba + i * 4;
+			opaque &= pixel[3] == 255;
+			grayscale &= pixel[0] == pixel[1] && pixel[1] == pixel[2];
+		}
+
+		if (!opaque) return VK_FORMAT_BC7_UNORM_BLOCK;
+		return grayscale ? VK_FORMAT_BC4_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	}
+
+	std::vector<uint8_t> BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t& mipLevels)
+	{
+		mipLevels = std::max(vk::GetMipLevelCount(glm::vec2(width, height)), 1u);
+
+		size_t size = 0;
+		for (uint32_t i = 0; i < mipLevels; i++)
+			size += GetImageSize(VK_FORMAT_R8G8B8A8_UNORM, std::max(width >> i, 1u), std::max(height >> i, 1u));
+
+		std::vector<uint8_t> chain(size);
+		memcpy(chain.data(), rgba, size_t(width) * height * 4);
+
+		uint8_t* previous = chain.data();
+		for (uint32_t i = 1; i < mipLevels; i++)
+		{
+			uint32_t srcWidth = std::max(width >> (i - 1), 1u), srcHeight = std::max(height >> (i - 1), 1u);
+			uint32_t dstWidth = std::max(width >> i, 1u), dstHeight = std::max(height >> i, 1u);
+			uint8_t* current = previous + size_t(srcWidth) * srcHeight * 4;
+
+			for (uint32_t y = 0; y < dstHeight; y++)
+				for (uint32_t x = 0; x < dstWidth; x++)
+				{
+					uint32_t x0 = std::min(x * 2, srcWidth - 1), x1 = std::min(x * 2 + 1, srcWidth - 1);
+					uint32_t y0 = std::min(y * 2, srcHeight - 1), y1 = std::min(y * 2 + 1, srcHeight - 1);
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						uint32_t sum = previous[(y0 * srcWidth + x0) * 4 + c] + previous[(y0 * srcWidth + x1) * 4 + c] +
+							previous[(y1 * srcWidth + x0) * 4 + c] + previous[(y1 * srcWidth + x1) * 4 + c];
+						current[(y * dstWidth + x) * 4 + c] = uint8_t((sum + 2) / 4);
+					}
+				}
+
+			previous = current;
+		}
+
+		return chain;
+	}
+
+	std::vector<uint8_t> Encode(VkFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t mipLevels)
+	{
+		struct Level
+		{
+			const uint8_t* Pixels;
+			uint32_t Width, Height;
+			uint32_t BlocksX, FirstRow;
+			size_t Offset;
+		};
+
+		std::vector<Level> levels(mipLevels);
+		size_t size = 0;
+		uint32_t rowCount = 0;
+		for (uint32_t i = 0; i < mipLevels; i++)
+		{
+			uint32_t levelWidth = std::max(width >> i, 1u), levelHeight = std::max(height >> i, 1u);
+			levels[i] = { rgba, levelWidth, levelHeight, (levelWidth + 3) / 4, rowCount, size };
+
+			rgba += size_t(levelWidth) * levelHeight * 4;
+			size += GetImageSize(format, levelWidth, levelHeight);
+			rowCount += (levelHeight + 3) / 4;
+		}
+
+		std::vector<uint8_t> output(size);
+		const size_t blockSize = format == VK_FORMAT_BC7_UNORM_BLOCK ? 16 : 8;
+
+		// Rows of blocks are handed out one at a time, the small mips at the end balance out the threads
+		std::atomic<uint32_t> nextRow = 0;
+		auto Worker = [&]() {
+			for (uint32_t row = nextRow++; row < rowCount; row = nextRow++)
+			{
+				auto level = std::find_if(levels.rbegin(), levels.rend(), [row](const Level& level) { return level.FirstRow <= row; });
+				uint32_t blockY = row - level->FirstRow;
+				uint8_t* destination = output.data() + level->Offset + size_t(blockY) * level->BlocksX * blockSize;
+
+				for (uint32_t blockX = 0; blockX < level->BlocksX; blockX++, destination += blockSize)
+				{
+					Block block = LoadBlock(level->Pixels, level->Width, level->Height, blockX, blockY);
+					switch (format)
+					{
+					case VK_FORMAT_BC4_UNORM_BLOCK:
+					{
+						uint64_t bits = EncodeBC4(block);
+						memcpy(destination, &bits, 8);
+						break;
+					}
+					case VK_FORMAT_BC7_UNORM_BLOCK:
+						EncodeBC7(block, destination);
+						break;
+					default:
+					{
+						uint64_t bits = EncodeBC1(block);
+						memcpy(destination, &bits, 8);
+						break;
+					}
+					}
+				}
+			}
+			};
+
+		uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, std::max(rowCount / 4, 1u));
+		std::vector<std::thread> threads;
+		for (uint32_t i = 1; i < threadCount; i++)
+			threads.emplace_back(Worker);
+
+		Worker();
+		for (auto& thread : threads)
+			thread.join();
+
+		return output;
+	}
+
+	bool ShouldCompress(uint32_t width, uint32_t height) { return width > 128 && height > 128; }
+
+	bool Import(const std::string& filepath, const std::string& cacheDirectory, bool mipMapping, EncodedTexture& texture)
+	{
+		int width = 0, height = 0, channels = 0;
+		if (!stbi_info(filepath.c_str(), &width, &height, &channels) || !ShouldCompress(width, height)) return false;
+
+		uint64_t fileHash = wc::HashFile(filepath);
+		if (fileHash == 0) return false;
+
+		uint64_t key = wc::HashCombine(wc::HashCombine(fileHash, VERSION), mipMapping);
+		std::string cachePath = cacheDirectory.empty() ? "" : (std::filesystem::path(cacheDirectory) / std::format("{:016x}.bctex", key)).string();
+		if (!cachePath.empty() && Restore(cachePath, texture)) return true;
+
+		wc::Timer timer;
+		timer.Start();
+
+		stbi_uc* pixels = stbi_load(filepath.c_str(), &width, &height, &channels, 4);
+		if (!pixels) return false;
+
+		texture.Format = ChooseFormat(pixels, width, height);
+		texture.Width = width;
+		texture.Height = height;
+		texture.MipLevels = 1;
+
+		if (mipMapping)
+		{
+			auto chain = BuildMipChain(pixels, width, height, texture.MipLevels);
+			texture.Data = Encode(texture.Format, chain.data(), width, height, texture.MipLevels);
+		}
+		else
+			texture.Data = Encode(texture.Format, pixels, width, height);
+
+		stbi_image_free(pixels);
+
+		size_t uncompressedSize = 0;
+		for (uint32_t i = 0; i < texture.MipLevels; i++)
+			uncompressedSize += GetImageSize(VK_FORMAT_R8G8B8A8_UNORM, std::max(texture.Width >> i, 1u), std::max(texture.Height >> i, 1u));
+
+		WC_CORE_INFO("Compressed {} ({}x{}, {} mips) in {:.2f}ms, {:.1f}x smaller", filepath, width, height, texture.MipLevels,
+			timer.GetElapsedTime() * 1000.f, float(uncompressedSize) / texture.Data.size());
+
+		if (!cachePath.empty()) Save(cachePath, texture);
+		return true;
+	}
+}
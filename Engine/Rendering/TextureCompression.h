@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <Volk/volk.h>
+
+namespace blaze::TextureCompression
+{
+	// Bumped whenever the encoders change so stale cache entries are re-encoded
+	constexpr uint32_t VERSION = 1;
+
+	struct EncodedTexture
+	{
+		VkFormat Format = VK_FORMAT_UNDEFINED;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t MipLevels = 0;
+		std::vector<uint8_t> Data; // Every mip level, largest first and tightly packed (see GetImageSize)
+	};
+
+	// BC4 for opaque grayscale images (sampled through a R,R,R,1 swizzle), BC1 for opaque color and BC7 when there's alpha
+	VkFormat ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+	// Same level count the renderer uses for runtime generated mips, every level is a 2x2 box filter of the previous one.
+	// Returns the RGBA8 levels tightly packed
+	std::vector<uint8_t> BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t& mipLevels);
+
+	// Encodes `mipLevels` tightly packed RGBA8 levels into `format` (BC1, BC4 or BC7). Blocks are spread over all hardware threads
+	std::vector<uint8_t> Encode(VkFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t mipLevels = 1);
+
+	// Only textures that are filtered linearly are worth compressing, the small ones are pixel art (see Texture::GetSpecification)
+	// where block artifacts are visible at any zoom
+	bool ShouldCompress(uint32_t width, uint32_t height);
+
+	// Decodes, mips and encodes an image file. The result is cached in `cacheDirectory` keyed by the file's content hash so
+	// the encoder only runs the first time a texture is seen. Returns false for images that shouldn't be compressed
+	bool Import(const std::string& filepath, const std::string& cacheDirectory, bool mipMapping, EncodedTexture& texture);
+}
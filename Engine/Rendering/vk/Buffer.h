@@ -184,6 +184,8 @@ namespace vk
 
 		uint32_t GetSize() const { return m_Data.size(); }
 
+		const std::vector<T>& GetData() const { return m_Data; }
+
 		T* Map()
 		{
 			m_StagingPtr = (T*)m_StagingBuffer.Map();
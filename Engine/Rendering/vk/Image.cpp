@@ -1,5 +1,7 @@
 #include "Image.h"
 
+#include "../../Utils/Log.h"
+
 namespace vk
 {
 	glm::ivec2 GetMipSize(uint32_t level, glm::ivec2 size) { return { size.x >> level, size.y >> level }; }
@@ -285,13 +287,18 @@ namespace vk
 
 	VkResult ImageView::Create(const Image& image)
 	{
+		// BC4 only stores red, it's used for grayscale textures so the other channels mirror it
+		VkComponentMapping components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
+		if (image.format == VK_FORMAT_BC4_UNORM_BLOCK)
+			components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
+
 		return Create({
 			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 
 			.image = image,
 			.viewType = image.layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
 			.format = image.format,
-			.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G, VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A },
+			.components = components,
 			.subresourceRange = {
 				.aspectMask = VkImageAspectFlags(image.HasDepth() ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT),
 				.levelCount = image.mipLevels,
@@ -322,4 +329,90 @@ namespace vk
 			.unnormalizedCoordinates = false
 			});
 	}
-}
\ No newline at end of file
+
+	size_t SamplerSpecificationHash::operator()(const SamplerSpecification& spec) const
+	{
+		// FNV-1a over the fields, the struct has padding so it can't be hashed as raw bytes
+		uint64_t hash = 14695981039346656037ull;
+		auto Combine = [&](const auto& value) {
+			const uint8_t* bytes = (const uint8_t*)&value;
+			for (size_t i = 0; i < sizeof(value); i++)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			};
+
+		Combine(spec.magFilter);
+		Combine(spec.minFilter);
+		Combine(spec.mipmapMode);
+		Combine(spec.addressModeU);
+		Combine(spec.addressModeV);
+		Combine(spec.addressModeW);
+		Combine(spec.mipLodBias);
+		Combine(spec.anisotropyEnable);
+		Combine(spec.maxAnisotropy);
+		Combine(spec.minLod);
+		Combine(spec.maxLod);
+		return (size_t)hash;
+	}
+
+	Sampler SamplerCache::Acquire(const SamplerSpecification& spec)
+	{
+		auto& entry = m_Samplers[spec];
+		if (entry.Handle)
+			m_Hits++;
+		else
+		{
+			m_Misses++;
+			entry.Handle.Create(spec);
+			m_Specifications[entry.Handle] = spec;
+		}
+
+		entry.RefCount++;
+		return entry.Handle;
+	}
+
+	void SamplerCache::Release(Sampler sampler)
+	{
+		if (!sampler) return;
+
+		auto it = m_Specifications.find(sampler);
+		if (it == m_Specifications.end())
+		{
+			WC_CORE_WARN("Releasing a sampler that isn't owned by the sampler cache");
+			return;
+		}
+
+		auto entry = m_Samplers.find(it->second);
+		if (--entry->second.RefCount == 0)
+		{
+			entry->second.Handle.Destroy();
+			m_Samplers.erase(entry);
+			m_Specifications.erase(it);
+		}
+	}
+
+	void SamplerCache::Destroy()
+	{
+		if (!m_Samplers.empty())
+			WC_CORE_WARN("Sampler cache destroyed with {} samplers still in use", m_Samplers.size());
+
+		for (auto& [spec, entry] : m_Samplers)
+			entry.Handle.Destroy();
+
+		m_Samplers.clear();
+		m_Specifications.clear();
+	}
+
+	SamplerCache::Stats SamplerCache::GetStats() const
+	{
+		Stats stats = {
+			.Samplers = (uint32_t)m_Samplers.size(),
+			.Hits = m_Hits,
+			.Misses = m_Misses,
+		};
+
+		for (auto& [spec, entry] : m_Samplers)
+			stats.References += entry.RefCount;
+
+		return stats;
+	}
+}
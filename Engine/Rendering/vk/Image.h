@@ -2,6 +2,7 @@
 
 #include "Buffer.h"
 #include <glm/glm.hpp>
+#include <unordered_map>
 #undef min
 
 namespace vk 
@@ -166,6 +167,13 @@ namespace vk
         float                 maxAnisotropy = 1.f;
         float                 minLod = 0.f;
         float                 maxLod = 1.f;
+
+        bool operator==(const SamplerSpecification&) const = default;
+    };
+
+    struct SamplerSpecificationHash
+    {
+        size_t operator()(const SamplerSpecification& spec) const;
     };
 
     struct Sampler : public VkObject<VkSampler> 
@@ -183,4 +191,38 @@ namespace vk
 			m_Handle = VK_NULL_HANDLE;
 		}
     };
+
+    // Textures with the same sampler state share a single VkSampler, most projects only ever need a handful of them
+    struct SamplerCache
+    {
+        struct Stats
+        {
+            uint32_t Samplers = 0; // Unique VkSamplers alive
+            uint32_t References = 0; // Textures holding one of them
+            uint64_t Hits = 0;
+            uint64_t Misses = 0;
+        };
+
+        Sampler Acquire(const SamplerSpecification& spec);
+
+        // Destroys the sampler once the last texture using it releases it
+        void Release(Sampler sampler);
+
+        void Destroy();
+
+        Stats GetStats() const;
+
+    private:
+        struct Entry
+        {
+            Sampler Handle;
+            uint32_t RefCount = 0;
+        };
+
+        std::unordered_map<SamplerSpecification, Entry, SamplerSpecificationHash> m_Samplers;
+        std::unordered_map<VkSampler, SamplerSpecification> m_Specifications;
+
+        uint64_t m_Hits = 0;
+        uint64_t m_Misses = 0;
+    }inline samplerCache;
 }
\ No newline at end of file
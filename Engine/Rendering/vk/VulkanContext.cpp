@@ -115,7 +115,7 @@ namespace VulkanContext
 #endif
 	}
 
-	bool Create()
+	bool Create(bool headless)
 	{
 		if (volkInitialize() != VK_SUCCESS)
 		{
@@ -141,8 +141,13 @@ namespace VulkanContext
 
 		if (!bValidationLayers)
 		{
-			WC_CORE_ERROR("Validation layers requested, but not available!");
-			return false;
+			// @NOTE: Headless runs are expected on CI / software implementations (lavapipe) which often ship without the layers
+			if (!headless)
+			{
+				WC_CORE_ERROR("Validation layers requested, but not available!");
+				return false;
+			}
+			WC_CORE_WARN("Validation layers requested, but not available!");
 		}
 #endif
 
@@ -158,11 +163,15 @@ namespace VulkanContext
 		VkInstanceCreateInfo instanceCreateInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
 		instanceCreateInfo.pApplicationInfo = &appInfo;
 
-		uint32_t glfwExtensionCount = 0;
-		const char** glfwExtensions;
-		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		std::vector<const char*> extensions;
+		if (!headless)
+		{
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions;
+			glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
-		std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+			extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+		}
 
 #if WC_GRAPHICS_VALIDATION
 		VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
@@ -267,7 +276,8 @@ namespace VulkanContext
 
 		volkLoadInstance(instance);
 
-		const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME, };
+		std::vector<const char*> deviceExtensions;
+		if (!headless) deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME); // Headless renders offscreen only, no surface
 
 #if WC_GRAPHICS_VALIDATION
 		if (bValidationLayers)
@@ -393,14 +403,20 @@ namespace VulkanContext
 				else
 					WC_CORE_WARN("Independent blend feature is not supported")
 
+					// Optional, compressed texture imports fall back to RGBA8 without it
+					deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+
 					VkPhysicalDeviceVulkan12Features features12 = {
 						.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
 
 						.shaderSampledImageArrayNonUniformIndexing = true,
+						.descriptorBindingSampledImageUpdateAfterBind = true,
+						.descriptorBindingUpdateUnusedWhilePending = true,
 						.descriptorBindingPartiallyBound = true,
 						.descriptorBindingVariableDescriptorCount = true,
 						.runtimeDescriptorArray = true,
 						.scalarBlockLayout = true,
+						.hostQueryReset = true,
 						.timelineSemaphore = true,
 						.bufferDeviceAddress = true,
 				};
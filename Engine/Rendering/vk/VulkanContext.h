@@ -75,7 +75,8 @@ namespace VulkanContext
 	void EndLabel(VkQueue queue);
 
 
-	bool Create();
+	// A headless context has no surface and doesn't require VK_KHR_swapchain, so it works without a window (CI, lavapipe)
+	bool Create(bool headless = false);
 
 	void Destroy();
 }
@@ -0,0 +1,213 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "../Utils/Hash.h"
+#include "../Utils/LZ4.h"
+#include "../Utils/Log.h"
+
+namespace blaze
+{
+	namespace
+	{
+		uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+	}
+
+	bool AssetPack::Open(const std::string& filepath, const std::string& mountPath)
+	{
+		Close();
+		if (!m_File.Open(filepath)) return false;
+
+		auto Fail = [&](const char* reason) {
+			WC_CORE_ERROR("{} is not a valid asset pack: {}", filepath, reason);
+			m_File.Close();
+			return false;
+			};
+
+		if (m_File.GetSize() < sizeof(AssetPackHeader)) return Fail("too small");
+		memcpy(&m_Header, m_File.GetData(), sizeof(AssetPackHeader));
+
+		if (m_Header.Magic != AssetPackHeader::MAGIC) return Fail("wrong magic");
+		if (m_Header.Version != AssetPackHeader::VERSION) return Fail("unsupported version");
+
+		uint64_t tableSize = uint64_t(m_Header.EntryCount) * sizeof(AssetPackEntry);
+		if (m_Header.TableOffset + tableSize > m_File.GetSize() || m_Header.StringsOffset + m_Header.StringsSize > m_File.GetSize() || m_Header.TableOffset % alignof(AssetPackEntry) != 0)
+			return Fail("truncated");
+
+		m_Entries = (const AssetPackEntry*)(m_File.GetData() + m_Header.TableOffset);
+		m_Strings = (const char*)(m_File.GetData() + m_Header.StringsOffset);
+
+		for (const auto& entry : GetEntries())
+			if (entry.Offset + entry.Size > m_File.GetSize() || uint64_t(entry.PathOffset) + entry.PathLength > m_Header.StringsSize)
+				return Fail("entry out of bounds");
+
+		m_MountPath = std::filesystem::absolute(mountPath).lexically_normal().generic_string();
+		if (!m_MountPath.empty() && m_MountPath.back() == '/') m_MountPath.pop_back();
+
+		WC_CORE_INFO("Mounted {} ({} assets) at {}", filepath, m_Header.EntryCount, m_MountPath);
+		return true;
+	}
+
+	void AssetPack::Close()
+	{
+		m_File.Close();
+		m_Header = {};
+		m_Entries = nullptr;
+		m_Strings = nullptr;
+		m_MountPath.clear();
+	}
+
+	const AssetPackEntry* AssetPack::Find(const std::string& path, AssetPackKind kind) const
+	{
+		if (!IsOpen()) return nullptr;
+
+		std::filesystem::path normalized = std::filesystem::path(path).lexically_normal();
+		std::string relativePath = normalized.is_absolute() ? normalized.lexically_relative(m_MountPath).generic_string() : normalized.generic_string();
+		if (relativePath.empty() || relativePath.starts_with("..")) return nullptr;
+
+		uint64_t hash = wc::Hash64(relativePath);
+		auto entries = GetEntries();
+		auto it = std::lower_bound(entries.begin(), entries.end(), hash, [](const AssetPackEntry& entry, uint64_t hash) { return entry.PathHash < hash; });
+		for (; it != entries.end() && it->PathHash == hash; ++it)
+			if (it->Kind == kind && GetPath(*it) == relativePath)
+				return &*it;
+
+		return nullptr;
+	}
+
+	std::string_view AssetPack::GetPath(const AssetPackEntry& entry) const { return { m_Strings + entry.PathOffset, entry.PathLength }; }
+
+	std::span<const uint8_t> AssetPack::GetStoredData(const AssetPackEntry& entry) const { return { m_File.GetData() + entry.Offset, (size_t)entry.Size }; }
+
+	bool AssetPack::Read(const AssetPackEntry& entry, void* destination) const
+	{
+		auto data = GetStoredData(entry);
+
+		switch (entry.Compression)
+		{
+		case AssetPackCompression::None:
+			if (entry.Size != entry.RawSize) return false;
+			if (!data.empty()) memcpy(destination, data.data(), data.size());
+			return true;
+
+		case AssetPackCompression::LZ4:
+			if (wc::LZ4::Decompress(data.data(), data.size(), destination, (size_t)entry.RawSize)) return true;
+			WC_CORE_ERROR("Corrupted asset pack entry {}", GetPath(entry));
+			return false;
+		}
+
+		return false;
+	}
+
+	std::vector<uint8_t> AssetPack::Read(const AssetPackEntry& entry) const
+	{
+		std::vector<uint8_t> data((size_t)entry.RawSize);
+		if (!Read(entry, data.data())) data.clear();
+		return data;
+	}
+
+	bool AssetPack::Verify() const
+	{
+		bool valid = true;
+		for (const auto& entry : GetEntries())
+		{
+			auto data = Read(entry);
+			if (data.size() != entry.RawSize || wc::Hash64(data.data(), data.size()) != entry.ContentHash)
+			{
+				WC_CORE_ERROR("Asset pack entry {} doesn't match its hash", GetPath(entry));
+				valid = false;
+			}
+		}
+
+		return valid;
+	}
+
+	bool AssetPackWriter::Create(const std::string& filepath)
+	{
+		std::filesystem::path parent = std::filesystem::path(filepath).parent_path();
+		if (!parent.empty()) std::filesystem::create_directories(parent);
+
+		m_File.open(filepath, std::ios::binary | std::ios::trunc);
+		if (!m_File.is_open())
+		{
+			WC_CORE_ERROR("Failed to create {}", filepath);
+			return false;
+		}
+
+		// The header is rewritten once the table offsets are known
+		AssetPackHeader header;
+		m_File.write((const char*)&header, sizeof(header));
+		m_Offset = sizeof(header);
+		return true;
+	}
+
+	void AssetPackWriter::Pad()
+	{
+		static const char zeros[AssetPackHeader::ALIGNMENT] = {};
+		uint64_t aligned = AlignUp(m_Offset, AssetPackHeader::ALIGNMENT);
+		m_File.write(zeros, std::streamsize(aligned - m_Offset));
+		m_Offset = aligned;
+	}
+
+	void AssetPackWriter::Add(const std::string& path, AssetPackKind kind, const void* data, size_t size, const uint32_t info[4], bool compress)
+	{
+		Pad();
+
+		AssetPackEntry entry = {
+			.PathHash = wc::Hash64(path),
+			.Offset = m_Offset,
+			.Size = size,
+			.RawSize = size,
+			.ContentHash = wc::Hash64(data, size),
+			.PathOffset = (uint32_t)m_Strings.size(),
+			.PathLength = (uint32_t)path.size(),
+			.Kind = kind,
+		};
+		if (info) memcpy(entry.Info, info, sizeof(entry.Info));
+		m_Strings += path;
+
+		const void* stored = data;
+		if (compress && size > 0)
+		{
+			m_Compressed.clear();
+			size_t compressedSize = wc::LZ4::Compress(data, size, m_Compressed);
+			if (compressedSize < size - size / 8)
+			{
+				entry.Compression = AssetPackCompression::LZ4;
+				entry.Size = compressedSize;
+				stored = m_Compressed.data();
+			}
+		}
+
+		m_File.write((const char*)stored, std::streamsize(entry.Size));
+		m_Offset += entry.Size;
+		m_RawSize += entry.RawSize;
+		m_StoredSize += entry.Size;
+		m_Entries.push_back(entry);
+	}
+
+	bool AssetPackWriter::Finish()
+	{
+		std::sort(m_Entries.begin(), m_Entries.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.PathHash < b.PathHash; });
+
+		Pad();
+		AssetPackHeader header = {
+			.EntryCount = (uint32_t)m_Entries.size(),
+			.TableOffset = m_Offset,
+			.StringsOffset = m_Offset + m_Entries.size() * sizeof(AssetPackEntry),
+			.StringsSize = m_Strings.size(),
+		};
+
+		m_File.write((const char*)m_Entries.data(), std::streamsize(m_Entries.size() * sizeof(AssetPackEntry)));
+		m_File.write(m_Strings.data(), std::streamsize(m_Strings.size()));
+
+		m_File.seekp(0);
+		m_File.write((const char*)&header, sizeof(header));
+
+		bool success = m_File.good();
+		m_File.close();
+		return success;
+	}
+}
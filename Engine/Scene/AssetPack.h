@@ -0,0 +1,129 @@
+#pragma once
+
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../Utils/MappedFile.h"
+
+namespace blaze
+{
+	// .blzpak layout, everything little endian:
+	//	AssetPackHeader
+	//	payloads, each starting on an ALIGNMENT boundary so uncompressed ones can be handed out straight from the mapping
+	//	AssetPackEntry[EntryCount], sorted by PathHash
+	//	string table with the project relative paths
+	enum class AssetPackKind : uint8_t
+	{
+		Raw,     // The file as it is on disk
+		Texture, // Mip chain, largest level first, tightly packed. Info = { VkFormat, width, height, mip levels }
+		Script,  // Compiled Luau bytecode, see ScriptBinary::Serialize
+		Font,    // Font file followed by the baked RGBA8 atlas. Info = { font file size, atlas width, atlas height, 0 }
+		Scene,   // Binary scene (see SceneFormat), YAML scenes are converted when packing
+	};
+
+	enum class AssetPackCompression : uint8_t
+	{
+		None,
+		LZ4,
+	};
+
+	struct AssetPackHeader
+	{
+		static constexpr uint32_t MAGIC = 0x4B415042; // "BPAK"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr uint32_t ALIGNMENT = 4096;
+
+		uint32_t Magic = MAGIC;
+		uint32_t Version = VERSION;
+		uint32_t EntryCount = 0;
+		uint32_t Alignment = ALIGNMENT;
+		uint64_t TableOffset = 0;
+		uint64_t StringsOffset = 0;
+		uint64_t StringsSize = 0;
+	};
+
+	struct AssetPackEntry
+	{
+		uint64_t PathHash = 0;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;        // As stored
+		uint64_t RawSize = 0;     // After decompression
+		uint64_t ContentHash = 0; // XXH64 of the decompressed payload
+		uint32_t PathOffset = 0;
+		uint32_t PathLength = 0;
+		uint32_t Info[4] = {};    // Kind specific
+		AssetPackKind Kind = AssetPackKind::Raw;
+		AssetPackCompression Compression = AssetPackCompression::None;
+		uint8_t Padding[6] = {};
+	};
+	static_assert(sizeof(AssetPackEntry) == 72);
+
+	// Read side of a .blzpak, the archive is memory mapped and nothing is copied on open. Paths under the mount path
+	// (usually the project root) resolve to the entry with the same project relative path.
+	struct AssetPack
+	{
+		bool Open(const std::string& filepath, const std::string& mountPath);
+
+		void Close();
+
+		bool IsOpen() const { return m_File.IsOpen(); }
+
+		// nullptr if the path isn't in the pack or is outside the mount path. Accepts absolute and mount relative paths
+		const AssetPackEntry* Find(const std::string& path, AssetPackKind kind) const;
+
+		std::string_view GetPath(const AssetPackEntry& entry) const;
+
+		// The payload as stored, compressed or not. Valid until Close
+		std::span<const uint8_t> GetStoredData(const AssetPackEntry& entry) const;
+
+		// Decompresses (or copies) the payload into `destination`, which has to hold entry.RawSize bytes.
+		// Meant to target mapped staging memory directly
+		bool Read(const AssetPackEntry& entry, void* destination) const;
+
+		std::vector<uint8_t> Read(const AssetPackEntry& entry) const;
+
+		// Checks every payload against its content hash
+		bool Verify() const;
+
+		std::span<const AssetPackEntry> GetEntries() const { return { m_Entries, m_Header.EntryCount }; }
+
+	private:
+		wc::MappedFile m_File;
+		AssetPackHeader m_Header;
+		const AssetPackEntry* m_Entries = nullptr;
+		const char* m_Strings = nullptr;
+		std::string m_MountPath;
+	};
+
+	inline AssetPack assetPack;
+
+	// Builds a .blzpak, payloads are streamed to disk as they're added so memory use stays at one asset
+	struct AssetPackWriter
+	{
+		bool Create(const std::string& filepath);
+
+		// Compression is kept only when it saves at least an eighth of the size
+		void Add(const std::string& path, AssetPackKind kind, const void* data, size_t size, const uint32_t info[4] = nullptr, bool compress = true);
+
+		// Writes the table and the header, returns false if any write failed
+		bool Finish();
+
+		uint64_t GetRawSize() const { return m_RawSize; }
+		uint64_t GetStoredSize() const { return m_StoredSize; }
+		size_t GetEntryCount() const { return m_Entries.size(); }
+
+	private:
+		void Pad();
+
+		std::ofstream m_File;
+		std::vector<AssetPackEntry> m_Entries;
+		std::string m_Strings;
+		std::vector<uint8_t> m_Compressed;
+		uint64_t m_Offset = 0;
+		uint64_t m_RawSize = 0;
+		uint64_t m_StoredSize = 0;
+	};
+}
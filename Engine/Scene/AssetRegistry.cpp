@@ -0,0 +1,201 @@
+#include "AssetRegistry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+#include <magic_enum.hpp>
+
+#include "../Utils/Hash.h"
+#include "../Utils/Log.h"
+#include "../Utils/YAML.h"
+
+namespace blaze
+{
+	void AssetRegistry::Open(const std::string& projectPath)
+	{
+		Close();
+		m_ProjectPath = std::filesystem::absolute(projectPath).lexically_normal().generic_string();
+		if (!m_ProjectPath.empty() && m_ProjectPath.back() == '/') m_ProjectPath.pop_back();
+
+		std::string manifestPath = m_ProjectPath + '/' + MANIFEST;
+		if (!std::filesystem::exists(manifestPath)) return;
+
+		try
+		{
+			YAML::Node data = YAML::LoadFile(manifestPath);
+			for (const auto& asset : data["Assets"])
+			{
+				AssetMetadata metadata = {
+					.ID = asset["ID"].as<AssetID>(),
+					.Type = magic_enum::enum_cast<AssetType>(asset["Type"].as<std::string>()).value_or(AssetType::Unknown),
+					.Path = asset["Path"].as<std::string>(),
+					.ContentHash = asset["Hash"] ? asset["Hash"].as<uint64_t>() : 0,
+				};
+
+				if (metadata.ID == NULL_ASSET || m_PathToID.contains(metadata.Path))
+				{
+					WC_CORE_WARN("Skipping duplicate asset {} in {}", metadata.Path, manifestPath);
+					continue;
+				}
+
+				m_PathToID[metadata.Path] = metadata.ID;
+				m_Assets[metadata.ID] = std::move(metadata);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			WC_CORE_ERROR("Failed to load {}: {}", manifestPath, e.what());
+		}
+	}
+
+	void AssetRegistry::Save()
+	{
+		if (!m_Dirty || !IsOpen()) return;
+
+		// Sorted by path so the manifest diffs nicely under version control
+		std::vector<const AssetMetadata*> assets;
+		assets.reserve(m_Assets.size());
+		for (const auto& [id, metadata] : m_Assets)
+			assets.push_back(&metadata);
+		std::sort(assets.begin(), assets.end(), [](const AssetMetadata* a, const AssetMetadata* b) { return a->Path < b->Path; });
+
+		YAML::Emitter emitter;
+		emitter << YAML::BeginMap << YAML::Key << "Assets" << YAML::Value << YAML::BeginSeq;
+		for (const auto* asset : assets)
+		{
+			emitter << YAML::BeginMap;
+			emitter << YAML::Key << "ID" << YAML::Value << asset->ID;
+			emitter << YAML::Key << "Type" << YAML::Value << std::string(magic_enum::enum_name(asset->Type));
+			emitter << YAML::Key << "Path" << YAML::Value << asset->Path;
+			emitter << YAML::Key << "Hash" << YAML::Value << asset->ContentHash;
+			emitter << YAML::EndMap;
+		}
+		emitter << YAML::EndSeq << YAML::EndMap;
+
+		YAMLUtils::SaveFile(m_ProjectPath + '/' + MANIFEST, emitter);
+		m_Dirty = false;
+	}
+
+	void AssetRegistry::Close()
+	{
+		Save();
+
+		m_ProjectPath.clear();
+		m_Assets.clear();
+		m_PathToID.clear();
+	}
+
+	AssetID AssetRegistry::Import(const std::string& path, AssetType type)
+	{
+		std::string relativePath = MakeRelative(path);
+		if (relativePath.empty()) return NULL_ASSET;
+
+		auto it = m_PathToID.find(relativePath);
+		if (it != m_PathToID.end()) return it->second;
+
+		AssetID id;
+		do id = m_Random(); while (id == NULL_ASSET || m_Assets.contains(id));
+
+		m_Assets[id] = {
+			.ID = id,
+			.Type = type != AssetType::Unknown ? type : GetTypeFromExtension(relativePath),
+			.Path = relativePath,
+			.ContentHash = wc::HashFile(m_ProjectPath + '/' + relativePath),
+		};
+		m_PathToID[relativePath] = id;
+		m_Dirty = true;
+		return id;
+	}
+
+	AssetID AssetRegistry::GetID(const std::string& path) const
+	{
+		auto it = m_PathToID.find(MakeRelative(path));
+		return it != m_PathToID.end() ? it->second : NULL_ASSET;
+	}
+
+	const AssetMetadata* AssetRegistry::Get(AssetID id) const
+	{
+		auto it = m_Assets.find(id);
+		return it != m_Assets.end() ? &it->second : nullptr;
+	}
+
+	std::string AssetRegistry::GetAbsolutePath(AssetID id) const
+	{
+		auto asset = Get(id);
+		return asset ? m_ProjectPath + '/' + asset->Path : std::string();
+	}
+
+	void AssetRegistry::Rename(const std::string& oldPath, const std::string& newPath)
+	{
+		std::string from = MakeRelative(oldPath);
+		std::string to = MakeRelative(newPath);
+		if (from.empty() || to.empty() || from == to) return;
+
+		for (auto& [id, asset] : m_Assets)
+		{
+			// Either the file itself or something inside the renamed directory
+			bool inside = asset.Path.size() > from.size() && asset.Path.starts_with(from) && asset.Path[from.size()] == '/';
+			if (asset.Path != from && !inside) continue;
+
+			m_PathToID.erase(asset.Path);
+			asset.Path = to + asset.Path.substr(from.size());
+			m_PathToID[asset.Path] = id;
+			m_Dirty = true;
+		}
+	}
+
+	void AssetRegistry::Remove(const std::string& path)
+	{
+		std::string relativePath = MakeRelative(path);
+		if (relativePath.empty()) return;
+
+		std::erase_if(m_Assets, [&](const auto& entry) {
+			const auto& asset = entry.second;
+			bool inside = asset.Path.size() > relativePath.size() && asset.Path.starts_with(relativePath) && asset.Path[relativePath.size()] == '/';
+			if (asset.Path != relativePath && !inside) return false;
+
+			m_PathToID.erase(asset.Path);
+			m_Dirty = true;
+			return true;
+			});
+	}
+
+	bool AssetRegistry::UpdateHash(AssetID id)
+	{
+		auto it = m_Assets.find(id);
+		if (it == m_Assets.end()) return false;
+
+		uint64_t hash = wc::HashFile(m_ProjectPath + '/' + it->second.Path);
+		if (hash == it->second.ContentHash) return false;
+
+		it->second.ContentHash = hash;
+		m_Dirty = true;
+		return true;
+	}
+
+	AssetType AssetRegistry::GetTypeFromExtension(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+		if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga") return AssetType::Texture;
+		if (extension == ".ttf" || extension == ".otf") return AssetType::Font;
+		if (extension == ".scene" || extension == ".blzscene") return AssetType::Scene;
+		if (extension == ".luau" || extension == ".lua") return AssetType::Script;
+		if (extension == ".wav" || extension == ".mp3" || extension == ".ogg" || extension == ".flac") return AssetType::Sound;
+		return AssetType::Unknown;
+	}
+
+	std::string AssetRegistry::MakeRelative(const std::string& path) const
+	{
+		if (m_ProjectPath.empty()) return {};
+
+		// Purely lexical, std::filesystem::relative would hit the disk on every lookup
+		std::filesystem::path normalized = std::filesystem::absolute(path).lexically_normal();
+
+		std::string relative = normalized.lexically_relative(m_ProjectPath).generic_string();
+		if (relative.empty() || relative.starts_with("..")) return {}; // Outside of the project
+		return relative;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace blaze
+{
+	using AssetID = uint64_t;
+	constexpr AssetID NULL_ASSET = 0;
+
+	enum class AssetType : uint8_t
+	{
+		Unknown,
+		Texture,
+		Font,
+		Scene,
+		Script,
+		Sound,
+	};
+
+	struct AssetMetadata
+	{
+		AssetID ID = NULL_ASSET;
+		AssetType Type = AssetType::Unknown;
+		std::string Path; // Relative to the project root, always with forward slashes
+		uint64_t ContentHash = 0; // XXH64 of the file when it was imported
+	};
+
+	// Project wide asset database, persisted in <project>/assets.yaml. Every asset gets a random 64-bit ID the first time
+	// it's referenced, scenes store that ID so references survive renames and moves done through the editor.
+	// Both directions are hash map lookups, paths are normalized lexically so no lookup touches the disk.
+	struct AssetRegistry
+	{
+		static constexpr const char* MANIFEST = "assets.yaml";
+
+		void Open(const std::string& projectPath);
+
+		// Only writes the manifest when something changed since the last save
+		void Save();
+
+		void Close();
+
+		// Returns the existing ID if the path is already registered, NULL_ASSET for paths outside of the project.
+		// Relative paths are resolved against the working directory like everywhere else
+		AssetID Import(const std::string& path, AssetType type = AssetType::Unknown);
+
+		AssetID GetID(const std::string& path) const;
+
+		const AssetMetadata* Get(AssetID id) const;
+
+		// Empty if the ID is unknown
+		std::string GetAbsolutePath(AssetID id) const;
+
+		// Keeps the IDs of a moved file or of everything inside a moved directory
+		void Rename(const std::string& oldPath, const std::string& newPath);
+
+		// Forgets the file or everything inside the directory
+		void Remove(const std::string& path);
+
+		// Rehashes the file, returns true if its content changed since it was imported
+		bool UpdateHash(AssetID id);
+
+		const std::unordered_map<AssetID, AssetMetadata>& GetAssets() const { return m_Assets; }
+		const std::string& GetProjectPath() const { return m_ProjectPath; }
+		bool IsOpen() const { return !m_ProjectPath.empty(); }
+
+		static AssetType GetTypeFromExtension(const std::string& path);
+
+	private:
+		std::string MakeRelative(const std::string& path) const;
+
+		std::string m_ProjectPath;
+		std::unordered_map<AssetID, AssetMetadata> m_Assets;
+		std::unordered_map<std::string, AssetID> m_PathToID;
+		bool m_Dirty = false;
+
+		std::mt19937_64 m_Random{ std::random_device{}() };
+	};
+
+	inline AssetRegistry assetRegistry;
+}
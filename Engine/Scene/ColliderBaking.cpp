@@ -0,0 +1,160 @@
+#include "ColliderBaking.h"
+
+#include <bit>
+#include <format>
+#include <map>
+#include <tuple>
+
+#include "../Utils/Profiler.h"
+
+namespace blaze
+{
+	namespace
+	{
+		// Right, up, left, down, so a left turn is the next one
+		constexpr glm::ivec2 DIRECTIONS[4] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+
+		constexpr size_t MAX_GRID_CELLS = 1 << 26;
+
+		struct Tile
+		{
+			flecs::entity_t Entity = 0;
+			glm::vec2 Center = glm::vec2(0.f);
+		};
+	}
+
+	std::vector<std::vector<glm::ivec2>> TraceGridOutlines(std::span<const uint8_t> solid, uint32_t width, uint32_t height)
+	{
+		auto IsSolid = [&](int x, int y) { return x >= 0 && y >= 0 && x < (int)width && y < (int)height && solid[size_t(y) * width + x]; };
+
+		// The edges between solid and empty cells as the directions that leave each corner, solid on the left
+		const size_t cornerWidth = size_t(width) + 1;
+		auto Corner = [&](glm::ivec2 corner) { return size_t(corner.y) * cornerWidth + corner.x; };
+
+		std::vector<uint8_t> edges(cornerWidth * (size_t(height) + 1), 0);
+		for (int y = 0; y < (int)height; y++)
+			for (int x = 0; x < (int)width; x++)
+			{
+				if (!IsSolid(x, y)) continue;
+				if (!IsSolid(x, y - 1)) edges[Corner({ x, y })] |= 1 << 0;
+				if (!IsSolid(x + 1, y)) edges[Corner({ x + 1, y })] |= 1 << 1;
+				if (!IsSolid(x, y + 1)) edges[Corner({ x + 1, y + 1 })] |= 1 << 2;
+				if (!IsSolid(x - 1, y)) edges[Corner({ x, y + 1 })] |= 1 << 3;
+			}
+
+		// Each edge continues left first. Where two cells only touch at a corner that keeps their outlines apart, and
+		// since it always picks the same way a loop ends on the edge it started with
+		std::vector<uint8_t> remaining = edges;
+		std::vector<std::vector<glm::ivec2>> outlines;
+		for (size_t start = 0; start < remaining.size(); start++)
+		{
+			if (!remaining[start]) continue;
+
+			const glm::ivec2 startCorner = { int(start % cornerWidth), int(start / cornerWidth) };
+			const int startDirection = std::countr_zero(remaining[start]);
+
+			auto& outline = outlines.emplace_back();
+			glm::ivec2 corner = startCorner;
+			int direction = startDirection;
+			do
+			{
+				remaining[Corner(corner)] &= ~(1 << direction);
+				corner += DIRECTIONS[direction];
+
+				const int previous = direction;
+				for (int turn : { 1, 0, 3 })
+					if (edges[Corner(corner)] & (1 << ((previous + turn) % 4)))
+					{
+						direction = (previous + turn) % 4;
+						break;
+					}
+
+				if (direction != previous) outline.push_back(corner);
+			} while (corner != startCorner || direction != startDirection);
+		}
+
+		return outlines;
+	}
+
+	TileBakeResult BakeTileColliders(Scene& scene)
+	{
+		WC_PROFILE_FUNCTION();
+
+		// Size, material, layer -> tiles. Entities with other colliders keep their body
+		std::map<std::tuple<float, float, uint32_t, uint32_t>, std::vector<Tile>> groups;
+		std::map<std::tuple<float, float, uint32_t, uint32_t>, float> depths;
+		scene.EntityWorld.each([&](flecs::entity entity, const TransformComponent& transform, const RigidBodyComponent& rigidBody, const BoxCollider2DComponent& collider) {
+			if (rigidBody.Type != BodyType::Static || transform.Rotation.z != 0.f || entity.parent() != flecs::entity::null()) return;
+			if (entity.has<CircleCollider2DComponent>() || entity.has<PolygonCollider2DComponent>() || entity.has<ChainCollider2DComponent>()) return;
+			if (collider.Size.x <= 0.f || collider.Size.y <= 0.f) return;
+
+			auto key = std::make_tuple(collider.Size.x, collider.Size.y, collider.MaterialID, collider.Layer);
+			groups[key].push_back({ entity, glm::vec2(transform.Translation) + collider.Offset });
+			depths.try_emplace(key, transform.Translation.z);
+			});
+
+		TileBakeResult result;
+		uint32_t chainIndex = 0;
+		for (const auto& [key, tiles] : groups)
+		{
+			const auto [width, height, material, layer] = key;
+			const glm::vec2 size = { width, height };
+
+			glm::vec2 origin = tiles.front().Center;
+			for (const auto& tile : tiles)
+				origin = glm::min(origin, tile.Center);
+
+			// Tiles that are off the grid stay as they are
+			std::vector<std::pair<flecs::entity_t, glm::ivec2>> cells;
+			glm::ivec2 extent = glm::ivec2(0);
+			for (const auto& tile : tiles)
+			{
+				glm::vec2 cell = (tile.Center - origin) / size;
+				glm::ivec2 index = glm::ivec2(glm::round(cell));
+				if (glm::any(glm::greaterThan(glm::abs(cell - glm::vec2(index)), glm::vec2(1e-3f)))) continue;
+
+				cells.emplace_back(tile.Entity, index);
+				extent = glm::max(extent, index + 1);
+			}
+
+			if (size_t(extent.x) * size_t(extent.y) > MAX_GRID_CELLS)
+			{
+				WC_CORE_WARN("Skipped baking {} tiles of {}x{}, they span {}x{} cells", cells.size(), width, height, extent.x, extent.y);
+				continue;
+			}
+
+			std::vector<uint8_t> solid(size_t(extent.x) * extent.y, 0);
+			for (const auto& [entity, index] : cells)
+				solid[size_t(index.y) * extent.x + index.x] = 1;
+
+			const glm::vec2 gridCorner = origin - size * 0.5f;
+			for (const auto& outline : TraceGridOutlines(solid, extent.x, extent.y))
+			{
+				ChainCollider2DComponent chain = { .MaterialID = material, .Layer = layer };
+				chain.Points.reserve(outline.size());
+				for (glm::ivec2 point : outline)
+					chain.Points.push_back(glm::vec2(point) * size);
+
+				std::string name;
+				do name = std::format("Tile chain {}", chainIndex++);
+				while (scene.EntityWorld.lookup(name.c_str()) != flecs::entity::null());
+
+				auto entity = scene.AddEntity(name);
+				entity.set<TransformComponent>({ .Translation = { gridCorner, depths[key] } });
+				entity.set<RigidBodyComponent>({ .Type = BodyType::Static });
+				entity.set<ChainCollider2DComponent>(chain);
+				result.Chains++;
+			}
+
+			for (const auto& [id, index] : cells)
+			{
+				flecs::entity entity(scene.EntityWorld, id);
+				entity.remove<BoxCollider2DComponent>();
+				entity.remove<RigidBodyComponent>();
+			}
+			result.Tiles += (uint32_t)cells.size();
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Scene.h"
+
+namespace blaze
+{
+	// Outlines of the solid cells of a row major grid with y up, adjacent cells merge into one outline. Every loop has the
+	// solid side on its left, outer outlines run counter clockwise and holes clockwise, which are the sides box2d chains
+	// collide on. Points are cell corners and only placed where the outline turns
+	std::vector<std::vector<glm::ivec2>> TraceGridOutlines(std::span<const uint8_t> solid, uint32_t width, uint32_t height);
+
+	struct TileBakeResult
+	{
+		uint32_t Tiles = 0;  // Bodies that went away
+		uint32_t Chains = 0; // Entities that took their place
+	};
+
+	// Replaces static, unrotated root entities with a box collider that sit on a grid with chain loops, one entity per
+	// loop. Tiles are grouped by collider size, material and layer. They keep every other component, only their rigid
+	// body and box collider are removed
+	TileBakeResult BakeTileColliders(Scene& scene);
+}
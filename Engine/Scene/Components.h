@@ -5,8 +5,9 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "box2d.h"
+#include "flecs.h"
 
-#include "../Rendering/Font.h"
+#include "../Rendering/AssetManager.h"
 
 #include "../Scripting/Script.h"
 
@@ -17,9 +18,18 @@ namespace blaze
 	    bool showEntity = true;
 	};
 
+	// Hierarchy order is an intrusive doubly linked list of entity IDs, so inserting, removing and moving an entity is O(1).
+	// Every listed entity has a link to its siblings, the parent holds the ends of its children's list (Scene::Roots for roots)
+	struct EntityLinkComponent
+	{
+		flecs::entity_t Previous = 0;
+		flecs::entity_t Next = 0;
+	};
+
 	struct EntityOrderComponent
 	{
-		std::vector<std::string> EntityOrder;
+		flecs::entity_t First = 0;
+		flecs::entity_t Last = 0;
 	};
 
 	struct TransformComponent
@@ -51,7 +61,7 @@ namespace blaze
 	struct SpriteRendererComponent
 	{
 		glm::vec4 Color = glm::vec4(1.f);
-		uint32_t Texture = 0;
+		TextureHandle Texture;
 	};
 
 	struct CircleRendererComponent
@@ -64,7 +74,7 @@ namespace blaze
 	struct TextRendererComponent
 	{
 		std::string Text;
-		uint32_t FontID = UINT32_MAX;
+		FontHandle FontID;
 		glm::vec4 Color = glm::vec4(1.f);
 		float Kerning = 0.f;
 		float LineSpacing = 0.f;
@@ -83,9 +93,7 @@ namespace blaze
 	struct RigidBodyComponent
 	{
 		// Don't expose in the ui
-		b2::Body body;
-		glm::vec2 prevPos;
-		float previousRotation = 0.f;
+		b2::Body body; // Its user data is the entity ID
 
 		BodyType Type = BodyType::Static;
 		bool FixedRotation = false;
@@ -143,6 +151,70 @@ namespace blaze
 
 			return shapeDef;
 		}
+
+		// Chains take the surface part only, they have no mass
+		b2SurfaceMaterial GetSurfaceMaterial() const
+		{
+			b2SurfaceMaterial material = b2DefaultSurfaceMaterial();
+			material.friction = Friction;
+			material.restitution = Restitution;
+			material.rollingResistance = RollingResistance;
+			material.customColor = glm::packUnorm4x8(DebugColor);
+
+			return material;
+		}
+	};
+
+	constexpr uint32_t COLLISION_LAYER_COUNT = 32;
+
+	// Category only queries have, every shape's mask includes it. box2d checks both sides of a query filter too, a layer
+	// that collides with nothing would otherwise be hidden from queries as well
+	constexpr uint64_t COLLISION_QUERY_BIT = 1ull << 63;
+
+	// Project wide named layers, every collider is on one of them. The broadphase only pairs shapes whose layers collide,
+	// so layers that never touch cost nothing past the tree query
+	struct CollisionLayerMatrix
+	{
+		std::string Names[COLLISION_LAYER_COUNT] = { "Default" }; // Empty for unused layers
+		uint32_t Masks[COLLISION_LAYER_COUNT]; // Bit j of Masks[i] is set if layer i collides with layer j, kept symmetric
+
+		CollisionLayerMatrix() { std::fill_n(Masks, COLLISION_LAYER_COUNT, UINT32_MAX); }
+
+		bool Collides(uint32_t a, uint32_t b) const { return Masks[a] & (1u << b); }
+
+		void SetCollides(uint32_t a, uint32_t b, bool collides)
+		{
+			if (collides)
+			{
+				Masks[a] |= 1u << b;
+				Masks[b] |= 1u << a;
+			}
+			else
+			{
+				Masks[a] &= ~(1u << b);
+				Masks[b] &= ~(1u << a);
+			}
+		}
+
+		// COLLISION_LAYER_COUNT if no layer has the name
+		uint32_t Find(std::string_view name) const
+		{
+			for (uint32_t i = 0; i < COLLISION_LAYER_COUNT; i++)
+				if (!Names[i].empty() && Names[i] == name) return i;
+			return COLLISION_LAYER_COUNT;
+		}
+
+		b2Filter GetFilter(uint32_t layer) const
+		{
+			b2Filter filter = b2DefaultFilter();
+			if (layer >= COLLISION_LAYER_COUNT) layer = 0;
+			filter.categoryBits = 1ull << layer;
+			filter.maskBits = Masks[layer] | COLLISION_QUERY_BIT;
+			return filter;
+		}
+
+		// Queries see every shape on the layers in the mask, whatever those layers collide with
+		static b2QueryFilter GetQueryFilter(uint32_t layerMask = UINT32_MAX) { return { .categoryBits = COLLISION_QUERY_BIT, .maskBits = layerMask }; }
 	};
 
 	struct BoxCollider2DComponent
@@ -151,6 +223,7 @@ namespace blaze
 		glm::vec2 Size = glm::vec2(1.f);
 
 		uint32_t MaterialID = 0; // @NOTE: This may need to be PhysMatID or something like that
+		uint32_t Layer = 0;      // Index into CollisionLayers
 
 		b2::Shape Shape;
 	};
@@ -161,10 +234,36 @@ namespace blaze
 		float Radius = 0.5f; // @TODO: if this is set to -1 derive the radius from other components
 
 		uint32_t MaterialID = 0;
+		uint32_t Layer = 0;
+
+		b2::Shape Shape;
+	};
+
+	// Convex hull of the points, at most B2_MAX_POLYGON_VERTICES of them
+	struct PolygonCollider2DComponent
+	{
+		std::vector<glm::vec2> Points = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.f, 0.5f } }; // Relative to the body
+		float Radius = 0.f; // Rounds the corners
+
+		uint32_t MaterialID = 0;
+		uint32_t Layer = 0;
 
 		b2::Shape Shape;
 	};
 
+	// Outlines for static terrain, a single body for what would otherwise be a body per tile. Chains are one sided and
+	// collide on the right of each segment, so a counter clockwise loop is solid inside and a clockwise one is a hole
+	struct ChainCollider2DComponent
+	{
+		std::vector<glm::vec2> Points; // Relative to the body, at least 4
+		bool Loop = true;
+
+		uint32_t MaterialID = 0;
+		uint32_t Layer = 0;
+
+		b2::Chain Chain;
+	};
+
 	// Scripting
 
 	struct ScriptComponent
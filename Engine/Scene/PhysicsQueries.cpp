@@ -0,0 +1,116 @@
+#include "PhysicsQueries.h"
+
+#include <algorithm>
+
+#include "Components.h"
+#include "../Utils/JobSystem.h"
+#include "../Utils/Profiler.h"
+
+namespace blaze
+{
+	namespace
+	{
+		// Rays and overlaps are short, smaller ranges cost more in dispatching than they gain
+		constexpr uint32_t MIN_QUERY_RANGE = 64;
+
+		b2QueryFilter GetFilter(uint32_t layerMask) { return CollisionLayerMatrix::GetQueryFilter(layerMask ? layerMask : UINT32_MAX); }
+
+		double GetEntity(b2ShapeId shape) { return (double)(uintptr_t)b2Shape_GetUserData(shape); }
+
+		// Where a query's entities went, a query runs entirely on one thread
+		struct PendingRange
+		{
+			uint32_t Thread = 0;
+			uint32_t First = 0;
+			uint32_t Count = 0;
+		};
+
+		// Each thread gathers into its own list, the lists are then packed in query order
+		template<typename Query, typename Overlap>
+		void RunOverlaps(std::span<const Query> queries, OverlapResults& results, Overlap&& overlap)
+		{
+			const uint32_t count = (uint32_t)queries.size();
+			std::vector<std::vector<double>> threadEntities(wc::jobSystem.GetThreadCount());
+			std::vector<PendingRange> pending(count);
+
+			wc::jobSystem.ParallelFor(count, MIN_QUERY_RANGE, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+				auto& entities = threadEntities[thread];
+				for (uint32_t i = begin; i < end; i++)
+				{
+					const uint32_t first = (uint32_t)entities.size();
+					overlap(queries[i], entities);
+					pending[i] = { thread, first, (uint32_t)entities.size() - first };
+				}
+				});
+
+			results.Ranges.resize(count);
+			uint32_t total = 0;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				results.Ranges[i] = { total, pending[i].Count };
+				total += pending[i].Count;
+			}
+
+			results.Entities.resize(total);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const auto& range = pending[i];
+				const double* source = threadEntities[range.Thread].data() + range.First;
+				std::copy(source, source + range.Count, results.Entities.begin() + results.Ranges[i].First);
+			}
+		}
+
+		bool CollectShape(b2ShapeId shape, void* context)
+		{
+			static_cast<std::vector<double>*>(context)->push_back(GetEntity(shape));
+			return true;
+		}
+	}
+
+	void CastRays(b2::World& world, std::span<const RayQuery> queries, std::span<RayHit> hits)
+	{
+		WC_PROFILE_FUNCTION();
+
+		const uint32_t count = (uint32_t)std::min(queries.size(), hits.size());
+		wc::jobSystem.ParallelFor(count, MIN_QUERY_RANGE, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+			for (uint32_t i = begin; i < end; i++)
+			{
+				const auto& query = queries[i];
+				b2RayResult result = world.CastRayClosest(query.Origin, query.Translation, GetFilter(query.LayerMask));
+				if (!result.hit)
+				{
+					hits[i] = {};
+					continue;
+				}
+
+				hits[i] = {
+					.Entity = GetEntity(result.shapeId),
+					.Point = { result.point.x, result.point.y },
+					.Normal = { result.normal.x, result.normal.y },
+					.Fraction = result.fraction,
+				};
+			}
+			});
+	}
+
+	void OverlapAABBs(b2::World& world, std::span<const AABBQuery> queries, OverlapResults& results)
+	{
+		WC_PROFILE_FUNCTION();
+
+		RunOverlaps(queries, results, [&](const AABBQuery& query, std::vector<double>& entities) {
+			const glm::vec2 lower = glm::min(query.Min, query.Max), upper = glm::max(query.Min, query.Max);
+			b2AABB aabb = { { lower.x, lower.y }, { upper.x, upper.y } };
+			world.OverlapAABB(aabb, GetFilter(query.LayerMask), CollectShape, &entities);
+			});
+	}
+
+	void OverlapCircles(b2::World& world, std::span<const CircleQuery> queries, OverlapResults& results)
+	{
+		WC_PROFILE_FUNCTION();
+
+		RunOverlaps(queries, results, [&](const CircleQuery& query, std::vector<double>& entities) {
+			b2Circle circle = { .center = { query.Center.x, query.Center.y }, .radius = std::max(query.Radius, 0.f) };
+			world.OverlapCircle(&circle, b2Transform_identity, GetFilter(query.LayerMask), CollectShape, &entities);
+			});
+	}
+}
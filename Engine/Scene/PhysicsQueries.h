@@ -0,0 +1,76 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "box2d.h"
+
+namespace blaze
+{
+	// Records of the packed buffers scripts hand to Physics.CastRays, Physics.OverlapAABBs and Physics.OverlapCircles,
+	// laid out for the buffer library: floats are f32, masks u32 and entities f64, which hold every flecs ID exactly.
+	// A mask of 0 is taken as every layer, so zeroed buffers query everything
+	struct RayQuery // 24 bytes
+	{
+		glm::vec2 Origin = glm::vec2(0.f);
+		glm::vec2 Translation = glm::vec2(0.f); // Direction times length
+		uint32_t LayerMask = 0;
+		uint32_t Padding = 0;
+	};
+
+	struct RayHit // 32 bytes
+	{
+		double Entity = 0.0; // 0 when the ray hit nothing
+		glm::vec2 Point = glm::vec2(0.f);
+		glm::vec2 Normal = glm::vec2(0.f);
+		float Fraction = 1.f; // Of the translation
+		uint32_t Padding = 0;
+	};
+
+	struct AABBQuery // 24 bytes
+	{
+		glm::vec2 Min = glm::vec2(0.f);
+		glm::vec2 Max = glm::vec2(0.f);
+		uint32_t LayerMask = 0;
+		uint32_t Padding = 0;
+	};
+
+	struct CircleQuery // 16 bytes
+	{
+		glm::vec2 Center = glm::vec2(0.f);
+		float Radius = 0.f;
+		uint32_t LayerMask = 0;
+	};
+
+	struct OverlapRange // 8 bytes
+	{
+		uint32_t First = 0; // Into OverlapResults::Entities
+		uint32_t Count = 0;
+	};
+
+	static_assert(sizeof(RayQuery) == 24 && sizeof(RayHit) == 32 && sizeof(AABBQuery) == 24 && sizeof(CircleQuery) == 16 && sizeof(OverlapRange) == 8);
+
+	struct OverlapResults
+	{
+		std::vector<OverlapRange> Ranges; // One per query
+		std::vector<double> Entities;     // One per shape found, grouped by query in query order
+
+		void Clear()
+		{
+			Ranges.clear();
+			Entities.clear();
+		}
+	};
+
+	// The batches run in parallel on the job system, the world can't step while they do. Every query sees the shapes
+	// whose layer is in its mask. Overlaps list an entity once per shape, chains once per segment, and AABB overlaps
+	// report the shapes whose bounds touch the box
+
+	void CastRays(b2::World& world, std::span<const RayQuery> queries, std::span<RayHit> hits);
+
+	void OverlapAABBs(b2::World& world, std::span<const AABBQuery> queries, OverlapResults& results);
+
+	void OverlapCircles(b2::World& world, std::span<const CircleQuery> queries, OverlapResults& results);
+}
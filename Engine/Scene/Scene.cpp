@@ -2,6 +2,8 @@
 
 #include "../Globals.h"
 #include "../Utils/YAML.h"
+#include "../Utils/Profiler.h"
+#include "../Utils/JobSystem.h"
 
 namespace blaze
 {
@@ -34,6 +36,18 @@ namespace blaze
 		YAMLUtils::SaveFile(filepath, data);
 	}
 
+	uint32_t AddPhysicsMaterial(const std::string& name, const PhysicsMaterial& material)
+	{
+		auto it = PhysicsMaterialNames.find(name);
+		if (it != PhysicsMaterialNames.end()) return it->second;
+
+		uint32_t id = uint32_t(PhysicsMaterials.size());
+		PhysicsMaterials.push_back(material);
+		PhysicsMaterialNamesByID.push_back(name);
+		PhysicsMaterialNames[name] = id;
+		return id;
+	}
+
 	void LoadPhysicsMaterials(const std::string& filepath)
 	{
 		if (!std::filesystem::exists(filepath))
@@ -63,12 +77,66 @@ namespace blaze
 				material.EnablePreSolveEvents = materialData["EnablePreSolveEvents"].as<bool>();
 				material.InvokeContactCreation = materialData["InvokeContactCreation"].as<bool>();
 				material.UpdateBodyMass = materialData["UpdateBodyMass"].as<bool>();
-				PhysicsMaterials.push_back(material);
-				PhysicsMaterialNames[materialName] = PhysicsMaterials.size() - 1;
+				AddPhysicsMaterial(materialName, material);
 			}
 		}
 	}
 
+	void SaveCollisionLayers(const std::string& filepath)
+	{
+		YAML::Node data;
+		for (uint32_t i = 0; i < COLLISION_LAYER_COUNT; i++)
+		{
+			if (CollisionLayers.Names[i].empty()) continue;
+
+			YAML::Node layer;
+			layer["Name"] = CollisionLayers.Names[i];
+			layer["Index"] = i;
+
+			YAML::Node collidesWith;
+			for (uint32_t j = 0; j < COLLISION_LAYER_COUNT; j++)
+				if (CollisionLayers.Collides(i, j)) collidesWith.push_back(j);
+			layer["CollidesWith"] = collidesWith;
+
+			data.push_back(layer); // A sequence, names aren't guaranteed to be unique
+		}
+
+		YAMLUtils::SaveFile(filepath, data);
+	}
+
+	void LoadCollisionLayers(const std::string& filepath)
+	{
+		CollisionLayers = {};
+		if (!std::filesystem::exists(filepath)) return;
+
+		auto LoadLayer = [](const std::string& name, const YAML::Node& layerData) {
+			uint32_t index = layerData["Index"].as<uint32_t>();
+			if (index >= COLLISION_LAYER_COUNT)
+			{
+				WC_CORE_ERROR("Collision layer {} has an invalid index {}", name, index);
+				return;
+			}
+
+			CollisionLayers.Names[index] = name;
+
+			uint32_t mask = 0;
+			for (const auto& other : layerData["CollidesWith"])
+				if (uint32_t j = other.as<uint32_t>(); j < COLLISION_LAYER_COUNT) mask |= 1u << j;
+
+			for (uint32_t j = 0; j < COLLISION_LAYER_COUNT; j++)
+				CollisionLayers.SetCollides(index, j, mask & (1u << j));
+			};
+
+		// Older files map names to layers
+		YAML::Node data = YAML::LoadFile(filepath);
+		if (data.IsSequence())
+			for (const auto& layerData : data)
+				LoadLayer(layerData["Name"].as<std::string>(), layerData);
+		else
+			for (const auto& layerPair : data)
+				LoadLayer(layerPair.first.as<std::string>(), layerPair.second);
+	}
+
 	uint32_t LoadScriptBinary(const std::string& filepath, bool reload)
 	{
 		if (ScriptBinaryCache.find(filepath) != ScriptBinaryCache.end())
@@ -79,11 +147,24 @@ namespace blaze
 				auto& script = ScriptBinaries[scriptID];
 				script.VariableNames.clear();
 				script.CompileScript(filepath);
+				scriptVM.ReleaseChunk(filepath);
 			}
 
 			return scriptID;
 		}
 
+		if (auto entry = assetPack.Find(filepath, AssetPackKind::Script))
+		{
+			auto data = assetPack.Read(*entry);
+			ScriptBinary binary;
+			if (binary.Deserialize(data.data(), data.size(), filepath))
+			{
+				ScriptBinaries.push_back(std::move(binary));
+				ScriptBinaryCache[filepath] = ScriptBinaries.size() - 1;
+				return ScriptBinaries.size() - 1;
+			}
+		}
+
 		if (!std::filesystem::exists(filepath))
 		{
 			WC_CORE_ERROR("{} does not exist", filepath);
@@ -98,127 +179,353 @@ namespace blaze
 		return ScriptBinaries.size() - 1;
 	}
 
-	void Scene::Create()
+	namespace
 	{
-		PhysicsWorld.Create(b2DefaultWorldDef());
+		// box2d hands its stages over as item ranges that run on the job system. Every task is finished before the step
+		// returns, so the slots are free again for the next one
+		struct PhysicsTask
+		{
+			wc::JobGroup Group;
+			b2TaskCallback* Callback = nullptr;
+			void* Context = nullptr;
+			std::atomic<bool> InUse = false;
+		};
 
-		/*EntityWorld.observer<BoxCollider2DComponent, RigidBodyComponent, TransformComponent>()
-			.event(flecs::Monitor).each([&](flecs::iter& it, size_t i, BoxCollider2DComponent& collider, RigidBodyComponent& rigidBody, TransformComponent& transform) {
-				if (it.event() == flecs::OnAdd)
-				{
-					b2BodyDef bodyDef = rigidBody.GetBodyDef();
+		PhysicsTask PhysicsTasks[128];
 
-					bodyDef.position = b2Vec2(transform.Translation.x + collider.Offset.x, transform.Translation.y + collider.Offset.y);
-					bodyDef.rotation = b2MakeRot(transform.Rotation);
-					rigidBody.body.Create(PhysicsWorld, bodyDef);
-					collider.Shape.CreatePolygonShape(rigidBody.body, PhysicsMaterials[collider.MaterialID].GetShapeDef(), b2MakeBox(collider.Size.x * 0.5f, collider.Size.y * 0.5f));
-				}
-				else if (it.event() == flecs::OnSet)
-				{
-					rigidBody.body.SetTransform(glm::vec2(transform.Translation) + collider.Offset, b2MakeRot(transform.Rotation));
-				}
-				else if (it.event() == flecs::OnRemove)
-				{
-					rigidBody.body.Destroy();
-				}
+		constexpr uint32_t MAX_PHYSICS_THREADS = 64; // B2_MAX_WORKERS, it isn't in box2d's public headers
+
+		void* EnqueuePhysicsTask(b2TaskCallback* callback, int itemCount, int minRange, void* taskContext, void* userContext)
+		{
+			auto& jobs = *static_cast<wc::JobSystem*>(userContext);
+			for (auto& task : PhysicsTasks)
+			{
+				if (task.InUse.exchange(true)) continue;
+
+				task.Callback = callback;
+				task.Context = taskContext;
+				jobs.Dispatch(task.Group, (uint32_t)itemCount, (uint32_t)minRange, [](uint32_t begin, uint32_t end, uint32_t thread, void* context) {
+					auto& task = *static_cast<PhysicsTask*>(context);
+					task.Callback((int)begin, (int)end, thread, task.Context);
+					}, &task);
+				return &task;
+			}
+
+			// Out of slots, box2d treats a null task as already done
+			callback(0, itemCount, jobs.GetThreadIndex(), taskContext);
+			return nullptr;
+		}
+
+		void FinishPhysicsTask(void* userTask, void* userContext)
+		{
+			if (!userTask) return;
+
+			auto& task = *static_cast<PhysicsTask*>(userTask);
+			static_cast<wc::JobSystem*>(userContext)->Wait(task.Group);
+			task.InUse = false;
+		}
+
+		// Steps on the job system when it has workers, the solver needs as many threads as box2d has workers
+		b2WorldDef GetPhysicsWorldDef()
+		{
+			b2WorldDef worldDef = b2DefaultWorldDef();
+			uint32_t threadCount = wc::jobSystem.GetThreadCount();
+			if (threadCount > 1 && threadCount <= MAX_PHYSICS_THREADS)
+			{
+				worldDef.workerCount = (int)threadCount;
+				worldDef.enqueueTask = EnqueuePhysicsTask;
+				worldDef.finishTask = FinishPhysicsTask;
+				worldDef.userTaskContext = &wc::jobSystem;
+			}
+
+			return worldDef;
+		}
+	}
+
+	Scene::Scene() { RegisterPhysicsObservers(); }
+
+	void Scene::Create() { CreatePhysicsWorld(); }
+
+	void Scene::CreatePhysicsWorld()
+	{
+		if (PhysicsWorld.IsValid()) PhysicsWorld.Destroy();
+
+		b2WorldDef worldDef = GetPhysicsWorldDef();
+		worldDef.gravity = { PhysicsWorldData.Gravity.x, PhysicsWorldData.Gravity.y };
+		PhysicsWorld.Create(worldDef);
+		PhysicsBodies.Clear();
+
+		// IDs from an old world could look valid in the new one
+		EntityWorld.each([this](flecs::entity entity, RigidBodyComponent& rigidBody) {
+			rigidBody.body = {};
+			QueuePhysicsChange(entity, PhysicsChange_Body);
 			});
+		EntityWorld.each([](BoxCollider2DComponent& collider) { collider.Shape = {}; });
+		EntityWorld.each([](CircleCollider2DComponent& collider) { collider.Shape = {}; });
+		EntityWorld.each([](PolygonCollider2DComponent& collider) { collider.Shape = {}; });
+		EntityWorld.each([](ChainCollider2DComponent& collider) { collider.Chain = {}; });
 
-		EntityWorld.observer<CircleCollider2DComponent, RigidBodyComponent, TransformComponent>()
-			.event(flecs::Monitor).each([&](flecs::iter& it, size_t i, CircleCollider2DComponent& collider, RigidBodyComponent& rigidBody, TransformComponent& transform) {
-				if (it.event() == flecs::OnAdd)
-				{
-					b2BodyDef bodyDef = rigidBody.GetBodyDef();
+		SyncPhysicsBodies();
+	}
 
-					bodyDef.position = b2Vec2(transform.Translation.x + collider.Offset.x, transform.Translation.y + collider.Offset.y);
-					bodyDef.rotation = b2MakeRot(transform.Rotation);
-					rigidBody.body.Create(PhysicsWorld, bodyDef);
-					collider.Shape.CreateCircleShape(rigidBody.body, PhysicsMaterials[collider.MaterialID].GetShapeDef(), { {0.f, 0.f}, collider.Radius });
-				}
-				else if (it.event() == flecs::OnSet)
-				{
-					rigidBody.body.SetTransform(glm::vec2(transform.Translation) + collider.Offset, b2MakeRot(transform.Rotation));
-				}
-				else if (it.event() == flecs::OnRemove)
+	void Scene::Destroy()
+	{
+		DeleteAllEntities();
+		if (PhysicsWorld) PhysicsWorld.Destroy();
+		PhysicsBodies.Clear();
+	}
+
+	void Scene::RegisterPhysicsObservers()
+	{
+		// Changes are only queued here, SyncPhysicsBodies applies them once per frame. Removals can't wait, the
+		// component holding the body is gone by then. Bodies and shapes carry the entity ID as user data, a copied
+		// component still points at the original's and must not destroy it
+		auto Owns = [](void* userData, flecs::entity_t entity) { return userData == (void*)(uintptr_t)entity; };
+
+		EntityWorld.observer<RigidBodyComponent>()
+			.event(flecs::OnAdd).event(flecs::OnSet).event(flecs::OnRemove)
+			.each([this, Owns](flecs::iter& it, size_t i, RigidBodyComponent& rigidBody) {
+				flecs::entity_t entity = it.entity(i);
+				if (it.event() != flecs::OnRemove)
+					QueuePhysicsChange(entity, PhysicsChange_Body);
+				else if (rigidBody.body.IsValid() && Owns(rigidBody.body.GetUserData(), entity))
 				{
+					PhysicsBodies.Remove(rigidBody.body);
 					rigidBody.body.Destroy();
 				}
-			});*/
+				});
+
+		auto ColliderChanged = [this, Owns](flecs::iter& it, size_t i, b2::Shape& shape) {
+			flecs::entity_t entity = it.entity(i);
+			if (it.event() != flecs::OnRemove)
+				QueuePhysicsChange(entity, PhysicsChange_Shapes);
+			else if (shape.IsValid() && Owns(shape.GetUserData(), entity))
+				shape.Destroy(true);
+			};
+
+		EntityWorld.observer<BoxCollider2DComponent>()
+			.event(flecs::OnAdd).event(flecs::OnSet).event(flecs::OnRemove)
+			.each([ColliderChanged](flecs::iter& it, size_t i, BoxCollider2DComponent& collider) { ColliderChanged(it, i, collider.Shape); });
+
+		EntityWorld.observer<CircleCollider2DComponent>()
+			.event(flecs::OnAdd).event(flecs::OnSet).event(flecs::OnRemove)
+			.each([ColliderChanged](flecs::iter& it, size_t i, CircleCollider2DComponent& collider) { ColliderChanged(it, i, collider.Shape); });
+
+		EntityWorld.observer<PolygonCollider2DComponent>()
+			.event(flecs::OnAdd).event(flecs::OnSet).event(flecs::OnRemove)
+			.each([ColliderChanged](flecs::iter& it, size_t i, PolygonCollider2DComponent& collider) { ColliderChanged(it, i, collider.Shape); });
+
+		EntityWorld.observer<ChainCollider2DComponent>()
+			.event(flecs::OnAdd).event(flecs::OnSet).event(flecs::OnRemove)
+			.each([this, Owns](flecs::iter& it, size_t i, ChainCollider2DComponent& collider) {
+				flecs::entity_t entity = it.entity(i);
+				if (it.event() != flecs::OnRemove)
+					QueuePhysicsChange(entity, PhysicsChange_Shapes);
+				else if (collider.Chain.IsValid() && Owns(collider.Chain.GetUserData(), entity))
+					collider.Chain.Destroy();
+				});
+
+		// Transforms written by the physics sync don't send OnSet, only edits do
+		EntityWorld.observer<TransformComponent>()
+			.event(flecs::OnSet)
+			.each([this](flecs::iter& it, size_t i, TransformComponent&) {
+				if (it.entity(i).has<RigidBodyComponent>()) QueuePhysicsChange(it.entity(i), PhysicsChange_Transform);
+				});
 	}
 
-	void Scene::CreatePhysicsWorld()
+	void Scene::CreateShapes(const flecs::entity& entity, const b2::Body& body)
 	{
-		b2WorldDef worldDef = b2DefaultWorldDef();
-		worldDef.gravity = { PhysicsWorldData.Gravity.x, PhysicsWorldData.Gravity.y };
-		PhysicsWorld.Create(worldDef);
-		EntityWorld.each([this](flecs::entity entt, RigidBodyComponent& p, TransformComponent& pos) {
-			if (p.body.IsValid()) return;
-			b2BodyDef bodyDef = p.GetBodyDef();
+		void* userData = (void*)(uintptr_t)entity.id();
+
+		// Offsets are relative to the body, so several colliders make up one body
+		if (auto collider = entity.get_mut<BoxCollider2DComponent>())
+		{
+			b2Polygon box = b2MakeOffsetBox(collider->Size.x * 0.5f, collider->Size.y * 0.5f, { collider->Offset.x, collider->Offset.y }, b2Rot_identity);
+			b2ShapeDef shapeDef = PhysicsMaterials[collider->MaterialID].GetShapeDef();
+			shapeDef.filter = CollisionLayers.GetFilter(collider->Layer);
+			collider->Shape.CreatePolygonShape(body, shapeDef, box);
+			collider->Shape.SetUserData(userData);
+		}
+
+		if (auto collider = entity.get_mut<CircleCollider2DComponent>())
+		{
+			b2ShapeDef shapeDef = PhysicsMaterials[collider->MaterialID].GetShapeDef();
+			shapeDef.filter = CollisionLayers.GetFilter(collider->Layer);
+			collider->Shape.CreateCircleShape(body, shapeDef, { { collider->Offset.x, collider->Offset.y }, collider->Radius });
+			collider->Shape.SetUserData(userData);
+		}
 
-			if (entt.has<BoxCollider2DComponent>())
+		if (auto collider = entity.get_mut<PolygonCollider2DComponent>())
+		{
+			b2Vec2 points[B2_MAX_POLYGON_VERTICES];
+			int count = (int)std::min<size_t>(collider->Points.size(), B2_MAX_POLYGON_VERTICES);
+			for (int i = 0; i < count; i++)
+				points[i] = { collider->Points[i].x, collider->Points[i].y };
+
+			b2Hull hull = b2ComputeHull(points, count);
+			if (hull.count == 0)
+				WC_CORE_WARN("Polygon collider of {} needs 3 to {} points that aren't on one line", entity.name().c_str(), B2_MAX_POLYGON_VERTICES);
+			else
 			{
-				auto collDef = entt.get_ref<BoxCollider2DComponent>();
-				bodyDef.position = b2Vec2(pos.Translation.x + collDef->Offset.x, pos.Translation.y + collDef->Offset.y);
-				bodyDef.rotation = b2MakeRot(pos.Rotation.z);
-				p.body.Create(PhysicsWorld, bodyDef);
-				collDef->Shape.CreatePolygonShape(p.body, PhysicsMaterials[collDef->MaterialID].GetShapeDef(), b2MakeBox(collDef->Size.x * 0.5f, collDef->Size.y * 0.5f));
+				b2ShapeDef shapeDef = PhysicsMaterials[collider->MaterialID].GetShapeDef();
+				shapeDef.filter = CollisionLayers.GetFilter(collider->Layer);
+				collider->Shape.CreatePolygonShape(body, shapeDef, b2MakePolygon(&hull, collider->Radius));
+				collider->Shape.SetUserData(userData);
 			}
+		}
 
-			if (entt.has<CircleCollider2DComponent>())
+		if (auto collider = entity.get_mut<ChainCollider2DComponent>())
+		{
+			if (collider->Points.size() < 4)
+				WC_CORE_WARN("Chain collider of {} needs at least 4 points", entity.name().c_str());
+			else
 			{
-				auto collDef = entt.get_ref<CircleCollider2DComponent>();
-				bodyDef.position = b2Vec2(pos.Translation.x + collDef->Offset.x, pos.Translation.y + collDef->Offset.y);
-				bodyDef.rotation = b2MakeRot(pos.Rotation.z);
-				p.body.Create(PhysicsWorld, bodyDef);
-				collDef->Shape.CreateCircleShape(p.body, PhysicsMaterials[collDef->MaterialID].GetShapeDef(), { {0.f, 0.f}, collDef->Radius });
+				static_assert(sizeof(glm::vec2) == sizeof(b2Vec2));
+				b2SurfaceMaterial material = PhysicsMaterials[collider->MaterialID].GetSurfaceMaterial();
+
+				b2ChainDef chainDef = b2DefaultChainDef();
+				chainDef.userData = userData;
+				chainDef.points = (const b2Vec2*)collider->Points.data();
+				chainDef.count = (int)collider->Points.size();
+				chainDef.materials = &material;
+				chainDef.materialCount = 1;
+				chainDef.filter = CollisionLayers.GetFilter(collider->Layer);
+				chainDef.isLoop = collider->Loop;
+				collider->Chain.Create(body, chainDef);
 			}
-			p.prevPos = { bodyDef.position.x, bodyDef.position.y };
-			p.previousRotation = pos.Rotation.z;
+		}
+	}
+
+	void Scene::UpdateCollisionFilters()
+	{
+		EntityWorld.each([](BoxCollider2DComponent& collider) {
+			if (collider.Shape.IsValid()) collider.Shape.SetFilter(CollisionLayers.GetFilter(collider.Layer));
+			});
+
+		EntityWorld.each([](CircleCollider2DComponent& collider) {
+			if (collider.Shape.IsValid()) collider.Shape.SetFilter(CollisionLayers.GetFilter(collider.Layer));
 			});
+
+		EntityWorld.each([](PolygonCollider2DComponent& collider) {
+			if (collider.Shape.IsValid()) collider.Shape.SetFilter(CollisionLayers.GetFilter(collider.Layer));
+			});
+
+		// Chains have no filter setter, they're built again
+		EntityWorld.each([this](flecs::entity entity, ChainCollider2DComponent&) { QueuePhysicsChange(entity, PhysicsChange_Shapes); });
 	}
 
-	void Scene::Destroy()
+	void Scene::SyncPhysicsBodies()
 	{
-		DeleteAllEntities();
-		if (PhysicsWorld) PhysicsWorld.Destroy();
+		if (!PhysicsWorld.IsValid()) return CreatePhysicsWorld(); // Queues every body again and comes back here
+		if (PhysicsChanges.empty()) return;
+
+		WC_PROFILE_FUNCTION();
+
+		// One entry per entity with every change it had this frame
+		std::sort(PhysicsChanges.begin(), PhysicsChanges.end());
+		size_t count = 0;
+		for (const auto& [entity, flags] : PhysicsChanges)
+		{
+			if (count != 0 && PhysicsChanges[count - 1].first == entity) PhysicsChanges[count - 1].second |= flags;
+			else PhysicsChanges[count++] = { entity, flags };
+		}
+		PhysicsChanges.resize(count);
+
+		for (auto [id, flags] : PhysicsChanges)
+		{
+			if (!EntityWorld.is_alive(id)) continue;
+
+			flecs::entity entity(EntityWorld, id);
+			auto rigidBody = entity.get_mut<RigidBodyComponent>();
+			auto transform = entity.get<TransformComponent>();
+			if (!rigidBody || !transform) continue;
+
+			void* userData = (void*)(uintptr_t)id;
+			auto& body = rigidBody->body;
+			bool owned = body.IsValid() && body.GetUserData() == userData;
+			if (!owned) flags |= PhysicsChange_Body;
+
+			glm::vec2 position = transform->Translation;
+			float rotation = transform->Rotation.z;
+
+			if (flags & PhysicsChange_Body)
+			{
+				if (owned)
+				{
+					PhysicsBodies.Remove(body);
+					body.Destroy(); // Takes its shapes along
+				}
+
+				b2BodyDef bodyDef = rigidBody->GetBodyDef();
+				bodyDef.position = { position.x, position.y };
+				bodyDef.rotation = b2MakeRot(rotation);
+				bodyDef.userData = userData;
+				body.Create(PhysicsWorld, bodyDef);
+
+				CreateShapes(entity, body);
+				PhysicsBodies.Add(body, id, position, rotation);
+				continue;
+			}
+
+			if (flags & PhysicsChange_Shapes)
+			{
+				auto DestroyShape = [&](b2::Shape& shape) { if (shape.IsValid() && shape.GetUserData() == userData) shape.Destroy(); };
+				if (auto collider = entity.get_mut<BoxCollider2DComponent>()) DestroyShape(collider->Shape);
+				if (auto collider = entity.get_mut<CircleCollider2DComponent>()) DestroyShape(collider->Shape);
+				if (auto collider = entity.get_mut<PolygonCollider2DComponent>()) DestroyShape(collider->Shape);
+				if (auto collider = entity.get_mut<ChainCollider2DComponent>(); collider && collider->Chain.IsValid() && collider->Chain.GetUserData() == userData)
+					collider->Chain.Destroy();
+
+				CreateShapes(entity, body);
+				b2Body_ApplyMassFromShapes(body);
+			}
+
+			if (flags & PhysicsChange_Transform)
+			{
+				body.SetTransform(position, b2MakeRot(rotation));
+				PhysicsBodies.Add(body, id, position, rotation);
+			}
+		}
+
+		PhysicsChanges.clear();
 	}
 
 	flecs::entity Scene::AddEntity() const { return EntityWorld.entity().add<EntityTag>(); }
 
 	flecs::entity Scene::AddEntity(const std::string& name)
 	{
-		EntityOrder.push_back(name);
-		return EntityWorld.entity(name.c_str()).add<EntityTag>();
+		auto entity = EntityWorld.entity(name.c_str()).add<EntityTag>();
+		LinkEntity(entity);
+		return entity;
 	}
 
 	void Scene::SetEntityName(const flecs::entity& entity, const std::string& name)
 	{
-		EntityOrder.push_back(name);
 		entity.set_name(name.c_str());
+		if (!entity.has<EntityLinkComponent>()) LinkEntity(entity);
 	}
 
-	void Scene::CopyEntity(const flecs::entity& ent, const flecs::entity& ent2) { ecs_clone(EntityWorld, ent2, ent, true); }
-	flecs::entity Scene::CopyEntity(const flecs::entity& ent) { return flecs::entity(EntityWorld, ecs_clone(EntityWorld, 0, ent, true)); }
-
-	void Scene::KillEntity(const flecs::entity& ent)
+	void Scene::CopyEntity(const flecs::entity& ent, const flecs::entity& ent2)
 	{
-		auto it = std::remove(EntityOrder.begin(), EntityOrder.end(), ent.name().c_str());
-		if (it != EntityOrder.end())
-			EntityOrder.erase(it, EntityOrder.end());
+		UnlinkEntity(ent2);
+		ecs_clone(EntityWorld, ent2, ent, true);
 
-		auto parent = ent.parent();
-		if (parent != flecs::entity::null() && parent.has<EntityOrderComponent>())
-		{
-			auto& order = parent.get_ref<EntityOrderComponent>()->EntityOrder;
-			auto childIt = std::remove(order.begin(), order.end(), ent.name().c_str());
-			if (childIt != order.end())
-			{
-				order.erase(childIt, order.end());
+		// The copied list pointers belong to `ent`, the children aren't cloned
+		ent2.remove<EntityOrderComponent>();
+		ent2.remove<EntityLinkComponent>();
+		if (ent.has<EntityLinkComponent>()) LinkEntity(ent2, GetLink(ent).Next);
+	}
 
-				if (order.empty())
-					parent.remove<EntityOrderComponent>();
-			}
-		}
+	flecs::entity Scene::CopyEntity(const flecs::entity& ent)
+	{
+		flecs::entity clone = EntityWorld.entity();
+		CopyEntity(ent, clone);
+		return clone;
+	}
 
+	void Scene::KillEntity(const flecs::entity& ent)
+	{
+		UnlinkEntity(ent);
 		ent.destruct();
 	}
 
@@ -238,23 +545,9 @@ namespace blaze
 				childTransform.Scale *= parentTransform->Scale;
 			}
 
+		UnlinkEntity(child);
 		child.remove(flecs::ChildOf, parent);
-
-		auto orderData = parent.get_ref<EntityOrderComponent>();
-
-		if (orderData)
-		{
-			auto& order = orderData->EntityOrder;
-			auto it = std::remove(order.begin(), order.end(), child.name().c_str());
-			if (it != order.end())
-			{
-				order.erase(it, order.end());
-
-				if (order.empty())
-					parent.remove<EntityOrderComponent>();
-			}
-		}
-		EntityOrder.push_back(std::string(child.name().c_str()));
+		LinkEntity(child);
 	}
 
 	void Scene::SetChild(const flecs::entity& parent, const flecs::entity& child, bool changeChildTransform)
@@ -262,9 +555,9 @@ namespace blaze
 		if (child.parent() != flecs::entity::null())
 			RemoveChild(child);
 
-		parent.add<EntityOrderComponent>();
-		parent.get_ref<EntityOrderComponent>()->EntityOrder.push_back(child.name().c_str());
+		UnlinkEntity(child);
 		child.add(flecs::ChildOf, parent);
+		LinkEntity(child);
 
 		if (changeChildTransform)
 			if (parent.has<TransformComponent>() && child.has<TransformComponent>())
@@ -274,67 +567,251 @@ namespace blaze
 				childTransform.Translation -= parentTransform->Translation;
 				childTransform.Scale /= parentTransform->Scale;
 			}
+	}
+
+	void Scene::MoveEntity(const flecs::entity& entity, const flecs::entity& target)
+	{
+		if (entity == target || entity.parent() != target.parent() || !target.has<EntityLinkComponent>()) return;
+
+		UnlinkEntity(entity);
+		LinkEntity(entity, GetLink(target).Next);
+	}
+
+	flecs::entity Scene::GetFirstChild(const flecs::entity& parent) const
+	{
+		if (parent == flecs::entity::null()) return flecs::entity(EntityWorld, Roots.First);
+
+		auto order = parent.get<EntityOrderComponent>();
+		return flecs::entity(EntityWorld, order ? order->First : 0);
+	}
+
+	flecs::entity Scene::GetNextSibling(const flecs::entity& entity) const
+	{
+		auto link = entity.get<EntityLinkComponent>();
+		return flecs::entity(EntityWorld, link ? link->Next : 0);
+	}
+
+	EntityOrderComponent& Scene::GetOrder(const flecs::entity& parent)
+	{
+		if (parent == flecs::entity::null()) return Roots;
+		return *parent.get_mut<EntityOrderComponent>();
+	}
 
-		EntityOrder.erase(std::remove(EntityOrder.begin(), EntityOrder.end(), child.name().c_str()), EntityOrder.end());
+	EntityLinkComponent& Scene::GetLink(flecs::entity_t entity) { return *flecs::entity(EntityWorld, entity).get_mut<EntityLinkComponent>(); }
+
+	void Scene::LinkEntity(const flecs::entity& entity, flecs::entity_t next)
+	{
+		if (entity.has<EntityLinkComponent>()) UnlinkEntity(entity);
+
+		// Table moves come first, they can relocate the components the pointers below point into
+		auto parent = entity.parent();
+		entity.add<EntityLinkComponent>();
+		if (parent != flecs::entity::null()) parent.add<EntityOrderComponent>();
+
+		auto& order = GetOrder(parent);
+		auto& link = GetLink(entity);
+		link.Next = next;
+		link.Previous = next ? GetLink(next).Previous : order.Last;
+
+		if (link.Previous) GetLink(link.Previous).Next = entity;
+		else order.First = entity;
+
+		if (next) GetLink(next).Previous = entity;
+		else order.Last = entity;
+	}
+
+	void Scene::UnlinkEntity(const flecs::entity& entity)
+	{
+		if (!entity.has<EntityLinkComponent>()) return;
+
+		auto parent = entity.parent();
+		auto& order = GetOrder(parent);
+		const auto link = GetLink(entity);
+
+		if (link.Previous) GetLink(link.Previous).Next = link.Next;
+		else order.First = link.Next;
+
+		if (link.Next) GetLink(link.Next).Previous = link.Previous;
+		else order.Last = link.Previous;
+
+		bool empty = order.First == 0;
+		entity.remove<EntityLinkComponent>();
+		if (empty && parent != flecs::entity::null()) parent.remove<EntityOrderComponent>();
 	}
 
 	void Scene::DeleteAllEntities()
 	{
+		// Every body goes along, the next sync starts a new world
+		if (PhysicsWorld.IsValid()) PhysicsWorld.Destroy();
+		PhysicsBodies.Clear();
+
 		EntityWorld.reset();
-		EntityOrder.clear();
+		Roots = {};
+
+		PhysicsChanges.clear();
+		RegisterPhysicsObservers();
 	}
 
 	void Scene::UpdatePhysics()
 	{
+		WC_PROFILE_FUNCTION();
+		SyncPhysicsBodies();
 		PhysicsWorld.SetGravity(PhysicsWorldData.Gravity);
 
 		AccumulatedTime += wc::Globals.deltaTime;
 
-		EntityWorld.each([](RigidBodyComponent& p, TransformComponent& pc) { // @TODO: Maybe optimize this?
-			if (!p.body.IsValid())
+		auto& bodies = PhysicsBodies;
+
+		// A new step starts from where the last one ended, bodies it doesn't move land on that pose below
+		if (AccumulatedTime >= SimulationTime)
+			for (uint32_t slot : bodies.Active)
 			{
-				WC_CORE_ERROR("Body is invalid!");
-				return;
+				bodies.PreviousPositions[slot] = bodies.Positions[slot];
+				bodies.PreviousRotations[slot] = bodies.Rotations[slot];
 			}
 
-			p.prevPos = p.body.GetPosition();
-			p.previousRotation = p.body.GetAngle();
-			});
+		auto& stats = PhysicsStats;
+		stats = { .SubSteps = PhysicsWorldData.SubSteps };
 
 		while (AccumulatedTime >= SimulationTime)
 		{
-			PhysicsWorld.Step(SimulationTime, 4);
+			// Catching up would take longer than the frame did, the simulation falls behind instead
+			if (stats.Steps >= std::max(PhysicsWorldData.MaxStepsPerFrame, 1u))
+			{
+				stats.DroppedSteps = uint32_t(AccumulatedTime / SimulationTime);
+				AccumulatedTime = std::fmod(AccumulatedTime, SimulationTime);
+				break;
+			}
+
+			WC_PROFILE_SCOPE("Physics Step");
+			PhysicsWorld.Step(SimulationTime, PhysicsWorldData.SubSteps);
+			stats.Steps++;
+
+			b2Profile profile = PhysicsWorld.GetProfile();
+			stats.Step += profile.step;
+			stats.Broadphase += profile.pairs + profile.refit;
+			stats.Narrowphase += profile.collide;
+			stats.Solver += profile.solve;
+			stats.SplitIslands += profile.splitIslands;
+			stats.SleepIslands += profile.sleepIslands;
+
+			// Only awake bodies get a move event
+			b2BodyEvents events = PhysicsWorld.GetBodyEvents();
+			for (int i = 0; i < events.moveCount; i++)
+			{
+				const auto& event = events.moveEvents[i];
+				uint32_t slot = PhysicsBodyStates::GetSlot(event.bodyId);
+				if (slot >= bodies.Entities.size()) continue; // Not created by the scene
+
+				bodies.Entities[slot] = (flecs::entity_t)(uintptr_t)event.userData;
+				bodies.Positions[slot] = { event.transform.p.x, event.transform.p.y };
+				bodies.Rotations[slot] = b2Rot_GetAngle(event.transform.q);
+				bodies.Activate(slot);
+			}
 
 			AccumulatedTime -= SimulationTime;
 		}
 
+		b2Counters counters = PhysicsWorld.GetCounters();
+		stats.Bodies = counters.bodyCount;
+		stats.AwakeBodies = PhysicsWorld.GetAwakeBodyCount();
+		stats.Shapes = counters.shapeCount;
+		stats.Contacts = counters.contactCount;
+		stats.Islands = counters.islandCount;
+
+		WC_PROFILE_COUNTER("Physics steps", stats.Steps);
+		WC_PROFILE_COUNTER("Physics step ms", stats.Step);
+		WC_PROFILE_COUNTER("Physics broadphase ms", stats.Broadphase);
+		WC_PROFILE_COUNTER("Physics narrowphase ms", stats.Narrowphase);
+		WC_PROFILE_COUNTER("Physics solver ms", stats.Solver);
+		WC_PROFILE_COUNTER("Physics split islands ms", stats.SplitIslands);
+		WC_PROFILE_COUNTER("Physics sleep islands ms", stats.SleepIslands);
+		WC_PROFILE_COUNTER("Physics bodies", stats.Bodies);
+		WC_PROFILE_COUNTER("Physics awake bodies", stats.AwakeBodies);
+		WC_PROFILE_COUNTER("Physics contacts", stats.Contacts);
+
 		float alpha = AccumulatedTime / SimulationTime;
 
-		EntityWorld.each([&alpha](RigidBodyComponent& p, TransformComponent& pc)
-			{
-				if (!p.body.IsValid())
+		WC_PROFILE_SCOPE("Physics Sync");
+		for (size_t i = 0; i < bodies.Active.size();)
+		{
+			uint32_t slot = bodies.Active[i];
+			bool settled = bodies.PreviousPositions[slot] == bodies.Positions[slot] && bodies.PreviousRotations[slot] == bodies.Rotations[slot];
+
+			if (EntityWorld.is_alive(bodies.Entities[slot]))
+				if (auto transform = flecs::entity(EntityWorld, bodies.Entities[slot]).get_mut<TransformComponent>())
 				{
-					WC_CORE_ERROR("Body is invalid!");
-					return;
+					transform->Translation = { glm::mix(bodies.PreviousPositions[slot], bodies.Positions[slot], alpha), transform->Translation.z };
+					transform->Rotation.z = glm::mix(bodies.PreviousRotations[slot], bodies.Rotations[slot], alpha);
 				}
-				pc.Translation = { glm::mix(p.prevPos, p.body.GetPosition(), alpha), pc.Translation.z };
 
-				float start = p.previousRotation;
-				float end = p.body.GetAngle();
-				//auto diff = end - start;
-
-				pc.Rotation.z = glm::mix(start, end, alpha);
-			});
+			if (settled)
+			{
+				bodies.IsActive[slot] = 0;
+				bodies.Active[i] = bodies.Active.back();
+				bodies.Active.pop_back();
+			}
+			else
+				i++;
+		}
 	}
 
 	void Scene::Update()
 		{
-			EntityWorld.each([](ScriptComponent& script)
-				{
-					if (script.ScriptInstance)
-						script.ScriptInstance.state.Execute("Update");
-				});
+			WC_PROFILE_FUNCTION();
+			{
+				WC_PROFILE_SCOPE("Scripts Update");
+				ScriptScene = this;
+				EntityWorld.each([](ScriptComponent& script)
+					{
+						if (script.ScriptInstance)
+							script.ScriptInstance.state.Execute("Update");
+					});
+				ScriptScene = nullptr;
+			}
 
 			UpdatePhysics();
 		}
-}
\ No newline at end of file
+
+	void Scene::Render(RenderData& renderData)
+	{
+		EntityWorld.each([&](flecs::entity entt, TransformComponent& p) {
+			if (entt.parent() != 0) return;
+
+			glm::mat4 transform = p.GetTransform();
+			RenderEntity(renderData, entt, transform);
+			});
+	}
+
+	void Scene::RenderEntity(RenderData& renderData, flecs::entity entt, glm::mat4& transform)
+	{
+		if (entt.get<EntityTag>()->showEntity)
+		{
+			if (entt.has<SpriteRendererComponent>())
+			{
+				auto& data = *entt.get<SpriteRendererComponent>();
+
+				renderData.DrawQuad(transform, data.Texture, data.Color, entt.id());
+			}
+			else if (entt.has<CircleRendererComponent>())
+			{
+				auto& data = *entt.get<CircleRendererComponent>();
+				renderData.DrawCircle(transform, data.Thickness, data.Fade, data.Color, entt.id());
+			}
+			else if (entt.has<TextRendererComponent>())
+			{
+				auto& data = *entt.get<TextRendererComponent>();
+
+				if (data.FontID != UINT32_MAX)
+					renderData.DrawString(data.Text, assetManager.Fonts[data.FontID], transform, data.Color, data.LineSpacing, data.Kerning, entt.id());
+			}
+			EntityWorld.query_builder<TransformComponent, EntityTag>()
+				.with(flecs::ChildOf, entt)
+				.each([&](flecs::entity child, TransformComponent childTransform, EntityTag)
+					{
+						transform = transform * childTransform.GetTransform();
+						RenderEntity(renderData, child, transform);
+					});
+		}
+	}
+}
@@ -3,6 +3,7 @@
 #include "flecs.h"
 #include "Components.h"
 #include "../Rendering/AssetManager.h"
+#include "../Rendering/RenderData.h"
 
 namespace blaze
 {
@@ -10,6 +11,86 @@ namespace blaze
 	{
 		glm::vec2 Gravity = { 0.f, -9.8f };
 		float TimeStep = 1.f / 60.f;
+		uint32_t SubSteps = 4;
+		uint32_t MaxStepsPerFrame = 8; // Time past this many steps is dropped, so a slow frame can't make the next one slower
+	};
+
+	// What the physics of the last frame cost, box2d's profile of each step summed up. Times are in milliseconds
+	struct PhysicsFrameStats
+	{
+		uint32_t Steps = 0;
+		uint32_t DroppedSteps = 0; // Cut by MaxStepsPerFrame
+		uint32_t SubSteps = 0;
+
+		float Step = 0.f;
+		float Broadphase = 0.f;  // Pair finding and tree refits
+		float Narrowphase = 0.f; // Contact updates
+		float Solver = 0.f;
+		float SplitIslands = 0.f;
+		float SleepIslands = 0.f;
+
+		int Bodies = 0;
+		int AwakeBodies = 0;
+		int Shapes = 0;
+		int Contacts = 0;
+		int Islands = 0;
+	};
+
+	// Interpolation state of the scene's bodies as parallel arrays indexed by the body's slot in the box2d world. The sync
+	// walks the move events of each step and the bodies still being interpolated, so sleeping and static bodies cost nothing
+	struct PhysicsBodyStates
+	{
+		std::vector<flecs::entity_t> Entities; // From the body's user data
+		std::vector<glm::vec2> PreviousPositions;
+		std::vector<glm::vec2> Positions;
+		std::vector<float> PreviousRotations;
+		std::vector<float> Rotations;
+		std::vector<uint8_t> IsActive;
+
+		std::vector<uint32_t> Active; // Slots that moved in the last step or still have to land on their final pose
+
+		static uint32_t GetSlot(b2BodyId body) { return uint32_t(body.index1 - 1); }
+
+		void Add(b2BodyId body, flecs::entity_t entity, glm::vec2 position, float rotation)
+		{
+			uint32_t slot = GetSlot(body);
+			if (slot >= Entities.size())
+			{
+				Entities.resize(slot + 1, 0);
+				PreviousPositions.resize(slot + 1);
+				Positions.resize(slot + 1);
+				PreviousRotations.resize(slot + 1);
+				Rotations.resize(slot + 1);
+				IsActive.resize(slot + 1, 0);
+			}
+
+			Entities[slot] = entity;
+			PreviousPositions[slot] = Positions[slot] = position;
+			PreviousRotations[slot] = Rotations[slot] = rotation;
+		}
+
+		void Activate(uint32_t slot)
+		{
+			if (IsActive[slot]) return;
+			IsActive[slot] = 1;
+			Active.push_back(slot);
+		}
+
+		// The body is going away, its slot stops being written to once it settles
+		void Remove(b2BodyId body)
+		{
+			uint32_t slot = GetSlot(body);
+			if (slot < Entities.size()) Entities[slot] = 0;
+		}
+
+		void Clear() { *this = {}; }
+	};
+
+	enum PhysicsChangeFlags : uint8_t
+	{
+		PhysicsChange_Body = 1 << 0, // Created again along with its shapes
+		PhysicsChange_Shapes = 1 << 1,
+		PhysicsChange_Transform = 1 << 2, // Teleported to the entity's transform
 	};
 
 	using Cache = std::unordered_map<std::string, uint32_t>;
@@ -17,35 +98,61 @@ namespace blaze
 	template<typename T>
 	using Storage = std::vector<T>;
 
-	inline AssetManager assetManager;
-
 	inline Storage<PhysicsMaterial> PhysicsMaterials;
 	inline Cache PhysicsMaterialNames;
+	inline Storage<std::string> PhysicsMaterialNamesByID;
+
+	inline CollisionLayerMatrix CollisionLayers;
 
 	inline Storage<ScriptBinary> ScriptBinaries;
 	inline Cache ScriptBinaryCache;
 
+	// Keeps PhysicsMaterialNames and PhysicsMaterialNamesByID in sync, returns the ID of the existing material if the name is taken
+	uint32_t AddPhysicsMaterial(const std::string& name, const PhysicsMaterial& material = {});
+
 	void SavePhysicsMaterials(const std::string& filepath);
 
 	void LoadPhysicsMaterials(const std::string& filepath);
 
+	// Only named layers are written, a project without the file has every layer colliding with every other
+	void SaveCollisionLayers(const std::string& filepath);
+
+	void LoadCollisionLayers(const std::string& filepath);
+
 	uint32_t LoadScriptBinary(const std::string& filepath, bool reload = false);
 
 	struct Scene
 	{
+		// Both are declared before the world, its observers still run while it's destroyed
+		std::vector<std::pair<flecs::entity_t, uint8_t>> PhysicsChanges; // Entities whose body has to catch up with their components
+		PhysicsBodyStates PhysicsBodies;
+
 		flecs::world EntityWorld;
 		b2::World PhysicsWorld;
 		PhysicsWorldData PhysicsWorldData;
+		PhysicsFrameStats PhysicsStats;
 
-		std::vector<std::string> EntityOrder; // only parents
+		EntityOrderComponent Roots; // Named entities without a parent, in hierarchy order
 
 		float AccumulatedTime = 0.f;
 		const float SimulationTime = 1.f / 60.f;
 
+		Scene();
+		Scene(const Scene&) = delete;
+		Scene& operator=(const Scene&) = delete;
+
 		void Create();
 
+		// Starts over with an empty world and creates every body again
 		void CreatePhysicsWorld();
 
+		// Creates, rebuilds and teleports the bodies whose components changed since the last call. Runs every frame, in
+		// edit mode too, so entering play mode starts from a world that's already built
+		void SyncPhysicsBodies();
+
+		// Applies an edited CollisionLayers to the existing shapes
+		void UpdateCollisionFilters();
+
 		void Destroy();
 
 		flecs::entity AddEntity() const;
@@ -63,10 +170,49 @@ namespace blaze
 
 		void SetChild(const flecs::entity& parent, const flecs::entity& child, bool changeChildTransform = true);
 
+		// Places the entity right after `target`, both have to have the same parent
+		void MoveEntity(const flecs::entity& entity, const flecs::entity& target);
+
+		// A null parent gives the roots. Null entities mark the ends
+		flecs::entity GetFirstChild(const flecs::entity& parent) const;
+		flecs::entity GetNextSibling(const flecs::entity& entity) const;
+
+		// The function may remove or move the child it's given
+		template<typename Function>
+		void EachChild(const flecs::entity& parent, Function&& function) const
+		{
+			for (auto child = GetFirstChild(parent); child;)
+			{
+				auto next = GetNextSibling(child);
+				function(child);
+				child = next;
+			}
+		}
+
 		void DeleteAllEntities();
 
 		void UpdatePhysics();
 
 		void Update();
+
+		// Draws every visible entity, shared by the editor viewport and the headless runner
+		void Render(RenderData& renderData);
+
+		void RenderEntity(RenderData& renderData, flecs::entity entt, glm::mat4& transform);
+
+	private:
+		void RegisterPhysicsObservers();
+		void QueuePhysicsChange(flecs::entity_t entity, uint8_t flags) { PhysicsChanges.emplace_back(entity, flags); }
+		void CreateShapes(const flecs::entity& entity, const b2::Body& body);
+
+		EntityOrderComponent& GetOrder(const flecs::entity& parent);
+		EntityLinkComponent& GetLink(flecs::entity_t entity);
+
+		// Appends to the list of the entity's current parent, or inserts before `next`
+		void LinkEntity(const flecs::entity& entity, flecs::entity_t next = 0);
+		void UnlinkEntity(const flecs::entity& entity);
 	};
+
+	// The scene whose scripts are running, null outside of them. Bindings that reach into the world go through it
+	inline Scene* ScriptScene = nullptr;
 }
\ No newline at end of file
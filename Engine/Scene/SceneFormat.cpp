@@ -0,0 +1,502 @@
+#include "SceneFormat.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include <magic_enum.hpp>
+
+#include "Components.h"
+
+#include "../Utils/Log.h"
+#include "../Utils/MappedFile.h"
+
+namespace blaze
+{
+	namespace
+	{
+		constexpr const char* NULL_NAME = "null[5ws78@!12]"; // How the YAML tells an entity named "null" from an unnamed one
+		constexpr uint32_t MAX_RECORD_SIZE = 4096;
+
+		uint64_t AlignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+		uint32_t AddAsset(SceneFileWriter& writer, const YAML::Node& data, const std::string& key, AssetType type)
+		{
+			AssetID id = data[key + "ID"] ? data[key + "ID"].as<AssetID>() : NULL_ASSET;
+			return writer.AddAsset(id, data[key].as<std::string>(), type);
+		}
+
+		uint32_t AddMaterial(SceneFileWriter& writer, const YAML::Node& data)
+		{
+			return data["Material"] ? writer.AddString(data["Material"].as<std::string>()) : SCENE_NONE;
+		}
+
+		uint32_t GetLayer(const YAML::Node& data) { return data["Layer"] ? data["Layer"].as<uint32_t>() : 0; }
+
+		void WriteEntity(SceneFileWriter& writer, const YAML::Node& entityData, uint32_t parent)
+		{
+			std::string name = entityData["Name"].as<std::string>();
+			uint32_t entity = writer.AddEntity(name == "null" ? SCENE_NONE : writer.AddString(name == NULL_NAME ? "null" : name), parent);
+
+			if (auto data = entityData["TransformComponent"])
+			{
+				writer.AddComponent(SceneComponent::Transform, entity, SceneTransformRecord{
+					.Translation = data["Translation"].as<glm::vec3>(),
+					.Scale = data["Scale"].as<glm::vec3>(),
+					.Rotation = glm::radians(data["Rotation"].as<glm::vec3>()),
+					});
+			}
+
+			if (auto data = entityData["TextRendererComponent"])
+			{
+				writer.AddComponent(SceneComponent::TextRenderer, entity, SceneTextRecord{
+					.Color = data["Color"].as<glm::vec4>(),
+					.Text = writer.AddString(data["Text"].as<std::string>()),
+					.Font = data["Font"] ? AddAsset(writer, data, "Font", AssetType::Font) : SCENE_NONE,
+					.Kerning = data["Kerning"].as<float>(),
+					.LineSpacing = data["LineSpacing"].as<float>(),
+					});
+			}
+
+			if (auto data = entityData["SpriteRendererComponent"])
+			{
+				writer.AddComponent(SceneComponent::SpriteRenderer, entity, SceneSpriteRecord{
+					.Color = data["Color"].as<glm::vec4>(),
+					.Texture = data["Texture"].as<std::string>() != "None" ? AddAsset(writer, data, "Texture", AssetType::Texture) : SCENE_NONE,
+					});
+			}
+
+			if (auto data = entityData["CircleRendererComponent"])
+			{
+				writer.AddComponent(SceneComponent::CircleRenderer, entity, SceneCircleRecord{
+					.Color = data["Color"].as<glm::vec4>(),
+					.Thickness = data["Thickness"].as<float>(),
+					.Fade = data["Fade"].as<float>(),
+					});
+			}
+
+			if (auto data = entityData["RigidBodyComponent"])
+			{
+				writer.AddComponent(SceneComponent::RigidBody, entity, SceneRigidBodyRecord{
+					.Type = (uint32_t)magic_enum::enum_cast<BodyType>(data["Type"].as<std::string>()).value(),
+					.FixedRotation = data["FixedRotation"].as<bool>(),
+					.Bullet = data["Bullet"].as<bool>(),
+					.FastRotation = data["FastRotation"].as<bool>(),
+					.GravityScale = data["GravityScale"].as<float>(),
+					.LinearDamping = data["LinearDamping"].as<float>(),
+					.AngularDamping = data["AngularDamping"].as<float>(),
+					});
+			}
+
+			if (auto data = entityData["BoxCollider2DComponent"])
+			{
+				writer.AddComponent(SceneComponent::BoxCollider2D, entity, SceneBoxColliderRecord{
+					.Offset = data["Offset"].as<glm::vec2>(),
+					.Size = data["Size"].as<glm::vec2>(),
+					.Material = AddMaterial(writer, data),
+					.Layer = GetLayer(data),
+					});
+			}
+
+			if (auto data = entityData["CircleCollider2DComponent"])
+			{
+				writer.AddComponent(SceneComponent::CircleCollider2D, entity, SceneCircleColliderRecord{
+					.Offset = data["Offset"].as<glm::vec2>(),
+					.Radius = data["Radius"].as<float>(),
+					.Material = AddMaterial(writer, data),
+					.Layer = GetLayer(data),
+					});
+			}
+
+			if (auto data = entityData["PolygonCollider2DComponent"])
+			{
+				writer.AddComponent(SceneComponent::PolygonCollider2D, entity, ScenePolygonColliderRecord{
+					.Points = writer.AddPoints(data["Points"].as<std::vector<glm::vec2>>()),
+					.Radius = data["Radius"] ? data["Radius"].as<float>() : 0.f,
+					.Material = AddMaterial(writer, data),
+					.Layer = GetLayer(data),
+					});
+			}
+
+			if (auto data = entityData["ChainCollider2DComponent"])
+			{
+				writer.AddComponent(SceneComponent::ChainCollider2D, entity, SceneChainColliderRecord{
+					.Points = writer.AddPoints(data["Points"].as<std::vector<glm::vec2>>()),
+					.Loop = data["Loop"] ? data["Loop"].as<bool>() : true,
+					.Material = AddMaterial(writer, data),
+					.Layer = GetLayer(data),
+					});
+			}
+
+			if (auto data = entityData["ScriptComponent"])
+				writer.AddComponent(SceneComponent::Script, entity, SceneScriptRecord{ .Script = AddAsset(writer, data, "Path", AssetType::Script) });
+
+			if (auto children = entityData["Children"])
+				for (const auto& child : children)
+					WriteEntity(writer, child, entity);
+		}
+	}
+
+	uint32_t SceneFileWriter::AddString(std::string_view string)
+	{
+		auto [it, inserted] = m_StringIndices.try_emplace(std::string(string), (uint32_t)m_Strings.size());
+		if (inserted)
+		{
+			m_Strings.push_back({ (uint32_t)m_Characters.size(), (uint32_t)string.size() });
+			m_Characters += string;
+		}
+		return it->second;
+	}
+
+	uint32_t SceneFileWriter::AddAsset(AssetID id, std::string_view path, AssetType type)
+	{
+		uint32_t pathIndex = AddString(path);
+		auto [it, inserted] = m_AssetIndices.try_emplace({ id, pathIndex }, (uint32_t)m_Assets.size());
+		if (inserted) m_Assets.push_back({ .ID = id, .Path = pathIndex, .Type = (uint32_t)type });
+		return it->second;
+	}
+
+	uint32_t SceneFileWriter::AddEntity(uint32_t name, uint32_t parent)
+	{
+		m_Entities.push_back({ name, parent });
+		return (uint32_t)m_Entities.size() - 1;
+	}
+
+	std::vector<uint8_t> SceneFileWriter::Finish()
+	{
+		std::vector<uint8_t> data(sizeof(SceneFileHeader));
+		auto Append = [&](const void* source, size_t size) {
+			uint64_t offset = AlignUp(data.size(), 8);
+			data.resize(offset + size);
+			if (size) memcpy(data.data() + offset, source, size);
+			return offset;
+			};
+
+		Header.Magic = SceneFileHeader::MAGIC;
+		Header.Version = SceneFileHeader::VERSION;
+		Header.EntityCount = (uint32_t)m_Entities.size();
+		Header.AssetCount = (uint32_t)m_Assets.size();
+		Header.StringCount = (uint32_t)m_Strings.size();
+		Header.EntitiesOffset = Append(m_Entities.data(), m_Entities.size() * sizeof(SceneEntityRecord));
+		Header.AssetsOffset = Append(m_Assets.data(), m_Assets.size() * sizeof(SceneAssetRecord));
+		Header.StringsOffset = Append(m_Strings.data(), m_Strings.size() * sizeof(SceneStringRecord));
+		Header.CharactersOffset = Append(m_Characters.data(), m_Characters.size());
+		Header.CharactersSize = m_Characters.size();
+
+		std::vector<SceneColumnHeader> columns;
+		for (uint32_t i = 0; i < (uint32_t)SceneComponent::Count; i++)
+		{
+			const auto& column = m_Columns[i];
+			if (column.Entities.empty()) continue;
+
+			SceneColumnHeader header = { .Component = i, .Count = (uint32_t)column.Entities.size(), .RecordSize = column.RecordSize };
+			header.EntitiesOffset = Append(column.Entities.data(), column.Entities.size() * sizeof(uint32_t));
+			header.RecordsOffset = Append(column.Records.data(), column.Records.size());
+			columns.push_back(header);
+		}
+
+		Header.ColumnCount = (uint32_t)columns.size();
+		Header.ColumnsOffset = Append(columns.data(), columns.size() * sizeof(SceneColumnHeader));
+		data.resize(AlignUp(data.size(), 8));
+
+		memcpy(data.data(), &Header, sizeof(SceneFileHeader));
+		return data;
+	}
+
+	bool SceneFileReader::IsSceneFile(const uint8_t* data, size_t size)
+	{
+		uint32_t magic = 0;
+		if (size >= sizeof(magic)) memcpy(&magic, data, sizeof(magic));
+		return magic == SceneFileHeader::MAGIC;
+	}
+
+	bool SceneFileReader::Open(const uint8_t* data, size_t size)
+	{
+		*this = {};
+
+		auto Fail = [&](const char* reason) {
+			WC_CORE_ERROR("Not a valid binary scene: {}", reason);
+			*this = {};
+			return false;
+			};
+
+		if (size < sizeof(SceneFileHeader)) return Fail("too small");
+		if ((uintptr_t)data % alignof(SceneFileHeader) != 0) return Fail("misaligned");
+
+		const auto& header = *(const SceneFileHeader*)data;
+		if (header.Magic != SceneFileHeader::MAGIC) return Fail("wrong magic");
+		if (header.Version != SceneFileHeader::VERSION) return Fail("unsupported version");
+
+		// Counts are 32-bit and element sizes are capped, none of the products can overflow
+		auto InBounds = [&](uint64_t offset, uint64_t count, uint64_t elementSize) { return offset % 8 == 0 && offset <= size && count * elementSize <= size - offset; };
+		if (!InBounds(header.EntitiesOffset, header.EntityCount, sizeof(SceneEntityRecord)) ||
+			!InBounds(header.AssetsOffset, header.AssetCount, sizeof(SceneAssetRecord)) ||
+			!InBounds(header.StringsOffset, header.StringCount, sizeof(SceneStringRecord)) ||
+			!InBounds(header.CharactersOffset, header.CharactersSize, 1) ||
+			!InBounds(header.ColumnsOffset, header.ColumnCount, sizeof(SceneColumnHeader)))
+			return Fail("truncated");
+
+		m_Data = data;
+		m_Header = &header;
+		m_Entities = { (const SceneEntityRecord*)(data + header.EntitiesOffset), header.EntityCount };
+		m_Assets = { (const SceneAssetRecord*)(data + header.AssetsOffset), header.AssetCount };
+		m_Strings = { (const SceneStringRecord*)(data + header.StringsOffset), header.StringCount };
+		m_Characters = (const char*)(data + header.CharactersOffset);
+
+		for (const auto& string : m_Strings)
+			if (uint64_t(string.Offset) + string.Length > header.CharactersSize)
+				return Fail("string out of bounds");
+
+		for (uint32_t i = 0; i < header.EntityCount; i++)
+		{
+			const auto& entity = m_Entities[i];
+			if ((entity.Name != SCENE_NONE && entity.Name >= header.StringCount) || (entity.Parent != SCENE_NONE && entity.Parent >= i))
+				return Fail("bad entity");
+		}
+
+		for (const auto& asset : m_Assets)
+			if (asset.Path >= header.StringCount)
+				return Fail("bad asset");
+
+		const auto* columns = (const SceneColumnHeader*)(data + header.ColumnsOffset);
+		for (uint32_t i = 0; i < header.ColumnCount; i++)
+		{
+			const auto& column = columns[i];
+			if (column.Component >= (uint32_t)SceneComponent::Count || m_Columns[column.Component]) return Fail("bad column");
+			if (column.RecordSize == 0 || column.RecordSize > MAX_RECORD_SIZE ||
+				!InBounds(column.EntitiesOffset, column.Count, sizeof(uint32_t)) || !InBounds(column.RecordsOffset, column.Count, column.RecordSize))
+				return Fail("truncated");
+
+			const auto* entities = (const uint32_t*)(data + column.EntitiesOffset);
+			for (uint32_t j = 0; j < column.Count; j++)
+				if (entities[j] >= header.EntityCount || (j > 0 && entities[j] <= entities[j - 1]))
+					return Fail("bad column");
+
+			m_Columns[column.Component] = &column;
+		}
+
+		return true;
+	}
+
+	bool ConvertSceneToBinary(const YAML::Node& scene, std::vector<uint8_t>& output)
+	{
+		SceneFileWriter writer;
+		try
+		{
+			if (auto entities = scene["Entities"])
+				for (const auto& entity : entities)
+					WriteEntity(writer, entity, SCENE_NONE);
+
+			if (scene["Gravity"])
+			{
+				writer.Header.Flags |= SceneFile_Gravity;
+				writer.Header.Gravity = scene["Gravity"].as<glm::vec2>();
+			}
+
+			if (scene["SubSteps"] && scene["MaxStepsPerFrame"])
+			{
+				writer.Header.Flags |= SceneFile_Stepping;
+				writer.Header.SubSteps = (uint16_t)scene["SubSteps"].as<uint32_t>();
+				writer.Header.MaxStepsPerFrame = (uint16_t)scene["MaxStepsPerFrame"].as<uint32_t>();
+			}
+
+			if (scene["CameraFocalPoint"] && scene["CameraYaw"] && scene["CameraPitch"] && scene["CameraDistance"])
+			{
+				writer.Header.Flags |= SceneFile_Camera;
+				writer.Header.CameraFocalPoint = scene["CameraFocalPoint"].as<glm::vec3>();
+				writer.Header.CameraYaw = scene["CameraYaw"].as<float>();
+				writer.Header.CameraPitch = scene["CameraPitch"].as<float>();
+				writer.Header.CameraDistance = scene["CameraDistance"].as<float>();
+			}
+		}
+		catch (const std::exception& e)
+		{
+			WC_CORE_ERROR("Failed to convert the scene: {}", e.what());
+			return false;
+		}
+
+		output = writer.Finish();
+		return true;
+	}
+
+	YAML::Node ConvertSceneToYAML(const SceneFileReader& scene)
+	{
+		auto entities = scene.GetEntities();
+		auto assets = scene.GetAssets();
+
+		std::vector<YAML::Node> nodes(entities.size());
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			uint32_t name = entities[i].Name;
+			nodes[i]["Name"] = name == SCENE_NONE ? std::string("null") : scene.GetString(name) == "null" ? std::string(NULL_NAME) : std::string(scene.GetString(name));
+		}
+
+		auto SetAsset = [&](YAML::Node& data, const std::string& key, uint32_t index) {
+			if (index >= assets.size()) return;
+			data[key] = std::string(scene.GetString(assets[index].Path));
+			if (assets[index].ID != NULL_ASSET) data[key + "ID"] = assets[index].ID;
+			};
+
+		auto SetMaterial = [&](YAML::Node& data, uint32_t material) {
+			if (material != SCENE_NONE) data["Material"] = std::string(scene.GetString(material));
+			};
+
+		auto SetLayer = [&](YAML::Node& data, uint32_t layer) {
+			if (layer != 0) data["Layer"] = layer;
+			};
+
+		// Column by column, which is also the order the components are written in
+		auto ForEach = [&]<typename T>(SceneComponent component, const char* key, auto&& write) {
+			auto column = scene.GetColumn<T>(component);
+			for (size_t i = 0; i < column.size(); i++)
+			{
+				YAML::Node data;
+				write(data, column[i]);
+				nodes[column.Entities[i]][key] = data;
+			}
+			};
+
+		ForEach.operator()<SceneTransformRecord>(SceneComponent::Transform, "TransformComponent", [&](YAML::Node& data, const SceneTransformRecord& record) {
+			data["Translation"] = record.Translation;
+			data["Scale"] = record.Scale;
+			data["Rotation"] = glm::degrees(record.Rotation);
+			});
+
+		ForEach.operator()<SceneTextRecord>(SceneComponent::TextRenderer, "TextRendererComponent", [&](YAML::Node& data, const SceneTextRecord& record) {
+			data["Text"] = std::string(scene.GetString(record.Text));
+			SetAsset(data, "Font", record.Font);
+			data["Color"] = record.Color;
+			data["Kerning"] = record.Kerning;
+			data["LineSpacing"] = record.LineSpacing;
+			});
+
+		ForEach.operator()<SceneSpriteRecord>(SceneComponent::SpriteRenderer, "SpriteRendererComponent", [&](YAML::Node& data, const SceneSpriteRecord& record) {
+			data["Color"] = record.Color;
+			if (record.Texture < assets.size()) SetAsset(data, "Texture", record.Texture);
+			else data["Texture"] = "None";
+			});
+
+		ForEach.operator()<SceneCircleRecord>(SceneComponent::CircleRenderer, "CircleRendererComponent", [&](YAML::Node& data, const SceneCircleRecord& record) {
+			data["Color"] = record.Color;
+			data["Thickness"] = record.Thickness;
+			data["Fade"] = record.Fade;
+			});
+
+		ForEach.operator()<SceneRigidBodyRecord>(SceneComponent::RigidBody, "RigidBodyComponent", [&](YAML::Node& data, const SceneRigidBodyRecord& record) {
+			data["Type"] = std::string(magic_enum::enum_name((BodyType)record.Type));
+			data["FixedRotation"] = record.FixedRotation != 0;
+			data["Bullet"] = record.Bullet != 0;
+			data["FastRotation"] = record.FastRotation != 0;
+			data["GravityScale"] = record.GravityScale;
+			data["LinearDamping"] = record.LinearDamping;
+			data["AngularDamping"] = record.AngularDamping;
+			});
+
+		ForEach.operator()<SceneBoxColliderRecord>(SceneComponent::BoxCollider2D, "BoxCollider2DComponent", [&](YAML::Node& data, const SceneBoxColliderRecord& record) {
+			data["Offset"] = record.Offset;
+			data["Size"] = record.Size;
+			SetMaterial(data, record.Material);
+			SetLayer(data, record.Layer);
+			});
+
+		ForEach.operator()<SceneCircleColliderRecord>(SceneComponent::CircleCollider2D, "CircleCollider2DComponent", [&](YAML::Node& data, const SceneCircleColliderRecord& record) {
+			data["Offset"] = record.Offset;
+			data["Radius"] = record.Radius;
+			SetMaterial(data, record.Material);
+			SetLayer(data, record.Layer);
+			});
+
+		ForEach.operator()<ScenePolygonColliderRecord>(SceneComponent::PolygonCollider2D, "PolygonCollider2DComponent", [&](YAML::Node& data, const ScenePolygonColliderRecord& record) {
+			data["Points"] = scene.GetPoints(record.Points);
+			data["Radius"] = record.Radius;
+			SetMaterial(data, record.Material);
+			SetLayer(data, record.Layer);
+			});
+
+		ForEach.operator()<SceneChainColliderRecord>(SceneComponent::ChainCollider2D, "ChainCollider2DComponent", [&](YAML::Node& data, const SceneChainColliderRecord& record) {
+			data["Points"] = scene.GetPoints(record.Points);
+			data["Loop"] = record.Loop != 0;
+			SetMaterial(data, record.Material);
+			SetLayer(data, record.Layer);
+			});
+
+		ForEach.operator()<SceneScriptRecord>(SceneComponent::Script, "ScriptComponent", [&](YAML::Node& data, const SceneScriptRecord& record) {
+			SetAsset(data, "Path", record.Script);
+			});
+
+		YAML::Node data;
+		const auto& header = scene.GetHeader();
+		if (header.Flags & SceneFile_Gravity) data["Gravity"] = header.Gravity;
+		if (header.Flags & SceneFile_Stepping)
+		{
+			data["SubSteps"] = (uint32_t)header.SubSteps;
+			data["MaxStepsPerFrame"] = (uint32_t)header.MaxStepsPerFrame;
+		}
+
+		// Nodes are references, children are complete before they're attached
+		YAML::Node roots;
+		for (size_t i = 0; i < entities.size(); i++)
+		{
+			if (entities[i].Parent == SCENE_NONE) roots.push_back(nodes[i]);
+			else nodes[entities[i].Parent]["Children"].push_back(nodes[i]);
+		}
+		if (roots) data["Entities"] = roots;
+
+		if (header.Flags & SceneFile_Camera)
+		{
+			data["CameraFocalPoint"] = header.CameraFocalPoint;
+			data["CameraYaw"] = header.CameraYaw;
+			data["CameraPitch"] = header.CameraPitch;
+			data["CameraDistance"] = header.CameraDistance;
+		}
+
+		return data;
+	}
+
+	bool ConvertSceneFile(const std::string& inputPath, const std::string& outputPath)
+	{
+		wc::MappedFile file;
+		if (!file.Open(inputPath)) return false;
+
+		bool toBinary = std::filesystem::path(outputPath).extension() == ".blzscene";
+
+		YAML::Node yaml;
+		std::vector<uint8_t> binary;
+		if (SceneFileReader::IsSceneFile(file.GetData(), file.GetSize()))
+		{
+			SceneFileReader reader;
+			if (!reader.Open(file.GetData(), file.GetSize())) return false;
+
+			if (toBinary) binary.assign(file.GetData(), file.GetData() + file.GetSize());
+			else yaml = ConvertSceneToYAML(reader);
+		}
+		else
+		{
+			try
+			{
+				yaml = YAML::Load(std::string((const char*)file.GetData(), file.GetSize()));
+			}
+			catch (const std::exception& e)
+			{
+				WC_CORE_ERROR("Failed to parse {}: {}", inputPath, e.what());
+				return false;
+			}
+
+			if (toBinary && !ConvertSceneToBinary(yaml, binary)) return false;
+		}
+
+		if (!toBinary)
+		{
+			YAMLUtils::SaveFile(outputPath, yaml);
+			return true;
+		}
+
+		std::ofstream output(outputPath, std::ios::binary);
+		output.write((const char*)binary.data(), std::streamsize(binary.size()));
+		if (!output.good())
+		{
+			WC_CORE_ERROR("Failed to write {}", outputPath);
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "AssetRegistry.h"
+#include "../Utils/YAML.h"
+
+namespace blaze
+{
+	// .blzscene, the binary twin of the YAML .scene. Everything is little endian and every section starts on an 8 byte
+	// boundary, so a memory mapped file is read in place:
+	//	SceneFileHeader
+	//	SceneEntityRecord[EntityCount], parents before their children, siblings in the order the editor shows them
+	//	SceneAssetRecord[AssetCount], every asset the scene references, once
+	//	SceneStringRecord[StringCount] and the characters they point at, not null terminated
+	//	per component type: the sorted indices of the entities with the component, then one record per entity
+	//	SceneColumnHeader[ColumnCount], pointing at the above
+	// Columns line up with flecs tables, a loader groups entities by the columns they're in and creates each group in bulk.
+	// YAML stays the authoring format that goes into version control, ConvertSceneToBinary/ConvertSceneToYAML go between the two
+	static_assert(std::endian::native == std::endian::little, "The scene format is read in place");
+
+	constexpr uint32_t SCENE_NONE = UINT32_MAX; // Unnamed entities, roots, empty asset references
+
+	enum class SceneComponent : uint32_t
+	{
+		Transform, // Same order as the YAML
+		TextRenderer,
+		SpriteRenderer,
+		CircleRenderer,
+		RigidBody,
+		BoxCollider2D,
+		CircleCollider2D,
+		Script,
+		PolygonCollider2D,
+		ChainCollider2D,
+
+		Count
+	};
+
+	enum SceneFileFlags : uint32_t
+	{
+		SceneFile_Gravity = 1 << 0,
+		SceneFile_Camera = 1 << 1,
+		SceneFile_Stepping = 1 << 2, // SubSteps and MaxStepsPerFrame, older files keep the defaults
+	};
+
+	struct SceneFileHeader
+	{
+		static constexpr uint32_t MAGIC = 0x535A4C42; // "BLZS"
+		static constexpr uint32_t VERSION = 1;
+
+		uint32_t Magic = MAGIC;
+		uint32_t Version = VERSION;
+		uint32_t Flags = 0;
+		uint32_t EntityCount = 0;
+		uint32_t AssetCount = 0;
+		uint32_t StringCount = 0;
+		uint32_t ColumnCount = 0;
+		uint16_t SubSteps = 0;         // Were padding before SceneFile_Stepping, the size stays the same
+		uint16_t MaxStepsPerFrame = 0;
+		uint64_t EntitiesOffset = 0;
+		uint64_t AssetsOffset = 0;
+		uint64_t StringsOffset = 0;
+		uint64_t CharactersOffset = 0;
+		uint64_t CharactersSize = 0;
+		uint64_t ColumnsOffset = 0;
+
+		glm::vec2 Gravity = glm::vec2(0.f);
+		glm::vec3 CameraFocalPoint = glm::vec3(0.f);
+		float CameraYaw = 0.f;
+		float CameraPitch = 0.f;
+		float CameraDistance = 0.f;
+	};
+	static_assert(sizeof(SceneFileHeader) == 112);
+
+	struct SceneEntityRecord
+	{
+		uint32_t Name = SCENE_NONE;   // String index
+		uint32_t Parent = SCENE_NONE; // Entity index, always lower than the entity's own
+	};
+
+	struct SceneAssetRecord
+	{
+		AssetID ID = NULL_ASSET;    // Wins over the path when the registry knows it
+		uint32_t Path = SCENE_NONE; // String index, project relative like in the YAML
+		uint32_t Type = 0;          // AssetType
+	};
+	static_assert(sizeof(SceneAssetRecord) == 16);
+
+	struct SceneStringRecord
+	{
+		uint32_t Offset = 0; // Into the characters
+		uint32_t Length = 0;
+	};
+
+	struct SceneColumnHeader
+	{
+		uint32_t Component = 0;  // SceneComponent
+		uint32_t Count = 0;
+		uint32_t RecordSize = 0; // Records only grow, fields a file doesn't have keep their defaults
+		uint32_t Padding = 0;
+		uint64_t EntitiesOffset = 0;
+		uint64_t RecordsOffset = 0;
+	};
+	static_assert(sizeof(SceneColumnHeader) == 32);
+
+	// Component records, plain data with every reference turned into a string or asset index
+	struct SceneTransformRecord
+	{
+		glm::vec3 Translation = glm::vec3(0.f);
+		glm::vec3 Scale = glm::vec3(1.f);
+		glm::vec3 Rotation = glm::vec3(0.f); // Radians, the YAML has degrees
+	};
+
+	struct SceneSpriteRecord
+	{
+		glm::vec4 Color = glm::vec4(1.f);
+		uint32_t Texture = SCENE_NONE; // Asset index
+	};
+
+	struct SceneCircleRecord
+	{
+		glm::vec4 Color = glm::vec4(1.f);
+		float Thickness = 1.f;
+		float Fade = 0.005f;
+	};
+
+	struct SceneTextRecord
+	{
+		glm::vec4 Color = glm::vec4(1.f);
+		uint32_t Text = SCENE_NONE; // String index
+		uint32_t Font = SCENE_NONE; // Asset index
+		float Kerning = 0.f;
+		float LineSpacing = 0.f;
+	};
+
+	struct SceneRigidBodyRecord
+	{
+		uint32_t Type = 0; // BodyType
+		uint8_t FixedRotation = 0;
+		uint8_t Bullet = 0;
+		uint8_t FastRotation = 0;
+		uint8_t Padding = 0;
+		float GravityScale = 1.f;
+		float LinearDamping = 0.f;
+		float AngularDamping = 0.f;
+	};
+
+	struct SceneBoxColliderRecord
+	{
+		glm::vec2 Offset = glm::vec2(0.f);
+		glm::vec2 Size = glm::vec2(1.f);
+		uint32_t Material = SCENE_NONE; // String index, materials are looked up by name like in the YAML
+		uint32_t Layer = 0;             // Collision layer index
+	};
+
+	struct SceneCircleColliderRecord
+	{
+		glm::vec2 Offset = glm::vec2(0.f);
+		float Radius = 0.5f;
+		uint32_t Material = SCENE_NONE;
+		uint32_t Layer = 0;
+	};
+
+	struct ScenePolygonColliderRecord
+	{
+		uint32_t Points = SCENE_NONE; // Point list index
+		float Radius = 0.f;
+		uint32_t Material = SCENE_NONE;
+		uint32_t Layer = 0;
+	};
+
+	struct SceneChainColliderRecord
+	{
+		uint32_t Points = SCENE_NONE;
+		uint32_t Loop = 1;
+		uint32_t Material = SCENE_NONE;
+		uint32_t Layer = 0;
+	};
+
+	struct SceneScriptRecord
+	{
+		uint32_t Script = SCENE_NONE; // Asset index
+	};
+
+	// Builds a .blzscene in memory. Entities have to be added parents first and components right after their entity,
+	// which keeps every column sorted
+	class SceneFileWriter
+	{
+	public:
+		SceneFileHeader Header; // Flags, gravity and camera are up to the caller, the rest is filled in by Finish
+
+		uint32_t AddString(std::string_view string);
+
+		// Point lists are kept in the string table as raw glm::vec2s, identical outlines are stored once
+		uint32_t AddPoints(std::span<const glm::vec2> points) { return AddString({ (const char*)points.data(), points.size_bytes() }); }
+
+		// The same reference twice returns the same index
+		uint32_t AddAsset(AssetID id, std::string_view path, AssetType type);
+
+		uint32_t AddEntity(uint32_t name = SCENE_NONE, uint32_t parent = SCENE_NONE);
+
+		template<typename T>
+		void AddComponent(SceneComponent component, uint32_t entity, const T& record)
+		{
+			auto& column = m_Columns[(size_t)component];
+			column.Entities.push_back(entity);
+			column.RecordSize = sizeof(T);
+			column.Records.resize(column.Records.size() + sizeof(T));
+			std::memcpy(column.Records.data() + column.Records.size() - sizeof(T), &record, sizeof(T));
+		}
+
+		uint32_t GetEntityCount() const { return (uint32_t)m_Entities.size(); }
+
+		std::vector<uint8_t> Finish();
+
+	private:
+		struct Column
+		{
+			std::vector<uint32_t> Entities;
+			std::vector<uint8_t> Records;
+			uint32_t RecordSize = 0;
+		};
+
+		std::vector<SceneEntityRecord> m_Entities;
+		std::vector<SceneAssetRecord> m_Assets;
+		std::vector<SceneStringRecord> m_Strings;
+		std::string m_Characters;
+		std::unordered_map<std::string, uint32_t> m_StringIndices;
+		std::map<std::pair<AssetID, uint32_t>, uint32_t> m_AssetIndices;
+		Column m_Columns[(size_t)SceneComponent::Count];
+	};
+
+	// The entities with one component and their records. Records are copied out since older files may have shorter ones
+	template<typename T>
+	struct SceneColumn
+	{
+		std::span<const uint32_t> Entities;
+		const uint8_t* Records = nullptr;
+		uint32_t RecordSize = 0;
+
+		size_t size() const { return Entities.size(); }
+
+		T operator[](size_t index) const
+		{
+			T record;
+			std::memcpy(&record, Records + index * RecordSize, std::min<size_t>(RecordSize, sizeof(T)));
+			return record;
+		}
+	};
+
+	// Read side of a .blzscene. Open validates the sections and the entity, asset and string tables, so the getters hand out
+	// spans into the data without checks. Indices inside component records are up to the caller. Nothing is copied, the data
+	// has to outlive the reader
+	class SceneFileReader
+	{
+	public:
+		static bool IsSceneFile(const uint8_t* data, size_t size);
+
+		bool Open(const uint8_t* data, size_t size);
+
+		const SceneFileHeader& GetHeader() const { return *m_Header; }
+
+		std::span<const SceneEntityRecord> GetEntities() const { return m_Entities; }
+		std::span<const SceneAssetRecord> GetAssets() const { return m_Assets; }
+
+		// Empty for SCENE_NONE
+		std::string_view GetString(uint32_t index) const
+		{
+			if (index >= m_Strings.size()) return {};
+			return { m_Characters + m_Strings[index].Offset, m_Strings[index].Length };
+		}
+
+		// Copied out, the characters have no alignment
+		std::vector<glm::vec2> GetPoints(uint32_t index) const
+		{
+			auto bytes = GetString(index);
+			std::vector<glm::vec2> points(bytes.size() / sizeof(glm::vec2));
+			if (!points.empty()) std::memcpy(points.data(), bytes.data(), points.size() * sizeof(glm::vec2));
+			return points;
+		}
+
+		// Empty if no entity has the component
+		template<typename T>
+		SceneColumn<T> GetColumn(SceneComponent component) const
+		{
+			const auto* column = m_Columns[(size_t)component];
+			if (!column) return {};
+
+			return {
+				.Entities = { (const uint32_t*)(m_Data + column->EntitiesOffset), column->Count },
+				.Records = m_Data + column->RecordsOffset,
+				.RecordSize = column->RecordSize,
+			};
+		}
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		const SceneFileHeader* m_Header = nullptr;
+		std::span<const SceneEntityRecord> m_Entities;
+		std::span<const SceneAssetRecord> m_Assets;
+		std::span<const SceneStringRecord> m_Strings;
+		const char* m_Characters = nullptr;
+		const SceneColumnHeader* m_Columns[(size_t)SceneComponent::Count] = {};
+	};
+
+	// Converts the YAML written by EditorScene::Save, keys and fallbacks are the same as when loading it. Works on the
+	// files alone, assets aren't loaded and the registry isn't needed. Returns false if the YAML is malformed
+	bool ConvertSceneToBinary(const YAML::Node& scene, std::vector<uint8_t>& output);
+
+	YAML::Node ConvertSceneToYAML(const SceneFileReader& scene);
+
+	// Converts between the two by extension (.scene and .blzscene), the input is detected by its content
+	bool ConvertSceneFile(const std::string& inputPath, const std::string& outputPath);
+}
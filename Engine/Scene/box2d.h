@@ -185,6 +185,9 @@ namespace b2
 		/// Get world counters and sizes
 		inline auto GetCounters() { return b2World_GetCounters(id); }
 
+		/// Get the number of awake bodies
+		inline int GetAwakeBodyCount() { return b2World_GetAwakeBodyCount(id); }
+
 		/// Dump memory stats to box2d_memory.txt
 		inline void DumpMemoryStats() { b2World_DumpMemoryStats(id); }
 	};
@@ -616,4 +619,53 @@ namespace b2
 		/// Get the closest point on a shape to a target point. Target and result are in world space.
 		inline auto GetClosestPoint(glm::vec2 target) { return b2Shape_GetClosestPoint(id, { target.x, target.y }); }
 	};
+
+	struct Chain
+	{
+	private:
+		b2ChainId id = b2_nullChainId;
+	public:
+		Chain() = default;
+		Chain(b2ChainId handle) { id = handle; }
+		Chain(Body body, const b2ChainDef& def) { Create(body, def); }
+
+		operator b2ChainId& () { return id; }
+		operator const b2ChainId& () const { return id; }
+
+		/// Create a chain shape
+		///	@see b2ChainDef for details
+		inline void Create(b2BodyId bodyId, const b2ChainDef& def) { id = b2CreateChain(bodyId, &def); }
+
+		/// Destroy a chain shape
+		inline void Destroy()
+		{
+			b2DestroyChain(id);
+			id = b2_nullChainId;
+		}
+
+		/// Chain identifier validation. Provides validation for up to 64K allocations.
+		inline bool IsValid() { return b2Chain_IsValid(id); }
+
+		/// Get the number of segments on this chain
+		inline int GetSegmentCount() { return b2Chain_GetSegmentCount(id); }
+
+		/// Fill a user array with chain segment shape ids up to the specified capacity. Returns
+		/// the actual number of segments returned.
+		inline int GetSegments(b2ShapeId* segmentArray, int capacity) { return b2Chain_GetSegments(id, segmentArray, capacity); }
+
+		/// The segments share the chain's user data, b2ChainDef::userData
+		inline void* GetUserData()
+		{
+			b2ShapeId segment;
+			return GetSegments(&segment, 1) == 1 ? b2Shape_GetUserData(segment) : nullptr;
+		}
+
+		/// Set the chain friction
+		///	@see b2ChainDef::friction
+		inline void SetFriction(float friction) { b2Chain_SetFriction(id, friction); }
+
+		/// Set the chain restitution (bounciness)
+		///	@see b2ChainDef::restitution
+		inline void SetRestitution(float restitution) { b2Chain_SetRestitution(id, restitution); }
+	};
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "../Utils/Window.h"
 #include "glm/glm.hpp"
 #include "../Sound/SoundEngine.h"
+#include "../Scene/Scene.h"
+#include "../Scene/PhysicsQueries.h"
 
 using namespace blaze;
 
@@ -1014,6 +1016,119 @@ static int lua_PauseSound(lua_State* L)
 	return 0;
 }
 
+// Physics bindings
+
+// LayerMask("Player", "Enemies") gives the mask physics queries take to only see those collision layers
+static int lua_LayerMask(lua_State* L)
+{
+	uint32_t mask = 0;
+	for (int i = 1; i <= lua_gettop(L); i++)
+	{
+		const char* name = lua_tostring(L, i);
+		uint32_t layer = name ? CollisionLayers.Find(name) : COLLISION_LAYER_COUNT;
+		if (layer == COLLISION_LAYER_COUNT)
+		{
+			WC_WARN("Unknown collision layer {}", name ? name : "(not a string)");
+			continue;
+		}
+
+		mask |= 1u << layer;
+	}
+
+	lua_pushnumber(L, mask);
+	return 1;
+}
+
+// The batched queries read packed records from a buffer, the layouts are in PhysicsQueries.h. The count defaults to as
+// many records as fit. Output buffers are optional, one is reused when it's big enough and a new one is returned otherwise
+static b2::World& GetQueryWorld(lua_State* L)
+{
+	if (!ScriptScene || !ScriptScene->PhysicsWorld.IsValid()) luaL_error(L, "Physics queries only run from scripts of a scene");
+	return ScriptScene->PhysicsWorld;
+}
+
+template<typename Query>
+static std::span<const Query> CheckQueries(lua_State* L)
+{
+	size_t size = 0;
+	const Query* queries = (const Query*)luaL_checkbuffer(L, 1, &size);
+	const int count = luaL_optinteger(L, 2, int(size / sizeof(Query)));
+	if (count < 0 || size_t(count) > size / sizeof(Query)) luaL_error(L, "%d queries don't fit in a buffer of %d bytes", count, int(size));
+	return { queries, size_t(count) };
+}
+
+static void* PushOutput(lua_State* L, int index, size_t size)
+{
+	if (lua_isbuffer(L, index))
+	{
+		size_t capacity = 0;
+		void* data = lua_tobuffer(L, index, &capacity);
+		if (capacity >= size)
+		{
+			lua_pushvalue(L, index);
+			return data;
+		}
+	}
+
+	return lua_newbuffer(L, size);
+}
+
+// CastRays(rays, count?, hits?) -> hits, the closest hit of every ray
+static int lua_CastRays(lua_State* L)
+{
+	// Outputs are pushed above the arguments, and a hits buffer that is also the rays would be written while read
+	lua_settop(L, 3);
+	if (lua_rawequal(L, 1, 3))
+	{
+		lua_pushnil(L);
+		lua_replace(L, 3);
+	}
+
+	auto& world = GetQueryWorld(L);
+	auto queries = CheckQueries<RayQuery>(L);
+	auto* hits = (RayHit*)PushOutput(L, 3, queries.size() * sizeof(RayHit));
+	CastRays(world, queries, { hits, queries.size() });
+	return 1;
+}
+
+// (queries, count?, ranges?, entities?) -> ranges, entities, entity count
+template<typename Query>
+static int lua_Overlap(lua_State* L, void (*overlap)(b2::World&, std::span<const Query>, OverlapResults&))
+{
+	static OverlapResults results; // Keeps its capacity between calls
+
+	// Outputs are pushed above the arguments, both of them always get a buffer of their own
+	lua_settop(L, 4);
+	if (lua_rawequal(L, 3, 4))
+	{
+		lua_pushnil(L);
+		lua_replace(L, 4);
+	}
+
+	auto& world = GetQueryWorld(L);
+	overlap(world, CheckQueries<Query>(L), results);
+
+	const size_t rangesSize = results.Ranges.size() * sizeof(OverlapRange);
+	const size_t entitiesSize = results.Entities.size() * sizeof(double);
+	if (rangesSize) memcpy(PushOutput(L, 3, rangesSize), results.Ranges.data(), rangesSize);
+	else PushOutput(L, 3, 0);
+	if (entitiesSize) memcpy(PushOutput(L, 4, entitiesSize), results.Entities.data(), entitiesSize);
+	else PushOutput(L, 4, 0);
+	lua_pushinteger(L, (int)results.Entities.size());
+	return 3;
+}
+
+static int lua_OverlapAABBs(lua_State* L) { return lua_Overlap<AABBQuery>(L, OverlapAABBs); }
+static int lua_OverlapCircles(lua_State* L) { return lua_Overlap<CircleQuery>(L, OverlapCircles); }
+
+static const luaL_Reg physicsFuncs[] =
+{
+	{"CastRays", lua_CastRays},
+	{"OverlapAABBs", lua_OverlapAABBs},
+	{"OverlapCircles", lua_OverlapCircles},
+	{NULL, NULL}
+};
+
 static int lua_Print(lua_State* L) { return lua_Log(L, spdlog::level::level_enum::trace); }
 static int lua_Info(lua_State* L) { return lua_Log(L, spdlog::level::level_enum::info); }
 static int lua_Warn(lua_State* L) { return lua_Log(L, spdlog::level::level_enum::warn); }
@@ -1029,101 +1144,245 @@ static const luaL_Reg logFuncs[] =
 	{NULL, NULL}
 };
 
-int Script::Load(const ScriptBinary& script)
+void blaze::RegisterScriptBindings(lua_State* L)
 {
-	auto res = state.Load(script);
-	if (res == LUA_OK)
+	ScriptState state(L);
+
+	enum FrozenTable
 	{
-		Name = script.Name;
+		Red,
+		Green,
+		Blue,
+	};
+
+	state.RegisterEnumType<FrozenTable>("FrozenTable");
+
+	state.Register("print", lua_Print);
+	state.Register("IsKeyPressed", lua_IsKeyPressed);
+
+	state.Register("normalize", lua_normalize);
+	state.Register("min", lua_min);
+	state.Register("max", lua_max);
+	state.Register("length", lua_length);
+	state.Register("distance", lua_distance);
+	state.Register("cross", lua_cross);
+	state.Register("dot", lua_dot);
+
+	// Setup metatable
+	state.NewMetatable("SoundID");
+	state.RegisterField("__name", "SoundID");
+	state.RegisterField("__index", SoundID_index);
+	state.Pop();
+
+	state.Register("SoundID", construct_SoundID);
+
+	// Setup metatable
+	state.NewMetatable("vec4");
+	state.RegisterField("__name", "vec4");
+	state.RegisterField("__index", vec4_index);
+	state.RegisterField("__add", vec4_add);
+	state.RegisterField("__sub", vec4_sub);
+	state.RegisterField("__mul", vec4_mul);
+	state.RegisterField("__div", vec4_div);
+	state.RegisterField("__eq", vec4_eq);
+	state.RegisterField("__unm", vec4_unm);
+	state.Pop();
+
+	state.Register("vec4", construct_vec4);
+
+	// Setup metatable
+	state.NewMetatable("vec3");
+	state.RegisterField("__name", "vec3");
+	state.RegisterField("__index", vec3_index);
+	state.RegisterField("__add", vec3_add);
+	state.RegisterField("__sub", vec3_sub);
+	state.RegisterField("__mul", vec3_mul);
+	state.RegisterField("__div", vec3_div);
+	state.RegisterField("__eq", vec3_eq);
+	state.RegisterField("__unm", vec3_unm);
+	state.Pop();
+
+	state.Register("vec3", construct_vec3);
+
+	// Setup metatable
+	state.NewMetatable("vec2");
+	state.RegisterField("__name", "vec2");
+	state.RegisterField("__index", vec2_index);
+	state.RegisterField("__add", vec2_add);
+	state.RegisterField("__sub", vec2_sub);
+	state.RegisterField("__mul", vec2_mul);
+	state.RegisterField("__div", vec2_div);
+	state.RegisterField("__eq", vec2_eq);
+	state.RegisterField("__unm", vec2_unm);
+	state.Pop();
+
+	state.Register("vec2", construct_vec2);
+
+	state.Register("LoadSound", lua_LoadSound);
+	state.Register("UnloadSound", lua_UnloadSound);
+	state.Register("ReloadSound", lua_ReloadSound);
+	state.Register("InitializeSoundInstance", lua_InitializeSoundInstance);
+	state.Register("UninitializeSoundInstance", lua_UninitializeSoundInstance);
+	state.Register("UninitializeSound", lua_UninitializeSound);
+	state.Register("ReloadSoundInstance", lua_ReloadSoundInstance);
+	state.Register("PlaySound", lua_PlaySound);
+	state.Register("PauseSound", lua_PauseSound);
+
+	state.Register("LayerMask", lua_LayerMask);
+	state.Register("Physics", physicsFuncs);
+
+	state.Register("log", logFuncs);
+
+	state.SetTop(0); // luaL_register leaves the library tables on the stack
+}
 
-		enum FrozenTable
-		{
-			Red,
-			Green,
-			Blue,
-		};
-
-		state.RegisterEnumType<FrozenTable>("FrozenTable");
-
-		state.Register("print", lua_Print);
-		state.Register("IsKeyPressed", lua_IsKeyPressed);
-
-		state.Register("normalize", lua_normalize);
-		state.Register("min", lua_min);
-		state.Register("max", lua_max);
-		state.Register("length", lua_length);
-		state.Register("distance", lua_distance);
-		state.Register("cross", lua_cross);
-		state.Register("dot", lua_dot);
-
-		// Setup metatable
-		state.NewMetatable("SoundID");
-		state.RegisterField("__name", "SoundID");
-		state.RegisterField("__index", SoundID_index);
-		state.Pop();
+void ScriptVM::Create()
+{
+	Destroy();
 
-		state.Register("SoundID", construct_SoundID);
-
-		// Setup metatable
-		state.NewMetatable("vec4");
-		state.RegisterField("__name", "vec4");
-		state.RegisterField("__index", vec4_index);
-		state.RegisterField("__add", vec4_add);
-		state.RegisterField("__sub", vec4_sub);
-		state.RegisterField("__mul", vec4_mul);
-		state.RegisterField("__div", vec4_div);
-		state.RegisterField("__eq", vec4_eq);
-		state.RegisterField("__unm", vec4_unm);
-		state.Pop();
+	L = luaL_newstate();
+	luaL_openlibs(L);
+	RegisterScriptBindings(L);
+	luaL_sandbox(L); // Freezes the globals and the tables in them, instances share all of it
 
-		state.Register("vec4", construct_vec4);
-
-		// Setup metatable
-		state.NewMetatable("vec3");
-		state.RegisterField("__name", "vec3");
-		state.RegisterField("__index", vec3_index);
-		state.RegisterField("__add", vec3_add);
-		state.RegisterField("__sub", vec3_sub);
-		state.RegisterField("__mul", vec3_mul);
-		state.RegisterField("__div", vec3_div);
-		state.RegisterField("__eq", vec3_eq);
-		state.RegisterField("__unm", vec3_unm);
-		state.Pop();
+	// The binding metatables live in the registry where luaL_sandbox doesn't look
+	for (const char* name : { "SoundID", "vec2", "vec3", "vec4" })
+	{
+		luaL_getmetatable(L, name);
+		lua_setreadonly(L, -1, true);
+		lua_pop(L, 1);
+	}
 
-		state.Register("vec3", construct_vec3);
-
-		// Setup metatable
-		state.NewMetatable("vec2");
-		state.RegisterField("__name", "vec2");
-		state.RegisterField("__index", vec2_index);
-		state.RegisterField("__add", vec2_add);
-		state.RegisterField("__sub", vec2_sub);
-		state.RegisterField("__mul", vec2_mul);
-		state.RegisterField("__div", vec2_div);
-		state.RegisterField("__eq", vec2_eq);
-		state.RegisterField("__unm", vec2_unm);
-		state.Pop();
+	// Shared by every instance environment, one table less per instance than luaL_sandboxthread
+	lua_newtable(L);
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
+	lua_setfield(L, -2, "__index");
+	lua_setreadonly(L, -1, true);
+	m_EnvironmentMetatable = lua_ref(L, -1);
+	lua_pop(L, 1);
+}
+
+void ScriptVM::Destroy()
+{
+	if (!L) return;
+
+	lua_close(L);
+	L = nullptr;
+	m_EnvironmentMetatable = LUA_NOREF;
+	m_Chunks.clear();
+}
+
+lua_State* ScriptVM::NewInstance(const ScriptBinary& binary, int& ref)
+{
+	ref = LUA_NOREF;
+	if (binary.binary.empty())
+	{
+		WC_CORE_ERROR("Script binary is empty");
+		return nullptr;
+	}
+
+	if (!L) Create();
 
-		state.Register("vec2", construct_vec2);
+	auto chunk = m_Chunks.find(binary.Name);
+	if (chunk == m_Chunks.end())
+	{
+		if (luau_load(L, binary.Name.c_str(), (const char*)binary.binary.data(), binary.binary.size(), 0) != LUA_OK)
+		{
+			WC_ERROR("Failed to load bytecode: {}", binary.Name);
+			lua_pop(L, 1);
+			return nullptr;
+		}
 
-		state.Register("LoadSound", lua_LoadSound);
-		state.Register("UnloadSound", lua_UnloadSound);
-		state.Register("ReloadSound", lua_ReloadSound);
-		state.Register("InitializeSoundInstance", lua_InitializeSoundInstance);
-		state.Register("UninitializeSoundInstance", lua_UninitializeSoundInstance);
-		state.Register("UninitializeSound", lua_UninitializeSound);
-		state.Register("ReloadSoundInstance", lua_ReloadSoundInstance);
-		state.Register("PlaySound", lua_PlaySound);
-		state.Register("PauseSound", lua_PauseSound);
+		chunk = m_Chunks.emplace(binary.Name, lua_ref(L, -1)).first;
+		lua_pop(L, 1);
+	}
 
-		state.Register("log", logFuncs);
+	lua_State* thread = lua_newthread(L);
+	ref = lua_ref(L, -1);
+	lua_pop(L, 1);
+
+	// Globals the instance writes land in its own table, reads fall through to the frozen shared ones
+	lua_newtable(thread);
+	lua_getref(thread, m_EnvironmentMetatable);
+	lua_setmetatable(thread, -2);
+	lua_replace(thread, LUA_GLOBALSINDEX);
+	lua_setsafeenv(thread, LUA_GLOBALSINDEX, true);
+
+	// The clone shares the chunk's bytecode and takes the thread's globals as its environment
+	lua_getref(thread, chunk->second);
+	lua_clonefunction(thread, -1);
+	lua_remove(thread, -2);
+	if (lua_pcall(thread, 0, 0, 0) != LUA_OK)
+	{
+		WC_ERROR("Failed to execute script: {}", lua_tostring(thread, -1));
+		ReleaseInstance(ref);
+		ref = LUA_NOREF;
+		return nullptr;
 	}
 
-	return res;
+	return thread;
+}
+
+void ScriptVM::ReleaseInstance(int ref)
+{
+	if (L && ref != LUA_NOREF) lua_unref(L, ref);
+}
+
+void ScriptVM::ReleaseChunk(const std::string& name)
+{
+	auto chunk = m_Chunks.find(name);
+	if (chunk == m_Chunks.end()) return;
+
+	lua_unref(L, chunk->second);
+	m_Chunks.erase(chunk);
+}
+
+size_t ScriptVM::GetMemoryUsage() const
+{
+	if (!L) return 0;
+	return size_t(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+}
+
+Script& Script::operator=(const Script& other)
+{
+	if (this == &other) return *this;
+
+	Unload();
+	auto it = ScriptBinaryCache.find(other.Name);
+	if (other.state.L && it != ScriptBinaryCache.end()) Load(ScriptBinaries[it->second]);
+	Name = other.Name;
+	return *this;
+}
+
+Script& Script::operator=(Script&& other) noexcept
+{
+	if (this == &other) return *this;
+
+	Unload();
+	Name = std::move(other.Name);
+	state = other.state;
+	m_Thread = other.m_Thread;
+	other.Name.clear();
+	other.state = {};
+	other.m_Thread = LUA_NOREF;
+	return *this;
+}
+
+int Script::Load(const ScriptBinary& script)
+{
+	Unload();
+
+	state.L = scriptVM.NewInstance(script, m_Thread);
+	if (!state.L) return LUA_ERRERR;
+
+	Name = script.Name;
+	return LUA_OK;
 }
 
 void Script::Unload()
 {
 	Name.clear();
-	state.Close();
+	scriptVM.ReleaseInstance(m_Thread);
+	m_Thread = LUA_NOREF;
+	state = {};
 }
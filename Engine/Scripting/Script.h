@@ -1,18 +1,75 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "ScriptBase.h"
 
 namespace blaze
 {
+	// Registers every binding scripts can use into the globals of `L`
+	void RegisterScriptBindings(lua_State* L);
+
+	// One Luau state shared by every script. The bindings are registered once and frozen with the builtin libraries,
+	// each instance is a thread with its own global table that reads through to the shared one. A script's bytecode is
+	// loaded once, its instances run clones of that chunk
+	class ScriptVM
+	{
+	public:
+		ScriptVM() = default;
+		~ScriptVM() { Destroy(); }
+
+		ScriptVM(const ScriptVM&) = delete;
+		ScriptVM& operator=(const ScriptVM&) = delete;
+
+		// NewInstance creates the state when it's needed
+		void Create();
+
+		// Every instance has to be unloaded first, their threads close with the state
+		void Destroy();
+
+		bool IsValid() const { return L; }
+
+		// Runs the script's top level in a new thread, `ref` keeps the thread alive until ReleaseInstance
+		lua_State* NewInstance(const ScriptBinary& binary, int& ref);
+
+		void ReleaseInstance(int ref);
+
+		// Drops the loaded chunk of a recompiled script, running instances keep the old one
+		void ReleaseChunk(const std::string& name);
+
+		// Everything the state allocated, shared globals and every instance included
+		size_t GetMemoryUsage() const;
+
+	private:
+		lua_State* L = nullptr;
+		int m_EnvironmentMetatable = LUA_NOREF; // { __index = shared globals }, read only
+		std::unordered_map<std::string, int> m_Chunks; // Script name -> registry ref of its loaded chunk
+	};
+
+	inline ScriptVM scriptVM;
+
+	// An instance of a script in the shared VM. Copies get an instance of their own that starts over from the script's
+	// top level, they don't share variables
 	struct Script
 	{
 		std::string Name;
-		ScriptState state;
+		ScriptState state; // The instance's thread
+
+		Script() = default;
+		Script(const Script& other) { *this = other; }
+		Script(Script&& other) noexcept { *this = std::move(other); }
+		~Script() { Unload(); }
+
+		Script& operator=(const Script& other);
+		Script& operator=(Script&& other) noexcept;
 
 		int Load(const ScriptBinary& script);
 
 		void Unload();
 
 		operator bool() { return state.L; }
+
+	private:
+		int m_Thread = LUA_NOREF;
 	};
-}
\ No newline at end of file
+}
@@ -169,6 +169,51 @@ namespace blaze
 
 			return hasErrors;
 		}
+
+		// Variable names followed by the bytecode, asset packs store this so shipped builds skip the Luau frontend entirely
+		std::vector<uint8_t> Serialize() const
+		{
+			std::vector<uint8_t> data;
+			auto Write = [&](const void* src, size_t size) { data.insert(data.end(), (const uint8_t*)src, (const uint8_t*)src + size); };
+
+			uint32_t count = (uint32_t)VariableNames.size();
+			Write(&count, sizeof(count));
+			for (const auto& variable : VariableNames)
+			{
+				uint32_t length = (uint32_t)variable.size();
+				Write(&length, sizeof(length));
+				Write(variable.data(), length);
+			}
+			Write(binary.data(), binary.size());
+			return data;
+		}
+
+		bool Deserialize(const uint8_t* data, size_t size, const std::string& name)
+		{
+			const uint8_t* end = data + size;
+			auto Read = [&](void* dst, size_t bytes) {
+				if (size_t(end - data) < bytes) return false;
+				memcpy(dst, data, bytes);
+				data += bytes;
+				return true;
+				};
+
+			uint32_t count = 0;
+			if (!Read(&count, sizeof(count))) return false;
+
+			VariableNames.clear();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t length = 0;
+				if (!Read(&length, sizeof(length)) || size_t(end - data) < length) return false;
+				VariableNames.emplace_back((const char*)data, length);
+				data += length;
+			}
+
+			binary.assign(data, end);
+			Name = name;
+			return true;
+		}
 	};
 
 	struct ScriptState
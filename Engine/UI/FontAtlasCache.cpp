@@ -0,0 +1,310 @@
+#include "FontAtlasCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#include <imgui/imgui_internal.h>
+
+#include "../Utils/Hash.h"
+#include "../Utils/Log.h"
+
+// The cache writes ImFontGlyph and a few ImFont/ImFontAtlas fields directly, these moved around in 1.92 (dynamic fonts)
+#define WC_FONT_ATLAS_CACHE (IMGUI_VERSION_NUM >= 19000 && IMGUI_VERSION_NUM < 19200)
+
+namespace wc::FontAtlasCache
+{
+	namespace
+	{
+		constexpr uint32_t MAGIC = 0x43414642; // "BFAC"
+		constexpr uint32_t VERSION = 2;
+
+		uint64_t ComputeKey(const ImFontAtlas& atlas, const std::vector<FontDesc>& fonts)
+		{
+			uint64_t key = Hash64(IMGUI_VERSION);
+			key = HashCombine(key, sizeof(ImFontGlyph));
+			key = HashCombine(key, sizeof(ImFontConfig));
+			key = HashCombine(key, sizeof(ImFontAtlasCustomRect));
+			key = HashCombine(key, (uint64_t)atlas.Flags);
+			key = HashCombine(key, (uint64_t)atlas.TexDesiredWidth);
+			key = HashCombine(key, (uint64_t)atlas.TexGlyphPadding);
+
+			std::unordered_map<std::string, uint64_t> fileHashes; // The same file is usually added at several sizes
+			for (const auto& font : fonts)
+			{
+				auto [it, inserted] = fileHashes.try_emplace(font.Path, 0);
+				if (inserted) it->second = HashFile(font.Path);
+
+				uint64_t fileHash = it->second;
+				if (fileHash == 0) return 0;
+
+				key = HashCombine(key, fileHash);
+				key = HashCombine(key, (uint64_t)(font.Size * 64.f));
+			}
+
+			return key;
+		}
+
+#if WC_FONT_ATLAS_CACHE
+		template<typename T>
+		void Write(std::ofstream& file, const T& value) { file.write((const char*)&value, sizeof(T)); }
+
+		template<typename T>
+		bool Read(std::ifstream& file, T& value) { return (bool)file.read((char*)&value, sizeof(T)); }
+
+		// Fonts are written as their index in the atlas, -1 for none
+		int32_t FindFont(const ImFontAtlas& atlas, const ImFont* font)
+		{
+			for (int32_t i = 0; i < atlas.Fonts.Size; i++)
+				if (atlas.Fonts[i] == font) return i;
+			return -1;
+		}
+
+		void Save(const ImFontAtlas& atlas, uint64_t key, const std::string& cachePath)
+		{
+			std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path());
+
+			std::ofstream file(cachePath, std::ios::binary);
+			if (!file.is_open())
+			{
+				WC_CORE_WARN("Failed to write the font atlas cache to {}", cachePath);
+				return;
+			}
+
+			Write(file, MAGIC);
+			Write(file, VERSION);
+			Write(file, key);
+
+			Write(file, atlas.TexWidth);
+			Write(file, atlas.TexHeight);
+			Write(file, atlas.TexUvScale);
+			Write(file, atlas.TexUvWhitePixel);
+			Write(file, atlas.TexUvLines);
+			Write(file, atlas.TexPixelsUseColors);
+
+			// The mouse cursors and the line textures are custom rects too, found through the pack IDs
+			Write(file, atlas.PackIdMouseCursors);
+			Write(file, atlas.PackIdLines);
+			Write(file, (uint32_t)atlas.CustomRects.Size);
+			for (ImFontAtlasCustomRect rect : atlas.CustomRects)
+			{
+				int32_t font = FindFont(atlas, rect.Font);
+				rect.Font = nullptr;
+				Write(file, rect);
+				Write(file, font);
+			}
+
+			// Only the settings are kept (names, sizes, ...), the font data isn't, so a restored atlas can't be rebuilt
+			Write(file, (uint32_t)atlas.ConfigData.Size);
+			for (ImFontConfig config : atlas.ConfigData)
+			{
+				int32_t font = FindFont(atlas, config.DstFont);
+				config.FontData = nullptr;
+				config.FontDataSize = 0;
+				config.FontDataOwnedByAtlas = false;
+				config.GlyphRanges = nullptr;
+				config.DstFont = nullptr;
+				Write(file, config);
+				Write(file, font);
+			}
+
+			Write(file, (uint32_t)atlas.Fonts.Size);
+			for (const ImFont* font : atlas.Fonts)
+			{
+				// A font's configs are consecutive, the first one and any merged into it
+				Write(file, font->ConfigData ? int32_t(font->ConfigData - atlas.ConfigData.Data) : -1);
+				Write(file, (int32_t)font->ConfigDataCount);
+
+				Write(file, font->FontSize);
+				Write(file, font->Ascent);
+				Write(file, font->Descent);
+				Write(file, font->FallbackChar);
+				Write(file, font->EllipsisChar);
+				Write(file, font->EllipsisCharCount);
+				Write(file, font->EllipsisWidth);
+				Write(file, font->EllipsisCharStep);
+				Write(file, font->MetricsTotalSurfaceWidth);
+
+				Write(file, (uint32_t)font->Glyphs.Size);
+				file.write((const char*)font->Glyphs.Data, font->Glyphs.size_in_bytes());
+			}
+
+			// Colored glyphs only exist in the RGBA32 data, otherwise the alpha channel is all that's needed
+			size_t pixelCount = size_t(atlas.TexWidth) * atlas.TexHeight;
+			if (atlas.TexPixelsUseColors)
+				file.write((const char*)atlas.TexPixelsRGBA32, pixelCount * 4);
+			else
+				file.write((const char*)atlas.TexPixelsAlpha8, pixelCount);
+		}
+
+		bool Restore(ImFontAtlas& atlas, const std::vector<FontDesc>& fonts, uint64_t key, const std::string& cachePath)
+		{
+			std::ifstream file(cachePath, std::ios::binary);
+			if (!file.is_open()) return false;
+
+			uint32_t magic = 0, version = 0;
+			uint64_t cachedKey = 0;
+			if (!Read(file, magic) || !Read(file, version) || !Read(file, cachedKey)) return false;
+			if (magic != MAGIC || version != VERSION || cachedKey != key) return false;
+
+			int width = 0, height = 0;
+			ImVec2 uvScale;
+			ImVec4 uvWhitePixel;
+			ImVec4 uvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+			bool useColors = false;
+			int packIdMouseCursors = -1, packIdLines = -1;
+			uint32_t rectCount = 0;
+			if (!Read(file, width) || !Read(file, height) || !Read(file, uvScale) || !Read(file, uvWhitePixel) || !Read(file, uvLines) || !Read(file, useColors) ||
+				!Read(file, packIdMouseCursors) || !Read(file, packIdLines) || !Read(file, rectCount))
+				return false;
+
+			if (width <= 0 || height <= 0 || rectCount > 0xFFFF) return false;
+			if (packIdMouseCursors < -1 || packIdMouseCursors >= (int)rectCount || packIdLines < -1 || packIdLines >= (int)rectCount) return false;
+
+			// Font indices are resolved once the fonts are read
+			std::vector<ImFontAtlasCustomRect> rects(rectCount);
+			std::vector<int32_t> rectFonts(rectCount);
+			for (uint32_t i = 0; i < rectCount; i++)
+				if (!Read(file, rects[i]) || !Read(file, rectFonts[i])) return false;
+
+			uint32_t configCount = 0;
+			if (!Read(file, configCount) || configCount > 0xFFFF) return false;
+
+			std::vector<ImFontConfig> configs(configCount);
+			std::vector<int32_t> configFonts(configCount);
+			for (uint32_t i = 0; i < configCount; i++)
+				if (!Read(file, configs[i]) || !Read(file, configFonts[i])) return false;
+
+			uint32_t fontCount = 0;
+			if (!Read(file, fontCount) || fontCount != fonts.size()) return false;
+
+			std::vector<ImFont*> restored;
+			std::vector<std::pair<int32_t, int32_t>> fontConfigs(fontCount); // First config and count
+			auto Fail = [&]() {
+				for (ImFont* font : restored)
+					IM_DELETE(font);
+				return false;
+				};
+
+			auto ValidFont = [&](int32_t index) { return index >= -1 && index < (int32_t)fontCount; };
+			for (int32_t index : rectFonts)
+				if (!ValidFont(index)) return false;
+			for (int32_t index : configFonts)
+				if (!ValidFont(index)) return false;
+
+			for (uint32_t i = 0; i < fontCount; i++)
+			{
+				ImFont* font = restored.emplace_back(IM_NEW(ImFont));
+				font->ContainerAtlas = &atlas;
+
+				auto& [firstConfig, configDataCount] = fontConfigs[i];
+				if (!Read(file, firstConfig) || !Read(file, configDataCount)) return Fail();
+				if (firstConfig < -1 || configDataCount < 0 || (firstConfig == -1 && configDataCount) || int64_t(firstConfig) + configDataCount > configCount)
+					return Fail();
+
+				uint32_t glyphCount = 0;
+				if (!Read(file, font->FontSize) || !Read(file, font->Ascent) || !Read(file, font->Descent) || !Read(file, font->FallbackChar) ||
+					!Read(file, font->EllipsisChar) || !Read(file, font->EllipsisCharCount) || !Read(file, font->EllipsisWidth) || !Read(file, font->EllipsisCharStep) ||
+					!Read(file, font->MetricsTotalSurfaceWidth) || !Read(file, glyphCount))
+					return Fail();
+
+				font->Glyphs.resize(glyphCount);
+				if (!file.read((char*)font->Glyphs.Data, font->Glyphs.size_in_bytes()))
+					return Fail();
+			}
+
+			size_t pixelCount = size_t(width) * height;
+			size_t pixelSize = useColors ? pixelCount * 4 : pixelCount;
+			unsigned char* pixels = (unsigned char*)IM_ALLOC(pixelSize);
+			if (!file.read((char*)pixels, pixelSize))
+			{
+				IM_FREE(pixels);
+				return Fail();
+			}
+
+			// BuildLookupTable resolves the fallback glyph but also resets the ellipsis, so those are applied afterwards
+			for (ImFont* font : restored)
+			{
+				ImWchar ellipsisChar = font->EllipsisChar;
+				auto ellipsisCount = font->EllipsisCharCount;
+				float ellipsisWidth = font->EllipsisWidth, ellipsisStep = font->EllipsisCharStep;
+
+				font->BuildLookupTable();
+
+				font->EllipsisChar = ellipsisChar;
+				font->EllipsisCharCount = ellipsisCount;
+				font->EllipsisWidth = ellipsisWidth;
+				font->EllipsisCharStep = ellipsisStep;
+				atlas.Fonts.push_back(font);
+			}
+
+			atlas.TexWidth = width;
+			atlas.TexHeight = height;
+			atlas.TexUvScale = uvScale;
+			atlas.TexUvWhitePixel = uvWhitePixel;
+			memcpy(atlas.TexUvLines, uvLines, sizeof(uvLines));
+			atlas.TexPixelsUseColors = useColors;
+			if (useColors)
+				atlas.TexPixelsRGBA32 = (unsigned int*)pixels;
+			else
+				atlas.TexPixelsAlpha8 = pixels; // GetTexDataAsRGBA32 expands it without rebuilding
+			atlas.TexReady = true;
+
+			auto GetFont = [&](int32_t index) { return index >= 0 ? restored[index] : nullptr; };
+			for (uint32_t i = 0; i < rectCount; i++)
+			{
+				rects[i].Font = GetFont(rectFonts[i]);
+				atlas.CustomRects.push_back(rects[i]);
+			}
+			atlas.PackIdMouseCursors = packIdMouseCursors;
+			atlas.PackIdLines = packIdLines;
+
+			// The fonts point into ConfigData, so it has to be complete first
+			for (uint32_t i = 0; i < configCount; i++)
+			{
+				configs[i].DstFont = GetFont(configFonts[i]);
+				atlas.ConfigData.push_back(configs[i]);
+			}
+			for (uint32_t i = 0; i < fontCount; i++)
+			{
+				auto [firstConfig, configDataCount] = fontConfigs[i];
+				restored[i]->ConfigData = firstConfig >= 0 ? &atlas.ConfigData[firstConfig] : nullptr;
+				restored[i]->ConfigDataCount = (decltype(ImFont::ConfigDataCount))configDataCount;
+			}
+
+			for (size_t i = 0; i < fonts.size(); i++)
+				*fonts[i].Target = restored[i];
+
+			return true;
+		}
+#endif
+	}
+
+	void Build(ImFontAtlas& atlas, const std::vector<FontDesc>& fonts, const std::string& cachePath)
+	{
+		uint64_t key = ComputeKey(atlas, fonts);
+
+#if WC_FONT_ATLAS_CACHE
+		if (key && Restore(atlas, fonts, key, cachePath))
+		{
+			WC_CORE_INFO("Restored the font atlas ({} fonts) from {}", fonts.size(), cachePath);
+			return;
+		}
+#endif
+
+		bool loaded = true;
+		for (const auto& font : fonts)
+		{
+			*font.Target = atlas.AddFontFromFileTTF(font.Path, font.Size);
+			loaded &= *font.Target != nullptr;
+		}
+
+		atlas.Build();
+
+#if WC_FONT_ATLAS_CACHE
+		// Missing font files would make the key meaningless
+		if (key && loaded)
+			Save(atlas, key, cachePath);
+#endif
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <imgui/imgui.h>
+
+namespace wc::FontAtlasCache
+{
+	struct FontDesc
+	{
+		const char* Path;
+		float Size;
+		ImFont** Target; // Set to the loaded font, nullptr if the file couldn't be loaded
+	};
+
+	// Adds the fonts to `atlas` and builds it. If `cachePath` holds an atlas built from the same font files (by content hash)
+	// and sizes, the pixels and glyph tables are restored from it instead, skipping rasterization entirely.
+	// Expects `atlas` to be empty, doesn't touch anything besides the atlas so it can run on a worker thread.
+	void Build(ImFontAtlas& atlas, const std::vector<FontDesc>& fonts, const std::string& cachePath);
+}
@@ -0,0 +1,282 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "Log.h"
+
+namespace wc
+{
+	bool FileWatcher::Start(const std::string& directory, uint32_t debounceMs)
+	{
+		Stop();
+
+		if (!std::filesystem::is_directory(directory))
+		{
+			WC_CORE_ERROR("Can't watch {}, it's not a directory", directory);
+			return false;
+		}
+
+		m_Directory = std::filesystem::path(directory).lexically_normal().generic_string();
+		if (m_Directory.size() > 1 && m_Directory.back() == '/') m_Directory.pop_back();
+		m_Debounce = std::chrono::milliseconds(debounceMs);
+
+#ifdef _WIN32
+		m_DirectoryHandle = CreateFileW(std::filesystem::path(m_Directory).c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (m_DirectoryHandle == INVALID_HANDLE_VALUE)
+		{
+			m_DirectoryHandle = nullptr;
+			WC_CORE_ERROR("Failed to watch {}", m_Directory);
+			return false;
+		}
+
+		m_StopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+#elif defined(__linux__)
+		m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		m_StopEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (m_Inotify < 0 || m_StopEvent < 0)
+		{
+			if (m_Inotify >= 0) close(m_Inotify);
+			if (m_StopEvent >= 0) close(m_StopEvent);
+			m_Inotify = m_StopEvent = -1;
+			WC_CORE_ERROR("Failed to watch {}: {}", m_Directory, strerror(errno));
+			return false;
+		}
+
+		// inotify isn't recursive, every directory gets its own watch
+		AddWatches("", false);
+#else
+		WC_CORE_WARN("File watching isn't supported on this platform, changes in {} won't be picked up", m_Directory);
+		return false;
+#endif
+
+		m_Running = true;
+		m_Thread = std::thread(&FileWatcher::Run, this);
+		return true;
+	}
+
+	void FileWatcher::Stop()
+	{
+		if (!m_Thread.joinable()) return;
+
+		m_Running = false;
+#ifdef _WIN32
+		SetEvent(m_StopEvent);
+		m_Thread.join();
+
+		CloseHandle(m_StopEvent);
+		CloseHandle(m_DirectoryHandle);
+		m_StopEvent = nullptr;
+		m_DirectoryHandle = nullptr;
+#elif defined(__linux__)
+		uint64_t value = 1;
+		[[maybe_unused]] auto written = write(m_StopEvent, &value, sizeof(value));
+		m_Thread.join();
+
+		close(m_Inotify);
+		close(m_StopEvent);
+		m_Inotify = m_StopEvent = -1;
+		m_Watches.clear();
+#endif
+
+		std::scoped_lock lock(m_Mutex);
+		m_Pending.clear();
+	}
+
+	std::vector<FileWatcher::Event> FileWatcher::Poll()
+	{
+		std::vector<Event> events;
+		auto now = Clock::now();
+		{
+			std::scoped_lock lock(m_Mutex);
+			for (auto it = m_Pending.begin(); it != m_Pending.end();)
+			{
+				if (now - it->second.Time < m_Debounce)
+				{
+					++it;
+					continue;
+				}
+
+				events.push_back({ it->first, it->second.Type });
+				it = m_Pending.erase(it);
+			}
+		}
+
+		// Directories before their contents
+		std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.Path < b.Path; });
+		return events;
+	}
+
+	void FileWatcher::Push(const std::string& relativePath, Action type)
+	{
+		std::string path = m_Directory + '/' + relativePath;
+
+		std::scoped_lock lock(m_Mutex);
+		auto [it, inserted] = m_Pending.try_emplace(path, PendingChange{ type, Clock::now() });
+		if (inserted) return;
+
+		// A file created within the debounce time is still new, one that was removed and written again (atomic saves) was modified
+		auto& change = it->second;
+		if (type == Action::Removed) change.Type = Action::Removed;
+		else if (change.Type == Action::Removed) change.Type = Action::Modified;
+		else if (change.Type != Action::Added) change.Type = type;
+		change.Time = Clock::now();
+	}
+
+#ifdef _WIN32
+	void FileWatcher::Run()
+	{
+		std::vector<DWORD> buffer(16 * 1024); // FILE_NOTIFY_INFORMATION has to be DWORD aligned
+
+		OVERLAPPED overlapped = {};
+		overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+		HANDLE handles[2] = { overlapped.hEvent, m_StopEvent };
+
+		const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+		while (m_Running)
+		{
+			ResetEvent(overlapped.hEvent);
+			if (!ReadDirectoryChangesW(m_DirectoryHandle, buffer.data(), DWORD(buffer.size() * sizeof(DWORD)), TRUE, filter, nullptr, &overlapped, nullptr))
+			{
+				WC_CORE_ERROR("Stopped watching {}", m_Directory);
+				break;
+			}
+
+			DWORD bytes = 0;
+			if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+			{
+				CancelIo(m_DirectoryHandle);
+				GetOverlappedResult(m_DirectoryHandle, &overlapped, &bytes, TRUE);
+				break;
+			}
+
+			if (!GetOverlappedResult(m_DirectoryHandle, &overlapped, &bytes, FALSE)) break;
+			if (bytes == 0)
+			{
+				WC_CORE_WARN("Too many changes in {}, some were missed", m_Directory);
+				continue;
+			}
+
+			for (auto info = (const FILE_NOTIFY_INFORMATION*)buffer.data();; info = (const FILE_NOTIFY_INFORMATION*)((const uint8_t*)info + info->NextEntryOffset))
+			{
+				std::string relativePath = std::filesystem::path(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR))).generic_string();
+				switch (info->Action)
+				{
+				case FILE_ACTION_ADDED:
+				case FILE_ACTION_RENAMED_NEW_NAME:
+					Push(relativePath, Action::Added);
+					break;
+				case FILE_ACTION_REMOVED:
+				case FILE_ACTION_RENAMED_OLD_NAME:
+					Push(relativePath, Action::Removed);
+					break;
+				case FILE_ACTION_MODIFIED:
+					Push(relativePath, Action::Modified);
+					break;
+				}
+
+				if (info->NextEntryOffset == 0) break;
+			}
+		}
+
+		CloseHandle(overlapped.hEvent);
+	}
+#elif defined(__linux__)
+	void FileWatcher::AddWatches(const std::string& relativePath, bool reportFiles)
+	{
+		std::string path = relativePath.empty() ? m_Directory : m_Directory + '/' + relativePath;
+
+		const uint32_t mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+		int watch = inotify_add_watch(m_Inotify, path.c_str(), mask);
+		if (watch < 0)
+		{
+			WC_CORE_WARN("Failed to watch {}: {}", path, strerror(errno));
+			return;
+		}
+		m_Watches[watch] = relativePath; // Replaces the old path if the directory was moved
+
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+		{
+			std::string childPath = relativePath.empty() ? entry.path().filename().string() : relativePath + '/' + entry.path().filename().string();
+			if (entry.is_directory(ec) && !entry.is_symlink(ec))
+			{
+				if (reportFiles) Push(childPath, Action::Added);
+				AddWatches(childPath, reportFiles);
+			}
+			else if (reportFiles)
+				Push(childPath, Action::Added);
+		}
+	}
+
+	void FileWatcher::Run()
+	{
+		alignas(inotify_event) char buffer[16 * 1024];
+		pollfd fds[2] = { { m_Inotify, POLLIN, 0 }, { m_StopEvent, POLLIN, 0 } };
+
+		while (m_Running)
+		{
+			if (poll(fds, 2, -1) < 0)
+			{
+				if (errno == EINTR) continue;
+				WC_CORE_ERROR("Stopped watching {}: {}", m_Directory, strerror(errno));
+				break;
+			}
+
+			if (fds[1].revents & POLLIN) break;
+
+			ssize_t length;
+			while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+			{
+				for (char* ptr = buffer; ptr < buffer + length;)
+				{
+					auto event = (const inotify_event*)ptr;
+					ptr += sizeof(inotify_event) + event->len;
+
+					if (event->mask & IN_Q_OVERFLOW)
+					{
+						WC_CORE_WARN("Too many changes in {}, some were missed", m_Directory);
+						continue;
+					}
+
+					if (event->mask & IN_IGNORED)
+					{
+						m_Watches.erase(event->wd);
+						continue;
+					}
+
+					auto it = m_Watches.find(event->wd);
+					if (it == m_Watches.end() || event->len == 0) continue;
+
+					std::string relativePath = it->second.empty() ? std::string(event->name) : it->second + '/' + event->name;
+					if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					{
+						Push(relativePath, Action::Added);
+
+						// Files can be created inside a new directory before its watch is added, those are reported by the scan
+						if (event->mask & IN_ISDIR) AddWatches(relativePath, true);
+					}
+					else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+						Push(relativePath, Action::Removed);
+					else if (event->mask & IN_CLOSE_WRITE)
+						Push(relativePath, Action::Modified);
+				}
+			}
+		}
+	}
+#else
+	void FileWatcher::Run() {}
+#endif
+}
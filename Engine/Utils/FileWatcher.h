@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace wc
+{
+	// Watches a directory tree for changes on a background thread (inotify on Linux, ReadDirectoryChangesW on Windows).
+	// Editors and exporters usually touch a file several times per save, so the events for a path are merged and only handed
+	// out by Poll once the path was quiet for the debounce time. Other platforms don't report anything
+	class FileWatcher
+	{
+	public:
+		enum class Action : uint8_t
+		{
+			Added,
+			Modified,
+			Removed,
+		};
+
+		struct Event
+		{
+			std::string Path; // The watched directory joined with the path relative to it, forward slashes
+			Action Type = Action::Modified;
+		};
+
+		FileWatcher() = default;
+		~FileWatcher() { Stop(); }
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		bool Start(const std::string& directory, uint32_t debounceMs = 150);
+
+		void Stop();
+
+		// Settled changes since the last call, at most one per path. Called from the main thread
+		std::vector<Event> Poll();
+
+		bool IsRunning() const { return m_Running; }
+		const std::string& GetDirectory() const { return m_Directory; }
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		struct PendingChange
+		{
+			Action Type;
+			Clock::time_point Time; // Last time the path changed
+		};
+
+		void Run();
+
+		void Push(const std::string& path, Action type);
+
+		std::string m_Directory;
+		std::chrono::milliseconds m_Debounce{ 150 };
+
+		std::thread m_Thread;
+		std::atomic<bool> m_Running = false;
+
+		std::mutex m_Mutex;
+		std::unordered_map<std::string, PendingChange> m_Pending;
+
+#ifdef _WIN32
+		void* m_DirectoryHandle = nullptr;
+		void* m_StopEvent = nullptr;
+#elif defined(__linux__)
+		int m_Inotify = -1;
+		int m_StopEvent = -1; // eventfd, wakes the thread up when stopping
+		std::unordered_map<int, std::string> m_Watches; // Watch descriptor -> directory relative to m_Directory, only used by the thread
+
+		void AddWatches(const std::string& relativePath, bool reportFiles);
+#endif
+	};
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace wc
+{
+	// XXH64 (https://github.com/Cyan4973/xxHash), a port of the reference algorithm
+	namespace xxh64
+	{
+		constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t Rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+		inline uint64_t Read64(const uint8_t* p) { uint64_t v; memcpy(&v, p, sizeof(v)); return v; } // Little endian only
+		inline uint32_t Read32(const uint8_t* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+		inline uint64_t Round(uint64_t acc, uint64_t input)
+		{
+			acc += input * PRIME2;
+			acc = Rotl(acc, 31);
+			return acc * PRIME1;
+		}
+
+		inline uint64_t MergeRound(uint64_t acc, uint64_t value)
+		{
+			acc ^= Round(0, value);
+			return acc * PRIME1 + PRIME4;
+		}
+	}
+
+	inline uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0)
+	{
+		using namespace xxh64;
+
+		const uint8_t* p = (const uint8_t*)data;
+		const uint8_t* end = p + size;
+		uint64_t hash;
+
+		if (size >= 32)
+		{
+			uint64_t v1 = seed + PRIME1 + PRIME2;
+			uint64_t v2 = seed + PRIME2;
+			uint64_t v3 = seed;
+			uint64_t v4 = seed - PRIME1;
+
+			const uint8_t* limit = end - 32;
+			do
+			{
+				v1 = Round(v1, Read64(p)); p += 8;
+				v2 = Round(v2, Read64(p)); p += 8;
+				v3 = Round(v3, Read64(p)); p += 8;
+				v4 = Round(v4, Read64(p)); p += 8;
+			} while (p <= limit);
+
+			hash = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+			hash = MergeRound(hash, v1);
+			hash = MergeRound(hash, v2);
+			hash = MergeRound(hash, v3);
+			hash = MergeRound(hash, v4);
+		}
+		else
+			hash = seed + PRIME5;
+
+		hash += (uint64_t)size;
+
+		for (; p + 8 <= end; p += 8)
+		{
+			hash ^= Round(0, Read64(p));
+			hash = Rotl(hash, 27) * PRIME1 + PRIME4;
+		}
+
+		if (p + 4 <= end)
+		{
+			hash ^= (uint64_t)Read32(p) * PRIME1;
+			hash = Rotl(hash, 23) * PRIME2 + PRIME3;
+			p += 4;
+		}
+
+		for (; p < end; p++)
+		{
+			hash ^= (*p) * PRIME5;
+			hash = Rotl(hash, 11) * PRIME1;
+		}
+
+		hash ^= hash >> 33;
+		hash *= PRIME2;
+		hash ^= hash >> 29;
+		hash *= PRIME3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	inline uint64_t Hash64(const std::string& string, uint64_t seed = 0) { return Hash64(string.data(), string.size(), seed); }
+
+	// Returns 0 if the file can't be read
+	inline uint64_t HashFile(const std::string& filepath, uint64_t seed = 0)
+	{
+		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) return 0;
+
+		std::vector<char> data((size_t)file.tellg());
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		return Hash64(data.data(), data.size(), seed);
+	}
+
+	inline uint64_t HashCombine(uint64_t hash, uint64_t value) { return Hash64(&value, sizeof(value), hash); }
+}
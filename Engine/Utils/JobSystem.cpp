@@ -0,0 +1,166 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <format>
+
+#include "Profiler.h"
+
+namespace wc
+{
+	namespace
+	{
+		struct ThreadSlot
+		{
+			const JobSystem* System = nullptr;
+			uint32_t Index = 0;
+		};
+
+		thread_local ThreadSlot t_Thread;
+
+		// Yields this many times before a worker goes to sleep, a solver dispatches its stages right after each other
+		constexpr uint32_t SPIN_COUNT = 64;
+	}
+
+	void JobSystem::Create(uint32_t workerCount)
+	{
+		Destroy();
+
+		if (workerCount == HARDWARE_WORKERS) workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_WorkerCount = workerCount;
+		m_Queues = std::make_unique<Queue[]>(workerCount + 1);
+		m_Stopping = false;
+		for (uint32_t i = 0; i < workerCount; i++)
+			m_Workers.emplace_back([this, thread = i + 1]() {
+				WC_PROFILE_THREAD(std::format("Job worker {}", thread));
+				t_Thread = { this, thread };
+				Work(thread);
+				});
+	}
+
+	void JobSystem::Destroy()
+	{
+		{
+			std::scoped_lock lock(m_SleepMutex);
+			m_Stopping = true;
+		}
+		m_WakeUp.notify_all();
+
+		for (auto& worker : m_Workers)
+			worker.join();
+		m_Workers.clear();
+		m_WorkerCount = 0;
+		m_Queues.reset();
+		m_Queued = 0;
+	}
+
+	uint32_t JobSystem::GetThreadIndex() const { return t_Thread.System == this ? t_Thread.Index : 0; }
+
+	void JobSystem::Dispatch(JobGroup& group, uint32_t count, uint32_t minRange, JobFunction function, void* context)
+	{
+		if (count == 0) return;
+
+		minRange = std::max(minRange, 1u);
+		uint32_t rangeCount = std::min(GetThreadCount(), (count + minRange - 1) / minRange);
+
+		// Single ranges are still queued, a caller may expect the job to run next to it
+		if (m_WorkerCount == 0)
+		{
+			function(0, count, GetThreadIndex(), context);
+			return;
+		}
+
+		group.Pending.fetch_add(rangeCount, std::memory_order_relaxed);
+
+		auto& queue = m_Queues[GetThreadIndex()];
+		{
+			std::scoped_lock lock(queue.Mutex);
+			for (uint32_t i = 0; i < rangeCount; i++)
+				queue.Jobs.push_back({
+					.Function = function,
+					.Context = context,
+					.Begin = uint32_t(uint64_t(count) * i / rangeCount),
+					.End = uint32_t(uint64_t(count) * (i + 1) / rangeCount),
+					.Group = &group,
+					});
+		}
+
+		{
+			std::scoped_lock lock(m_SleepMutex);
+			m_Queued.fetch_add(rangeCount);
+		}
+		m_WakeUp.notify_all();
+	}
+
+	void JobSystem::Wait(JobGroup& group)
+	{
+		uint32_t thread = GetThreadIndex();
+		while (group.Pending.load(std::memory_order_acquire) != 0)
+		{
+			Job job;
+			if (Pop(thread, job)) Execute(job, thread);
+			else std::this_thread::yield();
+		}
+	}
+
+	bool JobSystem::Pop(uint32_t thread, Job& job)
+	{
+		if (m_Queued.load(std::memory_order_relaxed) == 0) return false;
+
+		const uint32_t queueCount = GetThreadCount();
+		for (uint32_t i = 0; i < queueCount; i++)
+		{
+			auto& queue = m_Queues[(thread + i) % queueCount];
+			std::scoped_lock lock(queue.Mutex);
+			if (queue.Jobs.empty()) continue;
+
+			if (i == 0)
+			{
+				job = queue.Jobs.back();
+				queue.Jobs.pop_back();
+			}
+			else
+			{
+				job = queue.Jobs.front();
+				queue.Jobs.pop_front();
+			}
+
+			m_Queued.fetch_sub(1);
+			return true;
+		}
+
+		return false;
+	}
+
+	void JobSystem::Execute(const Job& job, uint32_t thread)
+	{
+		job.Function(job.Begin, job.End, thread, job.Context);
+		job.Group->Pending.fetch_sub(1, std::memory_order_release);
+	}
+
+	void JobSystem::Work(uint32_t thread)
+	{
+		uint32_t idle = 0;
+		while (true)
+		{
+			Job job;
+			if (Pop(thread, job))
+			{
+				Execute(job, thread);
+				idle = 0;
+				continue;
+			}
+
+			if (++idle < SPIN_COUNT)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock lock(m_SleepMutex);
+			m_WakeUp.wait(lock, [&]() { return m_Queued.load() != 0 || m_Stopping; });
+			if (m_Stopping && m_Queued.load() == 0) return;
+			idle = 0;
+		}
+	}
+}
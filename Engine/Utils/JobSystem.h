@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace wc
+{
+	// Fixed pool of worker threads for short data parallel jobs (physics solver stages, batch queries). Every thread has
+	// its own queue, new jobs go to the queue of the thread that dispatched them and idle threads steal from the others.
+	// The thread that called Create is thread 0 and helps out while it waits, workers are 1..GetWorkerCount().
+	//
+	//	JobGroup group;
+	//	jobSystem.Dispatch(group, count, 64, [](uint32_t begin, uint32_t end, uint32_t thread, void* context) { ... }, &data);
+	//	jobSystem.Wait(group);
+	//
+	// ParallelFor does both for a lambda
+	struct JobGroup
+	{
+		std::atomic<uint32_t> Pending = 0; // Jobs that haven't finished yet
+	};
+
+	class JobSystem
+	{
+	public:
+		using JobFunction = void (*)(uint32_t begin, uint32_t end, uint32_t thread, void* context);
+
+		JobSystem() = default;
+		~JobSystem() { Destroy(); }
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// One worker per hardware thread besides the calling one
+		static constexpr uint32_t HARDWARE_WORKERS = UINT32_MAX;
+
+		// Without workers every job runs on the dispatching thread
+		void Create(uint32_t workerCount = HARDWARE_WORKERS);
+
+		void Destroy();
+
+		uint32_t GetWorkerCount() const { return m_WorkerCount; }
+		uint32_t GetThreadCount() const { return GetWorkerCount() + 1; }
+
+		// 0 for threads that aren't workers of this system
+		uint32_t GetThreadIndex() const;
+
+		// Splits [0, count) into at most one range per thread, none shorter than minRange. Without workers the ranges run
+		// right away on the calling thread
+		void Dispatch(JobGroup& group, uint32_t count, uint32_t minRange, JobFunction function, void* context);
+
+		// Runs queued jobs until the group is done
+		void Wait(JobGroup& group);
+
+		// Blocks until function(begin, end, thread) ran for every range of [0, count)
+		template<typename Function>
+		void ParallelFor(uint32_t count, uint32_t minRange, Function&& function)
+		{
+			using Callable = std::remove_reference_t<Function>;
+
+			JobGroup group;
+			Dispatch(group, count, minRange, [](uint32_t begin, uint32_t end, uint32_t thread, void* context) {
+				(*static_cast<Callable*>(context))(begin, end, thread);
+				}, (void*)&function);
+			Wait(group);
+		}
+
+	private:
+		struct Job
+		{
+			JobFunction Function = nullptr;
+			void* Context = nullptr;
+			uint32_t Begin = 0;
+			uint32_t End = 0;
+			JobGroup* Group = nullptr;
+		};
+
+		struct Queue
+		{
+			std::mutex Mutex;
+			std::deque<Job> Jobs;
+		};
+
+		// Own queue first from the back, then the others from the front
+		bool Pop(uint32_t thread, Job& job);
+
+		void Execute(const Job& job, uint32_t thread);
+
+		void Work(uint32_t thread);
+
+		std::unique_ptr<Queue[]> m_Queues; // One per thread, 0 is shared by every thread that isn't a worker
+		std::vector<std::thread> m_Workers;
+		uint32_t m_WorkerCount = 0; // Set before the workers start, they read it while the vector still grows
+
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WakeUp;
+		std::atomic<uint32_t> m_Queued = 0;
+		std::atomic<bool> m_Stopping = false;
+	};
+
+	inline JobSystem jobSystem;
+}
@@ -0,0 +1,148 @@
+#include "LZ4.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wc::LZ4
+{
+	namespace
+	{
+		constexpr size_t MIN_MATCH = 4;
+		constexpr size_t LAST_LITERALS = 5; // The last 5 bytes are always literals
+		constexpr size_t MF_LIMIT = 12; // The last match has to start at least 12 bytes before the end
+		constexpr size_t MAX_OFFSET = 65535;
+		constexpr uint32_t HASH_LOG = 16;
+
+		inline uint32_t Read32(const uint8_t* p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+
+		inline uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - HASH_LOG); }
+
+		void WriteLength(std::vector<uint8_t>& output, size_t length)
+		{
+			for (; length >= 255; length -= 255)
+				output.push_back(255);
+			output.push_back((uint8_t)length);
+		}
+
+		void WriteSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+		{
+			uint8_t token = uint8_t(std::min<size_t>(literalLength, 15) << 4);
+			if (matchLength) token |= uint8_t(std::min<size_t>(matchLength - MIN_MATCH, 15));
+			output.push_back(token);
+
+			if (literalLength >= 15) WriteLength(output, literalLength - 15);
+			output.insert(output.end(), literals, literals + literalLength);
+
+			if (!matchLength) return; // Last sequence
+
+			output.push_back(uint8_t(offset));
+			output.push_back(uint8_t(offset >> 8));
+			if (matchLength - MIN_MATCH >= 15) WriteLength(output, matchLength - MIN_MATCH - 15);
+		}
+	}
+
+	size_t Compress(const void* source, size_t size, std::vector<uint8_t>& output)
+	{
+		const uint8_t* input = (const uint8_t*)source;
+		size_t start = output.size();
+		output.reserve(start + CompressBound(size));
+
+		size_t anchor = 0;
+		if (size > MF_LIMIT)
+		{
+			std::vector<uint32_t> table(size_t(1) << HASH_LOG, UINT32_MAX);
+			size_t matchLimit = size - LAST_LITERALS;
+			size_t position = 0;
+
+			while (position + MF_LIMIT < size)
+			{
+				uint32_t sequence = Read32(input + position);
+				uint32_t& slot = table[Hash(sequence)];
+				size_t candidate = slot;
+				slot = (uint32_t)position;
+
+				if (candidate == UINT32_MAX || position - candidate > MAX_OFFSET || Read32(input + candidate) != sequence)
+				{
+					position++;
+					continue;
+				}
+
+				size_t length = MIN_MATCH;
+				while (position + length < matchLimit && input[candidate + length] == input[position + length])
+					length++;
+
+				// Extend backwards into the pending literals
+				while (position > anchor && candidate > 0 && input[position - 1] == input[candidate - 1])
+				{
+					position--;
+					candidate--;
+					length++;
+				}
+
+				WriteSequence(output, input + anchor, position - anchor, position - candidate, length);
+				position += length;
+				anchor = position;
+
+				if (position >= 2 && position + MF_LIMIT < size) table[Hash(Read32(input + position - 2))] = uint32_t(position - 2);
+			}
+		}
+
+		WriteSequence(output, input + anchor, size - anchor, 0, 0);
+		return output.size() - start;
+	}
+
+	bool Decompress(const void* source, size_t size, void* destination, size_t decompressedSize)
+	{
+		const uint8_t* input = (const uint8_t*)source;
+		const uint8_t* inputEnd = input + size;
+		uint8_t* output = (uint8_t*)destination;
+		uint8_t* outputStart = output;
+		uint8_t* outputEnd = output + decompressedSize;
+
+		auto ReadLength = [&](size_t& length) {
+			uint8_t byte;
+			do
+			{
+				if (input >= inputEnd) return false;
+				byte = *input++;
+				length += byte;
+			} while (byte == 255);
+			return true;
+			};
+
+		while (input < inputEnd)
+		{
+			uint8_t token = *input++;
+
+			size_t literalLength = token >> 4;
+			if (literalLength == 15 && !ReadLength(literalLength)) return false;
+			if (literalLength > size_t(inputEnd - input) || literalLength > size_t(outputEnd - output)) return false;
+
+			if (literalLength) memcpy(output, input, literalLength);
+			input += literalLength;
+			output += literalLength;
+
+			if (input == inputEnd) break; // The last sequence has no match
+
+			if (inputEnd - input < 2) return false;
+			size_t offset = size_t(input[0]) | (size_t(input[1]) << 8);
+			input += 2;
+			if (offset == 0 || offset > size_t(output - outputStart)) return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !ReadLength(matchLength)) return false;
+			matchLength += MIN_MATCH;
+			if (matchLength > size_t(outputEnd - output)) return false;
+
+			const uint8_t* match = output - offset;
+			if (offset >= matchLength)
+				memcpy(output, match, matchLength);
+			else
+				for (size_t i = 0; i < matchLength; i++) // Overlapping copy, repeats the last `offset` bytes
+					output[i] = match[i];
+			output += matchLength;
+		}
+
+		return output == outputEnd;
+	}
+}
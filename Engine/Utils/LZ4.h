@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), the output is readable by the reference
+// decoder. Only the fast greedy compressor is implemented, packing is an offline step and decompression speed is what matters.
+namespace wc::LZ4
+{
+	constexpr size_t CompressBound(size_t size) { return size + size / 255 + 16; }
+
+	// Appends the compressed block to `output`, returns the compressed size
+	size_t Compress(const void* source, size_t size, std::vector<uint8_t>& output);
+
+	// `destination` must be exactly `decompressedSize` bytes, returns false on malformed input instead of reading or writing out of bounds
+	bool Decompress(const void* source, size_t size, void* destination, size_t decompressedSize);
+}
@@ -0,0 +1,98 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Log.h"
+
+namespace wc
+{
+	bool MappedFile::Open(const std::string& filepath)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			WC_CORE_ERROR("Failed to open {}", filepath);
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			WC_CORE_ERROR("Failed to map {}", filepath);
+			if (mapping) CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_File = file;
+		m_Mapping = mapping;
+		m_Size = (size_t)size.QuadPart;
+		m_Data = (const uint8_t*)data;
+#else
+		int file = open(filepath.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			WC_CORE_ERROR("Failed to open {}", filepath);
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			WC_CORE_ERROR("Failed to map {}", filepath);
+			close(file);
+			return false;
+		}
+
+		m_File = file;
+		m_Size = (size_t)info.st_size;
+		m_Data = (const uint8_t*)data;
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (!m_Data) return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_Data);
+		CloseHandle(m_Mapping);
+		CloseHandle(m_File);
+		m_Mapping = nullptr;
+		m_File = nullptr;
+#else
+		munmap((void*)m_Data, m_Size);
+		close(m_File);
+		m_File = -1;
+#endif
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+}
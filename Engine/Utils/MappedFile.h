@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace wc
+{
+	// Read only memory mapping of a whole file. Pages are faulted in by the OS on first access, so opening is O(1)
+	// regardless of the file size and reading never goes through an intermediate buffer
+	class MappedFile
+	{
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WIN32
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+#else
+		int m_File = -1;
+#endif
+
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::string& filepath);
+
+		void Close();
+
+		const uint8_t* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+		bool IsOpen() const { return m_Data != nullptr; }
+	};
+}
@@ -0,0 +1,238 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include "Log.h"
+
+namespace wc::Profiler
+{
+#if WC_PROFILER
+	namespace
+	{
+		std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+		std::mutex s_ThreadsMutex; // Only taken when a thread registers itself and when collecting
+		std::vector<std::unique_ptr<ThreadBuffer>> s_Threads;
+		thread_local ThreadBuffer* t_Buffer = nullptr;
+
+		std::vector<Frame> s_Frames;
+		uint32_t s_FrameHead = 0;
+		uint64_t s_FrameIndex = 0;
+		uint64_t s_FrameStart = 0;
+
+		uint32_t s_CaptureFrames = 0;
+		std::string s_CapturePath;
+		std::vector<Frame> s_Capture;
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (!t_Buffer)
+			{
+				std::scoped_lock lock(s_ThreadsMutex);
+				auto& buffer = s_Threads.emplace_back(std::make_unique<ThreadBuffer>());
+				buffer->Index = uint32_t(s_Threads.size() - 1);
+				buffer->Name = buffer->Index == 0 ? "Main" : std::format("Thread {}", buffer->Index);
+				t_Buffer = buffer.get();
+			}
+
+			return *t_Buffer;
+		}
+
+		void WriteTrace(const std::string& filepath, const std::vector<Frame>& frames)
+		{
+			std::ofstream file(filepath);
+			if (!file.is_open())
+			{
+				WC_CORE_ERROR("Failed to open {}", filepath);
+				return;
+			}
+
+			auto us = [](uint64_t ns) { return double(ns) / 1000.0; };
+
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			bool first = true;
+			auto Separator = [&]() { if (!first) file << ",\n"; first = false; };
+
+			auto threadNames = GetThreadNames();
+			for (uint32_t i = 0; i < threadNames.size(); i++)
+			{
+				Separator();
+				file << std::format("{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", i, threadNames[i]);
+			}
+
+			for (auto& frame : frames)
+			{
+				Separator();
+				file << std::format("{{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Frame {}\",\"pid\":0,\"tid\":0,\"ts\":{:.3f}}}", frame.Index, us(frame.Start));
+
+				for (auto& event : frame.Events)
+				{
+					Separator();
+					if (event.Data.Type == EventType::Zone)
+						file << std::format("{{\"ph\":\"X\",\"name\":\"{}\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", event.Data.Name, event.Thread, us(event.Data.Start), us(event.Data.End - event.Data.Start));
+					else
+						file << std::format("{{\"ph\":\"C\",\"name\":\"{}\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"value\":{}}}}}", event.Data.Name, event.Thread, us(event.Data.Start), event.Data.Value);
+				}
+			}
+			file << "\n]}\n";
+
+			WC_CORE_INFO("Wrote a {} frame trace to {}", frames.size(), filepath);
+		}
+	}
+
+	void ThreadBuffer::Push(const Event& event)
+	{
+		uint32_t head = Head.load(std::memory_order_relaxed);
+		if (head - Tail.load(std::memory_order_acquire) >= CAPACITY) return; // Full, drop the event
+
+		Events[head & (CAPACITY - 1)] = event;
+		Head.store(head + 1, std::memory_order_release);
+	}
+
+	void Init()
+	{
+		s_Epoch = std::chrono::steady_clock::now();
+		s_Frames.resize(FRAME_HISTORY);
+		s_FrameStart = 0;
+		GetThreadBuffer(); // The main thread is always index 0
+	}
+
+	void Shutdown()
+	{
+		std::scoped_lock lock(s_ThreadsMutex);
+		s_Frames.clear();
+		s_Capture.clear();
+		s_CaptureFrames = 0;
+	}
+
+	uint64_t Now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count(); }
+
+	void SetThreadName(const std::string& name)
+	{
+		auto& buffer = GetThreadBuffer();
+		std::scoped_lock lock(s_ThreadsMutex);
+		buffer.Name = name;
+	}
+
+	void BeginZone(const char* name)
+	{
+		auto& buffer = GetThreadBuffer();
+		if (buffer.Depth < ThreadBuffer::MAX_DEPTH)
+		{
+			auto& event = buffer.Open[buffer.Depth];
+			event.Name = name;
+			event.Depth = buffer.Depth;
+			event.Type = EventType::Zone;
+			event.Start = Now();
+		}
+		buffer.Depth++;
+	}
+
+	void EndZone()
+	{
+		auto& buffer = GetThreadBuffer();
+		if (buffer.Depth == 0) return;
+
+		buffer.Depth--;
+		if (buffer.Depth < ThreadBuffer::MAX_DEPTH)
+		{
+			auto& event = buffer.Open[buffer.Depth];
+			event.End = Now();
+			buffer.Push(event);
+		}
+	}
+
+	void Counter(const char* name, double value)
+	{
+		Event event;
+		event.Name = name;
+		event.Start = Now();
+		event.Value = value;
+		event.Type = EventType::Counter;
+		GetThreadBuffer().Push(event);
+	}
+
+	void MarkFrame()
+	{
+		if (s_Frames.empty()) return;
+
+		uint64_t now = Now();
+		s_FrameHead = (s_FrameHead + 1) % FRAME_HISTORY;
+		auto& frame = s_Frames[s_FrameHead];
+		frame.Index = s_FrameIndex++;
+		frame.Start = s_FrameStart;
+		frame.End = now;
+		frame.Events.clear();
+		s_FrameStart = now;
+
+		{
+			std::scoped_lock lock(s_ThreadsMutex);
+			for (auto& buffer : s_Threads)
+			{
+				uint32_t tail = buffer->Tail.load(std::memory_order_relaxed);
+				uint32_t head = buffer->Head.load(std::memory_order_acquire);
+				for (; tail != head; tail++)
+					frame.Events.push_back({ buffer->Events[tail & (ThreadBuffer::CAPACITY - 1)], buffer->Index });
+				buffer->Tail.store(tail, std::memory_order_release);
+			}
+		}
+
+		if (s_CaptureFrames)
+		{
+			s_Capture.push_back(frame);
+			if (--s_CaptureFrames == 0)
+			{
+				WriteTrace(s_CapturePath, s_Capture);
+				s_Capture.clear();
+			}
+		}
+	}
+
+	void CaptureTrace(uint32_t frameCount, const std::string& filepath)
+	{
+		s_Capture.clear();
+		s_Capture.reserve(frameCount);
+		s_CaptureFrames = frameCount;
+		s_CapturePath = filepath;
+	}
+
+	bool IsCapturing() { return s_CaptureFrames > 0; }
+
+	const std::vector<Frame>& GetFrames() { return s_Frames; }
+	uint32_t GetFrameHead() { return s_FrameHead; }
+
+	std::vector<std::string> GetThreadNames()
+	{
+		std::scoped_lock lock(s_ThreadsMutex);
+		std::vector<std::string> names;
+		names.reserve(s_Threads.size());
+		for (auto& buffer : s_Threads)
+			names.push_back(buffer->Name);
+		return names;
+	}
+#else
+	// Only the clock is kept, startup still logs its time to first frame
+	namespace
+	{
+		std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+	}
+
+	void Init() { s_Epoch = std::chrono::steady_clock::now(); }
+	void Shutdown() {}
+	uint64_t Now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count(); }
+	void SetThreadName(const std::string&) {}
+	void BeginZone(const char*) {}
+	void EndZone() {}
+	void Counter(const char*, double) {}
+	void MarkFrame() {}
+	void CaptureTrace(uint32_t, const std::string&) {}
+	bool IsCapturing() { return false; }
+	const std::vector<Frame>& GetFrames() { static std::vector<Frame> frames; return frames; }
+	uint32_t GetFrameHead() { return 0; }
+	std::vector<std::string> GetThreadNames() { return {}; }
+#endif
+}
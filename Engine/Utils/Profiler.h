@@ -0,0 +1,118 @@
+#pragma once
+
+// Set by CMake, off in Release unless the WC_PROFILER option is on
+#ifndef WC_PROFILER
+#define WC_PROFILER 1
+#endif
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace wc::Profiler
+{
+	enum class EventType : uint8_t
+	{
+		Zone,
+		Counter,
+	};
+
+	// Names are expected to be string literals (or otherwise outlive the profiler)
+	struct Event
+	{
+		const char* Name = nullptr;
+		uint64_t Start = 0; // nanoseconds since Init
+		union
+		{
+			uint64_t End;
+			double Value;
+		};
+		uint16_t Depth = 0;
+		EventType Type = EventType::Zone;
+	};
+
+	struct ThreadBuffer
+	{
+		static constexpr uint32_t CAPACITY = 1 << 14; // must be a power of 2
+		static constexpr uint32_t MAX_DEPTH = 64;
+
+		// Single producer (the owning thread) / single consumer (the collecting thread)
+		Event Events[CAPACITY];
+		std::atomic<uint32_t> Head = 0;
+		std::atomic<uint32_t> Tail = 0;
+
+		Event Open[MAX_DEPTH]; // Zones that haven't ended yet, only touched by the owning thread
+		uint16_t Depth = 0;
+		uint32_t Index = 0;
+		std::string Name;
+
+		void Push(const Event& event);
+	};
+
+	struct CollectedEvent
+	{
+		Event Data;
+		uint32_t Thread = 0;
+	};
+
+	struct Frame
+	{
+		uint64_t Index = 0;
+		uint64_t Start = 0;
+		uint64_t End = 0;
+		std::vector<CollectedEvent> Events;
+
+		float GetDuration() const { return float(End - Start) / 1'000'000.f; } // milliseconds
+	};
+
+	constexpr uint32_t FRAME_HISTORY = 240;
+
+	void Init();
+
+	void Shutdown();
+
+	uint64_t Now();
+
+	void SetThreadName(const std::string& name);
+
+	void BeginZone(const char* name);
+
+	void EndZone();
+
+	void Counter(const char* name, double value);
+
+	// Closes the current frame and collects the events of all threads
+	void MarkFrame();
+
+	// The next `frameCount` frames will be written to `filepath` as a chrome://tracing / Perfetto trace
+	void CaptureTrace(uint32_t frameCount, const std::string& filepath);
+
+	bool IsCapturing();
+
+	const std::vector<Frame>& GetFrames(); // Ring buffer, use GetFrameHead to get the newest frame
+	uint32_t GetFrameHead();
+	std::vector<std::string> GetThreadNames();
+
+	struct Zone
+	{
+		Zone(const char* name) { BeginZone(name); }
+		~Zone() { EndZone(); }
+	};
+}
+
+#define WC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define WC_PROFILE_CONCAT(a, b) WC_PROFILE_CONCAT_IMPL(a, b)
+
+#if WC_PROFILER
+#define WC_PROFILE_SCOPE(name) ::wc::Profiler::Zone WC_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define WC_PROFILE_FUNCTION() WC_PROFILE_SCOPE(__FUNCTION__)
+#define WC_PROFILE_FRAME() ::wc::Profiler::MarkFrame()
+#define WC_PROFILE_COUNTER(name, value) ::wc::Profiler::Counter(name, double(value))
+#define WC_PROFILE_THREAD(name) ::wc::Profiler::SetThreadName(name)
+#else
+#define WC_PROFILE_SCOPE(name)
+#define WC_PROFILE_FUNCTION()
+#define WC_PROFILE_FRAME()
+#define WC_PROFILE_COUNTER(name, value)
+#define WC_PROFILE_THREAD(name)
+#endif
@@ -0,0 +1,184 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <mutex>
+#include <thread>
+
+#include "Log.h"
+#include "Profiler.h"
+
+namespace wc
+{
+	TaskGraph::TaskID TaskGraph::Add(const char* name, std::function<void()> function, std::initializer_list<TaskID> dependencies, ThreadAffinity affinity)
+	{
+		TaskID id = TaskID(m_Tasks.size());
+		auto& task = m_Tasks.emplace_back();
+		task.Name = name;
+		task.Function = std::move(function);
+		task.Affinity = affinity;
+
+		for (TaskID dependency : dependencies)
+		{
+			if (dependency >= id)
+			{
+				WC_CORE_ERROR("Task {} depends on a task that was added after it", name);
+				continue;
+			}
+
+			task.Dependencies.push_back(dependency);
+			m_Tasks[dependency].Dependents.push_back(id);
+		}
+
+		return id;
+	}
+
+	void TaskGraph::Run(uint32_t workerCount)
+	{
+		if (workerCount == 0) workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		uint32_t anyThreadTasks = 0;
+		for (const auto& task : m_Tasks)
+			anyThreadTasks += task.Affinity == AnyThread;
+		m_WorkerCount = std::min(workerCount, anyThreadTasks);
+
+		std::mutex mutex;
+		std::condition_variable workerReady, mainReady;
+		std::deque<TaskID> workerQueue, mainQueue;
+		std::vector<uint32_t> remaining(m_Tasks.size());
+		uint32_t finished = 0;
+
+		auto Enqueue = [&](TaskID id) {
+			if (m_Tasks[id].Affinity == MainThread)
+			{
+				mainQueue.push_back(id);
+				mainReady.notify_one();
+			}
+			else
+			{
+				workerQueue.push_back(id);
+				workerReady.notify_one();
+			}
+			};
+
+		for (TaskID id = 0; id < m_Tasks.size(); id++)
+		{
+			remaining[id] = uint32_t(m_Tasks[id].Dependencies.size());
+			if (remaining[id] == 0) Enqueue(id);
+		}
+
+		auto epoch = std::chrono::steady_clock::now();
+		auto Now = [&]() { return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count()); };
+
+		auto Execute = [&](TaskID id, uint32_t thread) {
+			auto& task = m_Tasks[id];
+			task.Thread = thread;
+			task.Start = Now();
+			{
+				WC_PROFILE_SCOPE(task.Name);
+				task.Function();
+			}
+			task.End = Now();
+
+			std::scoped_lock lock(mutex);
+			finished++;
+			for (TaskID dependent : task.Dependents)
+				if (--remaining[dependent] == 0)
+					Enqueue(dependent);
+
+			if (finished == m_Tasks.size())
+			{
+				workerReady.notify_all();
+				mainReady.notify_all();
+			}
+			};
+
+		std::vector<std::thread> workers;
+		for (uint32_t i = 0; i < m_WorkerCount; i++)
+			workers.emplace_back([&, thread = i + 1]() {
+				WC_PROFILE_THREAD(std::format("Task worker {}", thread));
+				while (true)
+				{
+					TaskID id;
+					{
+						std::unique_lock lock(mutex);
+						workerReady.wait(lock, [&]() { return !workerQueue.empty() || finished == m_Tasks.size(); });
+						if (workerQueue.empty()) return;
+
+						id = workerQueue.front();
+						workerQueue.pop_front();
+					}
+					Execute(id, thread);
+				}
+				});
+
+		// Without workers the main thread has to run everything itself
+		bool mainRunsAll = m_WorkerCount == 0;
+		while (true)
+		{
+			TaskID id;
+			{
+				std::unique_lock lock(mutex);
+				mainReady.wait(lock, [&]() { return !mainQueue.empty() || (mainRunsAll && !workerQueue.empty()) || finished == m_Tasks.size(); });
+
+				auto& queue = !mainQueue.empty() ? mainQueue : workerQueue;
+				if (queue.empty()) break;
+
+				id = queue.front();
+				queue.pop_front();
+			}
+			Execute(id, 0);
+		}
+
+		for (auto& worker : workers)
+			worker.join();
+
+		m_Duration = Now();
+	}
+
+	void TaskGraph::PrintTimeline(const char* title) const
+	{
+		if (m_Tasks.empty()) return;
+
+		constexpr uint32_t WIDTH = 48;
+		auto ms = [](uint64_t ns) { return double(ns) / 1'000'000.0; };
+		double scale = m_Duration ? double(WIDTH) / double(m_Duration) : 0.0;
+
+		size_t nameWidth = 0;
+		for (const auto& task : m_Tasks)
+			nameWidth = std::max(nameWidth, strlen(task.Name));
+
+		WC_CORE_INFO("{}: {:.2f}ms on {} workers + main thread", title, ms(m_Duration), m_WorkerCount);
+		for (const auto& task : m_Tasks)
+		{
+			uint32_t begin = std::min(uint32_t(double(task.Start) * scale), WIDTH - 1);
+			uint32_t end = std::clamp(uint32_t(double(task.End) * scale), begin + 1, WIDTH);
+
+			std::string bar(WIDTH, ' ');
+			std::fill(bar.begin() + begin, bar.begin() + end, task.Thread == 0 ? '#' : '=');
+
+			WC_CORE_INFO("  {:<{}} |{}| {:8.2f}ms  {:8.2f}ms  {}", task.Name, nameWidth, bar, ms(task.Start), ms(task.End - task.Start),
+				task.Thread == 0 ? std::string("main") : std::format("worker {}", task.Thread));
+		}
+
+		// Walk back from the task that finished last through the dependency that finished last
+		TaskID current = TaskID(std::max_element(m_Tasks.begin(), m_Tasks.end(), [](const Task& a, const Task& b) { return a.End < b.End; }) - m_Tasks.begin());
+		std::vector<TaskID> path = { current };
+		while (!m_Tasks[current].Dependencies.empty())
+		{
+			const auto& dependencies = m_Tasks[current].Dependencies;
+			current = *std::max_element(dependencies.begin(), dependencies.end(), [&](TaskID a, TaskID b) { return m_Tasks[a].End < m_Tasks[b].End; });
+			path.push_back(current);
+		}
+
+		std::string criticalPath;
+		for (auto it = path.rbegin(); it != path.rend(); ++it)
+			criticalPath += std::format("{}{} ({:.2f}ms)", it == path.rbegin() ? "" : " -> ", m_Tasks[*it].Name, ms(m_Tasks[*it].End - m_Tasks[*it].Start));
+
+		WC_CORE_INFO("  Critical path: {}", criticalPath);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace wc
+{
+	// Runs a set of tasks once, respecting the declared dependencies. Used for startup where most steps are independent
+	// (reading shaders, decoding images, rasterizing fonts) but a few have to stay on the main thread (GLFW, queue submits).
+	//
+	//	TaskGraph graph;
+	//	auto window = graph.Add("Window", CreateWindow, {}, TaskGraph::MainThread);
+	//	auto fonts = graph.Add("Fonts", BuildFonts);
+	//	graph.Add("ImGui", InitImGui, { window, fonts }, TaskGraph::MainThread);
+	//	graph.Run();
+	struct TaskGraph
+	{
+		using TaskID = uint32_t;
+
+		enum ThreadAffinity : uint8_t
+		{
+			AnyThread,
+			MainThread, // Runs on the thread that called Run, in the order the tasks become ready
+		};
+
+		struct Task
+		{
+			const char* Name = nullptr; // Expected to be a string literal, it's also used as a profiler zone name
+			std::function<void()> Function;
+			std::vector<TaskID> Dependencies;
+			std::vector<TaskID> Dependents;
+			ThreadAffinity Affinity = AnyThread;
+
+			// Filled by Run, nanoseconds since Run was called
+			uint64_t Start = 0;
+			uint64_t End = 0;
+			uint32_t Thread = 0; // 0 is the main thread
+		};
+
+		// Dependencies have to be added before the tasks that depend on them
+		TaskID Add(const char* name, std::function<void()> function, std::initializer_list<TaskID> dependencies = {}, ThreadAffinity affinity = AnyThread);
+
+		// Blocks until every task finished. 0 workers uses the hardware thread count
+		void Run(uint32_t workerCount = 0);
+
+		// Logs every task on a shared time axis along with the critical path
+		void PrintTimeline(const char* title) const;
+
+		uint64_t GetDuration() const { return m_Duration; } // nanoseconds
+
+		const std::vector<Task>& GetTasks() const { return m_Tasks; }
+
+	private:
+		std::vector<Task> m_Tasks;
+		uint32_t m_WorkerCount = 0;
+		uint64_t m_Duration = 0;
+	};
+}
@@ -3,6 +3,7 @@
 #include "imgui_impl_vulkan.h"
 #include "../Rendering/Texture.h"
 #include "../Rendering/Shader.h"
+#include "../Rendering/GPUProfiler.h"
 
 #include <stdio.h>
 
@@ -158,7 +159,10 @@ static ImGui_ImplVulkan_Data* ImGui_ImplVulkan_GetBackendData() { return ImGui::
 
 VkDescriptorSet MakeImGuiDescriptor(VkDescriptorSet dSet, const VkDescriptorImageInfo& imageInfo)
 {
-	if (dSet == VK_NULL_HANDLE) vk::descriptorAllocator.Allocate(dSet, ImGui_ImplVulkan_GetBackendData()->Shader.DescriptorLayout);
+	ImGui_ImplVulkan_Data* bd = ImGui_ImplVulkan_GetBackendData();
+	if (!bd) return dSet; // Headless, there is no ImGui backend to display the image with
+
+	if (dSet == VK_NULL_HANDLE) vk::descriptorAllocator.Allocate(dSet, bd->Shader.DescriptorLayout);
 
 	vk::DescriptorWriter writer(dSet);
 	writer.BindImage(0, imageInfo, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
@@ -238,6 +242,12 @@ void ImGui_ImplVulkan_RenderDrawData(ImDrawData* draw_data, VkCommandBuffer cmd,
 	begInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 	vkBeginCommandBuffer(cmd, &begInfo);
+
+    // Only the main viewport is recorded into the frame's command buffer
+    uint32_t zone = UINT32_MAX;
+    if (draw_data->OwnerViewport == ImGui::GetMainViewport())
+        zone = blaze::gpuProfiler.BeginZone(cmd, "ImGui");
+
     vkCmdBeginRenderPass(cmd, &rpInfo, VK_SUBPASS_CONTENTS_INLINE);
 	{
 		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bd->Shader.Pipeline);
@@ -326,6 +336,7 @@ void ImGui_ImplVulkan_RenderDrawData(ImDrawData* draw_data, VkCommandBuffer cmd,
     VkRect2D scissor = { { 0, 0 }, { (uint32_t)fb_width, (uint32_t)fb_height } };
     vkCmdSetScissor(cmd, 0, 1, &scissor);
     vkCmdEndRenderPass(cmd);
+    blaze::gpuProfiler.EndZone(cmd, zone);
     vkEndCommandBuffer(cmd);
 }
 
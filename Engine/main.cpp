@@ -13,6 +13,12 @@
 #include "imgui_backend/imgui_impl_vulkan.h"
 
 #include "Editor/Editor.h"
+#include "Headless.h"
+#include "Benchmarks.h"
+#include "Packer.h"
+#include "Utils/TaskGraph.h"
+#include "Utils/JobSystem.h"
+#include "UI/FontAtlasCache.h"
 
 //DANGEROUS!
 #pragma warning(push, 0)
@@ -56,28 +62,14 @@ void Resize()
 //----------------------------------------------------------------------------------------------------------------------
 bool InitApp()
 {
-	Globals.SoundContext.InitializeContext();
+	// Independent steps run on worker threads, everything that touches GLFW or submits to a queue stays on the main thread
+	TaskGraph startup;
 
-	WindowCreateInfo windowInfo =
-	{
-		.Width = 1280,
-		.Height = 720,
-		.Name = "Editor",
-		.StartMode = WindowMode::Maximized,
-		.VSync = false,
-		.Resizeable = true,
-		.Decorated = false,
-	};
-	Globals.window.Create(windowInfo);
-	Globals.window.SetFramebufferResizeCallback([](GLFWwindow* window, int w, int h)
-		{
-			reinterpret_cast<wc::Window*>(glfwGetWindowUserPointer(window))->resized = true;
-		});
-	swapchain.Create(Globals.window);
+	auto audio = startup.Add("Audio", []() { Globals.SoundContext.InitializeContext(); });
 
-	vk::SyncContext::Create();
+	auto shaders = startup.Add("Shader binaries", []() { PrefetchBinaries("assets/shaders"); });
 
-	vk::descriptorAllocator.Create();
+	auto icons = startup.Add("Editor icons", []() { editor.DecodeIcons(); });
 
 	ImGui::CreateContext();
 
@@ -85,38 +77,81 @@ bool InitApp()
 	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 	io.IniFilename = "assets/imgui.ini"; // TODO - remove and find alternative
 	//io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
-	/*//OLD FONTS
-	Globals.fontDefault = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 17.f);
-	Globals.fontBig = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 30.f);
-	Globals.fontMenu = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 20.f);*/
-
-	// Default font -> Poppins
-	Globals.f_Default.Regular = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Regular.ttf", 17.f);
-	Globals.f_Default.Bold = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Bold.ttf", 17.f);
-	Globals.f_Default.Italic = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Italic.ttf", 17.f);
-	Globals.f_Default.Thin = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Thin.ttf", 17.f);
-	Globals.f_Default.Big = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Regular.ttf", 30.f);
-	Globals.f_Default.Small = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Regular.ttf", 14.f);
-	Globals.f_Default.Menu = io.Fonts->AddFontFromFileTTF("assets/fonts/Poppins/Poppins-Regular.ttf", 20.f);
-
-	// Display font -> Neptune
-	Globals.f_Display.Regular = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Regular.ttf", 17.f);
-	Globals.f_Display.Bold = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Bold.ttf", 17.f);
-	Globals.f_Display.Thin = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Thin.ttf", 17.f);
-	Globals.f_Display.Big = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Regular.ttf", 30.f);
-	Globals.f_Display.Small = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Regular.ttf", 14.f);
-	Globals.f_Display.Menu = io.Fonts->AddFontFromFileTTF("assets/fonts/SeedSans/SeedSans-Regular.ttf", 20.f);
-
-	io.FontDefault = Globals.f_Default.Regular;
-
-	ImGui_ImplGlfw_InitForVulkan(Globals.window, false);
-
-	ImGui_ImplVulkan_Init(swapchain.RenderPass);
-	ImGui_ImplVulkan_CreateFontsTexture();
-
-	ImGuiStyle& style = ImGui::GetStyle();
-	style = ui::SoDark(0.0f);
-	editor.Create();
+
+	// Goes through the ImGui context (every IM_ALLOC counts into its IO), so whatever else uses ImGui has to wait for it.
+	// It still overlaps the window, swapchain and sync setup
+	auto fonts = startup.Add("ImGui fonts", [&io]() {
+		/*//OLD FONTS
+		Globals.fontDefault = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 17.f);
+		Globals.fontBig = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 30.f);
+		Globals.fontMenu = io.Fonts->AddFontFromFileTTF("assets/fonts/OpenSans-Regular.ttf", 20.f);*/
+
+		// Rasterizes the atlas here (or restores it from the cache) instead of in ImGui_ImplVulkan_CreateFontsTexture
+		FontAtlasCache::Build(*io.Fonts, {
+			// Default font -> Poppins
+			{ "assets/fonts/Poppins/Poppins-Regular.ttf", 17.f, &Globals.f_Default.Regular },
+			{ "assets/fonts/Poppins/Poppins-Bold.ttf", 17.f, &Globals.f_Default.Bold },
+			{ "assets/fonts/Poppins/Poppins-Italic.ttf", 17.f, &Globals.f_Default.Italic },
+			{ "assets/fonts/Poppins/Poppins-Thin.ttf", 17.f, &Globals.f_Default.Thin },
+			{ "assets/fonts/Poppins/Poppins-Regular.ttf", 30.f, &Globals.f_Default.Big },
+			{ "assets/fonts/Poppins/Poppins-Regular.ttf", 14.f, &Globals.f_Default.Small },
+			{ "assets/fonts/Poppins/Poppins-Regular.ttf", 20.f, &Globals.f_Default.Menu },
+
+			// Display font -> Neptune
+			{ "assets/fonts/SeedSans/SeedSans-Regular.ttf", 17.f, &Globals.f_Display.Regular },
+			{ "assets/fonts/SeedSans/SeedSans-Bold.ttf", 17.f, &Globals.f_Display.Bold },
+			{ "assets/fonts/SeedSans/SeedSans-Thin.ttf", 17.f, &Globals.f_Display.Thin },
+			{ "assets/fonts/SeedSans/SeedSans-Regular.ttf", 30.f, &Globals.f_Display.Big },
+			{ "assets/fonts/SeedSans/SeedSans-Regular.ttf", 14.f, &Globals.f_Display.Small },
+			{ "assets/fonts/SeedSans/SeedSans-Regular.ttf", 20.f, &Globals.f_Display.Menu },
+			}, ".blaze/cache/imgui_fonts.bin");
+		});
+
+	auto window = startup.Add("Window", []() {
+		WindowCreateInfo windowInfo =
+		{
+			.Width = 1280,
+			.Height = 720,
+			.Name = "Editor",
+			.StartMode = WindowMode::Maximized,
+			.VSync = false,
+			.Resizeable = true,
+			.Decorated = false,
+		};
+		Globals.window.Create(windowInfo);
+		Globals.window.SetFramebufferResizeCallback([](GLFWwindow* window, int w, int h)
+			{
+				reinterpret_cast<wc::Window*>(glfwGetWindowUserPointer(window))->resized = true;
+			});
+		}, {}, TaskGraph::MainThread);
+
+	auto swapchainTask = startup.Add("Swapchain", []() { swapchain.Create(Globals.window); }, { window }, TaskGraph::MainThread);
+
+	auto sync = startup.Add("Sync context", []() {
+		vk::SyncContext::Create();
+		gpuProfiler.Init();
+
+		vk::descriptorAllocator.Create();
+		}, {}, TaskGraph::MainThread);
+
+	auto imguiBackend = startup.Add("ImGui backend", []() {
+		ImGui_ImplGlfw_InitForVulkan(Globals.window, false);
+		ImGui_ImplVulkan_Init(swapchain.RenderPass);
+		}, { window, swapchainTask, sync, shaders, fonts }, TaskGraph::MainThread);
+
+	startup.Add("ImGui font texture", [&io]() {
+		io.FontDefault = Globals.f_Default.Regular;
+		ImGui_ImplVulkan_CreateFontsTexture();
+
+		ImGuiStyle& style = ImGui::GetStyle();
+		style = ui::SoDark(0.0f);
+		}, { imguiBackend, fonts }, TaskGraph::MainThread);
+
+	// Textures create ImGui descriptors so the backend has to exist, loading the project may run scripts that play sounds
+	startup.Add("Editor", []() { editor.Create(); }, { imguiBackend, icons, audio, fonts }, TaskGraph::MainThread);
+
+	startup.Run();
+	startup.PrintTimeline("Startup");
 
 	return true;
 }
@@ -125,7 +160,11 @@ bool InitApp()
 void UpdateApp()
 {
 	//auto r = 
-	vk::SyncContext::GetRenderFence().Wait();
+	{
+		WC_PROFILE_SCOPE("Wait for GPU");
+		vk::SyncContext::GetRenderFence().Wait();
+	}
+	gpuProfiler.BeginFrame();
 
 	//WC_CORE_INFO("Acquire result: {}, {}", magic_enum::enum_name(r), (int)r);
 
@@ -152,13 +191,16 @@ void UpdateApp()
 		vk::SyncContext::GetRenderFence().Reset(); // deadlock fix
 
 
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
-		ImGuizmo::BeginFrame();
+		{
+			WC_PROFILE_SCOPE("ImGui");
+			ImGui_ImplGlfw_NewFrame();
+			ImGui::NewFrame();
+			ImGuizmo::BeginFrame();
 
-		editor.UI();
+			editor.UI();
 
-		ImGui::Render();
+			ImGui::Render();
+		}
 
 		auto& cmd = vk::SyncContext::GetMainCommandBuffer();
 		vkResetCommandBuffer(cmd, 0);
@@ -186,7 +228,10 @@ void UpdateApp()
 			.pClearValues = &clearValue,
 		};
 
-		ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd, rpInfo);
+		{
+			WC_PROFILE_SCOPE("ImGui Render");
+			ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd, rpInfo);
+		}
 
 		VkPipelineStageFlags waitStage[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
 		vk::Semaphore waitSemaphores[] = { vk::SyncContext::GetImageAvaibleSemaphore(), vk::SyncContext::m_TimelineSemaphore, };
@@ -225,6 +270,7 @@ void UpdateApp()
 			.pImageIndices = &swapchainImageIndex,
 		};
 
+		WC_PROFILE_SCOPE("Present");
 		VkResult presentationResult = vkQueuePresentKHR(vk::SyncContext::GetPresentQueue(), &presentInfo);
 
 		if (presentationResult == VK_ERROR_OUT_OF_DATE_KHR || presentationResult == VK_SUBOPTIMAL_KHR || Globals.window.resized)
@@ -380,6 +426,14 @@ void UpdateAppFrame()
 		if (Globals.window.HasFocus()) editor.Input();
 
 		UpdateApp();
+		WC_PROFILE_FRAME();
+
+		static bool firstFrame = true;
+		if (firstFrame)
+		{
+			WC_CORE_INFO("Time to first frame: {:.2f}ms", double(Profiler::Now()) / 1'000'000.0);
+			firstFrame = false;
+		}
 	}
 }
 
@@ -398,13 +452,45 @@ void DeinitApp()
 
 	vk::descriptorAllocator.Destroy();
 	editor.Destroy();
+	vk::samplerCache.Destroy();
+	gpuProfiler.Deinit();
 
 	vk::SyncContext::Destroy();
 }
 
-int main()
+int main(int argc, char** argv)
 {
 	Log::Init();
+	Profiler::Init();
+
+	// --workers N sizes the job system physics steps on, 0 steps on the main thread alone. Without the flag there's a
+	// worker per hardware thread
+	uint32_t workerCount = JobSystem::HARDWARE_WORKERS;
+	for (int i = 1; i + 1 < argc; i++)
+		if (std::string(argv[i]) == "--workers") workerCount = (uint32_t)std::max(std::atoi(argv[i + 1]), 0);
+	jobSystem.Create(workerCount);
+
+	HeadlessOptions headlessOptions;
+	bool headless = ParseHeadlessArgs(argc, argv, headlessOptions); // Before the working directory changes
+
+	PackOptions packOptions;
+	bool pack = ParsePackArgs(argc, argv, packOptions);
+
+	ConvertSceneOptions convertOptions;
+	if (ParseConvertSceneArgs(argc, argv, convertOptions))
+	{
+		int result = RunSceneConverter(convertOptions);
+		Profiler::Shutdown();
+		return result;
+	}
+
+	BenchmarkOptions benchmarkOptions;
+	if (ParseBenchmarkArgs(argc, argv, benchmarkOptions))
+	{
+		int result = RunBenchmarks(benchmarkOptions);
+		Profiler::Shutdown();
+		return result;
+	}
 
 #ifdef MSVC  // Visual Studio
 	std::filesystem::current_path("../../../../Engine/workdir");
@@ -414,6 +500,26 @@ int main()
 	std::filesystem::current_path("../../../../Engine/workdir");
 #endif
 
+	if (pack) // Script compilation needs the builtin definitions from the working directory
+	{
+		int result = RunPacker(packOptions);
+		Profiler::Shutdown();
+		return result;
+	}
+
+	if (headless)
+	{
+		int result = 1;
+		if (VulkanContext::Create(true))
+		{
+			result = RunHeadless(headlessOptions);
+			VulkanContext::Destroy();
+		}
+
+		Profiler::Shutdown();
+		return result;
+	}
+
 	glfwSetErrorCallback([](int err, const char* description) { WC_CORE_ERROR(description); /*WC_DEBUGBREAK();*/ });
 	//glfwSetMonitorCallback([](GLFWmonitor* monitor, int event)
 	//	{
@@ -438,6 +544,7 @@ int main()
 	}
 
 	glfwTerminate();
+	Profiler::Shutdown();
 
 	return 0;
 }
\ No newline at end of file